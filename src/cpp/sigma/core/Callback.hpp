@@ -7,6 +7,7 @@
 #define SIGMA_CORE_CALLBACK_HPP_
 
 #include <cassert>
+#include <cstddef>
 #include <map>
 #include <memory>
 
@@ -27,6 +28,17 @@ class ScopedCallback;
 template<typename... function_parameters>
 class CallbackHandler;
 
+//------------------------------------------------------------------------------
+//                                    TYPEDEFS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Function that is passed the owner given to
+ *        CallbackHandler::set_usage_observer() along with the change in the
+ *        number of bytes allocated for registered callbacks.
+ */
+typedef void (*CallbackUsageObserver)(void*, std::ptrdiff_t);
+
 //------------------------------------------------------------------------------
 //                                    CLASSES
 //------------------------------------------------------------------------------
@@ -560,6 +572,7 @@ public:
         f.owner = NULL;
         f.function.standard = callback_function;
         m_callback_funcs[id] = f;
+        notify_usage(static_cast<std::ptrdiff_t>(get_function_usage()));
 
         // return transient information about the callback
         return TransientCallbackID(this, id);
@@ -597,6 +610,7 @@ public:
         f.owner = owner;
         f.function.member = member_wrapper<owner_type, function_type>;
         m_callback_funcs[id] = f;
+        notify_usage(static_cast<std::ptrdiff_t>(get_function_usage()));
 
         // return transient information about the callback
         return TransientCallbackID(this, id);
@@ -622,11 +636,43 @@ private:
      *        reference counters.
      */
     std::map<arc::uint32, CallbackReferenceCounter*> m_scope_refs;
+    /*!
+     * \brief Is called whenever callbacks are registered or unregistered, or
+     *        null.
+     */
+    CallbackUsageObserver m_usage_observer;
+    /*!
+     * \brief The owner passed to m_usage_observer.
+     */
+    void* m_usage_owner;
 
     //--------------------------------------------------------------------------
     //                          PRIVATE STATIC FUNCTIONS
     //--------------------------------------------------------------------------
 
+    /*!
+     * \brief Returns the approximate number of bytes allocated for each
+     *        registered function.
+     */
+    static std::size_t get_function_usage()
+    {
+        // each entry of a map is a node holding the value along with its
+        // links to the other nodes
+        return sizeof(typename decltype(m_callback_funcs)::value_type) +
+               4 * sizeof(void*);
+    }
+
+    /*!
+     * \brief Returns the approximate number of bytes allocated for each
+     *        reference counter held for a ScopedCallback.
+     */
+    static std::size_t get_reference_usage()
+    {
+        return sizeof(typename decltype(m_scope_refs)::value_type) +
+               4 * sizeof(void*) +
+               sizeof(CallbackReferenceCounter);
+    }
+
     /*!
      * \brief Static function used to wrap member functions so they can be
      *        handled as normal function pointer.
@@ -647,7 +693,9 @@ private:
      */
     CallbackInterface()
         :
-        m_next_id(0)
+        m_next_id       (0),
+        m_usage_observer(nullptr),
+        m_usage_owner   (nullptr)
     {
     }
 
@@ -678,6 +726,7 @@ private:
         assert(m_scope_refs.find(id) == m_scope_refs.end());
         // add to mapping
          m_scope_refs[id] = ref_counter;
+         notify_usage(static_cast<std::ptrdiff_t>(get_reference_usage()));
     }
 
     /*!
@@ -696,6 +745,20 @@ private:
         // remove the id and function from the mappings
         m_callback_funcs.erase(id);
         m_scope_refs.erase(id);
+        notify_usage(-static_cast<std::ptrdiff_t>(
+                get_function_usage() + get_reference_usage()));
+    }
+
+    /*!
+     * \brief Passes the change in the number of bytes allocated for
+     *        registered callbacks to the usage observer, if there is one.
+     */
+    void notify_usage(std::ptrdiff_t bytes)
+    {
+        if(m_usage_observer != nullptr)
+        {
+            m_usage_observer(m_usage_owner, bytes);
+        }
     }
 
     /*!
@@ -819,6 +882,35 @@ public:
         m_interface.trigger(params...);
     }
 
+    /*!
+     * \brief Returns the approximate number of bytes allocated for the
+     *        callback functions registered with this handler.
+     *
+     * The handler itself is not included.
+     */
+    std::size_t get_memory_usage() const
+    {
+        typedef CallbackInterface<function_parameters...> Interface;
+        return m_interface.m_callback_funcs.size() *
+                    Interface::get_function_usage() +
+               m_interface.m_scope_refs.size() *
+                    Interface::get_reference_usage();
+    }
+
+    /*!
+     * \brief Sets the function that is called with the change in
+     *        get_memory_usage() whenever a callback is registered or
+     *        unregistered with this handler.
+     *
+     * \param observer The function to call, or null to stop observing.
+     * \param owner Is passed as the first argument of the observer.
+     */
+    void set_usage_observer(CallbackUsageObserver observer, void* owner)
+    {
+        m_interface.m_usage_observer = observer;
+        m_interface.m_usage_owner = owner;
+    }
+
 private:
 
     //--------------------------------------------------------------------------
@@ -0,0 +1,752 @@
+#include "sigma/core/tasks/AttributeTable.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+#include <arcanecore/base/Exceptions.hpp>
+
+#include "sigma/core/tasks/Task.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+inline bool get_bit(const std::vector<arc::uint64>& bits, std::size_t index)
+{
+    return ((bits[index >> 6] >> (index & 63)) & 1) != 0;
+}
+
+inline void set_bit(
+        std::vector<arc::uint64>& bits,
+        std::size_t index,
+        bool value)
+{
+    arc::uint64 bit = static_cast<arc::uint64>(1) << (index & 63);
+    if(value)
+    {
+        bits[index >> 6] |= bit;
+    }
+    else
+    {
+        bits[index >> 6] &= ~bit;
+    }
+}
+
+/*!
+ * \brief Resizes the bitset to the given number of words and masks the last
+ *        word.
+ */
+inline void truncate_bits(
+        std::vector<arc::uint64>& bits,
+        std::size_t words,
+        arc::uint64 mask)
+{
+    bits.resize(words);
+    if(!bits.empty())
+    {
+        bits.back() &= mask;
+    }
+}
+
+/*!
+ * \brief Returns the index of the lowest set bit of a non-zero word.
+ */
+inline std::size_t lowest_bit(arc::uint64 word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return static_cast<std::size_t>(__builtin_ctzll(word));
+#endif
+}
+
+/*!
+ * \brief Returns the number of set bits of a word.
+ */
+inline std::size_t count_bits(arc::uint64 word)
+{
+#ifdef _MSC_VER
+    return static_cast<std::size_t>(__popcnt64(word));
+#else
+    return static_cast<std::size_t>(__builtin_popcountll(word));
+#endif
+}
+
+/*!
+ * \brief Restricts the mask to the Tasks whose bit-sliced value equals one of
+ *        the values in the given bit mask of values.
+ */
+void match_sliced_values(
+        const std::vector<arc::uint64>* planes,
+        std::size_t plane_count,
+        arc::uint32 values,
+        std::vector<arc::uint64>& mask)
+{
+    for(std::size_t word = 0; word < mask.size(); ++word)
+    {
+        arc::uint64 matches = 0;
+        for(arc::uint32 value = 0; value < (1U << plane_count); ++value)
+        {
+            if((values & (1U << value)) == 0)
+            {
+                continue;
+            }
+            arc::uint64 equal = ~static_cast<arc::uint64>(0);
+            for(std::size_t plane = 0; plane < plane_count; ++plane)
+            {
+                arc::uint64 bits = planes[plane][word];
+                equal &= ((value >> plane) & 1) ? bits : ~bits;
+            }
+            matches |= equal;
+        }
+        mask[word] &= matches;
+    }
+}
+
+/*!
+ * \brief Restricts the mask to the Tasks whose bit-sliced value is within the
+ *        given inclusive range.
+ *
+ * The comparison is performed from the most significant plane down, tracking
+ * which Tasks are already known to be greater/less than the bound and which
+ * are still equal to it.
+ */
+void match_sliced_range(
+        const std::vector<arc::uint64>* planes,
+        std::size_t plane_count,
+        arc::uint32 min,
+        arc::uint32 max,
+        std::vector<arc::uint64>& mask)
+{
+    for(std::size_t word = 0; word < mask.size(); ++word)
+    {
+        arc::uint64 greater = 0;
+        arc::uint64 less = 0;
+        arc::uint64 equal_min = ~static_cast<arc::uint64>(0);
+        arc::uint64 equal_max = ~static_cast<arc::uint64>(0);
+        for(std::size_t plane = plane_count; plane-- > 0;)
+        {
+            arc::uint64 bits = planes[plane][word];
+            if((min >> plane) & 1)
+            {
+                equal_min &= bits;
+            }
+            else
+            {
+                greater |= equal_min & bits;
+                equal_min &= ~bits;
+            }
+            if((max >> plane) & 1)
+            {
+                less |= equal_max & ~bits;
+                equal_max &= bits;
+            }
+            else
+            {
+                equal_max &= ~bits;
+            }
+        }
+        mask[word] &= (greater | equal_min) & (less | equal_max);
+    }
+}
+
+/*!
+ * \brief Restricts the mask to the Tasks whose value in the given column is
+ *        within the given inclusive range.
+ */
+template<typename T>
+void match_column_range(
+        const std::vector<T>& column,
+        T min,
+        T max,
+        std::vector<arc::uint64>& mask)
+{
+    for(std::size_t word = 0; word < mask.size(); ++word)
+    {
+        // skip words that can no longer match
+        if(mask[word] == 0)
+        {
+            continue;
+        }
+        std::size_t begin = word << 6;
+        std::size_t end = std::min(begin + 64, column.size());
+        arc::uint64 matches = 0;
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            matches |=
+                static_cast<arc::uint64>(column[i] >= min && column[i] <= max)
+                << (i - begin);
+        }
+        mask[word] &= matches;
+    }
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+AttributeTable::AttributeTable()
+{
+    m_assignee_names.push_back(arc::str::UTF8String());
+    m_assignee_ids[arc::str::UTF8String()] = 0;
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+std::size_t AttributeTable::get_size() const
+{
+    return m_tasks.size();
+}
+
+void AttributeTable::insert(Task* task)
+{
+    std::size_t index = m_tasks.size();
+    task->m_dense_index = static_cast<arc::uint32>(index);
+    m_tasks.push_back(task);
+
+    // start a new word of each bitset
+    if((index & 63) == 0)
+    {
+        for(std::size_t i = 0; i < STATUS_BITS; ++i)
+        {
+            m_status[i].push_back(0);
+        }
+        for(std::size_t i = 0; i < PRIORITY_BITS; ++i)
+        {
+            m_priority[i].push_back(0);
+        }
+        for(std::size_t i = 0; i < FLAG_BITS; ++i)
+        {
+            m_flags[i].push_back(0);
+        }
+        m_has_due_date.push_back(0);
+    }
+    m_estimates.push_back(0);
+    m_due_dates.push_back(0);
+    m_assignees.push_back(0);
+}
+
+void AttributeTable::remove(Task* task)
+{
+    std::size_t index = task->m_dense_index;
+    std::size_t last = m_tasks.size() - 1;
+    assert(m_tasks[index] == task);
+
+    // fill the gap with the last Task
+    if(index != last)
+    {
+        move_index(last, index);
+        m_tasks[index] = m_tasks[last];
+        m_tasks[index]->m_dense_index = static_cast<arc::uint32>(index);
+    }
+
+    // clear the last index so that unused bits are always zero
+    TaskAttributes defaults;
+    set(last, defaults);
+    m_tasks.pop_back();
+    m_estimates.pop_back();
+    m_due_dates.pop_back();
+    m_assignees.pop_back();
+    if((last & 63) == 0)
+    {
+        for(std::size_t i = 0; i < STATUS_BITS; ++i)
+        {
+            m_status[i].pop_back();
+        }
+        for(std::size_t i = 0; i < PRIORITY_BITS; ++i)
+        {
+            m_priority[i].pop_back();
+        }
+        for(std::size_t i = 0; i < FLAG_BITS; ++i)
+        {
+            m_flags[i].pop_back();
+        }
+        m_has_due_date.pop_back();
+    }
+}
+
+void AttributeTable::transfer(
+        const std::vector<Task*>& tasks,
+        AttributeTable& target)
+{
+    static const arc::uint32 UNMAPPED = 0xFFFFFFFF;
+
+    target.m_tasks.reserve(target.m_tasks.size() + tasks.size());
+    target.m_estimates.reserve(target.m_estimates.size() + tasks.size());
+    target.m_due_dates.reserve(target.m_due_dates.size() + tasks.size());
+    target.m_assignees.reserve(target.m_assignees.size() + tasks.size());
+
+    // each distinct assignee is only interned by the target once
+    std::vector<arc::uint32> assignee_ids(m_assignee_names.size(), UNMAPPED);
+    std::vector<std::size_t> removed;
+    removed.reserve(tasks.size());
+    ARC_CONST_FOR_EACH(it, tasks)
+    {
+        Task* task = *it;
+        std::size_t from = task->m_dense_index;
+        assert(m_tasks[from] == task);
+        removed.push_back(from);
+
+        target.insert(task);
+        std::size_t to = task->m_dense_index;
+        for(std::size_t i = 0; i < STATUS_BITS; ++i)
+        {
+            set_bit(target.m_status[i], to, get_bit(m_status[i], from));
+        }
+        for(std::size_t i = 0; i < PRIORITY_BITS; ++i)
+        {
+            set_bit(target.m_priority[i], to, get_bit(m_priority[i], from));
+        }
+        for(std::size_t i = 0; i < FLAG_BITS; ++i)
+        {
+            set_bit(target.m_flags[i], to, get_bit(m_flags[i], from));
+        }
+        set_bit(target.m_has_due_date, to, get_bit(m_has_due_date, from));
+        target.m_estimates[to] = m_estimates[from];
+        target.m_due_dates[to] = m_due_dates[from];
+
+        arc::uint32 assignee = m_assignees[from];
+        if(assignee_ids[assignee] == UNMAPPED)
+        {
+            assignee_ids[assignee] =
+                target.intern_assignee(m_assignee_names[assignee]);
+        }
+        target.m_assignees[to] = assignee_ids[assignee];
+    }
+
+    // fill the gaps from the end of the table, in descending order so that
+    // every Task moved into a gap is one that stays in this table
+    std::sort(removed.begin(), removed.end(), std::greater<std::size_t>());
+    std::size_t size = m_tasks.size();
+    ARC_CONST_FOR_EACH(it, removed)
+    {
+        std::size_t index = *it;
+        std::size_t last = --size;
+        if(index != last)
+        {
+            move_index(last, index);
+            m_tasks[index] = m_tasks[last];
+            m_tasks[index]->m_dense_index = static_cast<arc::uint32>(index);
+        }
+    }
+    truncate(size);
+}
+
+void AttributeTable::get(std::size_t index, TaskAttributes& attributes) const
+{
+    attributes.status       = get_status(index);
+    attributes.priority     = get_priority(index);
+    attributes.estimate     = get_estimate(index);
+    attributes.assignee     = get_assignee(index);
+    attributes.has_due_date = has_due_date(index);
+    attributes.due_date     = get_due_date(index);
+    attributes.flags        = get_flags(index);
+}
+
+void AttributeTable::set(std::size_t index, const TaskAttributes& attributes)
+{
+    for(std::size_t i = 0; i < STATUS_BITS; ++i)
+    {
+        set_bit(m_status[i], index, (attributes.status >> i) & 1);
+    }
+    for(std::size_t i = 0; i < PRIORITY_BITS; ++i)
+    {
+        set_bit(m_priority[i], index, (attributes.priority >> i) & 1);
+    }
+    for(std::size_t i = 0; i < FLAG_BITS; ++i)
+    {
+        set_bit(m_flags[i], index, (attributes.flags >> i) & 1);
+    }
+    set_bit(m_has_due_date, index, attributes.has_due_date);
+    m_estimates[index] = attributes.estimate;
+    m_due_dates[index] = attributes.has_due_date ? attributes.due_date : 0;
+    m_assignees[index] = intern_assignee(attributes.assignee);
+}
+
+TaskStatus AttributeTable::get_status(std::size_t index) const
+{
+    arc::uint32 status = 0;
+    for(std::size_t i = 0; i < STATUS_BITS; ++i)
+    {
+        status |= static_cast<arc::uint32>(get_bit(m_status[i], index)) << i;
+    }
+    return static_cast<TaskStatus>(status);
+}
+
+TaskPriority AttributeTable::get_priority(std::size_t index) const
+{
+    arc::uint32 priority = 0;
+    for(std::size_t i = 0; i < PRIORITY_BITS; ++i)
+    {
+        priority |=
+            static_cast<arc::uint32>(get_bit(m_priority[i], index)) << i;
+    }
+    return static_cast<TaskPriority>(priority);
+}
+
+arc::uint32 AttributeTable::get_estimate(std::size_t index) const
+{
+    return m_estimates[index];
+}
+
+const arc::str::UTF8String& AttributeTable::get_assignee(
+        std::size_t index) const
+{
+    return m_assignee_names[m_assignees[index]];
+}
+
+bool AttributeTable::has_due_date(std::size_t index) const
+{
+    return get_bit(m_has_due_date, index);
+}
+
+arc::int64 AttributeTable::get_due_date(std::size_t index) const
+{
+    return m_due_dates[index];
+}
+
+arc::uint32 AttributeTable::get_flags(std::size_t index) const
+{
+    arc::uint32 flags = 0;
+    for(std::size_t i = 0; i < FLAG_BITS; ++i)
+    {
+        flags |= static_cast<arc::uint32>(get_bit(m_flags[i], index)) << i;
+    }
+    return flags;
+}
+
+void AttributeTable::select(
+        const TaskFilter& filter,
+        std::vector<Task*>& out) const
+{
+    std::vector<arc::uint64> mask;
+    evaluate(filter, mask);
+
+    for(std::size_t word = 0; word < mask.size(); ++word)
+    {
+        arc::uint64 bits = mask[word];
+        while(bits != 0)
+        {
+            out.push_back(m_tasks[(word << 6) + lowest_bit(bits)]);
+            bits &= bits - 1;
+        }
+    }
+}
+
+std::size_t AttributeTable::count(const TaskFilter& filter) const
+{
+    std::vector<arc::uint64> mask;
+    evaluate(filter, mask);
+
+    std::size_t total = 0;
+    ARC_CONST_FOR_EACH(word, mask)
+    {
+        total += count_bits(*word);
+    }
+    return total;
+}
+
+void AttributeTable::reorder(const std::vector<Task*>& order)
+{
+    assert(order.size() == m_tasks.size());
+
+    // the columns are rebuilt at exactly their required size
+    std::size_t words = (order.size() + 63) >> 6;
+    std::vector<arc::uint64> status[STATUS_BITS];
+    std::vector<arc::uint64> priority[PRIORITY_BITS];
+    std::vector<arc::uint64> flags[FLAG_BITS];
+    for(std::size_t i = 0; i < STATUS_BITS; ++i)
+    {
+        status[i].resize(words, 0);
+    }
+    for(std::size_t i = 0; i < PRIORITY_BITS; ++i)
+    {
+        priority[i].resize(words, 0);
+    }
+    for(std::size_t i = 0; i < FLAG_BITS; ++i)
+    {
+        flags[i].resize(words, 0);
+    }
+    std::vector<arc::uint64> has_due_date(words, 0);
+    std::vector<arc::uint32> estimates;
+    std::vector<arc::int64> due_dates;
+    std::vector<arc::uint32> assignees;
+    estimates.reserve(order.size());
+    due_dates.reserve(order.size());
+    assignees.reserve(order.size());
+
+    for(std::size_t to = 0; to < order.size(); ++to)
+    {
+        std::size_t from = order[to]->m_dense_index;
+        assert(m_tasks[from] == order[to]);
+
+        for(std::size_t i = 0; i < STATUS_BITS; ++i)
+        {
+            set_bit(status[i], to, get_bit(m_status[i], from));
+        }
+        for(std::size_t i = 0; i < PRIORITY_BITS; ++i)
+        {
+            set_bit(priority[i], to, get_bit(m_priority[i], from));
+        }
+        for(std::size_t i = 0; i < FLAG_BITS; ++i)
+        {
+            set_bit(flags[i], to, get_bit(m_flags[i], from));
+        }
+        set_bit(has_due_date, to, get_bit(m_has_due_date, from));
+        estimates.push_back(m_estimates[from]);
+        due_dates.push_back(m_due_dates[from]);
+        assignees.push_back(m_assignees[from]);
+    }
+
+    for(std::size_t i = 0; i < STATUS_BITS; ++i)
+    {
+        m_status[i].swap(status[i]);
+    }
+    for(std::size_t i = 0; i < PRIORITY_BITS; ++i)
+    {
+        m_priority[i].swap(priority[i]);
+    }
+    for(std::size_t i = 0; i < FLAG_BITS; ++i)
+    {
+        m_flags[i].swap(flags[i]);
+    }
+    m_has_due_date.swap(has_due_date);
+    m_estimates.swap(estimates);
+    m_due_dates.swap(due_dates);
+    m_assignees.swap(assignees);
+
+    std::vector<Task*>(order).swap(m_tasks);
+    for(std::size_t i = 0; i < m_tasks.size(); ++i)
+    {
+        m_tasks[i]->m_dense_index = static_cast<arc::uint32>(i);
+    }
+}
+
+std::size_t AttributeTable::get_memory_usage() const
+{
+    std::size_t usage = m_tasks.capacity() * sizeof(Task*);
+    for(std::size_t i = 0; i < STATUS_BITS; ++i)
+    {
+        usage += m_status[i].capacity() * sizeof(arc::uint64);
+    }
+    for(std::size_t i = 0; i < PRIORITY_BITS; ++i)
+    {
+        usage += m_priority[i].capacity() * sizeof(arc::uint64);
+    }
+    for(std::size_t i = 0; i < FLAG_BITS; ++i)
+    {
+        usage += m_flags[i].capacity() * sizeof(arc::uint64);
+    }
+    usage += m_has_due_date.capacity() * sizeof(arc::uint64);
+    usage += m_estimates.capacity() * sizeof(arc::uint32);
+    usage += m_due_dates.capacity() * sizeof(arc::int64);
+    usage += m_assignees.capacity() * sizeof(arc::uint32);
+    usage += m_assignee_names.capacity() * sizeof(arc::str::UTF8String);
+    return usage;
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+arc::uint32 AttributeTable::intern_assignee(
+        const arc::str::UTF8String& assignee)
+{
+    std::map<arc::str::UTF8String, arc::uint32>::const_iterator id =
+        m_assignee_ids.find(assignee);
+    if(id != m_assignee_ids.end())
+    {
+        return id->second;
+    }
+
+    arc::uint32 new_id = static_cast<arc::uint32>(m_assignee_names.size());
+    m_assignee_names.push_back(assignee);
+    m_assignee_ids[assignee] = new_id;
+    return new_id;
+}
+
+void AttributeTable::move_index(std::size_t from, std::size_t to)
+{
+    for(std::size_t i = 0; i < STATUS_BITS; ++i)
+    {
+        set_bit(m_status[i], to, get_bit(m_status[i], from));
+    }
+    for(std::size_t i = 0; i < PRIORITY_BITS; ++i)
+    {
+        set_bit(m_priority[i], to, get_bit(m_priority[i], from));
+    }
+    for(std::size_t i = 0; i < FLAG_BITS; ++i)
+    {
+        set_bit(m_flags[i], to, get_bit(m_flags[i], from));
+    }
+    set_bit(m_has_due_date, to, get_bit(m_has_due_date, from));
+    m_estimates[to] = m_estimates[from];
+    m_due_dates[to] = m_due_dates[from];
+    m_assignees[to] = m_assignees[from];
+}
+
+void AttributeTable::truncate(std::size_t size)
+{
+    // clear the bits past the new size so that unused bits are always zero
+    std::size_t words = (size + 63) >> 6;
+    arc::uint64 mask = ~static_cast<arc::uint64>(0);
+    if((size & 63) != 0)
+    {
+        mask = (static_cast<arc::uint64>(1) << (size & 63)) - 1;
+    }
+    for(std::size_t i = 0; i < STATUS_BITS; ++i)
+    {
+        truncate_bits(m_status[i], words, mask);
+    }
+    for(std::size_t i = 0; i < PRIORITY_BITS; ++i)
+    {
+        truncate_bits(m_priority[i], words, mask);
+    }
+    for(std::size_t i = 0; i < FLAG_BITS; ++i)
+    {
+        truncate_bits(m_flags[i], words, mask);
+    }
+    truncate_bits(m_has_due_date, words, mask);
+
+    m_tasks.resize(size);
+    m_estimates.resize(size);
+    m_due_dates.resize(size);
+    m_assignees.resize(size);
+}
+
+void AttributeTable::evaluate(
+        const TaskFilter& filter,
+        std::vector<arc::uint64>& mask) const
+{
+    std::size_t size = m_tasks.size();
+    std::size_t words = (size + 63) >> 6;
+
+    // start from either every Task or the Tasks of the subtree
+    if(filter.m_ancestor != nullptr)
+    {
+        mask.assign(words, 0);
+        std::vector<const Task*> stack(
+                filter.m_ancestor->m_children.begin(),
+                filter.m_ancestor->m_children.end()
+        );
+        while(!stack.empty())
+        {
+            const Task* task = stack.back();
+            stack.pop_back();
+            set_bit(mask, task->m_dense_index, true);
+            stack.insert(
+                    stack.end(),
+                    task->m_children.begin(),
+                    task->m_children.end()
+            );
+        }
+    }
+    else
+    {
+        mask.assign(words, ~static_cast<arc::uint64>(0));
+        if((size & 63) != 0)
+        {
+            mask.back() = (static_cast<arc::uint64>(1) << (size & 63)) - 1;
+        }
+    }
+    // the RootTask is never matched
+    if(size > 0)
+    {
+        set_bit(mask, 0, false);
+    }
+
+    // each criteria is applied as a separate pass over its columns
+    arc::uint32 all_statuses = (1U << (STATUS_DONE + 1)) - 1;
+    if(filter.m_statuses != 0 &&
+       (filter.m_statuses & all_statuses) != all_statuses)
+    {
+        match_sliced_values(m_status, STATUS_BITS, filter.m_statuses, mask);
+    }
+
+    if(filter.m_min_priority > PRIORITY_NONE ||
+       filter.m_max_priority < PRIORITY_HIGH)
+    {
+        match_sliced_range(
+                m_priority,
+                PRIORITY_BITS,
+                static_cast<arc::uint32>(filter.m_min_priority),
+                static_cast<arc::uint32>(filter.m_max_priority),
+                mask
+        );
+    }
+
+    for(std::size_t i = 0; i < FLAG_BITS; ++i)
+    {
+        if((filter.m_flags >> i) & 1)
+        {
+            for(std::size_t word = 0; word < words; ++word)
+            {
+                mask[word] &= m_flags[i][word];
+            }
+        }
+    }
+
+    if(filter.m_has_due_range)
+    {
+        for(std::size_t word = 0; word < words; ++word)
+        {
+            mask[word] &= m_has_due_date[word];
+        }
+        match_column_range(
+                m_due_dates,
+                filter.m_first_due,
+                filter.m_last_due,
+                mask
+        );
+    }
+
+    if(filter.m_has_estimate_range)
+    {
+        match_column_range(
+                m_estimates,
+                filter.m_min_estimate,
+                filter.m_max_estimate,
+                mask
+        );
+    }
+
+    if(filter.m_has_assignee)
+    {
+        std::map<arc::str::UTF8String, arc::uint32>::const_iterator id =
+            m_assignee_ids.find(filter.m_assignee);
+        if(id == m_assignee_ids.end())
+        {
+            // nobody has this assignee
+            mask.assign(words, 0);
+        }
+        else
+        {
+            match_column_range(m_assignees, id->second, id->second, mask);
+        }
+    }
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
@@ -0,0 +1,263 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Column oriented storage of the attributes of the Tasks of a board.
+ */
+#ifndef SIGMA_CORE_TASKS_ATTRIBUTETABLE_HPP_
+#define SIGMA_CORE_TASKS_ATTRIBUTETABLE_HPP_
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+
+#include "sigma/core/tasks/TaskAttributes.hpp"
+#include "sigma/core/tasks/TaskFilter.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+/*!
+ * \brief Stores the TaskAttributes of every Task of a board in typed columns.
+ *
+ * Each Task of the board is assigned a dense index when it's inserted into
+ * the table, the attributes of the Task are stored at this index of each
+ * column. When a Task is removed the last Task of the table is moved into its
+ * index so that the columns never contain gaps.
+ *
+ * The columns are laid out so that filtering can be performed 64 Tasks at a
+ * time using word wide bitwise operations:
+ *
+ * - Statuses and priorities are bit-sliced: a 2 bit value is stored as two
+ *   bitsets, one for each bit of the value.
+ * - Each TaskFlag and the presence of a due date are stored as bitsets.
+ * - Estimates and due dates are stored as plain integer arrays.
+ * - Assignees are interned, so the assignee column only stores integer ids.
+ *
+ * The table is owned by the board's RootTask and is not synchronised itself,
+ * the board's lock must be held while accessing it.
+ */
+class AttributeTable
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(AttributeTable);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates an empty table.
+     */
+    AttributeTable();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the number of Tasks in the table.
+     */
+    std::size_t get_size() const;
+
+    /*!
+     * \brief Adds the given Task to the table with default attributes and
+     *        assigns the Task its dense index.
+     */
+    void insert(Task* task);
+
+    /*!
+     * \brief Removes the given Task from the table.
+     *
+     * The Task that was last in the table takes the index of the removed
+     * Task.
+     */
+    void remove(Task* task);
+
+    /*!
+     * \brief Moves the given Tasks and their attributes from this table to
+     *        the given table.
+     *
+     * The Tasks are appended to the other table in the given order and the
+     * gaps they leave are filled by the Tasks at the end of this table, so
+     * this takes time proportional to the number of Tasks moved rather than
+     * the size of either table.
+     */
+    void transfer(const std::vector<Task*>& tasks, AttributeTable& target);
+
+    /*!
+     * \brief Writes the attributes stored at the given index to the given
+     *        structure.
+     */
+    void get(std::size_t index, TaskAttributes& attributes) const;
+
+    /*!
+     * \brief Stores the given attributes at the given index.
+     */
+    void set(std::size_t index, const TaskAttributes& attributes);
+
+    /*!
+     * \brief Returns the status stored at the given index.
+     */
+    TaskStatus get_status(std::size_t index) const;
+
+    /*!
+     * \brief Returns the priority stored at the given index.
+     */
+    TaskPriority get_priority(std::size_t index) const;
+
+    /*!
+     * \brief Returns the estimate stored at the given index.
+     */
+    arc::uint32 get_estimate(std::size_t index) const;
+
+    /*!
+     * \brief Returns the assignee stored at the given index.
+     */
+    const arc::str::UTF8String& get_assignee(std::size_t index) const;
+
+    /*!
+     * \brief Returns whether there is a due date stored at the given index.
+     */
+    bool has_due_date(std::size_t index) const;
+
+    /*!
+     * \brief Returns the due date stored at the given index.
+     */
+    arc::int64 get_due_date(std::size_t index) const;
+
+    /*!
+     * \brief Returns the TaskFlag values stored at the given index.
+     */
+    arc::uint32 get_flags(std::size_t index) const;
+
+    /*!
+     * \brief Appends the Tasks that match the given filter to the given
+     *        vector.
+     *
+     * Tasks are appended in the order of their dense indices, which has no
+     * relation to their position in the hierarchy. The Task at index 0 (the
+     * RootTask of the board) never matches.
+     */
+    void select(const TaskFilter& filter, std::vector<Task*>& out) const;
+
+    /*!
+     * \brief Returns the number of Tasks that match the given filter.
+     */
+    std::size_t count(const TaskFilter& filter) const;
+
+    /*!
+     * \brief Moves the attributes of the Tasks to the dense indices given by
+     *        their position in the given order, and releases any spare
+     *        capacity of the columns.
+     *
+     * \param order Every Task of the table, in their new order.
+     */
+    void reorder(const std::vector<Task*>& order);
+
+    /*!
+     * \brief Returns the approximate number of bytes used by the columns.
+     */
+    std::size_t get_memory_usage() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE CONSTANTS
+    //--------------------------------------------------------------------------
+
+    // the number of bits used to store statuses and priorities
+    static const std::size_t STATUS_BITS = 2;
+    static const std::size_t PRIORITY_BITS = 2;
+    // the number of bits required to store every TaskFlag
+    static const std::size_t FLAG_BITS = 2;
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The Task at each dense index.
+     */
+    std::vector<Task*> m_tasks;
+
+    /*!
+     * \brief Bitset per bit of the status column.
+     */
+    std::vector<arc::uint64> m_status[STATUS_BITS];
+    /*!
+     * \brief Bitset per bit of the priority column.
+     */
+    std::vector<arc::uint64> m_priority[PRIORITY_BITS];
+    /*!
+     * \brief Bitset per TaskFlag.
+     */
+    std::vector<arc::uint64> m_flags[FLAG_BITS];
+    /*!
+     * \brief Bitset of the Tasks which have a due date.
+     */
+    std::vector<arc::uint64> m_has_due_date;
+    /*!
+     * \brief The estimate column.
+     */
+    std::vector<arc::uint32> m_estimates;
+    /*!
+     * \brief The due date column.
+     */
+    std::vector<arc::int64> m_due_dates;
+    /*!
+     * \brief The assignee column, stored as ids into m_assignee_names.
+     */
+    std::vector<arc::uint32> m_assignees;
+
+    /*!
+     * \brief The interned assignee names, id 0 is the empty name.
+     */
+    std::vector<arc::str::UTF8String> m_assignee_names;
+    /*!
+     * \brief Maps assignee names to their interned ids.
+     */
+    std::map<arc::str::UTF8String, arc::uint32> m_assignee_ids;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the interned id of the given assignee, interning it if
+     *        it has not been seen before.
+     */
+    arc::uint32 intern_assignee(const arc::str::UTF8String& assignee);
+
+    /*!
+     * \brief Copies the attributes stored at one index to another.
+     */
+    void move_index(std::size_t from, std::size_t to);
+
+    /*!
+     * \brief Shrinks the columns to the given number of Tasks, clearing the
+     *        unused bits of the last word of each bitset.
+     */
+    void truncate(std::size_t size);
+
+    /*!
+     * \brief Computes the bitset of Tasks that match the given filter.
+     */
+    void evaluate(
+            const TaskFilter& filter,
+            std::vector<arc::uint64>& mask) const;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
@@ -0,0 +1,831 @@
+#include "sigma/core/tasks/BoardFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#ifdef ARC_OS_WINDOWS
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <arcanecore/base/Exceptions.hpp>
+#include <arcanecore/io/sys/FileWriter.hpp>
+
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TaskSerialiser.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                                    LAYOUTS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief The first 72 bytes of a board file.
+ */
+struct BoardFile::Header
+{
+    /// Identifies the file as a board file.
+    char magic[8];
+    /// BYTE_ORDER_MARK in the byte order of the machine that wrote the file.
+    arc::uint32 byte_order;
+    /// The version of the format.
+    arc::uint32 version;
+    /// The size of this header.
+    arc::uint32 header_size;
+    /// The number of nodes in the node table.
+    arc::uint32 node_count;
+    /// The offsets of the sections from the start of the file.
+    arc::uint64 node_offset;
+    arc::uint64 index_offset;
+    arc::uint64 heap_offset;
+    /// The number of bytes of the string heap.
+    arc::uint64 heap_size;
+    /// The number of bytes of the whole file.
+    arc::uint64 file_size;
+    /// The greatest id of the Tasks, including archived Tasks.
+    arc::uint32 max_id;
+    arc::uint32 reserved;
+};
+
+/*!
+ * \brief A single Task in the node table.
+ */
+struct BoardFile::Node
+{
+    arc::uint32 id;
+    arc::uint32 parent;
+    arc::uint32 first_child;
+    arc::uint32 next_sibling;
+    arc::uint32 children_count;
+    /// The status, priority, due date presence and flags, packed in the same
+    /// way as TaskSerialiser packs them.
+    arc::uint32 packed_attributes;
+    arc::uint32 estimate;
+    /// The strings are stored as offsets and lengths into the heap.
+    arc::uint32 title_offset;
+    arc::uint32 title_length;
+    arc::uint32 assignee_offset;
+    arc::uint32 assignee_length;
+    arc::uint32 archive_offset;
+    arc::uint32 archive_length;
+    arc::uint32 reserved;
+    arc::int64 due_date;
+};
+
+/*!
+ * \brief An entry of the id index.
+ */
+struct BoardFile::IndexEntry
+{
+    arc::uint32 id;
+    arc::uint32 node;
+};
+
+//------------------------------------------------------------------------------
+//                                   LOAD GUARD
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Suspends the changes of a board while it is loaded and deletes the
+ *        board if it is destroyed before release() is called.
+ */
+class BoardFile::LoadGuard
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(LoadGuard);
+
+public:
+
+    LoadGuard(TasksDomain& domain, RootTask* board)
+        :
+        m_domain(domain),
+        m_board (board)
+    {
+        ++m_board->m_suspended_changes;
+    }
+
+    ~LoadGuard()
+    {
+        if(m_board == nullptr)
+        {
+            return;
+        }
+
+        // the board hasn't been returned so no jobs can have been submitted
+        // for it, delete_board() would wait for them and throws if called
+        // from another shard, which can't happen while unwinding
+        std::lock_guard<std::recursive_mutex> lock(m_domain.m_mutex);
+        m_domain.m_boards.remove(m_board);
+    }
+
+    RootTask* get_board() const
+    {
+        return m_board;
+    }
+
+    /*!
+     * \brief Resumes the changes of the board and returns it, the board is
+     *        no longer deleted by this guard.
+     */
+    RootTask* release()
+    {
+        RootTask* board = m_board;
+        --board->m_suspended_changes;
+        m_board = nullptr;
+        return board;
+    }
+
+private:
+
+    TasksDomain& m_domain;
+    RootTask* m_board;
+};
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                   CONSTANTS
+//------------------------------------------------------------------------------
+
+const char MAGIC[8] = {'S', 'I', 'G', 'B', 'O', 'A', 'R', 'D'};
+
+const arc::uint32 BYTE_ORDER_MARK = 0x01020304;
+
+// the sections are aligned so they can be read in place
+const std::size_t ALIGNMENT = 8;
+
+// heap positions are stored as 32-bit offsets
+const std::size_t MAX_HEAP_SIZE = 0xFFFFFFFF;
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+inline arc::uint64 align(arc::uint64 offset)
+{
+    return (offset + ALIGNMENT - 1) & ~static_cast<arc::uint64>(ALIGNMENT - 1);
+}
+
+/*!
+ * \brief Appends the given bytes to the heap and returns their offset.
+ */
+arc::uint32 append_to_heap(
+        const void* data,
+        std::size_t length,
+        std::vector<char>& heap)
+{
+    if(length > MAX_HEAP_SIZE - heap.size())
+    {
+        throw arc::ex::ValueError(
+            "The board is too large to be stored as a board file"
+        );
+    }
+    arc::uint32 offset = static_cast<arc::uint32>(heap.size());
+    const char* bytes = static_cast<const char*>(data);
+    heap.insert(heap.end(), bytes, bytes + length);
+    return offset;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC CONSTANTS
+//------------------------------------------------------------------------------
+
+const arc::uint32 BoardFile::VERSION = 1;
+
+const arc::uint32 BoardFile::NONE = 0xFFFFFFFF;
+
+//------------------------------------------------------------------------------
+//                                   STRING REF
+//------------------------------------------------------------------------------
+
+BoardFile::StringRef::StringRef()
+    :
+    data  (nullptr),
+    length(0)
+{
+}
+
+arc::str::UTF8String BoardFile::StringRef::to_string() const
+{
+    if(length == 0)
+    {
+        return arc::str::UTF8String();
+    }
+    return arc::str::UTF8String(data, length);
+}
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTORS
+//------------------------------------------------------------------------------
+
+BoardFile::BoardFile(const arc::io::sys::Path& path)
+    :
+    m_data  (nullptr),
+    m_length(0),
+    m_mapped(false),
+    m_header(nullptr),
+    m_nodes (nullptr),
+    m_index (nullptr),
+    m_heap  (nullptr)
+{
+    arc::str::UTF8String native(path.to_native());
+    arc::str::UTF8String error("Failed to map board file: ");
+    error += native;
+
+#ifdef ARC_OS_WINDOWS
+
+    HANDLE file = CreateFileA(
+        native.get_raw(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        throw arc::ex::InvalidPathError(error);
+    }
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        throw arc::ex::InvalidPathError(error);
+    }
+    m_length = static_cast<std::size_t>(size.QuadPart);
+    if(m_length > 0)
+    {
+        HANDLE mapping =
+            CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(mapping != nullptr)
+        {
+            m_data = static_cast<const arc::uint8*>(
+                MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            // the view keeps the mapping open
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+
+#else
+
+    int file = ::open(native.get_raw(), O_RDONLY);
+    if(file < 0)
+    {
+        throw arc::ex::InvalidPathError(error);
+    }
+    struct stat status;
+    if(fstat(file, &status) != 0)
+    {
+        ::close(file);
+        throw arc::ex::InvalidPathError(error);
+    }
+    m_length = static_cast<std::size_t>(status.st_size);
+    if(m_length > 0)
+    {
+        void* mapping =
+            mmap(nullptr, m_length, PROT_READ, MAP_PRIVATE, file, 0);
+        if(mapping != MAP_FAILED)
+        {
+            m_data = static_cast<const arc::uint8*>(mapping);
+        }
+    }
+    // the mapping remains valid once the file is closed
+    ::close(file);
+
+#endif
+
+    if(m_length > 0 && m_data == nullptr)
+    {
+        throw arc::ex::InvalidPathError(error);
+    }
+    m_mapped = m_data != nullptr;
+
+    try
+    {
+        open();
+    }
+    catch(const arc::ex::ParseError& e)
+    {
+        unmap();
+        throw e;
+    }
+}
+
+BoardFile::BoardFile(const arc::uint8* data, std::size_t length)
+    :
+    m_data  (data),
+    m_length(length),
+    m_mapped(false),
+    m_header(nullptr),
+    m_nodes (nullptr),
+    m_index (nullptr),
+    m_heap  (nullptr)
+{
+    if(reinterpret_cast<std::size_t>(data) % ALIGNMENT != 0)
+    {
+        throw arc::ex::ValueError(
+            "Board file data must be aligned to 8 bytes"
+        );
+    }
+    open();
+}
+
+//------------------------------------------------------------------------------
+//                                   DESTRUCTOR
+//------------------------------------------------------------------------------
+
+BoardFile::~BoardFile()
+{
+    unmap();
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+void BoardFile::encode(const RootTask* board, std::vector<arc::uint8>& out)
+{
+    sigma::core::util::ScopedReadLock lock(board->get_lock());
+
+    std::vector<Node> nodes;
+    std::vector<char> heap;
+    // each distinct assignee is only stored once
+    std::map<arc::str::UTF8String, arc::uint32> assignee_offsets;
+    // the last child written of each node, used to link the siblings
+    std::vector<arc::uint32> last_children;
+
+    // iterative pre-order traversal so deep hierarchies can't overflow the
+    // stack, each Task is paired with the node of its parent
+    std::vector<std::pair<const Task*, arc::uint32>> stack;
+    stack.push_back(std::make_pair(board, NONE));
+    while(!stack.empty())
+    {
+        const Task* task = stack.back().first;
+        arc::uint32 parent = stack.back().second;
+        stack.pop_back();
+
+        if(nodes.size() >= NONE)
+        {
+            throw arc::ex::ValueError(
+                "The board is too large to be stored as a board file"
+            );
+        }
+        arc::uint32 index = static_cast<arc::uint32>(nodes.size());
+        Node node = Node();
+        node.id = task->get_id();
+        node.parent = parent;
+        node.first_child = NONE;
+        node.next_sibling = NONE;
+
+        const arc::str::UTF8String& title = task->get_title();
+        // the byte length includes the null terminator
+        node.title_length =
+            static_cast<arc::uint32>(title.get_byte_length() - 1);
+        node.title_offset =
+            append_to_heap(title.get_raw(), node.title_length, heap);
+
+        TaskAttributes attributes(task->get_attributes());
+        node.packed_attributes =
+            static_cast<arc::uint32>(attributes.status)            |
+            static_cast<arc::uint32>(attributes.priority)     << 2 |
+            static_cast<arc::uint32>(attributes.has_due_date) << 4 |
+            attributes.flags                                  << 5;
+        node.estimate = attributes.estimate;
+        node.due_date = attributes.has_due_date ? attributes.due_date : 0;
+        if(!attributes.assignee.is_empty())
+        {
+            node.assignee_length = static_cast<arc::uint32>(
+                attributes.assignee.get_byte_length() - 1);
+            std::map<arc::str::UTF8String, arc::uint32>::const_iterator
+                assignee = assignee_offsets.find(attributes.assignee);
+            if(assignee != assignee_offsets.end())
+            {
+                node.assignee_offset = assignee->second;
+            }
+            else
+            {
+                node.assignee_offset = append_to_heap(
+                    attributes.assignee.get_raw(),
+                    node.assignee_length,
+                    heap
+                );
+                assignee_offsets[attributes.assignee] = node.assignee_offset;
+            }
+        }
+
+        // the archive is kept as it is rather than rehydrating it
+        if(task->is_archived())
+        {
+            node.archive_length =
+                static_cast<arc::uint32>(task->m_archive.size());
+            node.archive_offset = append_to_heap(
+                &task->m_archive[0],
+                task->m_archive.size(),
+                heap
+            );
+        }
+        nodes.push_back(node);
+        last_children.push_back(NONE);
+
+        // link to the parent and previous sibling
+        if(parent != NONE)
+        {
+            if(last_children[parent] == NONE)
+            {
+                nodes[parent].first_child = index;
+            }
+            else
+            {
+                nodes[last_children[parent]].next_sibling = index;
+            }
+            last_children[parent] = index;
+            ++nodes[parent].children_count;
+        }
+
+        // push in reverse so the children are written in order
+        std::vector<Task*>::const_reverse_iterator child =
+            task->m_children.rbegin();
+        for(; child != task->m_children.rend(); ++child)
+        {
+            stack.push_back(std::make_pair(*child, index));
+        }
+    }
+
+    std::vector<IndexEntry> index(nodes.size());
+    for(std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        index[i].id = nodes[i].id;
+        index[i].node = static_cast<arc::uint32>(i);
+    }
+    std::sort(
+        index.begin(),
+        index.end(),
+        [](const IndexEntry& a, const IndexEntry& b)
+        {
+            return a.id < b.id;
+        }
+    );
+
+    Header header = Header();
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.byte_order = BYTE_ORDER_MARK;
+    header.version = VERSION;
+    header.header_size = sizeof(Header);
+    header.node_count = static_cast<arc::uint32>(nodes.size());
+    header.node_offset = align(sizeof(Header));
+    header.index_offset =
+        align(header.node_offset + nodes.size() * sizeof(Node));
+    header.heap_offset =
+        align(header.index_offset + index.size() * sizeof(IndexEntry));
+    header.heap_size = heap.size();
+    header.file_size = align(header.heap_offset + header.heap_size);
+    header.max_id = index.back().id;
+    ARC_CONST_FOR_EACH(it, board->m_archived)
+    {
+        header.max_id = std::max(header.max_id, it->first);
+    }
+
+    // the padding between the sections is zeroed by resizing
+    std::size_t start = out.size();
+    out.resize(start + static_cast<std::size_t>(header.file_size), 0);
+    arc::uint8* file = &out[start];
+    std::memcpy(file, &header, sizeof(Header));
+    std::memcpy(
+        file + header.node_offset,
+        &nodes[0],
+        nodes.size() * sizeof(Node)
+    );
+    std::memcpy(
+        file + header.index_offset,
+        &index[0],
+        index.size() * sizeof(IndexEntry)
+    );
+    if(!heap.empty())
+    {
+        std::memcpy(file + header.heap_offset, &heap[0], heap.size());
+    }
+}
+
+void BoardFile::save(const RootTask* board, const arc::io::sys::Path& path)
+{
+    std::vector<arc::uint8> data;
+    encode(board, data);
+
+    arc::io::sys::FileWriter writer(path);
+    writer.write(reinterpret_cast<const char*>(&data[0]), data.size());
+    writer.close();
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+arc::uint32 BoardFile::get_node_count() const
+{
+    return m_header->node_count;
+}
+
+arc::uint32 BoardFile::get_id(arc::uint32 node) const
+{
+    return get_node(node).id;
+}
+
+arc::uint32 BoardFile::get_parent(arc::uint32 node) const
+{
+    return get_node(node).parent;
+}
+
+arc::uint32 BoardFile::get_first_child(arc::uint32 node) const
+{
+    return get_node(node).first_child;
+}
+
+arc::uint32 BoardFile::get_next_sibling(arc::uint32 node) const
+{
+    return get_node(node).next_sibling;
+}
+
+arc::uint32 BoardFile::get_children_count(arc::uint32 node) const
+{
+    return get_node(node).children_count;
+}
+
+BoardFile::StringRef BoardFile::get_title(arc::uint32 node) const
+{
+    const Node& n = get_node(node);
+    return get_heap_range(n.title_offset, n.title_length);
+}
+
+void BoardFile::get_attributes(
+        arc::uint32 node,
+        TaskAttributes& attributes) const
+{
+    const Node& n = get_node(node);
+    attributes.status = static_cast<TaskStatus>(n.packed_attributes & 3);
+    attributes.priority =
+        static_cast<TaskPriority>((n.packed_attributes >> 2) & 3);
+    attributes.has_due_date = ((n.packed_attributes >> 4) & 1) != 0;
+    attributes.flags = n.packed_attributes >> 5;
+    attributes.estimate = n.estimate;
+    attributes.due_date = attributes.has_due_date ? n.due_date : 0;
+    try
+    {
+        attributes.assignee =
+            get_heap_range(n.assignee_offset, n.assignee_length).to_string();
+        attributes.validate();
+    }
+    catch(const arc::ex::EncodingError&)
+    {
+        throw arc::ex::ParseError("Invalid Task assignee in board file");
+    }
+    catch(const arc::ex::ValueError&)
+    {
+        throw arc::ex::ParseError("Invalid Task attributes in board file");
+    }
+}
+
+bool BoardFile::is_archived(arc::uint32 node) const
+{
+    return get_node(node).archive_length > 0;
+}
+
+arc::uint32 BoardFile::find_node(arc::uint32 id) const
+{
+    const IndexEntry* end = m_index + m_header->node_count;
+    const IndexEntry* entry = std::lower_bound(
+        m_index,
+        end,
+        id,
+        [](const IndexEntry& a, arc::uint32 b)
+        {
+            return a.id < b;
+        }
+    );
+    // the node is checked so a malformed index can't point outside the table
+    if(entry == end ||
+       entry->id != id ||
+       entry->node >= m_header->node_count ||
+       m_nodes[entry->node].id != id)
+    {
+        return NONE;
+    }
+    return entry->node;
+}
+
+RootTask* BoardFile::load(TasksDomain& domain) const
+{
+    arc::uint32 count = get_node_count();
+    StringRef root_title = get_title(0);
+    if(get_parent(0) != NONE || root_title.length == 0)
+    {
+        throw arc::ex::ParseError("Invalid RootTask in board file");
+    }
+    // reserve the saved ids first so that the new RootTask can't be assigned
+    // one of them
+    arc::uint32 max_id = m_header->max_id;
+    domain.reserve_id(max_id);
+
+    // only the creation of the board is recorded
+    LoadGuard guard(domain, domain.new_board(root_title.to_string()));
+    RootTask* board = guard.get_board();
+    try
+    {
+        std::vector<Task*> tasks(count, nullptr);
+        tasks[0] = board;
+        TaskAttributes defaults;
+        TaskAttributes attributes;
+        for(arc::uint32 i = 0; i < count; ++i)
+        {
+            const Node& node = m_nodes[i];
+            if(i > 0)
+            {
+                // nodes are in pre-order so the parent has been created
+                if(node.parent >= i)
+                {
+                    throw arc::ex::ParseError(
+                        "Board file nodes are not in pre-order"
+                    );
+                }
+                if(node.id == 0 ||
+                   node.id > max_id ||
+                   board->m_tasks.find(node.id) != board->m_tasks.end())
+                {
+                    throw arc::ex::ParseError(
+                        "Invalid or duplicate Task id in board file"
+                    );
+                }
+                StringRef title = get_title(i);
+                if(title.length == 0)
+                {
+                    throw arc::ex::ParseError(
+                        "Board file contains a Task with a blank title"
+                    );
+                }
+                tasks[i] = new Task(
+                    tasks[node.parent],
+                    title.to_string(),
+                    node.id,
+                    Task::APPEND
+                );
+            }
+            get_attributes(i, attributes);
+            if(attributes != defaults)
+            {
+                tasks[i]->set_attributes_internal(attributes);
+            }
+        }
+
+        // archives are loaded once every node exists so that no node is
+        // added beneath an archived Task
+        for(arc::uint32 i = 0; i < count; ++i)
+        {
+            const Node& node = m_nodes[i];
+            if(node.archive_length == 0)
+            {
+                continue;
+            }
+            if(!tasks[i]->m_children.empty())
+            {
+                throw arc::ex::ParseError(
+                    "Board file contains an archived Task with children"
+                );
+            }
+            StringRef archive =
+                get_heap_range(node.archive_offset, node.archive_length);
+            TaskSerialiser::load_children(
+                tasks[i],
+                reinterpret_cast<const arc::uint8*>(archive.data),
+                archive.length
+            );
+        }
+    }
+    catch(const arc::ex::EncodingError&)
+    {
+        throw arc::ex::ParseError("Invalid Task title in board file");
+    }
+    catch(const arc::ex::ValueError&)
+    {
+        throw arc::ex::ParseError("Invalid archived Tasks in board file");
+    }
+
+    return guard.release();
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void BoardFile::open()
+{
+    static_assert(sizeof(Header) == 72, "Unexpected board file header size");
+    static_assert(sizeof(Node) == 64, "Unexpected board file node size");
+    static_assert(sizeof(IndexEntry) == 8, "Unexpected board file index size");
+
+    if(m_length < sizeof(Header))
+    {
+        throw arc::ex::ParseError("Data is too short to be a board file");
+    }
+    m_header = reinterpret_cast<const Header*>(m_data);
+    if(std::memcmp(m_header->magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        throw arc::ex::ParseError("Data is not a board file");
+    }
+    if(m_header->byte_order != BYTE_ORDER_MARK)
+    {
+        throw arc::ex::ParseError(
+            "Board file was written with a different byte order"
+        );
+    }
+    if(m_header->version != VERSION)
+    {
+        throw arc::ex::ParseError("Unsupported board file version");
+    }
+
+    // check the sections are aligned, in order and within the file, each
+    // offset is checked before it is added to so the sums can't overflow
+    const Header& h = *m_header;
+    if(h.header_size != sizeof(Header) ||
+       h.file_size != m_length ||
+       h.node_count == 0 ||
+       h.node_count == NONE ||
+       h.node_offset < h.header_size ||
+       h.node_offset % ALIGNMENT != 0 ||
+       h.node_offset > m_length ||
+       h.index_offset < h.node_offset + h.node_count * sizeof(Node) ||
+       h.index_offset % ALIGNMENT != 0 ||
+       h.index_offset > m_length ||
+       h.heap_offset < h.index_offset + h.node_count * sizeof(IndexEntry) ||
+       h.heap_offset > m_length ||
+       h.heap_size > m_length - h.heap_offset ||
+       h.heap_size > MAX_HEAP_SIZE)
+    {
+        throw arc::ex::ParseError("Board file header is corrupt");
+    }
+
+    m_nodes = reinterpret_cast<const Node*>(m_data + h.node_offset);
+    m_index = reinterpret_cast<const IndexEntry*>(m_data + h.index_offset);
+    m_heap = reinterpret_cast<const char*>(m_data + h.heap_offset);
+}
+
+void BoardFile::unmap()
+{
+    if(!m_mapped)
+    {
+        return;
+    }
+#ifdef ARC_OS_WINDOWS
+    UnmapViewOfFile(m_data);
+#else
+    munmap(const_cast<arc::uint8*>(m_data), m_length);
+#endif
+    m_mapped = false;
+}
+
+const BoardFile::Node& BoardFile::get_node(arc::uint32 node) const
+{
+    if(node >= m_header->node_count)
+    {
+        throw arc::ex::IndexOutOfBoundsError(
+            "Node is not in the board file"
+        );
+    }
+    return m_nodes[node];
+}
+
+BoardFile::StringRef BoardFile::get_heap_range(
+        arc::uint32 offset,
+        arc::uint32 length) const
+{
+    if(offset > m_header->heap_size || length > m_header->heap_size - offset)
+    {
+        throw arc::ex::ParseError("Board file string extends beyond the heap");
+    }
+    StringRef range;
+    range.data = m_heap + offset;
+    range.length = length;
+    return range;
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
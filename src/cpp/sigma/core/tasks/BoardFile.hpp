@@ -0,0 +1,353 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Memory-mappable binary files of boards.
+ */
+#ifndef SIGMA_CORE_TASKS_BOARDFILE_HPP_
+#define SIGMA_CORE_TASKS_BOARDFILE_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+#include <arcanecore/io/sys/Path.hpp>
+
+#include "sigma/core/tasks/TaskAttributes.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class RootTask;
+class TasksDomain;
+
+/*!
+ * \brief A read-only view of a board stored in the binary board format.
+ *
+ * The format is made up of a fixed size header, a table of fixed size nodes,
+ * an index of the node ids and a heap of strings:
+ *
+ * - The header holds the format version, the byte order the file was written
+ *   in, the offsets and sizes of the other sections and the greatest Task id
+ *   so that ids can be reserved without visiting the nodes.
+ * - Each node holds the id of a Task, the indices of its parent, first child
+ *   and next sibling in the table, its attributes and the positions of its
+ *   title and assignee in the heap. Nodes are stored in pre-order with the
+ *   RootTask first, so a parent always precedes its children.
+ * - The id index pairs every id with its node, sorted by id.
+ * - The heap holds the UTF-8 bytes of the titles and assignees, each distinct
+ *   assignee is only stored once, and the archives of archived Tasks (see
+ *   Task::archive()) as they were encoded by TaskSerialiser.
+ *
+ * Files are opened by mapping them into memory. Opening only validates the
+ * header, so it takes the same time no matter how many Tasks the board has:
+ * nodes are read directly from the mapping as they are accessed and the pages
+ * of the file are only loaded by the operating system once they're touched.
+ * Titles are read in place, see get_title(), until the board is loaded into a
+ * domain with load().
+ *
+ * The data of each node is only checked when it is accessed, so the accessors
+ * throw arc::ex::ParseError if the file turns out to be malformed.
+ *
+ * \par Thread Safety
+ *
+ * Since a BoardFile is never modified it can be read from any number of
+ * threads.
+ */
+class BoardFile
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(BoardFile);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                             PUBLIC CONSTANTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The version of the format written by this version of Sigma.
+     */
+    static const arc::uint32 VERSION;
+
+    /*!
+     * \brief The node index used for the parent of the RootTask and for Tasks
+     *        without children or next siblings.
+     */
+    static const arc::uint32 NONE;
+
+    //--------------------------------------------------------------------------
+    //                               PUBLIC STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief UTF-8 bytes held by a BoardFile, these are only valid while the
+     *        BoardFile exists.
+     */
+    struct StringRef
+    {
+        /// The first byte of the string, this is not null terminated.
+        const char* data;
+        /// The number of bytes of the string.
+        std::size_t length;
+
+        StringRef();
+
+        /*!
+         * \brief Returns a copy of the string.
+         *
+         * \throws arc::ex::EncodingError If the bytes are not valid UTF-8.
+         */
+        arc::str::UTF8String to_string() const;
+    };
+
+    //--------------------------------------------------------------------------
+    //                               CONSTRUCTORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Opens the board file at the given path by mapping it into memory.
+     *
+     * \throws arc::ex::InvalidPathError If the file cannot be opened or
+     *                                   mapped.
+     * \throws arc::ex::ParseError If the header of the file is not valid or
+     *                             the file was written with a different
+     *                             version or byte order.
+     */
+    explicit BoardFile(const arc::io::sys::Path& path);
+
+    /*!
+     * \brief Opens a board encoded with encode() that is already in memory.
+     *
+     * The data is not copied so it must outlive this BoardFile.
+     *
+     * \throws arc::ex::ValueError If the data isn't aligned to 8 bytes.
+     * \throws arc::ex::ParseError If the header of the data is not valid or
+     *                             the data was written with a different
+     *                             version or byte order.
+     */
+    BoardFile(const arc::uint8* data, std::size_t length);
+
+    //--------------------------------------------------------------------------
+    //                                DESTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Unmaps the file if it was opened from a path.
+     */
+    ~BoardFile();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Appends the given board in the binary board format to the given
+     *        buffer.
+     *
+     * The board's read lock is held while it is encoded. Archived Tasks are
+     * stored with their archives rather than being rehydrated.
+     *
+     * \throws arc::ex::ValueError If the strings of the board don't fit in the
+     *                             4GiB heap of the format.
+     */
+    static void encode(const RootTask* board, std::vector<arc::uint8>& out);
+
+    /*!
+     * \brief Writes the given board to the file at the given path, replacing
+     *        the file if it exists, see encode().
+     *
+     * \throws arc::ex::InvalidPathError If the file cannot be opened for
+     *                                   writing.
+     */
+    static void save(const RootTask* board, const arc::io::sys::Path& path);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the number of Tasks in the file, including the RootTask
+     *        but not the descendants of archived Tasks.
+     */
+    arc::uint32 get_node_count() const;
+
+    /*!
+     * \brief Returns the id the Task of the given node had when it was saved.
+     *
+     * \throws arc::ex::IndexOutOfBoundsError If the node isn't in the file.
+     */
+    arc::uint32 get_id(arc::uint32 node) const;
+
+    /*!
+     * \brief Returns the node of the parent of the given node, or NONE for the
+     *        RootTask.
+     *
+     * \throws arc::ex::IndexOutOfBoundsError If the node isn't in the file.
+     */
+    arc::uint32 get_parent(arc::uint32 node) const;
+
+    /*!
+     * \brief Returns the node of the first child of the given node, or NONE
+     *        if it has no children.
+     *
+     * \throws arc::ex::IndexOutOfBoundsError If the node isn't in the file.
+     */
+    arc::uint32 get_first_child(arc::uint32 node) const;
+
+    /*!
+     * \brief Returns the node of the sibling after the given node, or NONE if
+     *        it is the last of its siblings.
+     *
+     * \throws arc::ex::IndexOutOfBoundsError If the node isn't in the file.
+     */
+    arc::uint32 get_next_sibling(arc::uint32 node) const;
+
+    /*!
+     * \brief Returns the number of children of the given node.
+     *
+     * \throws arc::ex::IndexOutOfBoundsError If the node isn't in the file.
+     */
+    arc::uint32 get_children_count(arc::uint32 node) const;
+
+    /*!
+     * \brief Returns the title of the given node without copying it out of
+     *        the file.
+     *
+     * \throws arc::ex::IndexOutOfBoundsError If the node isn't in the file.
+     * \throws arc::ex::ParseError If the title extends beyond the heap.
+     */
+    StringRef get_title(arc::uint32 node) const;
+
+    /*!
+     * \brief Writes the attributes of the given node to the given structure.
+     *
+     * \throws arc::ex::IndexOutOfBoundsError If the node isn't in the file.
+     * \throws arc::ex::ParseError If the attributes are not valid.
+     */
+    void get_attributes(arc::uint32 node, TaskAttributes& attributes) const;
+
+    /*!
+     * \brief Returns whether the descendants of the given node are stored as
+     *        an archive rather than as nodes.
+     *
+     * \throws arc::ex::IndexOutOfBoundsError If the node isn't in the file.
+     */
+    bool is_archived(arc::uint32 node) const;
+
+    /*!
+     * \brief Returns the node of the Task with the given id, or NONE if there
+     *        is no such node.
+     *
+     * This searches the id index of the file so doesn't visit other nodes.
+     */
+    arc::uint32 find_node(arc::uint32 id) const;
+
+    /*!
+     * \brief Creates a new board in the given domain from the Tasks of this
+     *        file.
+     *
+     * The Tasks keep the ids they were saved with, while the RootTask is
+     * assigned a new id and its title is made unique within the domain (see
+     * TasksDomain::new_board()). So a board should only be loaded into a
+     * domain that doesn't already contain its Tasks. Archived Tasks are
+     * loaded still archived.
+     *
+     * Only the creation of the board is recorded in the domain's ChangeFeed
+     * and the loading isn't recorded in the board's TaskHistory.
+     *
+     * If loading fails for any reason the new board is deleted before the
+     * exception is passed on.
+     *
+     * \throws arc::ex::ParseError If any of the nodes are malformed.
+     */
+    RootTask* load(TasksDomain& domain) const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    // the layouts of the sections, see BoardFile.cpp
+    struct Header;
+    struct Node;
+    struct IndexEntry;
+
+    // deletes a board that fails to load, see BoardFile.cpp
+    class LoadGuard;
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The start of the file.
+     */
+    const arc::uint8* m_data;
+    /*!
+     * \brief The number of bytes of the file.
+     */
+    std::size_t m_length;
+    /*!
+     * \brief Whether m_data is a mapping owned by this BoardFile.
+     */
+    bool m_mapped;
+    /*!
+     * \brief The header at the start of the file.
+     */
+    const Header* m_header;
+    /*!
+     * \brief The node table.
+     */
+    const Node* m_nodes;
+    /*!
+     * \brief The id index.
+     */
+    const IndexEntry* m_index;
+    /*!
+     * \brief The string heap.
+     */
+    const char* m_heap;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Checks the header and locates the sections of the file.
+     */
+    void open();
+
+    /*!
+     * \brief Unmaps the file if it was opened from a path.
+     */
+    void unmap();
+
+    /*!
+     * \brief Returns the given node, checking that it is in the file.
+     */
+    const Node& get_node(arc::uint32 node) const;
+
+    /*!
+     * \brief Returns the given range of the heap, checking that it is within
+     *        the heap.
+     */
+    StringRef get_heap_range(arc::uint32 offset, arc::uint32 length) const;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
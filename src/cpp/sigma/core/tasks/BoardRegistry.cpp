@@ -0,0 +1,122 @@
+#include "sigma/core/tasks/BoardRegistry.hpp"
+
+#include "sigma/core/tasks/RootTask.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                                PUBLIC CONSTANTS
+//------------------------------------------------------------------------------
+
+const BoardHandle BoardRegistry::NULL_HANDLE;
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+BoardRegistry::BoardRegistry()
+    :
+    m_next_handle(1)
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+BoardHandle BoardRegistry::add(std::unique_ptr<RootTask> board)
+{
+    RootTask* r = board.get();
+    m_boards.push_back(std::move(board));
+
+    Record record;
+    record.handle = m_next_handle++;
+    record.position = --m_boards.end();
+    m_handles[record.handle] = record.position;
+    m_records[r] = record;
+    m_titles.insert(r->get_title(), r);
+    return record.handle;
+}
+
+bool BoardRegistry::remove(const RootTask* board)
+{
+    // the board is destroyed once it's no longer registered
+    return release(board) != nullptr;
+}
+
+std::unique_ptr<RootTask> BoardRegistry::release(const RootTask* board)
+{
+    std::unordered_map<const RootTask*, Record>::iterator record =
+        m_records.find(board);
+    if(record == m_records.end())
+    {
+        return std::unique_ptr<RootTask>();
+    }
+
+    BoardList::iterator position = record->second.position;
+    m_titles.remove((*position)->get_title(), position->get());
+    m_handles.erase(record->second.handle);
+    m_records.erase(record);
+    std::unique_ptr<RootTask> released(std::move(*position));
+    m_boards.erase(position);
+    return released;
+}
+
+void BoardRegistry::clear()
+{
+    m_handles.clear();
+    m_records.clear();
+    m_titles.clear();
+    m_boards.clear();
+}
+
+std::size_t BoardRegistry::size() const
+{
+    return m_boards.size();
+}
+
+BoardRegistry::Range BoardRegistry::get_boards() const
+{
+    return Range(m_boards);
+}
+
+RootTask* BoardRegistry::get_board(BoardHandle handle) const
+{
+    std::unordered_map<BoardHandle, BoardList::iterator>::const_iterator
+        position = m_handles.find(handle);
+    if(position == m_handles.end())
+    {
+        return nullptr;
+    }
+    return position->second->get();
+}
+
+BoardHandle BoardRegistry::get_handle(const RootTask* board) const
+{
+    std::unordered_map<const RootTask*, Record>::const_iterator record =
+        m_records.find(board);
+    if(record == m_records.end())
+    {
+        return NULL_HANDLE;
+    }
+    return record->second.handle;
+}
+
+RootTask* BoardRegistry::find_board(const arc::str::UTF8String& title) const
+{
+    return m_titles.find(title);
+}
+
+BoardTitleIndex& BoardRegistry::get_titles()
+{
+    return m_titles;
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
@@ -0,0 +1,320 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief The collection of the boards of the task management domain.
+ */
+#ifndef SIGMA_CORE_TASKS_BOARDREGISTRY_HPP_
+#define SIGMA_CORE_TASKS_BOARDREGISTRY_HPP_
+
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include "sigma/core/tasks/BoardTitleIndex.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class RootTask;
+
+//------------------------------------------------------------------------------
+//                                TYPE DEFINITIONS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Identifies a board within the domain.
+ *
+ * Handles are never reused, so the handle of a deleted board never refers to
+ * another board.
+ */
+typedef arc::uint32 BoardHandle;
+
+/*!
+ * \brief Owns the boards of the task management domain.
+ *
+ * Boards are kept in the order they were added and are identified by handles
+ * which are assigned in increasing order from 1. Boards can be looked up by
+ * their handle, by their RootTask, or by their title in constant time, and
+ * removing a board takes constant time.
+ *
+ * The registry also owns the index of the titles of its boards, see
+ * BoardTitleIndex. Boards update the index when they are renamed.
+ *
+ * The registry is not synchronised, the domain's mutex must be held while
+ * modifying it.
+ */
+class BoardRegistry
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(BoardRegistry);
+
+    /*!
+     * \brief The storage of the boards in the order they were added.
+     */
+    typedef std::list<std::unique_ptr<RootTask>> BoardList;
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                              PUBLIC CONSTANTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The handle that refers to no board.
+     */
+    static const BoardHandle NULL_HANDLE = 0;
+
+    //--------------------------------------------------------------------------
+    //                               PUBLIC CLASSES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Iterates over the boards of a registry in the order they were
+     *        added.
+     */
+    class Iterator
+    {
+    public:
+
+        typedef std::forward_iterator_tag iterator_category;
+        typedef RootTask* value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef RootTask* const* pointer;
+        typedef RootTask* reference;
+
+        Iterator()
+        {
+        }
+
+        explicit Iterator(BoardList::const_iterator position)
+            :
+            m_position(position)
+        {
+        }
+
+        RootTask* operator*() const
+        {
+            return m_position->get();
+        }
+
+        /*!
+         * \brief Allows the members of the board to be accessed with ->.
+         */
+        RootTask* operator->() const
+        {
+            return m_position->get();
+        }
+
+        Iterator& operator++()
+        {
+            ++m_position;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator previous(*this);
+            ++m_position;
+            return previous;
+        }
+
+        bool operator==(const Iterator& other) const
+        {
+            return m_position == other.m_position;
+        }
+
+        bool operator!=(const Iterator& other) const
+        {
+            return m_position != other.m_position;
+        }
+
+    private:
+
+        BoardList::const_iterator m_position;
+    };
+
+    /*!
+     * \brief A view of the boards of a registry that can be iterated over.
+     *
+     * The view doesn't copy the boards, it remains valid while the registry
+     * exists and reflects boards that are added and removed, although
+     * iterators to removed boards are invalidated.
+     */
+    class Range
+    {
+    public:
+
+        typedef Iterator iterator;
+        typedef Iterator const_iterator;
+
+        explicit Range(const BoardList& boards)
+            :
+            m_boards(&boards)
+        {
+        }
+
+        Iterator begin() const
+        {
+            return Iterator(m_boards->begin());
+        }
+
+        Iterator end() const
+        {
+            return Iterator(m_boards->end());
+        }
+
+        Iterator cbegin() const
+        {
+            return begin();
+        }
+
+        Iterator cend() const
+        {
+            return end();
+        }
+
+        std::size_t size() const
+        {
+            return m_boards->size();
+        }
+
+        bool empty() const
+        {
+            return m_boards->empty();
+        }
+
+    private:
+
+        const BoardList* m_boards;
+    };
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates an empty registry.
+     */
+    BoardRegistry();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Takes ownership of the given board and returns its handle.
+     */
+    BoardHandle add(std::unique_ptr<RootTask> board);
+
+    /*!
+     * \brief Removes and destroys the given board.
+     *
+     * \return False if the board is not in this registry.
+     */
+    bool remove(const RootTask* board);
+
+    /*!
+     * \brief Removes the given board without destroying it.
+     *
+     * \return The board, or null if the board is not in this registry.
+     */
+    std::unique_ptr<RootTask> release(const RootTask* board);
+
+    /*!
+     * \brief Removes and destroys every board, in the order they were added.
+     */
+    void clear();
+
+    /*!
+     * \brief Returns the number of boards.
+     */
+    std::size_t size() const;
+
+    /*!
+     * \brief Returns a view of the boards in the order they were added.
+     */
+    Range get_boards() const;
+
+    /*!
+     * \brief Returns the board with the given handle, or null if there is no
+     *        such board.
+     */
+    RootTask* get_board(BoardHandle handle) const;
+
+    /*!
+     * \brief Returns the handle of the given board, or NULL_HANDLE if the
+     *        board is not in this registry.
+     */
+    BoardHandle get_handle(const RootTask* board) const;
+
+    /*!
+     * \brief Returns the board with the given title, or null if there is no
+     *        such board.
+     */
+    RootTask* find_board(const arc::str::UTF8String& title) const;
+
+    /*!
+     * \brief Returns the index of the titles of the boards.
+     */
+    BoardTitleIndex& get_titles();
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The registration of a board.
+     */
+    struct Record
+    {
+        BoardHandle handle;
+        BoardList::iterator position;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The handle that will be assigned to the next board.
+     */
+    BoardHandle m_next_handle;
+    /*!
+     * \brief The boards in the order they were added.
+     */
+    BoardList m_boards;
+    /*!
+     * \brief The positions of the boards mapped from their handles.
+     */
+    std::unordered_map<BoardHandle, BoardList::iterator> m_handles;
+    /*!
+     * \brief The registrations of the boards mapped from their RootTasks.
+     */
+    std::unordered_map<const RootTask*, Record> m_records;
+    /*!
+     * \brief The titles of the boards.
+     */
+    BoardTitleIndex m_titles;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
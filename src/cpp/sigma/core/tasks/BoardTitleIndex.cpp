@@ -0,0 +1,202 @@
+#include "sigma/core/tasks/BoardTitleIndex.hpp"
+
+#include <algorithm>
+
+#include <arcanecore/base/Exceptions.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTORS
+//------------------------------------------------------------------------------
+
+BoardTitleIndex::Entry::Entry()
+    :
+    frontier(1)
+{
+}
+
+BoardTitleIndex::BoardTitleIndex()
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+arc::uint32 BoardTitleIndex::Entry::get_lowest_free() const
+{
+    return freed.empty() ? frontier : *freed.begin();
+}
+
+void BoardTitleIndex::insert(
+        const arc::str::UTF8String& title,
+        RootTask* board)
+{
+    m_entries[get_key(title)].boards.push_back(board);
+
+    arc::str::UTF8String base;
+    arc::uint32 suffix;
+    if(!split_suffix(title, base, suffix))
+    {
+        return;
+    }
+    Entry& entry = m_entries[get_key(base)];
+    if(++entry.suffixes[suffix] > 1)
+    {
+        return;
+    }
+    if(suffix < entry.frontier)
+    {
+        entry.freed.erase(suffix);
+        return;
+    }
+    // the frontier only moves forward past suffixes that are in use, so this
+    // is amortised over the insertions that used them
+    while(entry.suffixes.find(entry.frontier) != entry.suffixes.end())
+    {
+        ++entry.frontier;
+    }
+}
+
+bool BoardTitleIndex::remove(
+        const arc::str::UTF8String& title,
+        RootTask* board)
+{
+    std::unordered_map<std::string, Entry>::iterator entry =
+        m_entries.find(get_key(title));
+    if(entry == m_entries.end())
+    {
+        return false;
+    }
+    // titles are unique so there is almost always a single board
+    std::vector<RootTask*>& boards = entry->second.boards;
+    std::vector<RootTask*>::iterator position =
+        std::find(boards.begin(), boards.end(), board);
+    if(position == boards.end())
+    {
+        return false;
+    }
+    boards.erase(position);
+    prune(entry);
+
+    arc::str::UTF8String base;
+    arc::uint32 suffix;
+    if(!split_suffix(title, base, suffix))
+    {
+        return true;
+    }
+    entry = m_entries.find(get_key(base));
+    std::unordered_map<arc::uint32, std::size_t>::iterator used =
+        entry->second.suffixes.find(suffix);
+    if(--used->second == 0)
+    {
+        entry->second.suffixes.erase(used);
+        // suffixes from the frontier on are free unless they're used
+        if(suffix != 0 && suffix < entry->second.frontier)
+        {
+            entry->second.freed.insert(suffix);
+        }
+    }
+    prune(entry);
+    return true;
+}
+
+void BoardTitleIndex::clear()
+{
+    m_entries.clear();
+}
+
+void BoardTitleIndex::resolve(
+        const arc::str::UTF8String& original,
+        arc::str::UTF8String& resolved) const
+{
+    resolved = original;
+
+    std::unordered_map<std::string, Entry>::const_iterator entry =
+        m_entries.find(get_key(original));
+    if(entry != m_entries.end() && !entry->second.boards.empty())
+    {
+        resolved << " (" << entry->second.get_lowest_free() << ")";
+    }
+}
+
+RootTask* BoardTitleIndex::find(const arc::str::UTF8String& title) const
+{
+    std::unordered_map<std::string, Entry>::const_iterator entry =
+        m_entries.find(get_key(title));
+    if(entry == m_entries.end() || entry->second.boards.empty())
+    {
+        return nullptr;
+    }
+    return entry->second.boards.back();
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+std::string BoardTitleIndex::get_key(const arc::str::UTF8String& title)
+{
+    // the byte length includes the null terminator
+    return std::string(title.get_raw(), title.get_byte_length() - 1);
+}
+
+bool BoardTitleIndex::split_suffix(
+        const arc::str::UTF8String& title,
+        arc::str::UTF8String& base,
+        arc::uint32& suffix)
+{
+    std::size_t par_end_i   = title.find_last(")");
+    std::size_t par_begin_i = title.find_last("(");
+    if(par_end_i   == arc::str::npos ||
+       par_begin_i == arc::str::npos ||
+       par_begin_i == 0              ||
+       par_begin_i > par_end_i)
+    {
+        return false;
+    }
+
+    arc::str::UTF8String par_contents(title.substring(
+        par_begin_i + 1,
+        par_end_i - (par_begin_i + 1)
+    ));
+    if(!par_contents.is_uint())
+    {
+        return false;
+    }
+    try
+    {
+        suffix = par_contents.to_uint32();
+    }
+    catch(const arc::ex::ConversionDataError&)
+    {
+        // too large to be a suffix
+        return false;
+    }
+    // the base title is separated from the suffix by a single symbol
+    base = title.substring(0, par_begin_i - 1);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void BoardTitleIndex::prune(
+        std::unordered_map<std::string, Entry>::iterator entry)
+{
+    if(entry->second.boards.empty() && entry->second.suffixes.empty())
+    {
+        m_entries.erase(entry);
+    }
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
@@ -0,0 +1,188 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Index of board titles used to resolve unique titles.
+ */
+#ifndef SIGMA_CORE_TASKS_BOARDTITLEINDEX_HPP_
+#define SIGMA_CORE_TASKS_BOARDTITLEINDEX_HPP_
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class RootTask;
+
+/*!
+ * \brief Indexes the titles of boards so that a title can be made unique
+ *        without visiting every board.
+ *
+ * A title is made unique by appending the lowest number that isn't already
+ * used as a suffix of the title, for example if there are boards titled
+ * ``Notes`` and ``Notes (1)`` then ``Notes`` resolves to ``Notes (2)``. A
+ * title is taken to use the suffix ``n`` of a base title if it's the base
+ * title followed by a single symbol and then ``(n)``, where no parentheses
+ * follow the closing parenthesis.
+ *
+ * Each indexed title is stored under its own title, along with the board that
+ * has the title, and under its base title if it has a suffix. Each base title
+ * tracks the suffixes that are used, a frontier below which every suffix has
+ * been used and the ordered suffixes below the frontier that have since been
+ * freed. Resolving a title and finding the board with a title take constant
+ * time, while adding or removing a title takes amortised logarithmic time in
+ * the number of freed suffixes, regardless of the number of boards.
+ *
+ * The index is not synchronised, the domain's mutex must be held while
+ * accessing it.
+ */
+class BoardTitleIndex
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(BoardTitleIndex);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates an empty index.
+     */
+    BoardTitleIndex();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Adds the title of the given board to the index.
+     *
+     * \param title The title of the board, this is passed separately since
+     *              the index may be updated before the board's title is.
+     * \param board The board with the title.
+     */
+    void insert(const arc::str::UTF8String& title, RootTask* board);
+
+    /*!
+     * \brief Removes the title of the given board from the index.
+     *
+     * \return False if the board was not in the index with the title.
+     */
+    bool remove(const arc::str::UTF8String& title, RootTask* board);
+
+    /*!
+     * \brief Removes all titles from the index.
+     */
+    void clear();
+
+    /*!
+     * \brief Resolves the given title so that it is unique among the indexed
+     *        titles.
+     *
+     * \param original The title to resolve.
+     * \param resolved Returns the original title if no indexed title is equal
+     *                 to it, otherwise the original title followed by the
+     *                 lowest unused suffix.
+     */
+    void resolve(
+            const arc::str::UTF8String& original,
+            arc::str::UTF8String& resolved) const;
+
+    /*!
+     * \brief Returns the board with the given title, or null if there is no
+     *        such board.
+     *
+     * If multiple boards have the title the most recently indexed board is
+     * returned.
+     */
+    RootTask* find(const arc::str::UTF8String& title) const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The indexed titles that are equal to, or are suffixed versions
+     *        of, a single title.
+     */
+    struct Entry
+    {
+        /// The boards that have this title.
+        std::vector<RootTask*> boards;
+        /// The number of indexed titles that use each suffix of this title.
+        std::unordered_map<arc::uint32, std::size_t> suffixes;
+        /// The lowest suffix (from 1) such that every suffix below it is
+        /// either used or in freed, this is never used.
+        arc::uint32 frontier;
+        /// The unused suffixes below the frontier.
+        std::set<arc::uint32> freed;
+
+        Entry();
+
+        /*!
+         * \brief Returns the lowest unused suffix.
+         */
+        arc::uint32 get_lowest_free() const;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The entries mapped from the bytes of their title.
+     */
+    std::unordered_map<std::string, Entry> m_entries;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the key of the given title in m_entries.
+     */
+    static std::string get_key(const arc::str::UTF8String& title);
+
+    /*!
+     * \brief Splits the given title into its base title and suffix.
+     *
+     * \return False if the title doesn't have a suffix.
+     */
+    static bool split_suffix(
+            const arc::str::UTF8String& title,
+            arc::str::UTF8String& base,
+            arc::uint32& suffix);
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Removes the given entry if no titles refer to it.
+     */
+    void prune(std::unordered_map<std::string, Entry>::iterator entry);
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
@@ -0,0 +1,156 @@
+#include "sigma/core/tasks/ChangeFeed.hpp"
+
+#include <arcanecore/base/Exceptions.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                             PUBLIC STATIC CONSTANTS
+//------------------------------------------------------------------------------
+
+const std::size_t ChangeFeed::DEFAULT_CAPACITY = 16384;
+
+//------------------------------------------------------------------------------
+//                                     CURSOR
+//------------------------------------------------------------------------------
+
+ChangeFeed::Cursor::Cursor(const ChangeFeed& feed)
+    :
+    m_feed    (&feed),
+    m_sequence(feed.get_head())
+{
+}
+
+ChangeFeed::ReadResult ChangeFeed::Cursor::read(ChangeRecord& out)
+{
+    ReadResult result = m_feed->read(m_sequence, out);
+    if(result == READ_CHANGE)
+    {
+        ++m_sequence;
+    }
+    return result;
+}
+
+void ChangeFeed::Cursor::resync()
+{
+    m_sequence = m_feed->get_head();
+}
+
+arc::uint64 ChangeFeed::Cursor::get_sequence() const
+{
+    return m_sequence;
+}
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+ChangeFeed::ChangeFeed(std::size_t capacity)
+    :
+    m_head (1),
+    m_mask (0),
+    m_slots(0)
+{
+    if(capacity == 0)
+    {
+        throw arc::ex::ValueError("A change feed must have a capacity");
+    }
+
+    std::size_t rounded = 1;
+    while(rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+    m_mask = rounded - 1;
+
+    std::vector<Slot> slots(rounded);
+    m_slots.swap(slots);
+    for(std::size_t i = 0; i < rounded; ++i)
+    {
+        m_slots[i].sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+arc::uint64 ChangeFeed::append(
+        ChangeRecord::Type type,
+        arc::uint32 board_id,
+        arc::uint32 task_id)
+{
+    arc::uint64 sequence = m_head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = m_slots[sequence & m_mask];
+
+    // readers of the change being overwritten see the slot is being written
+    // before they could see any of the new fields
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.type.store(static_cast<arc::uint32>(type), std::memory_order_relaxed);
+    slot.board_id.store(board_id, std::memory_order_relaxed);
+    slot.task_id.store(task_id, std::memory_order_relaxed);
+
+    // publish
+    slot.sequence.store(sequence, std::memory_order_release);
+    return sequence;
+}
+
+arc::uint64 ChangeFeed::get_head() const
+{
+    return m_head.load(std::memory_order_acquire);
+}
+
+std::size_t ChangeFeed::get_capacity() const
+{
+    return m_slots.size();
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+ChangeFeed::ReadResult ChangeFeed::read(
+        arc::uint64 sequence,
+        ChangeRecord& out) const
+{
+    const Slot& slot = m_slots[sequence & m_mask];
+
+    arc::uint64 published = slot.sequence.load(std::memory_order_acquire);
+    if(published == sequence)
+    {
+        out.sequence = sequence;
+        out.type = static_cast<ChangeRecord::Type>(
+                slot.type.load(std::memory_order_relaxed));
+        out.board_id = slot.board_id.load(std::memory_order_relaxed);
+        out.task_id = slot.task_id.load(std::memory_order_relaxed);
+
+        // if a writer started overwriting the slot while the fields were read
+        // the record may be torn
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            return READ_OVERRUN;
+        }
+        return READ_CHANGE;
+    }
+
+    // the slot either holds a later change, is being overwritten by a later
+    // change, or the change hasn't been published yet
+    arc::uint64 head = m_head.load(std::memory_order_acquire);
+    if(published > sequence || head > sequence + m_mask + 1)
+    {
+        return READ_OVERRUN;
+    }
+    return READ_EMPTY;
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
@@ -0,0 +1,277 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Sequenced feed of the changes made to the boards of a domain.
+ */
+#ifndef SIGMA_CORE_TASKS_CHANGEFEED_HPP_
+#define SIGMA_CORE_TASKS_CHANGEFEED_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+/*!
+ * \brief A single change made to a board or Task.
+ *
+ * Records only identify what changed, consumers read the current state of the
+ * board or Task from the domain.
+ */
+struct ChangeRecord
+{
+    //--------------------------------------------------------------------------
+    //                                ENUMERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The kinds of change.
+     */
+    enum Type
+    {
+        /// The board was created.
+        BOARD_CREATED,
+        /// The board and all of its Tasks were deleted.
+        BOARD_DELETED,
+        /// The Task was created, or restored by undoing its deletion.
+        CREATED,
+        /// The Task was destroyed.
+        DESTROYED,
+        /// The title of the Task or board changed.
+        RETITLED,
+        /// The attributes of the Task changed.
+        ATTRIBUTES_CHANGED,
+        /// The Task has a different parent or position among its siblings,
+        /// and may now belong to a different board.
+        MOVED,
+        /// The children of the Task were reordered.
+        REORDERED,
+        /// The descendants of the Task were archived.
+        ARCHIVED,
+        /// The descendants of the Task were rehydrated.
+        REHYDRATED
+    };
+
+    //--------------------------------------------------------------------------
+    //                                 ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /// The position of the change in the feed, starting from 1.
+    arc::uint64 sequence;
+    /// The kind of change.
+    Type type;
+    /// The id of the RootTask of the board the change was made to.
+    arc::uint32 board_id;
+    /// The id of the Task that changed, this is the board id for changes to
+    /// the board itself.
+    arc::uint32 task_id;
+};
+
+/*!
+ * \brief A fixed size ring buffer of the changes made to the boards of a
+ *        domain, which consumers read from at their own pace.
+ *
+ * Every change is assigned the next sequence number and written to the slot
+ * of the buffer for that number, overwriting the change that was written
+ * capacity changes earlier. Consumers read the changes in order through a
+ * Cursor, so a slow consumer never delays the Tasks being changed. A consumer
+ * that falls more than the capacity behind is told that it has been overrun,
+ * at which point it should resync() its cursor and rebuild its state from the
+ * domain.
+ *
+ * The feed of each domain is accessed through TasksDomain::get_changes().
+ * Changes made while a Task's descendants are archived or rehydrated are not
+ * recorded, only the ARCHIVED or REHYDRATED change of the Task is, and
+ * deleting a board only records BOARD_DELETED.
+ *
+ * \par Thread Safety
+ *
+ * The feed is lock-free. Any number of threads may append changes and read
+ * through their own cursors concurrently, as long as fewer than capacity
+ * changes are being appended at the same time.
+ */
+class ChangeFeed
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(ChangeFeed);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                ENUMERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The results of reading from a Cursor.
+     */
+    enum ReadResult
+    {
+        /// The next change was read.
+        READ_CHANGE,
+        /// There are no changes that haven't been read yet.
+        READ_EMPTY,
+        /// The next change has been overwritten.
+        READ_OVERRUN
+    };
+
+    //--------------------------------------------------------------------------
+    //                              PUBLIC CONSTANTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The number of changes held by a feed unless otherwise specified.
+     */
+    static const std::size_t DEFAULT_CAPACITY;
+
+    //--------------------------------------------------------------------------
+    //                               PUBLIC CLASSES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A consumer's position in a feed.
+     *
+     * A cursor may only be used by one thread at a time, and must not outlive
+     * its feed.
+     */
+    class Cursor
+    {
+    public:
+
+        /*!
+         * \brief Creates a cursor that will read the changes appended to the
+         *        given feed from now on.
+         */
+        explicit Cursor(const ChangeFeed& feed);
+
+        /*!
+         * \brief Reads the next change into out.
+         *
+         * The cursor only moves forward when a change is read, after an
+         * overrun the cursor must be resynced before changes can be read.
+         */
+        ReadResult read(ChangeRecord& out);
+
+        /*!
+         * \brief Moves this cursor past all of the changes that have been
+         *        appended so far.
+         *
+         * Consumers that have been overrun resync then rebuild their state
+         * from the domain, since the changes they missed are lost.
+         */
+        void resync();
+
+        /*!
+         * \brief Returns the sequence number of the next change this cursor
+         *        will read.
+         */
+        arc::uint64 get_sequence() const;
+
+    private:
+
+        const ChangeFeed* m_feed;
+        arc::uint64 m_sequence;
+    };
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates an empty feed.
+     *
+     * \param capacity The number of changes the feed holds, this is rounded
+     *                 up to a power of two.
+     *
+     * \throws arc::ex::ValueError If the capacity is zero.
+     */
+    explicit ChangeFeed(std::size_t capacity = DEFAULT_CAPACITY);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Appends a change to the feed.
+     *
+     * \return The sequence number of the change.
+     */
+    arc::uint64 append(
+            ChangeRecord::Type type,
+            arc::uint32 board_id,
+            arc::uint32 task_id);
+
+    /*!
+     * \brief Returns the sequence number that will be assigned to the next
+     *        change.
+     */
+    arc::uint64 get_head() const;
+
+    /*!
+     * \brief Returns the number of changes the feed holds.
+     */
+    std::size_t get_capacity() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The storage of a single change.
+     *
+     * The fields are atomic since a slot may be overwritten while it's being
+     * read, the sequence number is written last and checked again after the
+     * fields have been read to detect this.
+     */
+    struct Slot
+    {
+        /// The sequence number of the change, or 0 while the slot is empty
+        /// or being written.
+        std::atomic<arc::uint64> sequence;
+        std::atomic<arc::uint32> type;
+        std::atomic<arc::uint32> board_id;
+        std::atomic<arc::uint32> task_id;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The sequence number that will be assigned to the next change.
+     */
+    std::atomic<arc::uint64> m_head;
+    /*!
+     * \brief Masks a sequence number to the index of its slot.
+     */
+    arc::uint64 m_mask;
+    /*!
+     * \brief The ring buffer of changes.
+     */
+    std::vector<Slot> m_slots;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Reads the change with the given sequence number into out.
+     */
+    ReadResult read(arc::uint64 sequence, ChangeRecord& out) const;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
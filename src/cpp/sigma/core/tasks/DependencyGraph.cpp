@@ -0,0 +1,505 @@
+#include "sigma/core/tasks/DependencyGraph.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <queue>
+#include <unordered_set>
+
+#include "sigma/core/tasks/Task.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+DependencyGraph::DependencyGraph()
+    :
+    m_gaps(0)
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool DependencyGraph::add_dependency(Task* blocker, Task* blocked)
+{
+    if(blocker == nullptr || blocked == nullptr)
+    {
+        throw arc::ex::ValueError("Dependencies cannot involve a null Task");
+    }
+    if(blocker == blocked)
+    {
+        throw arc::ex::ValueError("A Task cannot depend on itself");
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    arc::uint32 blocker_id = blocker->get_id();
+    arc::uint32 blocked_id = blocked->get_id();
+    if(has_edge(blocker_id, blocked_id))
+    {
+        return false;
+    }
+
+    Node& blocker_node = get_or_create_node(blocker);
+    Node& blocked_node = get_or_create_node(blocked);
+    if(blocker_node.position > blocked_node.position)
+    {
+        try
+        {
+            reorder(blocker_id, blocked_id);
+        }
+        catch(...)
+        {
+            remove_if_isolated(blocker_id);
+            remove_if_isolated(blocked_id);
+            throw;
+        }
+    }
+
+    blocker_node.blocked.push_back(blocked_id);
+    blocked_node.blockers.push_back(blocker_id);
+    propagate(blocked_id);
+    return true;
+}
+
+bool DependencyGraph::remove_dependency(
+        const Task* blocker,
+        const Task* blocked)
+{
+    if(blocker == nullptr || blocked == nullptr)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    NodeMap::iterator blocker_node = m_nodes.find(blocker->get_id());
+    NodeMap::iterator blocked_node = m_nodes.find(blocked->get_id());
+    if(blocker_node == m_nodes.end() || blocked_node == m_nodes.end())
+    {
+        return false;
+    }
+    std::vector<arc::uint32>& edges = blocker_node->second.blocked;
+    std::vector<arc::uint32>::iterator edge =
+        std::find(edges.begin(), edges.end(), blocked_node->first);
+    if(edge == edges.end())
+    {
+        return false;
+    }
+
+    edges.erase(edge);
+    std::vector<arc::uint32>& blockers = blocked_node->second.blockers;
+    blockers.erase(
+            std::find(blockers.begin(), blockers.end(), blocker_node->first));
+
+    // removing a dependency never invalidates the topological order, but the
+    // blocked Task may finish earlier
+    propagate(blocked_node->first);
+    remove_if_isolated(blocker->get_id());
+    remove_if_isolated(blocked->get_id());
+    return true;
+}
+
+bool DependencyGraph::has_dependency(
+        const Task* blocker,
+        const Task* blocked) const
+{
+    if(blocker == nullptr || blocked == nullptr)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return has_edge(blocker->get_id(), blocked->get_id());
+}
+
+void DependencyGraph::remove_task(arc::uint32 id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    NodeMap::iterator node = m_nodes.find(id);
+    if(node == m_nodes.end())
+    {
+        return;
+    }
+
+    std::vector<arc::uint32> blockers;
+    std::vector<arc::uint32> blocked;
+    blockers.swap(node->second.blockers);
+    blocked.swap(node->second.blocked);
+
+    ARC_CONST_FOR_EACH(it, blockers)
+    {
+        std::vector<arc::uint32>& edges = m_nodes[*it].blocked;
+        edges.erase(std::find(edges.begin(), edges.end(), id));
+        remove_if_isolated(*it);
+    }
+    remove_if_isolated(id);
+    ARC_CONST_FOR_EACH(it, blocked)
+    {
+        std::vector<arc::uint32>& edges = m_nodes[*it].blockers;
+        edges.erase(std::find(edges.begin(), edges.end(), id));
+        propagate(*it);
+        remove_if_isolated(*it);
+    }
+}
+
+void DependencyGraph::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_nodes.clear();
+    m_order.clear();
+    m_gaps = 0;
+    m_finishes.clear();
+}
+
+std::size_t DependencyGraph::get_task_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_nodes.size();
+}
+
+void DependencyGraph::get_blockers(
+        const Task* task,
+        std::vector<arc::uint32>& out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    NodeMap::const_iterator node = m_nodes.find(task->get_id());
+    if(node != m_nodes.end())
+    {
+        out.insert(
+                out.end(),
+                node->second.blockers.begin(),
+                node->second.blockers.end()
+        );
+    }
+}
+
+void DependencyGraph::get_blocked(
+        const Task* task,
+        std::vector<arc::uint32>& out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    NodeMap::const_iterator node = m_nodes.find(task->get_id());
+    if(node != m_nodes.end())
+    {
+        out.insert(
+                out.end(),
+                node->second.blocked.begin(),
+                node->second.blocked.end()
+        );
+    }
+}
+
+void DependencyGraph::get_topological_order(
+        std::vector<arc::uint32>& out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    out.reserve(out.size() + m_nodes.size());
+    ARC_CONST_FOR_EACH(it, m_order)
+    {
+        if(*it != 0)
+        {
+            out.push_back(*it);
+        }
+    }
+}
+
+arc::uint64 DependencyGraph::get_finish_time(const Task* task) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    NodeMap::const_iterator node = m_nodes.find(task->get_id());
+    if(node == m_nodes.end())
+    {
+        return task->get_estimate();
+    }
+    return node->second.finish;
+}
+
+arc::uint64 DependencyGraph::get_critical_path_length() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_finishes.empty())
+    {
+        return 0;
+    }
+    return m_finishes.rbegin()->first;
+}
+
+void DependencyGraph::get_critical_path(std::vector<arc::uint32>& out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_finishes.empty())
+    {
+        return;
+    }
+
+    // walk back from the Task that finishes last, following the blockers that
+    // determined each finish time, the path can't be longer than the number
+    // of Tasks in the graph
+    std::vector<arc::uint32> path;
+    arc::uint32 id = m_finishes.rbegin()->second;
+    while(id != 0 && path.size() < m_nodes.size())
+    {
+        path.push_back(id);
+        const Node& node = m_nodes.find(id)->second;
+        arc::uint64 remaining = node.finish - node.estimate;
+        id = 0;
+        if(remaining == 0)
+        {
+            break;
+        }
+        ARC_CONST_FOR_EACH(it, node.blockers)
+        {
+            if(m_nodes.find(*it)->second.finish == remaining)
+            {
+                id = *it;
+                break;
+            }
+        }
+        // the finish time of a Task is always determined by one of its
+        // blockers
+        assert(id != 0);
+    }
+
+    out.insert(out.end(), path.rbegin(), path.rend());
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool DependencyGraph::has_edge(arc::uint32 blocker, arc::uint32 blocked) const
+{
+    NodeMap::const_iterator node = m_nodes.find(blocker);
+    if(node == m_nodes.end())
+    {
+        return false;
+    }
+    const std::vector<arc::uint32>& edges = node->second.blocked;
+    return std::find(edges.begin(), edges.end(), blocked) != edges.end();
+}
+
+DependencyGraph::Node& DependencyGraph::get_or_create_node(Task* task)
+{
+    NodeMap::iterator existing = m_nodes.find(task->get_id());
+    if(existing != m_nodes.end())
+    {
+        return existing->second;
+    }
+
+    Node& node = m_nodes[task->get_id()];
+    node.estimate = task->get_estimate();
+    node.position = m_order.size();
+    node.finish = node.estimate;
+    m_order.push_back(task->get_id());
+    m_finishes.insert(std::make_pair(node.finish, task->get_id()));
+    return node;
+}
+
+void DependencyGraph::remove_if_isolated(arc::uint32 id)
+{
+    NodeMap::iterator node = m_nodes.find(id);
+    if(node == m_nodes.end()            ||
+       !node->second.blockers.empty()   ||
+       !node->second.blocked.empty())
+    {
+        return;
+    }
+
+    m_finishes.erase(std::make_pair(node->second.finish, id));
+    m_order[node->second.position] = 0;
+    ++m_gaps;
+    m_nodes.erase(node);
+
+    if(m_gaps * 2 > m_order.size())
+    {
+        compact_order();
+    }
+}
+
+void DependencyGraph::reorder(arc::uint32 blocker, arc::uint32 blocked)
+{
+    // Pearce-Kelly: the order is only violated between the positions of the
+    // two Tasks, so only the Tasks within that range need to be moved
+    std::size_t lower = m_nodes[blocked].position;
+    std::size_t upper = m_nodes[blocker].position;
+
+    // the Tasks within the range that depend on the blocked Task
+    std::vector<arc::uint32> forward;
+    std::unordered_set<arc::uint32> visited;
+    std::vector<arc::uint32> stack(1, blocked);
+    visited.insert(blocked);
+    while(!stack.empty())
+    {
+        arc::uint32 id = stack.back();
+        stack.pop_back();
+        forward.push_back(id);
+        ARC_CONST_FOR_EACH(it, m_nodes[id].blocked)
+        {
+            if(*it == blocker)
+            {
+                throw arc::ex::IllegalActionError(
+                        "Adding the dependency would create a cycle");
+            }
+            if(m_nodes[*it].position < upper && visited.insert(*it).second)
+            {
+                stack.push_back(*it);
+            }
+        }
+    }
+
+    // the Tasks within the range that the blocker depends on
+    std::vector<arc::uint32> backward;
+    stack.assign(1, blocker);
+    visited.insert(blocker);
+    while(!stack.empty())
+    {
+        arc::uint32 id = stack.back();
+        stack.pop_back();
+        backward.push_back(id);
+        ARC_CONST_FOR_EACH(it, m_nodes[id].blockers)
+        {
+            if(m_nodes[*it].position > lower && visited.insert(*it).second)
+            {
+                stack.push_back(*it);
+            }
+        }
+    }
+
+    // the affected Tasks keep their relative order, but everything the blocker
+    // depends on moves in front of everything depending on the blocked Task
+    auto by_position = [this](arc::uint32 a, arc::uint32 b)
+    {
+        return m_nodes[a].position < m_nodes[b].position;
+    };
+    std::sort(backward.begin(), backward.end(), by_position);
+    std::sort(forward.begin(), forward.end(), by_position);
+
+    std::vector<std::size_t> positions;
+    positions.reserve(backward.size() + forward.size());
+    ARC_CONST_FOR_EACH(it, backward)
+    {
+        positions.push_back(m_nodes[*it].position);
+    }
+    ARC_CONST_FOR_EACH(it, forward)
+    {
+        positions.push_back(m_nodes[*it].position);
+    }
+    std::sort(positions.begin(), positions.end());
+
+    std::size_t next = 0;
+    ARC_CONST_FOR_EACH(it, backward)
+    {
+        m_nodes[*it].position = positions[next];
+        m_order[positions[next++]] = *it;
+    }
+    ARC_CONST_FOR_EACH(it, forward)
+    {
+        m_nodes[*it].position = positions[next];
+        m_order[positions[next++]] = *it;
+    }
+}
+
+void DependencyGraph::propagate(arc::uint32 id)
+{
+    // visiting Tasks in topological order means each Task is only recomputed
+    // once all of its changed blockers have been
+    typedef std::pair<std::size_t, arc::uint32> QueueEntry;
+    std::priority_queue<
+        QueueEntry,
+        std::vector<QueueEntry>,
+        std::greater<QueueEntry>
+    > queue;
+    std::unordered_set<arc::uint32> queued;
+
+    queue.push(QueueEntry(m_nodes[id].position, id));
+    queued.insert(id);
+    while(!queue.empty())
+    {
+        arc::uint32 current = queue.top().second;
+        queue.pop();
+        queued.erase(current);
+
+        Node& node = m_nodes[current];
+        arc::uint64 start = 0;
+        ARC_CONST_FOR_EACH(it, node.blockers)
+        {
+            start = std::max(start, m_nodes[*it].finish);
+        }
+        arc::uint64 finish = start + node.estimate;
+        if(finish == node.finish)
+        {
+            continue;
+        }
+
+        m_finishes.erase(std::make_pair(node.finish, current));
+        m_finishes.insert(std::make_pair(finish, current));
+        node.finish = finish;
+        ARC_CONST_FOR_EACH(it, node.blocked)
+        {
+            if(queued.insert(*it).second)
+            {
+                queue.push(QueueEntry(m_nodes[*it].position, *it));
+            }
+        }
+    }
+}
+
+void DependencyGraph::compact_order()
+{
+    std::vector<arc::uint32> order;
+    order.reserve(m_nodes.size());
+    ARC_CONST_FOR_EACH(it, m_order)
+    {
+        if(*it != 0)
+        {
+            m_nodes[*it].position = order.size();
+            order.push_back(*it);
+        }
+    }
+    m_order.swap(order);
+    m_gaps = 0;
+}
+
+void DependencyGraph::on_attributes_changed(
+        const Task* task,
+        const TaskAttributes& previous,
+        const TaskAttributes& attributes)
+{
+    if(previous.estimate == attributes.estimate)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    NodeMap::iterator node = m_nodes.find(task->get_id());
+    if(node != m_nodes.end())
+    {
+        node->second.estimate = attributes.estimate;
+        propagate(task->get_id());
+    }
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
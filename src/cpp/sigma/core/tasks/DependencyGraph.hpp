@@ -0,0 +1,296 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Blocks/blocked-by dependencies between Tasks.
+ */
+#ifndef SIGMA_CORE_TASKS_DEPENDENCYGRAPH_HPP_
+#define SIGMA_CORE_TASKS_DEPENDENCYGRAPH_HPP_
+
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+
+#include "sigma/core/tasks/TaskAttributes.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class Task;
+
+/*!
+ * \brief A directed acyclic graph of dependencies between Tasks.
+ *
+ * A dependency states that one Task (the blocker) must be completed before
+ * another Task (the blocked Task) can be. Dependencies are independent of the
+ * Task hierarchy, so any two Tasks may depend on each other, even if they
+ * are on different boards. Tasks are referred to by their ids, which are
+ * unique across all boards.
+ *
+ * The graph is kept acyclic, adding a dependency that would form a cycle is
+ * rejected. Alongside the dependencies the graph maintains:
+ *
+ * - A topological order of the Tasks, where every blocker is ordered before
+ *   the Tasks it blocks. Adding a dependency only reorders the Tasks between
+ *   the two Tasks involved in the current order, and removing a dependency
+ *   never invalidates the order.
+ * - The finish time of each Task, this is the largest total of estimates
+ *   (see Task::get_estimate()) along any chain of dependencies that ends with
+ *   the Task. When a dependency or estimate changes only the finish times of
+ *   the Tasks downstream of the change are recomputed, and propagation stops
+ *   at Tasks whose finish time does not change.
+ * - The critical path, the chain of dependencies with the largest total
+ *   estimate.
+ *
+ * Only Tasks that have at least one dependency are stored in the graph. The
+ * graph of each domain is accessed through TasksDomain::get_dependencies(),
+ * the domain keeps the estimates of the graph up to date as the attributes of
+ * its Tasks change and removes Tasks from the graph when they are destroyed.
+ * Archived Tasks (see Task::archive()) keep their dependencies since they are
+ * referred to by id.
+ *
+ * \note Undoing the deletion of a Task does not restore its dependencies.
+ *
+ * \par Thread Safety
+ *
+ * All functions of the graph are synchronised by a mutex of the graph, so the
+ * graph may be used from multiple threads. The graph never acquires the lock
+ * of a board.
+ */
+class DependencyGraph
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(DependencyGraph);
+
+    friend class TasksDomain;
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new graph with no dependencies.
+     */
+    DependencyGraph();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Adds a dependency where the given blocked Task cannot be
+     *        completed before the given blocker.
+     *
+     * \return False if the dependency already existed.
+     *
+     * \throws arc::ex::ValueError If either Task is null, or both are the same
+     *                             Task.
+     * \throws arc::ex::IllegalActionError If the blocker already depends on
+     *                                     the blocked Task (directly or
+     *                                     indirectly), since the dependency
+     *                                     would form a cycle.
+     */
+    bool add_dependency(Task* blocker, Task* blocked);
+
+    /*!
+     * \brief Removes the dependency between the given Tasks.
+     *
+     * \return False if there was no such dependency.
+     */
+    bool remove_dependency(const Task* blocker, const Task* blocked);
+
+    /*!
+     * \brief Returns whether the given blocked Task directly depends on the
+     *        given blocker.
+     */
+    bool has_dependency(const Task* blocker, const Task* blocked) const;
+
+    /*!
+     * \brief Removes all of the dependencies of the Task with the given id.
+     */
+    void remove_task(arc::uint32 id);
+
+    /*!
+     * \brief Removes all dependencies.
+     */
+    void clear();
+
+    /*!
+     * \brief Returns the number of Tasks that have at least one dependency.
+     */
+    std::size_t get_task_count() const;
+
+    /*!
+     * \brief Appends the ids of the Tasks that directly block the given Task
+     *        to the given vector.
+     */
+    void get_blockers(const Task* task, std::vector<arc::uint32>& out) const;
+
+    /*!
+     * \brief Appends the ids of the Tasks that are directly blocked by the
+     *        given Task to the given vector.
+     */
+    void get_blocked(const Task* task, std::vector<arc::uint32>& out) const;
+
+    /*!
+     * \brief Appends the ids of all Tasks with dependencies to the given vector
+     *        in topological order, every Task comes after all of its
+     *        blockers.
+     */
+    void get_topological_order(std::vector<arc::uint32>& out) const;
+
+    /*!
+     * \brief Returns the largest total of estimates along any chain of
+     *        dependencies that ends with the given Task, including the
+     *        estimate of the Task itself.
+     *
+     * For a Task without dependencies this is the estimate of the Task.
+     */
+    arc::uint64 get_finish_time(const Task* task) const;
+
+    /*!
+     * \brief Returns the largest total of estimates along any chain of
+     *        dependencies in the graph.
+     */
+    arc::uint64 get_critical_path_length() const;
+
+    /*!
+     * \brief Appends the ids of the Tasks that make up the critical path to the
+     *        given vector, in the order they must be completed.
+     *
+     * Tasks at the start of the path with no estimate are omitted. Nothing is
+     * appended if the graph has no dependencies.
+     */
+    void get_critical_path(std::vector<arc::uint32>& out) const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A Task with at least one dependency.
+     */
+    struct Node
+    {
+        /// The estimate of the Task in minutes.
+        arc::uint32 estimate;
+        /// The position of the Task in m_order.
+        std::size_t position;
+        /// The finish time of the Task.
+        arc::uint64 finish;
+        /// The ids of the Tasks that block this Task.
+        std::vector<arc::uint32> blockers;
+        /// The ids of the Tasks blocked by this Task.
+        std::vector<arc::uint32> blocked;
+    };
+
+    typedef std::unordered_map<arc::uint32, Node> NodeMap;
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Synchronises access to the graph.
+     */
+    mutable std::mutex m_mutex;
+    /*!
+     * \brief The Tasks with dependencies mapped from their ids.
+     */
+    NodeMap m_nodes;
+    /*!
+     * \brief The ids of the Tasks in topological order.
+     *
+     * Removing a Task leaves a gap (an id of 0) rather than shifting the
+     * positions of later Tasks, gaps are removed once they make up half of the
+     * order.
+     */
+    std::vector<arc::uint32> m_order;
+    /*!
+     * \brief The number of gaps in m_order.
+     */
+    std::size_t m_gaps;
+    /*!
+     * \brief The finish times of the Tasks paired with their ids, ordered so
+     *        the end of the critical path is the last element.
+     */
+    std::set<std::pair<arc::uint64, arc::uint32>> m_finishes;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns whether there is a dependency between the Tasks with the
+     *        given ids, without locking.
+     */
+    bool has_edge(arc::uint32 blocker, arc::uint32 blocked) const;
+
+    /*!
+     * \brief Returns the node for the given Task, creating it at the end of the
+     *        topological order if the Task has no dependencies yet.
+     */
+    Node& get_or_create_node(Task* task);
+
+    /*!
+     * \brief Removes the node with the given id if it no longer has any
+     *        dependencies.
+     */
+    void remove_if_isolated(arc::uint32 id);
+
+    /*!
+     * \brief Reorders the Tasks so that the given blocker comes before the
+     *        given blocked Task.
+     *
+     * Only the Tasks between the two Tasks in the current order that are
+     * reachable from the blocked Task, or that can reach the blocker, are
+     * moved.
+     *
+     * \throws arc::ex::IllegalActionError If the blocker can be reached from
+     *                                     the blocked Task.
+     */
+    void reorder(arc::uint32 blocker, arc::uint32 blocked);
+
+    /*!
+     * \brief Recomputes the finish time of the Task with the given id, and
+     *        of any downstream Tasks whose finish times change as a result.
+     */
+    void propagate(arc::uint32 id);
+
+    /*!
+     * \brief Removes the gaps from the topological order.
+     */
+    void compact_order();
+
+    /*!
+     * \brief Called by the domain that owns the graph when the attributes of
+     *        one of its Tasks change.
+     */
+    void on_attributes_changed(
+            const Task* task,
+            const TaskAttributes& previous,
+            const TaskAttributes& attributes);
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
@@ -0,0 +1,81 @@
+#include "sigma/core/tasks/DomainStats.hpp"
+
+#include <algorithm>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                                  BOARD STATS
+//------------------------------------------------------------------------------
+
+BoardStats::BoardStats()
+    :
+    board_id      (0),
+    task_count    (0),
+    archived_count(0),
+    max_depth     (0),
+    max_children  (0),
+    estimated     (false),
+    task_bytes    (0),
+    title_bytes   (0),
+    children_bytes(0),
+    callback_bytes(0),
+    index_bytes   (0),
+    mutations     (0)
+{
+}
+
+std::size_t BoardStats::get_total_bytes() const
+{
+    return task_bytes +
+           title_bytes +
+           children_bytes +
+           callback_bytes +
+           index_bytes;
+}
+
+void BoardStats::accumulate(const BoardStats& other)
+{
+    task_count     += other.task_count;
+    archived_count += other.archived_count;
+    max_depth       = std::max(max_depth, other.max_depth);
+    max_children    = std::max(max_children, other.max_children);
+    estimated       = estimated || other.estimated;
+    task_bytes     += other.task_bytes;
+    title_bytes    += other.title_bytes;
+    children_bytes += other.children_bytes;
+    callback_bytes += other.callback_bytes;
+    index_bytes    += other.index_bytes;
+    mutations      += other.mutations;
+}
+
+//------------------------------------------------------------------------------
+//                                  DOMAIN STATS
+//------------------------------------------------------------------------------
+
+DomainStats::DomainStats()
+    :
+    mutations(0),
+    audited  (false),
+    time     (std::chrono::steady_clock::now())
+{
+}
+
+double DomainStats::get_mutation_rate(const DomainStats& earlier) const
+{
+    double seconds = std::chrono::duration<double>(time - earlier.time).count();
+    if(seconds <= 0.0 || mutations < earlier.mutations)
+    {
+        return 0.0;
+    }
+    return static_cast<double>(mutations - earlier.mutations) / seconds;
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
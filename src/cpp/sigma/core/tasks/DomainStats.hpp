@@ -0,0 +1,122 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Statistics and memory accounting of the boards of a domain.
+ */
+#ifndef SIGMA_CORE_TASKS_DOMAINSTATS_HPP_
+#define SIGMA_CORE_TASKS_DOMAINSTATS_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include <arcanecore/base/Types.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+/*!
+ * \brief The statistics of a single board.
+ *
+ * The counts and byte totals are maintained as the board changes so they can
+ * be read without visiting the Tasks of the board. Byte totals are
+ * approximate, see RootTask::get_memory_usage() for the full usage of a
+ * board.
+ */
+struct BoardStats
+{
+    //--------------------------------------------------------------------------
+    //                                 ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /// The id of the RootTask of the board, or 0 for the totals of a domain.
+    arc::uint32 board_id;
+    /// The title of the board.
+    arc::str::UTF8String title;
+    /// The number of resident Tasks including the RootTask.
+    std::size_t task_count;
+    /// The number of archived Tasks.
+    std::size_t archived_count;
+    /// The greatest depth of a resident Task.
+    std::size_t max_depth;
+    /// The greatest number of children of a resident Task.
+    std::size_t max_children;
+    /// Whether task_bytes and children_bytes are estimates, which is the case
+    /// unless audited.
+    bool estimated;
+    /// The bytes used by the Task objects. When estimated every Task is
+    /// counted as a plain Task, otherwise the sizes of their types are used.
+    std::size_t task_bytes;
+    /// The bytes used by the titles of the Tasks.
+    std::size_t title_bytes;
+    /// The bytes used by the children vectors of the Tasks. When estimated
+    /// this only counts the children rather than the capacity of the
+    /// vectors.
+    std::size_t children_bytes;
+    /// The bytes used by the callbacks registered with the Tasks.
+    std::size_t callback_bytes;
+    /// The bytes used by the attribute columns and Task maps of the board.
+    std::size_t index_bytes;
+    /// The number of changes recorded for the board since it was created,
+    /// see ChangeFeed.
+    arc::uint64 mutations;
+
+    BoardStats();
+
+    /*!
+     * \brief Returns the total number of bytes accounted for.
+     */
+    std::size_t get_total_bytes() const;
+
+    /*!
+     * \brief Adds the counts and byte totals of the other statistics to these
+     *        statistics, taking the greater of the maximums.
+     *
+     * The totals are estimated if either of the statistics are.
+     */
+    void accumulate(const BoardStats& other);
+};
+
+/*!
+ * \brief The statistics of every board of a domain, see
+ *        TasksDomain::get_stats().
+ */
+struct DomainStats
+{
+    //--------------------------------------------------------------------------
+    //                                 ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /// The statistics of each board in the order the boards were created.
+    std::vector<BoardStats> boards;
+    /// The sum of the statistics of the boards.
+    BoardStats totals;
+    /// The number of changes appended to the domain's feed, including changes
+    /// to boards that have since been deleted.
+    arc::uint64 mutations;
+    /// Whether the statistics were computed by auditing every Task.
+    bool audited;
+    /// When the statistics were computed.
+    std::chrono::steady_clock::time_point time;
+
+    DomainStats();
+
+    /*!
+     * \brief Returns the number of changes per second between the given
+     *        earlier statistics and these statistics.
+     *
+     * Returns 0 if no time has passed.
+     */
+    double get_mutation_rate(const DomainStats& earlier) const;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
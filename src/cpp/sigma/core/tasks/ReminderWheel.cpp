@@ -0,0 +1,390 @@
+#include "sigma/core/tasks/ReminderWheel.hpp"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+#include <arcanecore/base/Exceptions.hpp>
+
+#include "sigma/core/tasks/Task.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+namespace
+{
+
+/*!
+ * \brief Returns the index of the lowest set bit of a non-zero word.
+ */
+inline std::size_t lowest_bit(arc::uint64 word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return static_cast<std::size_t>(__builtin_ctzll(word));
+#endif
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                            PRIVATE STATIC CONSTANTS
+//------------------------------------------------------------------------------
+
+const arc::uint32 ReminderWheel::NONE = 0xFFFFFFFF;
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+ReminderWheel::ReminderWheel(arc::int64 time)
+    :
+    m_time        (time),
+    m_heads       (PENDING_LIST + 1, NONE),
+    m_overflow_min(0)
+{
+    std::fill(&m_occupied[0][0], &m_occupied[0][0] + LEVELS * SLOTS / 64, 0);
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void ReminderWheel::schedule(Task* task, arc::int64 due)
+{
+    if(task == nullptr)
+    {
+        throw arc::ex::ValueError("Cannot schedule a null Task");
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    arc::uint32 index;
+    auto found = m_ids.find(task->get_id());
+    if(found != m_ids.end())
+    {
+        index = found->second;
+        unlink(index);
+    }
+    else
+    {
+        if(!m_free.empty())
+        {
+            index = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            index = static_cast<arc::uint32>(m_entries.size());
+            m_entries.push_back(Entry());
+        }
+        m_ids[task->get_id()] = index;
+    }
+
+    Entry& entry = m_entries[index];
+    entry.task = task;
+    entry.id = task->get_id();
+    entry.due = due;
+    if(due <= m_time)
+    {
+        link(index, PENDING_LIST);
+    }
+    else
+    {
+        place(index);
+    }
+}
+
+bool ReminderWheel::cancel(arc::uint32 id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto found = m_ids.find(id);
+    if(found == m_ids.end())
+    {
+        return false;
+    }
+    unlink(found->second);
+    release(found->second);
+    return true;
+}
+
+bool ReminderWheel::is_scheduled(arc::uint32 id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ids.find(id) != m_ids.end();
+}
+
+arc::int64 ReminderWheel::get_due(arc::uint32 id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto found = m_ids.find(id);
+    if(found == m_ids.end())
+    {
+        arc::str::UTF8String error_message;
+        error_message << "No Task with the id " << id << " is scheduled";
+        throw arc::ex::KeyError(error_message);
+    }
+    return m_entries[found->second].due;
+}
+
+std::size_t ReminderWheel::get_scheduled_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ids.size();
+}
+
+arc::int64 ReminderWheel::get_time() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_time;
+}
+
+std::size_t ReminderWheel::advance(arc::int64 time)
+{
+    std::vector<Entry> due;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if(time < m_time)
+        {
+            return 0;
+        }
+
+        // Tasks that were scheduled in the past are due before the rest
+        while(m_heads[PENDING_LIST] != NONE)
+        {
+            arc::uint32 index = m_heads[PENDING_LIST];
+            due.push_back(m_entries[index]);
+            unlink(index);
+            release(index);
+        }
+        std::stable_sort(
+            due.begin(),
+            due.end(),
+            [](const Entry& a, const Entry& b)
+            {
+                return a.due < b.due;
+            }
+        );
+
+        // jump between the times that have slots to process
+        arc::uint64 target = to_ticks(time);
+        while(to_ticks(m_time) < target && !m_ids.empty())
+        {
+            arc::uint64 next = find_next_ticks(target);
+            m_time = static_cast<arc::int64>(next ^ (1ULL << 63));
+            process(due);
+        }
+        m_time = time;
+    }
+
+    ARC_CONST_FOR_EACH(it, due)
+    {
+        m_due_callback.trigger(it->task, it->due);
+    }
+    return due.size();
+}
+
+void ReminderWheel::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_entries.clear();
+    m_free.clear();
+    m_ids.clear();
+    std::fill(m_heads.begin(), m_heads.end(), NONE);
+    std::fill(&m_occupied[0][0], &m_occupied[0][0] + LEVELS * SLOTS / 64, 0);
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+arc::uint64 ReminderWheel::to_ticks(arc::int64 time)
+{
+    return static_cast<arc::uint64>(time) ^ (1ULL << 63);
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void ReminderWheel::place(arc::uint32 index)
+{
+    arc::uint64 due = to_ticks(m_entries[index].due);
+    arc::uint64 now = to_ticks(m_time);
+
+    // the lowest level whose current rotation contains the due date
+    for(std::size_t level = 0; level < LEVELS; ++level)
+    {
+        std::size_t shift = SLOT_BITS * (level + 1);
+        if((due >> shift) == (now >> shift))
+        {
+            std::size_t slot = (due >> (SLOT_BITS * level)) & (SLOTS - 1);
+            link(index, static_cast<arc::uint32>(level * SLOTS + slot));
+            return;
+        }
+    }
+    if(m_heads[OVERFLOW_LIST] == NONE)
+    {
+        m_overflow_min = due;
+    }
+    link(index, OVERFLOW_LIST);
+}
+
+void ReminderWheel::link(arc::uint32 index, arc::uint32 list)
+{
+    Entry& entry = m_entries[index];
+    entry.list = list;
+    entry.previous = NONE;
+    entry.next = m_heads[list];
+    if(entry.next != NONE)
+    {
+        m_entries[entry.next].previous = index;
+    }
+    m_heads[list] = index;
+
+    if(list == OVERFLOW_LIST)
+    {
+        m_overflow_min = std::min(m_overflow_min, to_ticks(entry.due));
+    }
+    else if(list < OVERFLOW_LIST)
+    {
+        m_occupied[list / SLOTS][(list % SLOTS) / 64] |=
+            1ULL << (list % 64);
+    }
+}
+
+void ReminderWheel::unlink(arc::uint32 index)
+{
+    Entry& entry = m_entries[index];
+    if(entry.previous != NONE)
+    {
+        m_entries[entry.previous].next = entry.next;
+    }
+    else
+    {
+        m_heads[entry.list] = entry.next;
+    }
+    if(entry.next != NONE)
+    {
+        m_entries[entry.next].previous = entry.previous;
+    }
+
+    if(entry.list < OVERFLOW_LIST && m_heads[entry.list] == NONE)
+    {
+        m_occupied[entry.list / SLOTS][(entry.list % SLOTS) / 64] &=
+            ~(1ULL << (entry.list % 64));
+    }
+}
+
+void ReminderWheel::release(arc::uint32 index)
+{
+    m_ids.erase(m_entries[index].id);
+    m_entries[index].task = nullptr;
+    m_free.push_back(index);
+}
+
+arc::uint64 ReminderWheel::find_next_ticks(arc::uint64 limit) const
+{
+    arc::uint64 now = to_ticks(m_time);
+    arc::uint64 next = limit;
+
+    for(std::size_t level = 0; level < LEVELS; ++level)
+    {
+        // the next occupied slot after the current slot of the level
+        std::size_t shift = SLOT_BITS * level;
+        std::size_t slot = ((now >> shift) & (SLOTS - 1)) + 1;
+        while(slot < SLOTS)
+        {
+            arc::uint64 word =
+                m_occupied[level][slot / 64] >> (slot % 64);
+            if(word != 0)
+            {
+                slot += lowest_bit(word);
+                break;
+            }
+            slot = (slot / 64 + 1) * 64;
+        }
+        if(slot < SLOTS)
+        {
+            std::size_t rotation = shift + SLOT_BITS;
+            arc::uint64 start =
+                ((now >> rotation) << rotation) |
+                (static_cast<arc::uint64>(slot) << shift);
+            next = std::min(next, start);
+        }
+    }
+
+    // the overflow list is placed at the start of the rotation of the highest
+    // level that contains the earliest due date
+    if(m_heads[OVERFLOW_LIST] != NONE)
+    {
+        std::size_t rotation = SLOT_BITS * LEVELS;
+        next = std::min(next, (m_overflow_min >> rotation) << rotation);
+    }
+
+    return next;
+}
+
+void ReminderWheel::process(std::vector<Entry>& due)
+{
+    arc::uint64 now = to_ticks(m_time);
+
+    if((now & ((1ULL << (SLOT_BITS * LEVELS)) - 1)) == 0)
+    {
+        arc::uint32 index = m_heads[OVERFLOW_LIST];
+        m_heads[OVERFLOW_LIST] = NONE;
+        m_overflow_min = ~0ULL;
+        while(index != NONE)
+        {
+            arc::uint32 next = m_entries[index].next;
+            place(index);
+            index = next;
+        }
+    }
+
+    // move the Tasks of each slot starting now down to the levels below
+    for(std::size_t level = LEVELS - 1; level > 0; --level)
+    {
+        std::size_t shift = SLOT_BITS * level;
+        if((now & ((1ULL << shift) - 1)) != 0)
+        {
+            continue;
+        }
+        arc::uint32 list = static_cast<arc::uint32>(
+                level * SLOTS + ((now >> shift) & (SLOTS - 1)));
+        arc::uint32 index = m_heads[list];
+        while(index != NONE)
+        {
+            arc::uint32 next = m_entries[index].next;
+            unlink(index);
+            place(index);
+            index = next;
+        }
+    }
+
+    arc::uint32 list = static_cast<arc::uint32>(now & (SLOTS - 1));
+    while(m_heads[list] != NONE)
+    {
+        arc::uint32 index = m_heads[list];
+        due.push_back(m_entries[index]);
+        unlink(index);
+        release(index);
+    }
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
@@ -0,0 +1,311 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Schedules the due dates of Tasks.
+ */
+#ifndef SIGMA_CORE_TASKS_REMINDERWHEEL_HPP_
+#define SIGMA_CORE_TASKS_REMINDERWHEEL_HPP_
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+
+#include "sigma/core/Callback.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class Task;
+
+/*!
+ * \brief Fires an event for each scheduled Task once the current time reaches
+ *        its due date.
+ *
+ * Times are in seconds since the Unix epoch, the same as Task due dates. The
+ * wheel doesn't read the clock itself, instead the owner of the wheel calls
+ * advance() with the current time, for example from a periodic timer, and
+ * on_due() is fired for every Task that became due since the previous call.
+ *
+ * The Tasks are held in a hierarchical timer wheel: four levels of 256 slots,
+ * where each slot of a level covers the whole of the level below it. A Task is
+ * placed in the lowest level whose current rotation contains its due date, and
+ * is moved down a level each time the time reaches the start of its slot.
+ * Scheduling and cancelling are constant time, and advancing only visits the
+ * slots that contain Tasks rather than every Task or every second. Due dates
+ * more than 2^32 seconds away are kept in an overflow list.
+ *
+ * The wheel of each domain is accessed through
+ * TasksDomain::get_reminders(), which schedules Tasks that have a due date and
+ * aren't done, and cancels Tasks when they are destroyed.
+ *
+ * \note Tasks that are archived (see Task::archive()) are destroyed, so their
+ *       reminders are cancelled until they are rehydrated.
+ *
+ * \par Thread Safety
+ *
+ * All functions of the wheel are synchronised by a mutex of the wheel, and
+ * on_due() is fired after the mutex has been released so callbacks may
+ * schedule and cancel Tasks.
+ */
+class ReminderWheel
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(ReminderWheel);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new wheel with no scheduled Tasks, at the given time.
+     */
+    explicit ReminderWheel(arc::int64 time = 0);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Schedules on_due() to be fired for the given Task at the given
+     *        time, replacing any time the Task was already scheduled for.
+     *
+     * If the time has already been reached the Task is fired by the next call
+     * to advance().
+     *
+     * \throws arc::ex::ValueError If the Task is null.
+     */
+    void schedule(Task* task, arc::int64 due);
+
+    /*!
+     * \brief Removes the Task with the given id from the wheel.
+     *
+     * \return False if the Task was not scheduled.
+     */
+    bool cancel(arc::uint32 id);
+
+    /*!
+     * \brief Returns whether the Task with the given id is scheduled.
+     */
+    bool is_scheduled(arc::uint32 id) const;
+
+    /*!
+     * \brief Returns the time the Task with the given id is scheduled for.
+     *
+     * \throws arc::ex::KeyError If the Task is not scheduled.
+     */
+    arc::int64 get_due(arc::uint32 id) const;
+
+    /*!
+     * \brief Returns the number of scheduled Tasks.
+     */
+    std::size_t get_scheduled_count() const;
+
+    /*!
+     * \brief Returns the time the wheel has been advanced to.
+     */
+    arc::int64 get_time() const;
+
+    /*!
+     * \brief Moves the wheel forward to the given time, firing on_due() for
+     *        every scheduled Task with a due date at or before the time.
+     *
+     * The Tasks are removed from the wheel and fired in order of their due
+     * dates. Nothing happens if the time is before the current time of the
+     * wheel.
+     *
+     * \return The number of Tasks that were fired.
+     */
+    std::size_t advance(arc::int64 time);
+
+    /*!
+     * \brief Removes all scheduled Tasks.
+     */
+    void clear();
+
+    //--------------------------------------------------------------------------
+    //                              CALLBACK EVENTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief For registering callbacks that handle when a Task becomes due.
+     *
+     * Relevant callback functions take two arguments:
+     * - ``Task*`` - the Task that is due.
+     * - ``arc::int64`` - the time the Task was scheduled for.
+     */
+    sigma::core::CallbackInterface<Task*, arc::int64>* on_due()
+    {
+        return &m_due_callback.get_interface();
+    }
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE STATIC CONSTANTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The number of levels of the wheel.
+     */
+    static const std::size_t LEVELS = 4;
+    /*!
+     * \brief The number of bits of time covered by each slot of a level.
+     */
+    static const std::size_t SLOT_BITS = 8;
+    /*!
+     * \brief The number of slots of each level.
+     */
+    static const std::size_t SLOTS = 1 << SLOT_BITS;
+    /*!
+     * \brief The index of the overflow list in m_heads.
+     */
+    static const std::size_t OVERFLOW_LIST = LEVELS * SLOTS;
+    /*!
+     * \brief The index of the list in m_heads of Tasks that were scheduled for
+     *        a time that has already been reached.
+     */
+    static const std::size_t PENDING_LIST = OVERFLOW_LIST + 1;
+    /*!
+     * \brief Index used for the end of a list of entries.
+     */
+    static const arc::uint32 NONE;
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A scheduled Task, entries are linked into the list of the slot
+     *        they are in.
+     */
+    struct Entry
+    {
+        /// The scheduled Task, or null if the entry is free.
+        Task* task;
+        /// The id of the Task.
+        arc::uint32 id;
+        /// The time the Task is due.
+        arc::int64 due;
+        /// The list in m_heads the entry is in.
+        arc::uint32 list;
+        /// The previous and next entries of the list.
+        arc::uint32 previous;
+        arc::uint32 next;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Synchronises access to the wheel.
+     */
+    mutable std::mutex m_mutex;
+    /*!
+     * \brief The time the wheel has been advanced to, every Task due at or
+     *        before this time has been fired.
+     */
+    arc::int64 m_time;
+    /*!
+     * \brief The scheduled Tasks, and free entries for reuse.
+     */
+    std::vector<Entry> m_entries;
+    /*!
+     * \brief The indices of the free entries.
+     */
+    std::vector<arc::uint32> m_free;
+    /*!
+     * \brief The entries of the scheduled Tasks mapped from the Task ids.
+     */
+    std::unordered_map<arc::uint32, arc::uint32> m_ids;
+    /*!
+     * \brief The first entry of the list of each slot of each level, followed
+     *        by the overflow and pending lists.
+     */
+    std::vector<arc::uint32> m_heads;
+    /*!
+     * \brief A bit for each slot of each level which is set if the slot's list
+     *        isn't empty.
+     */
+    arc::uint64 m_occupied[LEVELS][SLOTS / 64];
+    /*!
+     * \brief A lower bound on the due dates of the overflow list in ticks (see
+     *        to_ticks()), so that rotations of the highest level without any
+     *        due Tasks can be skipped.
+     */
+    arc::uint64 m_overflow_min;
+
+    // callback handler
+    sigma::core::CallbackHandler<Task*, arc::int64> m_due_callback;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Maps a time to an unsigned value with the same ordering, so that
+     *        times before the epoch can be split into slots.
+     */
+    static arc::uint64 to_ticks(arc::int64 time);
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Adds the given entry to the list of the slot its due date belongs
+     *        to at the current time.
+     */
+    void place(arc::uint32 index);
+
+    /*!
+     * \brief Adds the given entry to the front of the given list.
+     */
+    void link(arc::uint32 index, arc::uint32 list);
+
+    /*!
+     * \brief Removes the given entry from the list it's in.
+     */
+    void unlink(arc::uint32 index);
+
+    /*!
+     * \brief Removes the given entry from the wheel and returns it to the free
+     *        entries.
+     */
+    void release(arc::uint32 index);
+
+    /*!
+     * \brief Returns the next time after the current time at which a slot
+     *        needs to be processed, or the given limit if there is no such
+     *        time before it.
+     */
+    arc::uint64 find_next_ticks(arc::uint64 limit) const;
+
+    /*!
+     * \brief Moves the Tasks of the slots that start at the current time down
+     *        the wheel, and removes the Tasks that are due at the current
+     *        time, appending them to the given vector.
+     */
+    void process(std::vector<Entry>& due);
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
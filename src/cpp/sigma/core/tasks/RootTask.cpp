@@ -1,5 +1,10 @@
 #include "sigma/core/tasks/RootTask.hpp"
 
+#include <algorithm>
+#include <unordered_set>
+
+#include "sigma/core/tasks/TaskSerialiser.hpp"
+
 namespace sigma
 {
 namespace core
@@ -7,6 +12,65 @@ namespace core
 namespace tasks
 {
 
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Returns the approximate number of bytes used by the buckets and nodes
+ *        of the given map.
+ */
+template<typename Map>
+std::size_t get_map_usage(const Map& map)
+{
+    return map.bucket_count() * sizeof(void*) +
+           map.size() * (sizeof(typename Map::value_type) + sizeof(void*));
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                   DESTRUCTOR
+//------------------------------------------------------------------------------
+
+RootTask::~RootTask()
+{
+    // the children must be destroyed while the board lock still exists
+    sigma::core::util::ScopedWriteLock lock(m_lock);
+
+    // the destruction of the board is not recorded, and the feed only records
+    // the deletion of the board rather than each of its Tasks
+    ++m_history.m_suspended;
+    m_history.clear();
+    record_change(ChangeRecord::BOARD_DELETED);
+    ++m_suspended_changes;
+
+    // children don't need to remove themselves from a board that is being
+    // destroyed
+    m_destroying = true;
+    if(is_archived())
+    {
+        std::vector<arc::uint32> ids;
+        get_archived_ids(ids);
+        ARC_CONST_FOR_EACH(it, ids)
+        {
+            m_domain->handle_task_destroyed(*it);
+        }
+    }
+    std::vector<Task*> children_copy(m_children);
+    ARC_FOR_EACH(it, children_copy)
+    {
+        delete *it;
+    }
+    m_children.clear();
+
+    // fire callback
+    m_domain->m_destroyed_callback.trigger(this);
+}
+
 //------------------------------------------------------------------------------
 //                            PUBLIC MEMBER FUNCTIONS
 //------------------------------------------------------------------------------
@@ -16,6 +80,234 @@ bool RootTask::is_root() const
     return true;
 }
 
+TasksDomain* RootTask::get_domain() const
+{
+    return m_domain;
+}
+
+sigma::core::util::ReadWriteLock& RootTask::get_lock() const
+{
+    return m_lock;
+}
+
+TaskSnapshot::Ptr RootTask::snapshot() const
+{
+    // fast path: the board hasn't changed since the last snapshot
+    TaskSnapshot::Ptr current(std::atomic_load(&m_snapshot));
+    if(current)
+    {
+        return current;
+    }
+
+    // writers are excluded while the modified tasks are copied
+    sigma::core::util::ScopedReadLock lock(m_lock);
+    std::lock_guard<std::mutex> build_lock(m_snapshot_mutex);
+    return build_snapshot();
+}
+
+Task* RootTask::find_task(arc::uint32 id) const
+{
+    {
+        sigma::core::util::ScopedReadLock lock(m_lock);
+        std::unordered_map<arc::uint32, Task*>::const_iterator task =
+            m_tasks.find(id);
+        if(task != m_tasks.end())
+        {
+            return task->second;
+        }
+
+        if(m_archived.find(id) == m_archived.end())
+        {
+            return nullptr;
+        }
+    }
+
+    // rehydrate the Task if it's archived, the read lock is released first
+    // and the Task may have been rehydrated or deleted by another thread
+    // since, which rehydrate_task() handles
+    sigma::core::util::ScopedWriteLock lock(m_lock);
+    RootTask* self = const_cast<RootTask*>(this);
+    Task* found = self->rehydrate_task(id);
+    if(found != nullptr)
+    {
+        self->enforce_resident_budget(std::vector<const Task*>(1, found));
+    }
+    return found;
+}
+
+std::size_t RootTask::get_archived_count() const
+{
+    sigma::core::util::ScopedReadLock lock(m_lock);
+    return m_archived.size();
+}
+
+void RootTask::rehydrate_all()
+{
+    sigma::core::util::ScopedWriteLock lock(m_lock);
+    while(!m_archived.empty())
+    {
+        m_archived.begin()->second->rehydrate_internal();
+    }
+}
+
+std::size_t RootTask::get_resident_count() const
+{
+    sigma::core::util::ScopedReadLock lock(m_lock);
+    return m_tasks.size();
+}
+
+std::size_t RootTask::get_resident_budget() const
+{
+    return m_resident_budget;
+}
+
+void RootTask::set_resident_budget(std::size_t budget)
+{
+    sigma::core::util::ScopedWriteLock lock(m_lock);
+    m_resident_budget = budget;
+    enforce_resident_budget(std::vector<const Task*>());
+}
+
+std::size_t RootTask::get_memory_usage() const
+{
+    sigma::core::util::ScopedReadLock lock(m_lock);
+    std::lock_guard<std::recursive_mutex> loaded_lock(m_loaded_mutex);
+
+    std::size_t usage = m_attributes.get_memory_usage();
+    usage += get_map_usage(m_tasks);
+    usage += get_map_usage(m_archived);
+    usage += get_map_usage(m_loaded_positions);
+    ARC_CONST_FOR_EACH(it, m_tasks)
+    {
+        const Task* task = it->second;
+        usage += sizeof(Task);
+        usage += task->m_children.capacity() * sizeof(Task*);
+        usage += task->m_archive.capacity();
+        usage += task->m_ancestors.capacity() * sizeof(Task*);
+        usage += task->m_collation_key.capacity();
+    }
+    return usage;
+}
+
+std::size_t RootTask::compact()
+{
+    sigma::core::util::ScopedWriteLock lock(m_lock);
+    std::lock_guard<std::recursive_mutex> loaded_lock(m_loaded_mutex);
+    std::size_t before = get_memory_usage();
+
+    // the Task objects stay where they are, since they are created and
+    // deleted by callers with new and delete, and their addresses are held
+    // by callers, callback owners, query results and the indices of the
+    // domain, so the depth-first order can only be applied to the attribute
+    // rows
+
+    // shrink each Task while collecting the depth-first order of the
+    // attribute rows, archived Tasks have no resident children to visit
+    std::vector<Task*> order;
+    order.reserve(m_tasks.size());
+    std::vector<Task*> stack(1, this);
+    while(!stack.empty())
+    {
+        Task* task = stack.back();
+        stack.pop_back();
+        order.push_back(task);
+
+        std::vector<Task*>(task->m_children).swap(task->m_children);
+        std::vector<arc::uint8>(task->m_archive).swap(task->m_archive);
+        task->m_ancestors.shrink_to_fit();
+        task->m_collation_key.shrink_to_fit();
+
+        stack.insert(
+                stack.end(),
+                task->m_children.rbegin(),
+                task->m_children.rend()
+        );
+    }
+    m_attributes.reorder(order);
+
+    m_tasks.rehash(0);
+    m_archived.rehash(0);
+    m_loaded_positions.rehash(0);
+
+    std::size_t after = get_memory_usage();
+    return before > after ? before - after : 0;
+}
+
+void RootTask::find_tasks(
+        const TaskFilter& filter,
+        std::vector<Task*>& out) const
+{
+    std::size_t first = out.size();
+    std::vector<arc::uint32> archived;
+    {
+        sigma::core::util::ScopedReadLock lock(m_lock);
+        check_filter(filter);
+        m_attributes.select(filter, out);
+        select_archived(filter, archived);
+    }
+    if(archived.empty())
+    {
+        return;
+    }
+
+    // only the matching archived Tasks are rehydrated, any that have since
+    // been rehydrated or deleted by another thread are found or skipped
+    sigma::core::util::ScopedWriteLock lock(m_lock);
+    RootTask* self = const_cast<RootTask*>(this);
+    ARC_CONST_FOR_EACH(it, archived)
+    {
+        Task* task = self->rehydrate_task(*it);
+        if(task != nullptr)
+        {
+            out.push_back(task);
+        }
+    }
+    // none of the found Tasks may be archived again
+    self->enforce_resident_budget(
+            std::vector<const Task*>(out.begin() + first, out.end()));
+}
+
+std::size_t RootTask::count_tasks(const TaskFilter& filter) const
+{
+    sigma::core::util::ScopedReadLock lock(m_lock);
+    check_filter(filter);
+    std::vector<arc::uint32> archived;
+    select_archived(filter, archived);
+    return m_attributes.count(filter) + archived.size();
+}
+
+void RootTask::find_common_ancestors(
+        const std::vector<std::pair<const Task*, const Task*>>& pairs,
+        std::vector<Task*>& out) const
+{
+    ARC_CONST_FOR_EACH(it, pairs)
+    {
+        if(it->first == nullptr            ||
+           it->second == nullptr           ||
+           it->first->get_board() != this  ||
+           it->second->get_board() != this)
+        {
+            throw arc::ex::ValueError(
+                    "Common ancestors can only be found for Tasks of this "
+                    "board"
+            );
+        }
+    }
+
+    sigma::core::util::ScopedReadLock lock(m_lock);
+    std::lock_guard<std::mutex> ancestry_lock(m_ancestry_mutex);
+    out.reserve(out.size() + pairs.size());
+    ARC_CONST_FOR_EACH(it, pairs)
+    {
+        out.push_back(it->first->find_common_ancestor_internal(it->second));
+    }
+}
+
+TaskHistory& RootTask::get_history()
+{
+    return m_history;
+}
+
 void RootTask::set_parent(Task* const parent)
 {
     throw arc::ex::IllegalActionError("");
@@ -23,33 +315,391 @@ void RootTask::set_parent(Task* const parent)
 
 void RootTask::set_title(const arc::str::UTF8String& title)
 {
-    // ensure this is a unique title using the resolver
+    // the title must be resolved and assigned atomically with respect to other
+    // boards, the domain is locked before the board like everywhere else that
+    // takes both
+    std::lock_guard<std::recursive_mutex> domain_lock(m_domain->m_mutex);
+    sigma::core::util::ScopedWriteLock lock(m_lock);
+    // a board that is being deleted has already left the index
+    if(m_closed)
+    {
+        Task::set_title(title);
+        return;
+    }
+    BoardTitleIndex& titles = m_domain->m_boards.get_titles();
+
+    // ensure this is a unique title using the domain's title index
     arc::str::UTF8String resolved;
-    // only use the resolver if the title has changed
+    // only resolve the title if it has changed
     if(title == m_title)
     {
         resolved = title;
     }
     else
     {
-        m_title_resolver(title, resolved);
+        titles.resolve(title, resolved);
     }
 
     // super call
+    arc::str::UTF8String old_title(m_title);
     Task::set_title(resolved);
+
+    // the title is only reindexed once it has been successfully assigned
+    titles.remove(old_title, this);
+    titles.insert(m_title, this);
+}
+
+BoardStats RootTask::get_stats() const
+{
+    sigma::core::util::ScopedReadLock lock(m_lock);
+    std::lock_guard<std::recursive_mutex> loaded_lock(m_loaded_mutex);
+
+    // the counts always hold the RootTask
+    BoardStats stats;
+    stats.board_id       = get_id();
+    stats.title          = m_title;
+    stats.task_count     = m_tasks.size();
+    stats.archived_count = m_archived.size();
+    stats.max_depth      = m_depth_counts.rbegin()->first;
+    stats.max_children   = m_children_counts.rbegin()->first;
+    stats.estimated      = true;
+    stats.task_bytes     =
+        sizeof(RootTask) + (m_tasks.size() - 1) * sizeof(Task);
+    stats.title_bytes    = m_title_bytes;
+    // every Task other than the root is the child of one Task
+    stats.children_bytes = (m_tasks.size() - 1) * sizeof(Task*);
+    stats.callback_bytes = m_callback_bytes;
+    stats.index_bytes    =
+        m_attributes.get_memory_usage() +
+        get_map_usage(m_tasks) +
+        get_map_usage(m_archived) +
+        get_map_usage(m_loaded_positions);
+    stats.mutations      = m_mutation_count;
+    return stats;
+}
+
+BoardStats RootTask::audit_stats()
+{
+    sigma::core::util::ScopedWriteLock lock(m_lock);
+    std::lock_guard<std::recursive_mutex> loaded_lock(m_loaded_mutex);
+
+    BoardStats stats(get_stats());
+    stats.task_count = 0;
+    stats.max_depth = 0;
+    stats.max_children = 0;
+    stats.estimated = false;
+    stats.title_bytes = 0;
+    stats.children_bytes = 0;
+    stats.callback_bytes = 0;
+
+    std::vector<std::pair<const Task*, std::size_t>> stack;
+    stack.push_back(std::make_pair(this, 0));
+    while(!stack.empty())
+    {
+        const Task* task = stack.back().first;
+        std::size_t depth = stack.back().second;
+        stack.pop_back();
+
+        ++stats.task_count;
+        stats.max_depth = std::max(stats.max_depth, depth);
+        stats.max_children =
+            std::max(stats.max_children, task->m_children.size());
+        stats.title_bytes += task->m_title.get_byte_length();
+        stats.children_bytes += task->m_children.capacity() * sizeof(Task*);
+        stats.callback_bytes += task->get_callback_usage();
+
+        ARC_CONST_FOR_EACH(child, task->m_children)
+        {
+            stack.push_back(std::make_pair(*child, depth + 1));
+        }
+    }
+    return stats;
 }
 
 //------------------------------------------------------------------------------
 //                              PRIVATE CONSTRUCTOR
 //------------------------------------------------------------------------------
 
-RootTask::RootTask(
-        const arc::str::UTF8String& title,
-        TitleResolver_t title_resolver)
+RootTask::RootTask(const arc::str::UTF8String& title, TasksDomain* domain)
     :
-    Task            (title),
-    m_title_resolver(title_resolver)
+    Task               (title, domain->allocate_id()),
+    m_domain           (domain),
+    m_ancestry_epoch   (domain->allocate_ancestry_epoch()),
+    m_resident_budget  (0),
+    m_history          (this),
+    m_suspended_changes(0),
+    m_archiving        (false),
+    m_title_bytes      (0),
+    m_callback_bytes   (0),
+    m_mutation_count   (0),
+    m_shard            (0),
+    m_closed           (false)
+{
+    m_board = this;
+    register_task(this);
+    record_change(ChangeRecord::BOARD_CREATED);
+
+    // fire callback
+    m_domain->m_created_callback.trigger(this);
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void RootTask::register_task(Task* task)
 {
+    m_tasks[task->get_id()] = task;
+    m_attributes.insert(task);
+    m_title_bytes += task->m_title.get_byte_length();
+    count_depth(task->get_depth(), 1);
+    count_children(task->m_children.size(), 1);
+    m_callback_bytes += task->get_callback_usage();
+}
+
+void RootTask::unregister_task(Task* task)
+{
+    m_tasks.erase(task->get_id());
+    m_attributes.remove(task);
+    m_title_bytes -= task->m_title.get_byte_length();
+    count_depth(task->get_depth(), -1);
+    count_children(task->m_children.size(), -1);
+    m_callback_bytes -= task->get_callback_usage();
+}
+
+void RootTask::count_depth(std::size_t depth, std::ptrdiff_t count)
+{
+    std::size_t& total = m_depth_counts[depth];
+    // negative counts wrap around to subtract
+    total += static_cast<std::size_t>(count);
+    if(total == 0)
+    {
+        m_depth_counts.erase(depth);
+    }
+}
+
+void RootTask::count_children(std::size_t children, std::ptrdiff_t count)
+{
+    std::size_t& total = m_children_counts[children];
+    // negative counts wrap around to subtract
+    total += static_cast<std::size_t>(count);
+    if(total == 0)
+    {
+        m_children_counts.erase(children);
+    }
+}
+
+void RootTask::count_subtree(const Task* task, std::size_t depth, int sign)
+{
+    std::vector<std::pair<const Task*, std::size_t>> stack;
+    stack.push_back(std::make_pair(task, depth));
+    while(!stack.empty())
+    {
+        const Task* current = stack.back().first;
+        std::size_t current_depth = stack.back().second;
+        stack.pop_back();
+
+        count_depth(current_depth, sign);
+        count_children(current->m_children.size(), sign);
+        if(sign > 0)
+        {
+            m_callback_bytes += current->get_callback_usage();
+        }
+        else
+        {
+            m_callback_bytes -= current->get_callback_usage();
+        }
+
+        ARC_CONST_FOR_EACH(child, current->m_children)
+        {
+            stack.push_back(std::make_pair(*child, current_depth + 1));
+        }
+    }
+}
+
+void RootTask::transfer_tasks(
+        const std::vector<Task*>& subtree,
+        RootTask* target)
+{
+    m_attributes.transfer(subtree, target->m_attributes);
+    target->m_tasks.reserve(target->m_tasks.size() + subtree.size());
+
+    std::vector<arc::uint32> archived_ids;
+    ARC_CONST_FOR_EACH(it, subtree)
+    {
+        Task* task = *it;
+        m_tasks.erase(task->get_id());
+        target->m_tasks[task->get_id()] = task;
+        std::size_t title_bytes = task->m_title.get_byte_length();
+        m_title_bytes -= title_bytes;
+        target->m_title_bytes += title_bytes;
+
+        if(forget_loaded(task))
+        {
+            target->mark_loaded(task);
+        }
+        if(task->is_archived())
+        {
+            archived_ids.clear();
+            task->get_archived_ids(archived_ids);
+            ARC_CONST_FOR_EACH(id, archived_ids)
+            {
+                m_archived.erase(*id);
+                target->m_archived[*id] = task;
+            }
+        }
+        task->m_board = target;
+    }
+}
+
+void RootTask::mark_loaded(Task* task)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_loaded_mutex);
+    forget_loaded(task);
+    m_loaded.push_front(task);
+    m_loaded_positions[task] = m_loaded.begin();
+}
+
+void RootTask::touch_loaded(const Task* task)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_loaded_mutex);
+    for(; task != nullptr; task = task->m_parent)
+    {
+        std::unordered_map<const Task*, std::list<Task*>::iterator>::iterator
+            position = m_loaded_positions.find(task);
+        if(position != m_loaded_positions.end())
+        {
+            m_loaded.splice(m_loaded.begin(), m_loaded, position->second);
+        }
+    }
+}
+
+bool RootTask::forget_loaded(const Task* task)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_loaded_mutex);
+    std::unordered_map<const Task*, std::list<Task*>::iterator>::iterator
+        position = m_loaded_positions.find(task);
+    if(position == m_loaded_positions.end())
+    {
+        return false;
+    }
+    m_loaded.erase(position->second);
+    m_loaded_positions.erase(position);
+    return true;
+}
+
+void RootTask::enforce_resident_budget(
+        const std::vector<const Task*>& in_use)
+{
+    if(m_resident_budget == 0 || m_tasks.size() <= m_resident_budget)
+    {
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(m_loaded_mutex);
+
+    std::unordered_set<const Task*> protected_tasks;
+    protected_tasks.insert(this);
+    ARC_CONST_FOR_EACH(it, in_use)
+    {
+        const Task* task = *it;
+        while(task != nullptr && protected_tasks.insert(task).second)
+        {
+            task = task->m_parent;
+        }
+    }
+
+    // walk from the least recently used Task, archiving a Task forgets it
+    // and any loaded descendants it destroys. The Tasks already passed over
+    // are protected, so none of them are descendants of the archived Task
+    // and the next one remains valid to continue from.
+    std::list<Task*>::iterator next = m_loaded.end();
+    while(m_tasks.size() > m_resident_budget && next != m_loaded.begin())
+    {
+        std::list<Task*>::iterator it = next;
+        --it;
+        if(protected_tasks.find(*it) != protected_tasks.end())
+        {
+            next = it;
+            continue;
+        }
+        (*it)->archive_internal();
+    }
+}
+
+void RootTask::check_filter(const TaskFilter& filter) const
+{
+    if(filter.get_ancestor() != nullptr &&
+       filter.get_ancestor()->get_board() != this)
+    {
+        throw arc::ex::ValueError(
+                "Cannot filter by the descendants of a Task on another board");
+    }
+}
+
+void RootTask::select_archived(
+        const TaskFilter& filter,
+        std::vector<arc::uint32>& out) const
+{
+    if(m_archived.empty())
+    {
+        return;
+    }
+
+    // each archive is decoded once, by the Task that holds it
+    std::unordered_set<const Task*> holders;
+    ARC_CONST_FOR_EACH(it, m_archived)
+    {
+        holders.insert(it->second);
+    }
+
+    const Task* ancestor = filter.get_ancestor();
+    ARC_CONST_FOR_EACH(holder, holders)
+    {
+        // the archived Tasks are below the ancestor if their holder is
+        const Task* current = *holder;
+        while(ancestor != nullptr && current != nullptr && current != ancestor)
+        {
+            current = current->m_parent;
+        }
+        if(current == nullptr)
+        {
+            continue;
+        }
+
+        const std::vector<arc::uint8>& archive = (*holder)->m_archive;
+        const arc::uint8* data = &archive[0];
+        const arc::uint8* end = data + archive.size();
+        TaskSerialiser::select(
+                data,
+                end,
+                TaskSerialiser::read_uint(data, end),
+                filter,
+                out
+        );
+    }
+}
+
+Task* RootTask::rehydrate_task(arc::uint32 id)
+{
+    // one level is rehydrated at a time so this continues until the Task
+    // itself has been created
+    while(true)
+    {
+        std::unordered_map<arc::uint32, Task*>::const_iterator task =
+            m_tasks.find(id);
+        if(task != m_tasks.end())
+        {
+            return task->second;
+        }
+        std::unordered_map<arc::uint32, Task*>::const_iterator archived =
+            m_archived.find(id);
+        if(archived == m_archived.end())
+        {
+            return nullptr;
+        }
+        archived->second->rehydrate_internal();
+    }
 }
 
 } // namespace tasks
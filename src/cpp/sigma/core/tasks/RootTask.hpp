@@ -5,8 +5,21 @@
 #ifndef SIGMA_CORE_TASKS_ROOTTASK_HPP_
 #define SIGMA_CORE_TASKS_ROOTTASK_HPP_
 
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sigma/core/tasks/AttributeTable.hpp"
+#include "sigma/core/tasks/DomainStats.hpp"
 #include "sigma/core/tasks/Task.hpp"
+#include "sigma/core/tasks/TaskFilter.hpp"
+#include "sigma/core/tasks/TaskHistory.hpp"
 #include "sigma/core/tasks/TasksDomain.hpp"
+#include "sigma/core/util/ReadWriteLock.hpp"
 
 namespace sigma
 {
@@ -15,10 +28,6 @@ namespace core
 namespace tasks
 {
 
-typedef void (*TitleResolver_t)(
-        const arc::str::UTF8String&,
-        arc::str::UTF8String&);
-
 /*!
  * \brief TODO
  *
@@ -27,16 +36,209 @@ typedef void (*TitleResolver_t)(
 class RootTask : public Task
 {
 
-    friend RootTask* domain::new_board(const arc::str::UTF8String&);
+    friend class BoardFile;
+    friend class Task;
+    friend class TaskQuery;
+    friend class TasksDomain;
 
 public:
 
+    //--------------------------------------------------------------------------
+    //                                 DESTRUCTOR
+    //--------------------------------------------------------------------------
+
+    virtual ~RootTask();
+
     //--------------------------------------------------------------------------
     //                          PUBLIC MEMBER FUNCTIONS
     //--------------------------------------------------------------------------
 
     virtual bool is_root() const;
 
+    /*!
+     * \brief Returns the domain this board belongs to.
+     */
+    TasksDomain* get_domain() const;
+
+    /*!
+     * \brief Returns the lock that synchronises access to this board.
+     *
+     * Task functions that modify the board acquire the write lock internally.
+     * Readers that may run concurrently with modifications should hold a
+     * sigma::core::util::ScopedReadLock on this lock while they read. Readers
+     * never block other readers.
+     */
+    sigma::core::util::ReadWriteLock& get_lock() const;
+
+    /*!
+     * \brief Returns an immutable snapshot of this board as it currently is.
+     *
+     * If the board has not been modified since the last snapshot was taken
+     * this returns the existing snapshot without taking any locks. Otherwise
+     * the snapshot is rebuilt under the read lock of the board, so this
+     * waits for any writer to finish. Only the Tasks that have been modified
+     * (and their ancestors) are copied, all other Tasks share their snapshots
+     * with previous versions of the board.
+     *
+     * Each copied Task copies its list of child snapshots, so rebuilding
+     * costs time and memory proportional to the number of children of the
+     * copied Tasks rather than to the number of modified Tasks. For example a
+     * single change to a board with 100k top-level Tasks copies all 100k
+     * child pointers of the board's snapshot.
+     *
+     * The returned snapshot can be read from any thread without locking and
+     * will never change.
+     */
+    TaskSnapshot::Ptr snapshot() const;
+
+    /*!
+     * \brief Returns the Task on this board with the given id.
+     *
+     * The Task is looked up under the read lock of the board. If the Task is
+     * archived (see Task::archive()) the archive that contains it is
+     * rehydrated under the write lock.
+     *
+     * \return The Task with the id, or null if there is no such Task on this
+     *         board.
+     *
+     * \throws arc::ex::StateError If the Task is archived and the calling
+     *                             thread holds a read lock on this board.
+     */
+    Task* find_task(arc::uint32 id) const;
+
+    /*!
+     * \brief Returns the number of Tasks on this board that are archived.
+     */
+    std::size_t get_archived_count() const;
+
+    /*!
+     * \brief Returns the number of Tasks on this board that are not archived,
+     *        including this RootTask.
+     */
+    std::size_t get_resident_count() const;
+
+    /*!
+     * \brief Returns the number of resident Tasks this board aims to keep
+     *        within, or 0 if there is no limit.
+     */
+    std::size_t get_resident_budget() const;
+
+    /*!
+     * \brief Sets the number of resident Tasks this board aims to keep within,
+     *        0 removes the limit.
+     *
+     * Whenever archived Tasks are rehydrated on demand (see Task::archive()),
+     * by navigation or by a search, and the board has more resident Tasks
+     * than the budget, the Tasks whose children were rehydrated least
+     * recently are archived again until the board is within the budget.
+     * Accessing the children of a Task with Task::get_children() counts as
+     * using the Task and its ancestors. The Tasks being rehydrated or
+     * returned by the search and their ancestors are never archived, so the
+     * board may stay above a small budget.
+     *
+     * Archiving again keeps the dependencies and tags of the Tasks, but any
+     * pointers to them that were held other than those just returned become
+     * invalid. So no budget should be set while such pointers are held.
+     */
+    void set_resident_budget(std::size_t budget);
+
+    /*!
+     * \brief Returns the approximate number of bytes used by the resident
+     *        Tasks of this board, their hierarchy, their attributes and the
+     *        indices of the board.
+     *
+     * Titles and the undo/redo history of the board are not included.
+     */
+    std::size_t get_memory_usage() const;
+
+    /*!
+     * \brief Releases the spare capacity this board has accumulated.
+     *
+     * After heavy editing the vectors that hold the children of each Task and
+     * the indices of the board keep their peak capacity. This shrinks them to
+     * their current size and rehashes the maps of the board. The rows of the
+     * attribute columns are also reordered depth-first, so a Task's
+     * attributes are next to those of its neighbours. The Tasks themselves
+     * and their children vectors are not relocated, since Tasks are
+     * referenced by pointer and each vector is allocated separately.
+     *
+     * The write lock of the board is held while compacting, so this can be
+     * called from a background thread or when the application is idle. The
+     * contents of the board don't change and nothing is recorded in its
+     * history.
+     *
+     * \return The number of bytes reclaimed, as measured by
+     *         get_memory_usage().
+     */
+    std::size_t compact();
+
+    /*!
+     * \brief Returns the statistics of this board.
+     *
+     * The statistics are read from counters that are updated as Tasks are
+     * added, removed and moved and as callbacks are registered, so this
+     * doesn't visit the Tasks of the board. See BoardStats for which
+     * statistics are estimated.
+     */
+    BoardStats get_stats() const;
+
+    /*!
+     * \brief Returns the exact statistics of this board by visiting every
+     *        resident Task.
+     *
+     * The write lock of the board is held while auditing.
+     */
+    BoardStats audit_stats();
+
+    /*!
+     * \brief Appends the Tasks of this board that match the given filter to the
+     *        given vector.
+     *
+     * The filter is evaluated as a sequence of passes over the columns of
+     * the board's attributes, rather than by visiting each Task. The Tasks
+     * are appended in no particular order. Archived Tasks (see
+     * Task::archive()) are matched against the attributes in their archives
+     * and only the archived Tasks that match are rehydrated.
+     *
+     * \throws arc::ex::ValueError If the filter is restricted to the
+     *                             descendants of a Task on a different board.
+     */
+    void find_tasks(const TaskFilter& filter, std::vector<Task*>& out) const;
+
+    /*!
+     * \brief Returns the number of Tasks of this board that match the given
+     *        filter.
+     *
+     * Archived Tasks are counted from their archives without rehydrating
+     * them, so only the read lock of the board is taken.
+     *
+     * \throws arc::ex::ValueError If the filter is restricted to the
+     *                             descendants of a Task on a different board.
+     */
+    std::size_t count_tasks(const TaskFilter& filter) const;
+
+    /*!
+     * \brief Finds the common ancestor of each of the given pairs of Tasks.
+     *
+     * This is equivalent to calling Task::find_common_ancestor() for each pair
+     * but only locks the board once.
+     *
+     * \param pairs The pairs of Tasks, which must be on this board.
+     * \param out The common ancestor of each pair is appended to this vector
+     *            in the same order as the pairs.
+     *
+     * \throws arc::ex::ValueError If any of the Tasks are null or on a
+     *                             different board.
+     */
+    void find_common_ancestors(
+            const std::vector<std::pair<const Task*, const Task*>>& pairs,
+            std::vector<Task*>& out) const;
+
+    /*!
+     * \brief Returns the undo/redo history of this board.
+     */
+    TaskHistory& get_history();
+
     /*!
      * \brief Throws an arc::ex::IllegalActionError since a RootTask cannot
      *        have a parent.
@@ -59,21 +261,227 @@ private:
      * the API.
      *
      * \param title The title of this task.
-     * \param title_resolver Function pointer to use for resolving unique
-     *                       titles.
+     * \param domain The domain this board belongs to. The domain's mutex is
+     *               held while the title of this board is resolved and
+     *               assigned so that concurrent renames remain unique.
      */
-    RootTask(
-            const arc::str::UTF8String& title,
-            TitleResolver_t title_resolver);
+    RootTask(const arc::str::UTF8String& title, TasksDomain* domain);
 
     //--------------------------------------------------------------------------
     //                             PRIVATE ATTRIBUTES
     //--------------------------------------------------------------------------
 
     /*!
-     * \brief The function to use for resolving board titles.
+     * \brief The domain this board belongs to.
+     */
+    TasksDomain* m_domain;
+    /*!
+     * \brief Synchronises access to the Tasks of this board.
+     */
+    mutable sigma::core::util::ReadWriteLock m_lock;
+    /*!
+     * \brief Serialises threads that rebuild snapshots of this board.
+     */
+    mutable std::mutex m_snapshot_mutex;
+    /*!
+     * \brief Serialises threads that update the cached ancestry of Tasks on
+     *        this board.
+     */
+    mutable std::mutex m_ancestry_mutex;
+    /*!
+     * \brief Synchronises the order of the loaded Tasks, which is updated by
+     *        readers of the board.
+     */
+    mutable std::recursive_mutex m_loaded_mutex;
+    /*!
+     * \brief Changes whenever a Task on this board is moved, invalidating the
+     *        cached ancestry of every Task on the board.
+     */
+    arc::uint64 m_ancestry_epoch;
+    /*!
+     * \brief The Tasks of this board mapped from their ids.
+     */
+    std::unordered_map<arc::uint32, Task*> m_tasks;
+    /*!
+     * \brief The ids of the archived Tasks of this board mapped to the Task
+     *        that holds their archive.
+     */
+    std::unordered_map<arc::uint32, Task*> m_archived;
+    /*!
+     * \brief The maximum number of resident Tasks, or 0 for no limit.
+     */
+    std::size_t m_resident_budget;
+    /*!
+     * \brief The Tasks that have had their children rehydrated, ordered from
+     *        most to least recently used.
+     */
+    std::list<Task*> m_loaded;
+    /*!
+     * \brief The position of each Task in m_loaded.
+     */
+    std::unordered_map<const Task*, std::list<Task*>::iterator>
+        m_loaded_positions;
+    /*!
+     * \brief The typed attributes of the Tasks of this board.
+     */
+    AttributeTable m_attributes;
+    /*!
+     * \brief The undo/redo history of this board.
+     */
+    TaskHistory m_history;
+    /*!
+     * \brief Changes to the Tasks of this board are not appended to the
+     *        domain's feed while this is greater than zero, see
+     *        ChangeFeed.
+     */
+    std::size_t m_suspended_changes;
+    /*!
+     * \brief Whether Tasks are being destroyed by archiving or created by
+     *        rehydrating, rather than being deleted or added.
+     */
+    bool m_archiving;
+    /*!
+     * \brief The number of bytes used by the titles of the resident Tasks.
+     */
+    std::size_t m_title_bytes;
+    /*!
+     * \brief Maps each depth to the number of resident Tasks at that depth,
+     *        depths without Tasks are not held.
+     */
+    std::map<std::size_t, std::size_t> m_depth_counts;
+    /*!
+     * \brief Maps each number of children to the number of resident Tasks
+     *        with that many children, numbers without Tasks are not held.
+     */
+    std::map<std::size_t, std::size_t> m_children_counts;
+    /*!
+     * \brief The number of bytes used by the callbacks registered with the
+     *        resident Tasks, this is atomic since callbacks are registered
+     *        without locking the board.
+     */
+    std::atomic<std::size_t> m_callback_bytes;
+    /*!
+     * \brief The number of changes recorded for this board.
+     */
+    arc::uint64 m_mutation_count;
+    /*!
+     * \brief Selects the shard of the domain that executes the jobs submitted
+     *        for this board, see TasksDomain::submit().
+     */
+    std::size_t m_shard;
+    /*!
+     * \brief Whether the board is being deleted, so jobs can't be submitted
+     *        for it and its title isn't indexed. This is guarded by the
+     *        domain's mutex.
+     */
+    bool m_closed;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Rehydrates every archived Task on this board.
+     *
+     * This is used by TaskQuery before streaming the board, since archived
+     * Tasks are not held in the board's attributes. The resident budget is
+     * not enforced.
+     */
+    void rehydrate_all();
+
+    /*!
+     * \brief Called by Tasks once they have been assigned an id on this board.
+     */
+    void register_task(Task* task);
+
+    /*!
+     * \brief Called by Tasks when they are removed from this board.
+     */
+    void unregister_task(Task* task);
+
+    /*!
+     * \brief Adds the given number of resident Tasks to the count of Tasks at
+     *        the given depth, or removes them if the number is negative.
+     */
+    void count_depth(std::size_t depth, std::ptrdiff_t count);
+
+    /*!
+     * \brief Adds the given number of resident Tasks to the count of Tasks
+     *        with the given number of children, or removes them if the number
+     *        is negative.
+     */
+    void count_children(std::size_t children, std::ptrdiff_t count);
+
+    /*!
+     * \brief Adds the resident Tasks of the given subtree to the depth,
+     *        children and callback counts of this board, or removes them if
+     *        the sign is negative.
+     *
+     * This is used when the subtree is moved to a different depth or board.
+     *
+     * \param task The top of the subtree.
+     * \param depth The depth of the top of the subtree on this board.
+     * \param sign 1 to add the subtree, or -1 to remove it.
+     */
+    void count_subtree(const Task* task, std::size_t depth, int sign);
+
+    /*!
+     * \brief Moves the given Tasks from this board to the target board.
+     *
+     * The Task objects, their children and callbacks are relinked rather than
+     * recreated and their attributes are moved to the target board's columns
+     * in one pass. The Tasks must be a subtree of this board and are not
+     * moved between parents, see Task::set_board_internal().
+     */
+    void transfer_tasks(const std::vector<Task*>& subtree, RootTask* target);
+
+    /*!
+     * \brief Moves the given Task to the front of the loaded Tasks, adding it
+     *        if it isn't already loaded.
+     */
+    void mark_loaded(Task* task);
+
+    /*!
+     * \brief Moves the given Task and its ancestors that are loaded to the
+     *        front of the loaded Tasks.
+     */
+    void touch_loaded(const Task* task);
+
+    /*!
+     * \brief Removes the given Task from the loaded Tasks.
+     *
+     * \return Whether the Task was loaded.
+     */
+    bool forget_loaded(const Task* task);
+
+    /*!
+     * \brief Archives the least recently used loaded Tasks until the board is
+     *        within its resident budget, other than the given Tasks and their
+     *        ancestors.
+     */
+    void enforce_resident_budget(const std::vector<const Task*>& in_use);
+
+    /*!
+     * \brief Checks that the Tasks selected by the given filter are on this
+     *        board.
+     */
+    void check_filter(const TaskFilter& filter) const;
+
+    /*!
+     * \brief Appends the ids of the archived Tasks of this board that match
+     *        the given filter to the given vector, without rehydrating them.
+     */
+    void select_archived(
+            const TaskFilter& filter,
+            std::vector<arc::uint32>& out) const;
+
+    /*!
+     * \brief Rehydrates the archives that contain the Task with the given id
+     *        without locking.
+     *
+     * \return The Task, or null if there is no such Task on this board.
      */
-    TitleResolver_t m_title_resolver;
+    Task* rehydrate_task(arc::uint32 id);
 };
 
 } // namespace tasks
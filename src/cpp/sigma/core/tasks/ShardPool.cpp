@@ -0,0 +1,150 @@
+#include "sigma/core/tasks/ShardPool.hpp"
+
+#include <future>
+
+#include <arcanecore/base/Exceptions.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTORS
+//------------------------------------------------------------------------------
+
+ShardPool::Shard::Shard()
+    :
+    stopping(false)
+{
+}
+
+ShardPool::ShardPool(std::size_t shard_count)
+{
+    if(shard_count == 0)
+    {
+        throw arc::ex::ValueError("A shard pool must have at least one shard");
+    }
+
+    // the shards are all created before any thread starts so that the vector
+    // doesn't change while the threads are running
+    for(std::size_t i = 0; i < shard_count; ++i)
+    {
+        m_shards.push_back(std::unique_ptr<Shard>(new Shard()));
+    }
+    ARC_FOR_EACH(it, m_shards)
+    {
+        Shard* shard = it->get();
+        shard->thread = std::thread(&ShardPool::run, this, shard);
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                   DESTRUCTOR
+//------------------------------------------------------------------------------
+
+ShardPool::~ShardPool()
+{
+    ARC_FOR_EACH(it, m_shards)
+    {
+        Shard& shard = **it;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.stopping = true;
+        }
+        shard.condition.notify_one();
+    }
+    ARC_FOR_EACH(it, m_shards)
+    {
+        (*it)->thread.join();
+    }
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+std::size_t ShardPool::get_shard_count() const
+{
+    return m_shards.size();
+}
+
+void ShardPool::post(std::size_t shard, std::function<void()> job)
+{
+    Shard& target = *m_shards.at(shard);
+    {
+        std::lock_guard<std::mutex> lock(target.mutex);
+        target.jobs.push_back(std::move(job));
+    }
+    target.condition.notify_one();
+}
+
+void ShardPool::drain(std::size_t shard)
+{
+    std::size_t current = get_current_shard();
+    if(current == shard)
+    {
+        return;
+    }
+    // two shards waiting for each other would never wake up
+    if(current < m_shards.size())
+    {
+        throw arc::ex::StateError(
+            "A shard cannot wait for the jobs of another shard");
+    }
+
+    // jobs are executed in order, so once this job has run every job posted
+    // before it has too
+    std::shared_ptr<std::promise<void>> done(new std::promise<void>());
+    std::future<void> drained(done->get_future());
+    post(shard, [done]()
+    {
+        done->set_value();
+    });
+    drained.wait();
+}
+
+std::size_t ShardPool::get_current_shard() const
+{
+    std::thread::id current = std::this_thread::get_id();
+    for(std::size_t i = 0; i < m_shards.size(); ++i)
+    {
+        if(m_shards[i]->thread.get_id() == current)
+        {
+            return i;
+        }
+    }
+    return m_shards.size();
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void ShardPool::run(Shard* shard)
+{
+    while(true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(shard->mutex);
+            shard->condition.wait(lock, [shard]()
+            {
+                return shard->stopping || !shard->jobs.empty();
+            });
+            if(shard->jobs.empty())
+            {
+                return;
+            }
+            job = std::move(shard->jobs.front());
+            shard->jobs.pop_front();
+        }
+        job();
+    }
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
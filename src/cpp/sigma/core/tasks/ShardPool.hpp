@@ -0,0 +1,152 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Worker threads that each execute the jobs of a subset of boards.
+ */
+#ifndef SIGMA_CORE_TASKS_SHARDPOOL_HPP_
+#define SIGMA_CORE_TASKS_SHARDPOOL_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+/*!
+ * \brief A fixed set of worker threads, called shards, that each execute the
+ *        jobs posted to them in the order they were posted.
+ *
+ * The domain assigns every board to a shard, so all of the jobs submitted for
+ * a board run on the same thread one after another, see
+ * TasksDomain::submit(). Boards on different shards are changed in parallel
+ * without their locks ever being contended.
+ *
+ * \par Thread Safety
+ *
+ * Jobs may be posted from any thread, including from the shards themselves.
+ */
+class ShardPool
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(ShardPool);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Starts the given number of shards.
+     *
+     * \throws arc::ex::ValueError If the shard count is zero.
+     */
+    explicit ShardPool(std::size_t shard_count);
+
+    //--------------------------------------------------------------------------
+    //                                 DESTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Executes the jobs that have already been posted then stops the
+     *        shards.
+     */
+    ~ShardPool();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the number of shards.
+     */
+    std::size_t get_shard_count() const;
+
+    /*!
+     * \brief Queues the given job to be executed by the given shard.
+     *
+     * Exceptions thrown by jobs are not caught, jobs should report errors
+     * through a future, see TasksDomain::submit().
+     */
+    void post(std::size_t shard, std::function<void()> job);
+
+    /*!
+     * \brief Blocks until the jobs that have been posted to the given shard
+     *        have been executed.
+     *
+     * Does nothing if called from the shard itself.
+     *
+     * \throws arc::ex::StateError If called from a different shard, since the
+     *                             shards could end up waiting for each
+     *                             other.
+     */
+    void drain(std::size_t shard);
+
+    /*!
+     * \brief Returns the shard the calling thread is, or get_shard_count() if
+     *        the calling thread isn't a shard of this pool.
+     */
+    std::size_t get_current_shard() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A worker thread and its queue of jobs.
+     */
+    struct Shard
+    {
+        /// Guards the jobs and stopping.
+        std::mutex mutex;
+        /// Notified when a job is posted or the shard is stopped.
+        std::condition_variable condition;
+        /// The jobs waiting to be executed.
+        std::deque<std::function<void()>> jobs;
+        /// Whether the shard should exit once its queue is empty.
+        bool stopping;
+        /// The thread that executes the jobs.
+        std::thread thread;
+
+        Shard();
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The shards, these are held by pointer since they can't be moved.
+     */
+    std::vector<std::unique_ptr<Shard>> m_shards;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Executes the jobs of the given shard until it is stopped.
+     */
+    void run(Shard* shard);
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
@@ -0,0 +1,323 @@
+#include "sigma/core/tasks/TagIndex.hpp"
+
+#include <algorithm>
+
+#include <arcanecore/base/Exceptions.hpp>
+
+#include "sigma/core/tasks/Task.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+TagIndex::TagIndex()
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool TagIndex::add_tag(Task* task, const arc::str::UTF8String& tag)
+{
+    if(task == nullptr)
+    {
+        throw arc::ex::ValueError("Cannot tag a null Task");
+    }
+    if(tag.is_empty())
+    {
+        throw arc::ex::ValueError("Tags cannot be empty");
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    arc::uint32 tag_id;
+    std::map<arc::str::UTF8String, arc::uint32>::const_iterator found =
+        m_tag_ids.find(tag);
+    if(found != m_tag_ids.end())
+    {
+        tag_id = found->second;
+    }
+    else
+    {
+        tag_id = static_cast<arc::uint32>(m_names.size());
+        m_names.push_back(tag);
+        m_tag_ids[tag] = tag_id;
+        m_tagged.push_back(TaskBitmap());
+    }
+
+    if(!m_tagged[tag_id].add(task->get_id()))
+    {
+        return false;
+    }
+    TaskTags& tags = m_tasks[task->get_id()];
+    tags.task = task;
+    tags.tags.push_back(tag_id);
+    return true;
+}
+
+bool TagIndex::remove_tag(const Task* task, const arc::str::UTF8String& tag)
+{
+    if(task == nullptr)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::map<arc::str::UTF8String, arc::uint32>::const_iterator found =
+        m_tag_ids.find(tag);
+    if(found == m_tag_ids.end() ||
+       !m_tagged[found->second].remove(task->get_id()))
+    {
+        return false;
+    }
+
+    std::unordered_map<arc::uint32, TaskTags>::iterator tags =
+        m_tasks.find(task->get_id());
+    tags->second.tags.erase(std::find(
+            tags->second.tags.begin(),
+            tags->second.tags.end(),
+            found->second
+    ));
+    if(tags->second.tags.empty())
+    {
+        m_tasks.erase(tags);
+    }
+    return true;
+}
+
+bool TagIndex::has_tag(
+        const Task* task,
+        const arc::str::UTF8String& tag) const
+{
+    if(task == nullptr)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const TaskBitmap* tagged = find_bitmap(tag);
+    return tagged != nullptr && tagged->contains(task->get_id());
+}
+
+void TagIndex::get_tags(
+        const Task* task,
+        std::vector<arc::str::UTF8String>& out) const
+{
+    if(task != nullptr)
+    {
+        get_tags(task->get_id(), out);
+    }
+}
+
+void TagIndex::get_tags(
+        arc::uint32 id,
+        std::vector<arc::str::UTF8String>& out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::unordered_map<arc::uint32, TaskTags>::const_iterator tags =
+        m_tasks.find(id);
+    if(tags == m_tasks.end())
+    {
+        return;
+    }
+    ARC_CONST_FOR_EACH(it, tags->second.tags)
+    {
+        out.push_back(m_names[*it]);
+    }
+}
+
+void TagIndex::get_all_tags(std::vector<arc::str::UTF8String>& out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ARC_CONST_FOR_EACH(it, m_tag_ids)
+    {
+        if(!m_tagged[it->second].is_empty())
+        {
+            out.push_back(it->first);
+        }
+    }
+}
+
+TaskBitmap TagIndex::get_tagged(const arc::str::UTF8String& tag) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const TaskBitmap* tagged = find_bitmap(tag);
+    if(tagged == nullptr)
+    {
+        return TaskBitmap();
+    }
+    return *tagged;
+}
+
+std::size_t TagIndex::get_tagged_count(const arc::str::UTF8String& tag) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const TaskBitmap* tagged = find_bitmap(tag);
+    if(tagged == nullptr)
+    {
+        return 0;
+    }
+    return tagged->get_cardinality();
+}
+
+TaskBitmap TagIndex::find(
+        const std::vector<arc::str::UTF8String>& all_of,
+        const std::vector<arc::str::UTF8String>& none_of) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // intersect from the rarest tag so the working set only shrinks
+    std::vector<std::pair<std::size_t, const TaskBitmap*>> required;
+    ARC_CONST_FOR_EACH(it, all_of)
+    {
+        const TaskBitmap* tagged = find_bitmap(*it);
+        if(tagged == nullptr || tagged->is_empty())
+        {
+            return TaskBitmap();
+        }
+        required.push_back(std::make_pair(tagged->get_cardinality(), tagged));
+    }
+    if(required.empty())
+    {
+        return TaskBitmap();
+    }
+    std::sort(required.begin(), required.end());
+
+    TaskBitmap result(*required[0].second);
+    for(std::size_t i = 1; i < required.size() && !result.is_empty(); ++i)
+    {
+        result.intersect(*required[i].second);
+    }
+    ARC_CONST_FOR_EACH(it, none_of)
+    {
+        const TaskBitmap* tagged = find_bitmap(*it);
+        if(result.is_empty())
+        {
+            break;
+        }
+        if(tagged != nullptr)
+        {
+            result.subtract(*tagged);
+        }
+    }
+    return result;
+}
+
+TaskBitmap TagIndex::find_any(
+        const std::vector<arc::str::UTF8String>& any_of) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    TaskBitmap result;
+    ARC_CONST_FOR_EACH(it, any_of)
+    {
+        const TaskBitmap* tagged = find_bitmap(*it);
+        if(tagged != nullptr)
+        {
+            result.unite(*tagged);
+        }
+    }
+    return result;
+}
+
+void TagIndex::get_tasks(const TaskBitmap& ids, std::vector<Task*>& out) const
+{
+    std::vector<arc::uint32> values;
+    ids.get_ids(values);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ARC_CONST_FOR_EACH(it, values)
+    {
+        std::unordered_map<arc::uint32, TaskTags>::const_iterator tags =
+            m_tasks.find(*it);
+        if(tags != m_tasks.end() && tags->second.task != nullptr)
+        {
+            out.push_back(tags->second.task);
+        }
+    }
+}
+
+void TagIndex::remove_task(arc::uint32 id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::unordered_map<arc::uint32, TaskTags>::iterator tags =
+        m_tasks.find(id);
+    if(tags == m_tasks.end())
+    {
+        return;
+    }
+    ARC_CONST_FOR_EACH(it, tags->second.tags)
+    {
+        m_tagged[*it].remove(id);
+    }
+    m_tasks.erase(tags);
+}
+
+void TagIndex::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_names.clear();
+    m_tag_ids.clear();
+    m_tagged.clear();
+    m_tasks.clear();
+}
+
+std::size_t TagIndex::get_memory_usage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::size_t usage = 0;
+    ARC_CONST_FOR_EACH(it, m_tagged)
+    {
+        usage += it->get_memory_usage();
+    }
+    return usage;
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void TagIndex::set_task(arc::uint32 id, Task* task)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::unordered_map<arc::uint32, TaskTags>::iterator tags =
+        m_tasks.find(id);
+    if(tags != m_tasks.end())
+    {
+        tags->second.task = task;
+    }
+}
+
+const TaskBitmap* TagIndex::find_bitmap(const arc::str::UTF8String& tag) const
+{
+    std::map<arc::str::UTF8String, arc::uint32>::const_iterator found =
+        m_tag_ids.find(tag);
+    if(found == m_tag_ids.end())
+    {
+        return nullptr;
+    }
+    return &m_tagged[found->second];
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
@@ -0,0 +1,247 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Tags on Tasks, indexed for set queries.
+ */
+#ifndef SIGMA_CORE_TASKS_TAGINDEX_HPP_
+#define SIGMA_CORE_TASKS_TAGINDEX_HPP_
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include "sigma/core/tasks/TaskBitmap.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class Task;
+
+/*!
+ * \brief Stores the tags of Tasks as a TaskBitmap per tag.
+ *
+ * A tag is a non-empty name that any number of Tasks may be tagged with, for
+ * example ``backend`` or ``p1``. The Tasks with a tag are stored as a
+ * compressed bitmap of their ids, so selecting the Tasks with a combination
+ * of tags is performed with bitmap intersections, unions and differences
+ * rather than by visiting Tasks. For example the Tasks tagged ``backend`` and
+ * ``p1`` that aren't tagged ``blocked`` are selected by:
+ *
+ * \code
+ * std::vector<arc::str::UTF8String> all_of;
+ * all_of.push_back("backend");
+ * all_of.push_back("p1");
+ * std::vector<arc::str::UTF8String> none_of;
+ * none_of.push_back("blocked");
+ * TaskBitmap tasks(index.find(all_of, none_of));
+ * \endcode
+ *
+ * Tags are independent of the Task hierarchy and boards, since Task ids are
+ * unique across all boards of a domain. The index of each domain is accessed
+ * through TasksDomain::get_tags(), which removes Tasks from the index when
+ * they are destroyed. The tags of archived Tasks (see Task::archive()) are
+ * kept by their ids and are attached to the Tasks again when they are
+ * rehydrated.
+ *
+ * \par Thread Safety
+ *
+ * All functions of the index are synchronised by a mutex of the index, and
+ * bitmaps are returned by value so they can be combined without holding the
+ * lock.
+ */
+class TagIndex
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(TagIndex);
+
+    friend class TasksDomain;
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new index with no tags.
+     */
+    TagIndex();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Tags the given Task with the given tag.
+     *
+     * \return False if the Task already had the tag.
+     *
+     * \throws arc::ex::ValueError If the Task is null or the tag is empty.
+     */
+    bool add_tag(Task* task, const arc::str::UTF8String& tag);
+
+    /*!
+     * \brief Removes the given tag from the given Task.
+     *
+     * \return False if the Task didn't have the tag.
+     */
+    bool remove_tag(const Task* task, const arc::str::UTF8String& tag);
+
+    /*!
+     * \brief Returns whether the given Task has the given tag.
+     */
+    bool has_tag(const Task* task, const arc::str::UTF8String& tag) const;
+
+    /*!
+     * \brief Appends the tags of the given Task to the given vector, in the
+     *        order they were added.
+     */
+    void get_tags(
+            const Task* task,
+            std::vector<arc::str::UTF8String>& out) const;
+
+    /*!
+     * \brief Appends the tags of the Task with the given id to the given
+     *        vector, in the order they were added.
+     *
+     * This also finds the tags of archived Tasks, which have no Task object.
+     */
+    void get_tags(
+            arc::uint32 id,
+            std::vector<arc::str::UTF8String>& out) const;
+
+    /*!
+     * \brief Appends every tag that at least one Task has to the given vector
+     *        in alphabetical order.
+     */
+    void get_all_tags(std::vector<arc::str::UTF8String>& out) const;
+
+    /*!
+     * \brief Returns the ids of the Tasks with the given tag.
+     */
+    TaskBitmap get_tagged(const arc::str::UTF8String& tag) const;
+
+    /*!
+     * \brief Returns the number of Tasks with the given tag.
+     */
+    std::size_t get_tagged_count(const arc::str::UTF8String& tag) const;
+
+    /*!
+     * \brief Returns the ids of the Tasks that have all of the tags of
+     *        all_of, and none of the tags of none_of.
+     *
+     * The intersection starts from the tag with the fewest Tasks, so the cost
+     * is bounded by the rarest tag. If all_of is empty no Tasks are returned.
+     */
+    TaskBitmap find(
+            const std::vector<arc::str::UTF8String>& all_of,
+            const std::vector<arc::str::UTF8String>& none_of =
+                std::vector<arc::str::UTF8String>()) const;
+
+    /*!
+     * \brief Returns the ids of the Tasks that have any of the given tags.
+     */
+    TaskBitmap find_any(
+            const std::vector<arc::str::UTF8String>& any_of) const;
+
+    /*!
+     * \brief Appends the Tasks with the ids in the given bitmap to the given
+     *        vector, in order of their ids.
+     *
+     * Ids of Tasks that have no tags or that are archived are skipped.
+     */
+    void get_tasks(const TaskBitmap& ids, std::vector<Task*>& out) const;
+
+    /*!
+     * \brief Removes all of the tags of the Task with the given id.
+     */
+    void remove_task(arc::uint32 id);
+
+    /*!
+     * \brief Removes all tags.
+     */
+    void clear();
+
+    /*!
+     * \brief Returns the approximate number of bytes used by the bitmaps of
+     *        the index.
+     */
+    std::size_t get_memory_usage() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The tags of a single Task.
+     */
+    struct TaskTags
+    {
+        /// The tagged Task, or null while the Task is archived.
+        Task* task;
+        /// The interned ids of the tags of the Task.
+        std::vector<arc::uint32> tags;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Synchronises access to the index.
+     */
+    mutable std::mutex m_mutex;
+    /*!
+     * \brief The tag names at their interned ids.
+     */
+    std::vector<arc::str::UTF8String> m_names;
+    /*!
+     * \brief Maps tag names to their interned ids.
+     */
+    std::map<arc::str::UTF8String, arc::uint32> m_tag_ids;
+    /*!
+     * \brief The Tasks with each tag at the tag's interned id.
+     */
+    std::vector<TaskBitmap> m_tagged;
+    /*!
+     * \brief The tags of the Tasks that have at least one tag.
+     */
+    std::unordered_map<arc::uint32, TaskTags> m_tasks;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Sets the Task object of the tags of the Task with the given id,
+     *        which is null while the Task is archived.
+     */
+    void set_task(arc::uint32 id, Task* task);
+
+    /*!
+     * \brief Returns the bitmap of the given tag, or null if no Task has ever
+     *        had the tag.
+     */
+    const TaskBitmap* find_bitmap(const arc::str::UTF8String& tag) const;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
@@ -1,6 +1,11 @@
 #include "sigma/core/tasks/Task.hpp"
 
 #include <algorithm>
+#include <limits>
+#include <thread>
+
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TaskSerialiser.hpp"
 
 namespace sigma
 {
@@ -9,14 +14,244 @@ namespace core
 namespace tasks
 {
 
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                    CLASSES
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Holds the write locks of up to two boards for the lifetime of this
+ *        object.
+ *
+ * The locks are always acquired in address order so that operations which
+ * span two boards cannot deadlock against each other. Null boards are
+ * ignored.
+ */
+class ScopedBoardLock
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(ScopedBoardLock);
+
+public:
+
+    explicit ScopedBoardLock(RootTask* board_a, RootTask* board_b = nullptr)
+        :
+        m_first (board_a),
+        m_second(board_b)
+    {
+        if(m_first == m_second)
+        {
+            m_second = nullptr;
+        }
+        if(m_first == nullptr || (m_second != nullptr && m_second < m_first))
+        {
+            std::swap(m_first, m_second);
+        }
+
+        if(m_first != nullptr)
+        {
+            m_first->get_lock().lock_write();
+        }
+        if(m_second != nullptr)
+        {
+            try
+            {
+                m_second->get_lock().lock_write();
+            }
+            catch(const arc::ex::StateError&)
+            {
+                m_first->get_lock().unlock_write();
+                throw;
+            }
+        }
+    }
+
+    ~ScopedBoardLock()
+    {
+        if(m_second != nullptr)
+        {
+            m_second->get_lock().unlock_write();
+        }
+        if(m_first != nullptr)
+        {
+            m_first->get_lock().unlock_write();
+        }
+    }
+
+private:
+
+    RootTask* m_first;
+    RootTask* m_second;
+};
+
+/*!
+ * \brief A child being sorted by one of the built-in orderings, with its sort
+ *        key extracted up front so comparisons don't go through the board.
+ */
+struct SortEntry
+{
+    Task* task;
+    arc::int64 number;
+    const std::string* text;
+};
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Returns the lower case form of the given code point for the Latin,
+ *        Greek and Cyrillic alphabets, other code points are returned as is.
+ */
+arc::uint32 fold_case(arc::uint32 code_point)
+{
+    // ASCII, Latin-1 (except the multiplication sign), Greek and Cyrillic
+    // capitals are a fixed offset from their lower case letters
+    if((code_point >= 0x41 && code_point <= 0x5A) ||
+       (code_point >= 0xC0 && code_point <= 0xDE && code_point != 0xD7) ||
+       (code_point >= 0x391 && code_point <= 0x3A9 && code_point != 0x3A2) ||
+       (code_point >= 0x410 && code_point <= 0x42F))
+    {
+        return code_point + 0x20;
+    }
+    if(code_point >= 0x400 && code_point <= 0x40F)
+    {
+        return code_point + 0x50;
+    }
+    // Latin Extended-A alternates between capitals and lower case letters
+    if((code_point >= 0x100 && code_point <= 0x137) ||
+       (code_point >= 0x14A && code_point <= 0x177))
+    {
+        return code_point | 1;
+    }
+    if((code_point >= 0x139 && code_point <= 0x148) ||
+       (code_point >= 0x179 && code_point <= 0x17E))
+    {
+        return code_point + (code_point & 1);
+    }
+    return code_point;
+}
+
+/*!
+ * \brief Appends the UTF-8 encoding of the given code point to the given
+ *        string.
+ */
+void append_utf8(arc::uint32 code_point, std::string& out)
+{
+    if(code_point < 0x80)
+    {
+        out.push_back(static_cast<char>(code_point));
+    }
+    else if(code_point < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if(code_point < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+/*!
+ * \brief Stable sorts the given values, using multiple threads if there are
+ *        more than the given threshold.
+ *
+ * The values are split into one chunk per thread, the chunks are sorted in
+ * parallel and then neighbouring chunks are merged in parallel pairs until a
+ * single chunk remains.
+ */
+template<typename T, typename Compare>
+void parallel_stable_sort(
+        std::vector<T>& values,
+        Compare compare,
+        std::size_t threshold)
+{
+    std::size_t max_threads = std::min<std::size_t>(
+            std::max<std::size_t>(std::thread::hardware_concurrency(), 2),
+            8
+    );
+    std::size_t chunk_count =
+        std::min<std::size_t>(values.size() / threshold, max_threads);
+    if(chunk_count < 2)
+    {
+        std::stable_sort(values.begin(), values.end(), compare);
+        return;
+    }
+
+    typename std::vector<T>::iterator begin = values.begin();
+    std::vector<std::size_t> bounds;
+    for(std::size_t i = 0; i <= chunk_count; ++i)
+    {
+        bounds.push_back(values.size() * i / chunk_count);
+    }
+
+    // sort the chunks, the first on this thread
+    std::vector<std::thread> threads;
+    for(std::size_t i = 1; i < chunk_count; ++i)
+    {
+        threads.push_back(std::thread([begin, &bounds, &compare, i]()
+        {
+            std::stable_sort(begin + bounds[i], begin + bounds[i + 1], compare);
+        }));
+    }
+    std::stable_sort(begin, begin + bounds[1], compare);
+    ARC_FOR_EACH(it, threads)
+    {
+        it->join();
+    }
+
+    // merging keeps elements of the earlier chunk first, so stays stable
+    for(std::size_t width = 1; width < chunk_count; width *= 2)
+    {
+        threads.clear();
+        for(std::size_t i = 0; i + width < chunk_count; i += width * 2)
+        {
+            std::size_t first = bounds[i];
+            std::size_t middle = bounds[i + width];
+            std::size_t last = bounds[std::min(i + width * 2, chunk_count)];
+            threads.push_back(std::thread(
+                    [begin, &compare, first, middle, last]()
+                    {
+                        std::inplace_merge(
+                                begin + first,
+                                begin + middle,
+                                begin + last,
+                                compare
+                        );
+                    }
+            ));
+        }
+        ARC_FOR_EACH(it, threads)
+        {
+            it->join();
+        }
+    }
+}
+
+} // namespace anonymous
+
 //------------------------------------------------------------------------------
-//                            PRIVATE STATIC VARIABLES
+//                            PRIVATE STATIC CONSTANTS
 //------------------------------------------------------------------------------
 
-arc::uint32 Task::s_id = 0;
+const std::size_t Task::APPEND = std::numeric_limits<std::size_t>::max();
 
-sigma::core::CallbackHandler<Task*> Task::s_created_callback;
-sigma::core::CallbackHandler<Task*> Task::s_destroyed_callback;
+const arc::uint64 Task::ORDER_KEY_GAP = static_cast<arc::uint64>(1) << 32;
+
+const std::size_t Task::PARALLEL_SORT_THRESHOLD = 4096;
 
 //------------------------------------------------------------------------------
 //                                  CONSTRUCTOR
@@ -24,8 +259,19 @@ sigma::core::CallbackHandler<Task*> Task::s_destroyed_callback;
 
 Task::Task(Task* parent, const arc::str::UTF8String& title)
     :
-    m_parent(nullptr)
+    m_board                (nullptr),
+    m_id                   (0),
+    m_dense_index          (0),
+    m_order_key            (0),
+    m_parent               (nullptr),
+    m_depth                (0),
+    m_ancestry_epoch       (0),
+    m_descendant_count     (0),
+    m_done_descendant_count(0),
+    m_destroying           (false)
 {
+    observe_callbacks();
+
     // tasks cannot be constructed with a null parent
     if(parent == nullptr)
     {
@@ -33,6 +279,9 @@ Task::Task(Task* parent, const arc::str::UTF8String& title)
         throw arc::ex::ValueError("Tasks cannot have a null parent");
     }
 
+    ScopedBoardLock lock(parent->m_board);
+    m_board = parent->m_board;
+
     try
     {
         // set parent
@@ -52,16 +301,30 @@ Task::Task(Task* parent, const arc::str::UTF8String& title)
     }
 
     // assign id
-    m_id = ++s_id;
+    m_id = m_board->m_domain->allocate_id();
+    m_board->register_task(this);
+    m_board->get_history().record_created(this);
+    record_change(ChangeRecord::CREATED);
 
     // fire callback
-    s_created_callback.trigger(this);
+    m_board->m_domain->m_created_callback.trigger(this);
 }
 
 Task::Task(const Task& other)
     :
-    m_parent(nullptr)
+    m_board                (nullptr),
+    m_id                   (0),
+    m_dense_index          (0),
+    m_order_key            (0),
+    m_parent               (nullptr),
+    m_depth                (0),
+    m_ancestry_epoch       (0),
+    m_descendant_count     (0),
+    m_done_descendant_count(0),
+    m_destroying           (false)
 {
+    observe_callbacks();
+
     // check the other task is not a RootTask
     if(other.is_root())
     {
@@ -69,6 +332,9 @@ Task::Task(const Task& other)
         throw arc::ex::ValueError("A RootTask cannot be copied from");
     }
 
+    ScopedBoardLock lock(other.m_board);
+    m_board = other.m_board;
+
     try
     {
         // set parent
@@ -88,10 +354,13 @@ Task::Task(const Task& other)
     }
 
     // assign id
-    m_id = ++s_id;
+    m_id = m_board->m_domain->allocate_id();
+    m_board->register_task(this);
+    m_board->get_history().record_created(this);
+    record_change(ChangeRecord::CREATED);
 
     // fire callback
-    s_created_callback.trigger(this);
+    m_board->m_domain->m_created_callback.trigger(this);
 }
 
 //------------------------------------------------------------------------------
@@ -108,11 +377,69 @@ bool Task::is_root() const
     return false;
 }
 
+RootTask* Task::get_board() const
+{
+    return m_board;
+}
+
 Task* const Task::get_parent() const
 {
     return m_parent;
 }
 
+std::size_t Task::get_depth() const
+{
+    sigma::core::util::ScopedReadLock lock(m_board->get_lock());
+    std::lock_guard<std::mutex> ancestry_lock(m_board->m_ancestry_mutex);
+    update_ancestry();
+    return m_depth;
+}
+
+Task* Task::get_ancestor_at_depth(std::size_t depth) const
+{
+    sigma::core::util::ScopedReadLock lock(m_board->get_lock());
+    std::lock_guard<std::mutex> ancestry_lock(m_board->m_ancestry_mutex);
+    update_ancestry();
+    if(depth > m_depth)
+    {
+        throw arc::ex::ValueError(
+                "Depth is greater than the depth of the Task");
+    }
+    return find_ancestor_at_depth(depth);
+}
+
+Task* Task::find_common_ancestor(const Task* other) const
+{
+    if(other == nullptr || other->m_board != m_board)
+    {
+        return nullptr;
+    }
+
+    sigma::core::util::ScopedReadLock lock(m_board->get_lock());
+    std::lock_guard<std::mutex> ancestry_lock(m_board->m_ancestry_mutex);
+    return find_common_ancestor_internal(other);
+}
+
+std::size_t Task::get_descendant_count() const
+{
+    return m_descendant_count;
+}
+
+std::size_t Task::get_done_descendant_count() const
+{
+    return m_done_descendant_count;
+}
+
+float Task::get_completion() const
+{
+    if(m_descendant_count == 0)
+    {
+        return get_status() == STATUS_DONE ? 1.0F : 0.0F;
+    }
+    return static_cast<float>(m_done_descendant_count) /
+           static_cast<float>(m_descendant_count);
+}
+
 void Task::set_parent(Task* const parent)
 {
     // is the given parent null?
@@ -123,20 +450,74 @@ void Task::set_parent(Task* const parent)
     }
     else
     {
+        ScopedBoardLock lock(m_board, parent->m_board);
+
         // set and trigger callback
         sigma::core::tasks::Task* old_parent = m_parent;
+        RootTask* old_board = m_board;
+        std::size_t old_index = old_parent->find_child_index(this);
+
         set_parent_internal(parent);
+
+        if(old_parent != m_parent && old_board == m_board)
+        {
+            m_board->get_history().record_moved(
+                    this,
+                    old_parent,
+                    old_index,
+                    m_parent->m_children.size() - 1
+            );
+        }
         m_parent_changed_callback.trigger(this, old_parent, m_parent);
     }
 }
 
+void Task::move_before(Task* const sibling)
+{
+    move_next_to(sibling, 0);
+}
+
+void Task::move_after(Task* const sibling)
+{
+    move_next_to(sibling, 1);
+}
+
+arc::uint64 Task::get_order_key() const
+{
+    return m_order_key;
+}
+
 std::size_t Task::get_children_count() const
 {
+    if(is_archived())
+    {
+        // the archive starts with the number of children
+        const arc::uint8* data = &m_archive[0];
+        return static_cast<std::size_t>(TaskSerialiser::read_uint(
+                data,
+                data + m_archive.size()
+        ));
+    }
     return m_children.size();
 }
 
 const std::vector<Task*>& Task::get_chidren() const
 {
+    {
+        sigma::core::util::ScopedReadLock lock(m_board->get_lock());
+        if(!is_archived())
+        {
+            if(m_board->m_resident_budget != 0)
+            {
+                m_board->touch_loaded(this);
+            }
+            return m_children;
+        }
+    }
+
+    // the read lock is released before rehydrating under the write lock,
+    // which fails if the caller holds the read lock
+    const_cast<Task*>(this)->rehydrate();
     return m_children;
 }
 
@@ -162,6 +543,8 @@ bool Task::add_child(Task* const child)
 
 bool Task::remove_child(Task* const child)
 {
+    ScopedBoardLock lock(m_board);
+
     // if the task is not a child, do nothing and return false
     if(!has_child(child))
     {
@@ -177,7 +560,10 @@ bool Task::remove_child(Task* const child)
 
 void Task::clear_children()
 {
+    ScopedBoardLock lock(m_board);
+
     // iterate over children and remove them
+    rehydrate_internal();
     std::vector<Task*> children_copy(m_children);
     ARC_FOR_EACH(it, children_copy)
     {
@@ -186,6 +572,119 @@ void Task::clear_children()
     m_children.clear();
 }
 
+void Task::sort_children(const TaskComparator& comparator)
+{
+    if(!comparator)
+    {
+        throw arc::ex::ValueError(
+                "Cannot sort children with a null comparator");
+    }
+
+    ScopedBoardLock lock(m_board);
+
+    rehydrate_internal();
+    std::vector<Task*> children(m_children);
+    parallel_stable_sort(
+            children,
+            [&comparator](const Task* a, const Task* b)
+            {
+                return comparator(a, b);
+            },
+            PARALLEL_SORT_THRESHOLD
+    );
+    reorder_children(children);
+}
+
+void Task::sort_children(TaskOrdering ordering)
+{
+    ScopedBoardLock lock(m_board);
+
+    // extract the keys once rather than on every comparison
+    rehydrate_internal();
+    std::vector<SortEntry> entries(m_children.size());
+    for(std::size_t i = 0; i < m_children.size(); ++i)
+    {
+        Task* child = m_children[i];
+        SortEntry& entry = entries[i];
+        entry.task = child;
+        entry.number = 0;
+        entry.text = nullptr;
+        switch(ordering)
+        {
+            case ORDER_BY_TITLE:
+            {
+                entry.text = &child->get_collation_key();
+                break;
+            }
+            case ORDER_BY_PRIORITY:
+            {
+                // highest first
+                entry.number = -static_cast<arc::int64>(
+                        m_board->m_attributes.get_priority(
+                                child->m_dense_index));
+                break;
+            }
+            case ORDER_BY_DUE_DATE:
+            {
+                TaskAttributes attributes(child->get_attributes());
+                entry.number = attributes.has_due_date
+                    ? attributes.due_date
+                    : std::numeric_limits<arc::int64>::max();
+                break;
+            }
+        }
+    }
+
+    if(ordering == ORDER_BY_TITLE)
+    {
+        parallel_stable_sort(
+                entries,
+                [](const SortEntry& a, const SortEntry& b)
+                {
+                    return *a.text < *b.text;
+                },
+                PARALLEL_SORT_THRESHOLD
+        );
+    }
+    else
+    {
+        parallel_stable_sort(
+                entries,
+                [](const SortEntry& a, const SortEntry& b)
+                {
+                    return a.number < b.number;
+                },
+                PARALLEL_SORT_THRESHOLD
+        );
+    }
+
+    std::vector<Task*> children;
+    children.reserve(entries.size());
+    ARC_CONST_FOR_EACH(it, entries)
+    {
+        children.push_back(it->task);
+    }
+    reorder_children(children);
+}
+
+bool Task::archive()
+{
+    ScopedBoardLock lock(m_board);
+    return archive_internal();
+}
+
+bool Task::is_archived() const
+{
+    return !m_archive.empty();
+}
+
+void Task::rehydrate()
+{
+    ScopedBoardLock lock(m_board);
+    rehydrate_internal();
+    m_board->enforce_resident_budget(std::vector<const Task*>(1, this));
+}
+
 const arc::str::UTF8String& Task::get_title() const
 {
     return m_title;
@@ -193,122 +692,1153 @@ const arc::str::UTF8String& Task::get_title() const
 
 void Task::set_title(const arc::str::UTF8String& title)
 {
-    arc::str::UTF8String old_title(title);
+    ScopedBoardLock lock(m_board);
+
+    arc::str::UTF8String old_title(m_title);
     set_title_internal(title);
+    m_board->get_history().record_retitled(this, old_title);
     // fire callback
     m_title_changed_callback.trigger(this, old_title, m_title);
 }
 
-//------------------------------------------------------------------------------
-//                             PROTECTED CONSTRUCTOR
-//------------------------------------------------------------------------------
+arc::uint64 Task::get_hash() const
+{
+    // hashes are computed as part of the snapshot of this Task
+    sigma::core::util::ScopedReadLock lock(m_board->get_lock());
+    std::lock_guard<std::mutex> build_lock(m_board->m_snapshot_mutex);
+    return build_snapshot()->get_hash();
+}
 
-Task::Task(const arc::str::UTF8String& title)
-    :
-    m_parent(nullptr),
-    m_title (title)
+TaskAttributes Task::get_attributes() const
 {
-    // title should never be empty since the task domain should enforce this
-    assert(!title.is_empty());
+    TaskAttributes attributes;
+    m_board->m_attributes.get(m_dense_index, attributes);
+    return attributes;
+}
 
-    // assign id
-    m_id = ++s_id;
+void Task::set_attributes(const TaskAttributes& attributes)
+{
+    attributes.validate();
 
+    ScopedBoardLock lock(m_board);
+
+    TaskAttributes old_attributes(get_attributes());
+    if(attributes == old_attributes)
+    {
+        return;
+    }
+    set_attributes_internal(attributes);
+    m_board->get_history().record_attributes_changed(this, old_attributes);
     // fire callback
-    s_created_callback.trigger(this);
+    m_attributes_changed_callback.trigger(this, old_attributes, attributes);
 }
 
-//------------------------------------------------------------------------------
-//                            PRIVATE MEMBER FUNCTIONS
-//------------------------------------------------------------------------------
+TaskStatus Task::get_status() const
+{
+    return m_board->m_attributes.get_status(m_dense_index);
+}
 
-void Task::set_parent_internal(Task* const parent)
+void Task::set_status(TaskStatus status)
 {
-    // do nothing if the parent is the same
-    if(parent == m_parent)
-    {
-        return;
-    }
+    TaskAttributes attributes(get_attributes());
+    attributes.status = status;
+    set_attributes(attributes);
+}
 
-    // check if the parent is a already a descendant of this task
-    if(has_descendant(parent))
-    {
-        throw arc::ex::IllegalActionError(
-            "A Task\'s parent cannot be set to one of it's descendants.");
-    }
+TaskPriority Task::get_priority() const
+{
+    return m_board->m_attributes.get_priority(m_dense_index);
+}
 
-    // remove from the current parent
-    if(m_parent != nullptr)
-    {
-        assert(m_parent->has_child(this));
-        m_parent->m_children.erase(std::find(
-                m_parent->m_children.begin(),
-                m_parent->m_children.end(),
-                this
-        ));
-    }
+void Task::set_priority(TaskPriority priority)
+{
+    TaskAttributes attributes(get_attributes());
+    attributes.priority = priority;
+    set_attributes(attributes);
+}
 
-    // set the parent
-    m_parent = parent;
-    // add to the children of the parent
-    m_parent->m_children.push_back(this);
+arc::uint32 Task::get_estimate() const
+{
+    return m_board->m_attributes.get_estimate(m_dense_index);
 }
 
-void Task::set_title_internal(const arc::str::UTF8String& title)
+void Task::set_estimate(arc::uint32 minutes)
 {
-    // check the title is not empty
-    if(title.is_empty())
-    {
-        throw arc::ex::ValueError("Tasks cannot have a blank title");
-    }
+    TaskAttributes attributes(get_attributes());
+    attributes.estimate = minutes;
+    set_attributes(attributes);
+}
 
-    m_title = title;
+const arc::str::UTF8String& Task::get_assignee() const
+{
+    return m_board->m_attributes.get_assignee(m_dense_index);
 }
 
-bool Task::has_descendant(Task* const descendant) const
+void Task::set_assignee(const arc::str::UTF8String& assignee)
 {
-    // check if any of direct children match
-    ARC_FOR_EACH(it, m_children)
+    TaskAttributes attributes(get_attributes());
+    attributes.assignee = assignee;
+    set_attributes(attributes);
+}
+
+bool Task::has_due_date() const
+{
+    return m_board->m_attributes.has_due_date(m_dense_index);
+}
+
+arc::int64 Task::get_due_date() const
+{
+    if(!has_due_date())
     {
-        if(*it == descendant || (*it)->has_descendant(descendant))
-        {
-            return true;
-        }
+        throw arc::ex::StateError("Task has no due date");
     }
+    return m_board->m_attributes.get_due_date(m_dense_index);
+}
 
-    return false;
+void Task::set_due_date(arc::int64 due_date)
+{
+    TaskAttributes attributes(get_attributes());
+    attributes.has_due_date = true;
+    attributes.due_date = due_date;
+    set_attributes(attributes);
 }
 
-void Task::clean_up()
+void Task::clear_due_date()
 {
-    // copy the list of children since deleting them will cause modifications
-    // on this Task's list of children
-    std::vector<Task*> children_copy(m_children);
+    TaskAttributes attributes(get_attributes());
+    attributes.has_due_date = false;
+    attributes.due_date = 0;
+    set_attributes(attributes);
+}
 
-    // iterate over children and delete them
-    ARC_FOR_EACH(it, children_copy)
+bool Task::has_flag(TaskFlag flag) const
+{
+    return (m_board->m_attributes.get_flags(m_dense_index) & flag) == flag;
+}
+
+void Task::set_flag(TaskFlag flag, bool value)
+{
+    TaskAttributes attributes(get_attributes());
+    if(value)
     {
-        delete *it;
+        attributes.flags |= flag;
     }
-    children_copy.clear();
-    m_children.clear();
-
-    // fire callback
-    s_destroyed_callback.trigger(this);
+    else
+    {
+        attributes.flags &= ~static_cast<arc::uint32>(flag);
+    }
+    set_attributes(attributes);
+}
 
-    // clean up this task from it's parent (if it has one)
-    if(m_parent != nullptr)
+//------------------------------------------------------------------------------
+//                             PROTECTED CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+Task::Task(const arc::str::UTF8String& title, arc::uint32 id)
+    :
+    m_title                (title),
+    m_board                (nullptr),
+    m_id                   (id),
+    m_dense_index          (0),
+    m_order_key            (0),
+    m_parent               (nullptr),
+    m_depth                (0),
+    m_ancestry_epoch       (0),
+    m_descendant_count     (0),
+    m_done_descendant_count(0),
+    m_destroying           (false)
+{
+    observe_callbacks();
+
+    // title should never be empty since the task domain should enforce this
+    assert(!title.is_empty());
+
+    // the RootTask fires the created callback once it has a domain
+}
+
+//------------------------------------------------------------------------------
+//                              PRIVATE CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+Task::Task(
+        Task* parent,
+        const arc::str::UTF8String& title,
+        arc::uint32 id,
+        std::size_t index)
+    :
+    m_board                (parent->m_board),
+    m_id                   (0),
+    m_dense_index          (0),
+    m_order_key            (0),
+    m_parent               (nullptr),
+    m_depth                (0),
+    m_ancestry_epoch       (0),
+    m_descendant_count     (0),
+    m_done_descendant_count(0),
+    m_destroying           (false)
+{
+    observe_callbacks();
+
+    ScopedBoardLock lock(m_board);
+
+    try
     {
-        // find this task in the parent's list of children
-        std::vector<Task*>::iterator location = std::find(
-            m_parent->m_children.begin(),
-            m_parent->m_children.end(),
+        set_parent_internal(parent, index);
+        set_title_internal(title);
+    }
+    catch(const arc::ex::ValueError& e)
+    {
+        clean_up();
+        throw e;
+    }
+
+    m_id = id;
+    // ensure newly allocated ids can't collide with the restored id
+    m_board->m_domain->reserve_id(id);
+
+    m_board->register_task(this);
+    record_change(ChangeRecord::CREATED);
+
+    // fire callback, rehydrated Tasks aren't new
+    if(!m_board->m_archiving)
+    {
+        m_board->m_domain->m_created_callback.trigger(this);
+    }
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Task::count_callback_usage(void* task, std::ptrdiff_t bytes)
+{
+    // Tasks are only counted by their board once they have an id, negative
+    // changes wrap around to subtract
+    Task* owner = static_cast<Task*>(task);
+    if(owner->m_board != nullptr && owner->m_id != 0)
+    {
+        owner->m_board->m_callback_bytes += static_cast<std::size_t>(bytes);
+    }
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Task::observe_callbacks()
+{
+    m_title_changed_callback.set_usage_observer(&count_callback_usage, this);
+    m_parent_changed_callback.set_usage_observer(&count_callback_usage, this);
+    m_attributes_changed_callback.set_usage_observer(
+            &count_callback_usage,
+            this
+    );
+    m_children_reordered_callback.set_usage_observer(
+            &count_callback_usage,
             this
+    );
+}
+
+std::size_t Task::get_callback_usage() const
+{
+    return m_title_changed_callback.get_memory_usage() +
+           m_parent_changed_callback.get_memory_usage() +
+           m_attributes_changed_callback.get_memory_usage() +
+           m_children_reordered_callback.get_memory_usage();
+}
+
+void Task::recount_children(std::size_t previous)
+{
+    if(m_board != nullptr && m_id != 0)
+    {
+        m_board->count_children(previous, -1);
+        m_board->count_children(m_children.size(), 1);
+    }
+}
+
+void Task::set_parent_internal(Task* const parent, std::size_t index)
+{
+    // children can't be added among archived Tasks
+    if(parent != nullptr)
+    {
+        parent->rehydrate_internal();
+    }
+
+    // do nothing if the parent is the same, unless this Task is being
+    // repositioned
+    if(parent == m_parent && index == APPEND)
+    {
+        return;
+    }
+
+    // ids, dependencies and tags are only meaningful within a domain
+    if(parent != nullptr &&
+       m_board != nullptr &&
+       parent->m_board->m_domain != m_board->m_domain)
+    {
+        throw arc::ex::IllegalActionError(
+            "Tasks cannot be moved between the boards of different domains.");
+    }
+
+    // check if the parent is a already a descendant of this task
+    if(parent != m_parent && (parent == this || has_descendant(parent)))
+    {
+        throw arc::ex::IllegalActionError(
+            "A Task\'s parent cannot be set to one of it's descendants.");
+    }
+
+    // this subtree's contribution to the completion of its ancestors
+    std::ptrdiff_t subtree_count =
+        static_cast<std::ptrdiff_t>(m_descendant_count + 1);
+    std::ptrdiff_t subtree_done =
+        static_cast<std::ptrdiff_t>(m_done_descendant_count + is_done());
+
+    // remove from the current parent
+    std::size_t old_depth = 0;
+    if(m_parent != nullptr)
+    {
+        if(parent != m_parent)
+        {
+            m_parent->adjust_descendant_counts(-subtree_count, -subtree_done);
+            old_depth = get_depth();
+        }
+        m_parent->invalidate_snapshot();
+        m_parent->m_children.erase(
+                m_parent->m_children.begin() +
+                m_parent->find_child_index(this)
+        );
+        m_parent->recount_children(m_parent->m_children.size() + 1);
+    }
+
+    // the depths and ancestors of this subtree have changed
+    Task* const old_parent = m_parent;
+    if(m_parent != nullptr && parent != m_parent)
+    {
+        m_board->m_ancestry_epoch =
+            m_board->m_domain->allocate_ancestry_epoch();
+        parent->m_board->m_ancestry_epoch = m_board->m_ancestry_epoch;
+    }
+
+    // set the parent
+    m_parent = parent;
+    // add to the children of the parent, only this Task's key is assigned
+    // unless the siblings need to be rebalanced
+    index = std::min(index, m_parent->m_children.size());
+    m_order_key = m_parent->allocate_order_key(index);
+    m_parent->m_children.insert(m_parent->m_children.begin() + index, this);
+    m_parent->recount_children(m_parent->m_children.size() - 1);
+    m_parent->invalidate_snapshot();
+    if(m_parent != old_parent)
+    {
+        m_parent->adjust_descendant_counts(subtree_count, subtree_done);
+    }
+
+    // the statistics count the moved subtree again at its new depth on the
+    // board it now belongs to, which is skipped if neither have changed
+    if(old_parent != nullptr && m_parent != old_parent)
+    {
+        RootTask* board = m_parent->m_board;
+        std::size_t depth = m_parent->get_depth() + 1;
+        if(depth != old_depth || board != m_board)
+        {
+            m_board->count_subtree(this, old_depth, -1);
+            board->count_subtree(this, depth, 1);
+        }
+    }
+
+    // has this task moved to a different board?
+    if(m_board != m_parent->m_board)
+    {
+        // moves between boards can't be undone
+        m_board->get_history().clear();
+        m_parent->m_board->get_history().clear();
+
+        set_board_internal(m_parent->m_board);
+    }
+
+    record_change(ChangeRecord::MOVED);
+}
+
+void Task::move_internal(Task* const parent, std::size_t index)
+{
+    Task* old_parent = m_parent;
+    set_parent_internal(parent, index);
+    if(old_parent != m_parent)
+    {
+        m_parent_changed_callback.trigger(this, old_parent, m_parent);
+    }
+}
+
+void Task::move_next_to(Task* const sibling, std::size_t offset)
+{
+    if(sibling == nullptr)
+    {
+        throw arc::ex::ValueError("Cannot move a Task next to a null sibling");
+    }
+    if(m_parent == nullptr || sibling->m_parent == nullptr)
+    {
+        throw arc::ex::IllegalActionError(
+                "A RootTask cannot be positioned among siblings");
+    }
+    if(sibling == this)
+    {
+        return;
+    }
+
+    ScopedBoardLock lock(m_board, sibling->m_board);
+
+    Task* parent = sibling->m_parent;
+    Task* old_parent = m_parent;
+    RootTask* old_board = m_board;
+    std::size_t old_index = old_parent->find_child_index(this);
+
+    // the position the sibling will be at once this Task has been removed
+    std::size_t index = parent->find_child_index(sibling);
+    if(parent == old_parent && old_index < index)
+    {
+        --index;
+    }
+    index += offset;
+    if(parent == old_parent && index == old_index)
+    {
+        return;
+    }
+
+    set_parent_internal(parent, index);
+
+    if(old_board == m_board)
+    {
+        m_board->get_history().record_moved(this, old_parent, old_index, index);
+    }
+    if(old_parent != m_parent)
+    {
+        m_parent_changed_callback.trigger(this, old_parent, m_parent);
+    }
+}
+
+std::size_t Task::find_child_index(const Task* child) const
+{
+    std::vector<Task*>::const_iterator location = std::lower_bound(
+            m_children.begin(),
+            m_children.end(),
+            child->m_order_key,
+            [](const Task* task, arc::uint64 key)
+            {
+                return task->m_order_key < key;
+            }
+    );
+    assert(location != m_children.end() && *location == child);
+    return static_cast<std::size_t>(location - m_children.begin());
+}
+
+arc::uint64 Task::allocate_order_key(std::size_t index)
+{
+    const arc::uint64 max_key = std::numeric_limits<arc::uint64>::max();
+
+    // the keys can be spread at most twice: once if the neighbours' keys are
+    // too close, then the newly spread keys always leave room
+    for(std::size_t attempt = 0; attempt < 2; ++attempt)
+    {
+        arc::uint64 previous = 0;
+        if(index > 0)
+        {
+            previous = m_children[index - 1]->m_order_key;
+        }
+
+        if(index >= m_children.size())
+        {
+            // appending
+            if(previous <= max_key - ORDER_KEY_GAP)
+            {
+                return previous + ORDER_KEY_GAP;
+            }
+        }
+        else
+        {
+            arc::uint64 next = m_children[index]->m_order_key;
+            if(next - previous > 1)
+            {
+                return previous + (next - previous) / 2;
+            }
+        }
+
+        rebalance_order_keys();
+    }
+
+    assert(false);
+    return 0;
+}
+
+void Task::rebalance_order_keys()
+{
+    // leave the same gap before the first child as between the children, and
+    // shrink the gap if there are too many children to fit
+    arc::uint64 gap = ORDER_KEY_GAP;
+    arc::uint64 slots = static_cast<arc::uint64>(m_children.size()) + 2;
+    if(gap > std::numeric_limits<arc::uint64>::max() / slots)
+    {
+        gap = std::numeric_limits<arc::uint64>::max() / slots;
+    }
+
+    arc::uint64 key = gap;
+    ARC_FOR_EACH(it, m_children)
+    {
+        (*it)->m_order_key = key;
+        key += gap;
+    }
+}
+
+void Task::reorder_children(const std::vector<Task*>& children)
+{
+    if(children == m_children)
+    {
+        return;
+    }
+
+    std::vector<Task*> old_children(m_children);
+    reorder_children_internal(children);
+    m_board->get_history().record_reordered(this, old_children);
+}
+
+void Task::reorder_children_internal(const std::vector<Task*>& children)
+{
+    if(children.size() != m_children.size())
+    {
+        throw arc::ex::StateError(
+                "A reorder must contain all of the children of a Task");
+    }
+
+    m_children = children;
+    rebalance_order_keys();
+    invalidate_snapshot();
+    record_change(ChangeRecord::REORDERED);
+
+    // fire callback
+    m_children_reordered_callback.trigger(this);
+}
+
+const std::string& Task::get_collation_key() const
+{
+    if(!m_collation_key.empty())
+    {
+        return m_collation_key;
+    }
+
+    // decode the title once, folding the case of each code point
+    const arc::uint8* data =
+        reinterpret_cast<const arc::uint8*>(m_title.get_raw());
+    const arc::uint8* end = data + m_title.get_byte_length() - 1;
+    m_collation_key.reserve(end - data);
+    while(data < end)
+    {
+        arc::uint32 code_point = *data;
+        std::size_t continuation = 0;
+        if(code_point >= 0xF0)
+        {
+            code_point &= 0x07;
+            continuation = 3;
+        }
+        else if(code_point >= 0xE0)
+        {
+            code_point &= 0x0F;
+            continuation = 2;
+        }
+        else if(code_point >= 0xC0)
+        {
+            code_point &= 0x1F;
+            continuation = 1;
+        }
+        for(++data; continuation > 0 && data < end; --continuation, ++data)
+        {
+            code_point = (code_point << 6) | (*data & 0x3F);
+        }
+
+        // the key is encoded as UTF-8 again, so comparing its bytes orders by
+        // code point
+        append_utf8(fold_case(code_point), m_collation_key);
+    }
+    return m_collation_key;
+}
+
+void Task::set_title_internal(const arc::str::UTF8String& title)
+{
+    // check the title is not empty
+    if(title.is_empty())
+    {
+        throw arc::ex::ValueError("Tasks cannot have a blank title");
+    }
+
+    // only the titles of registered Tasks are counted by the board
+    if(m_id != 0 && m_board != nullptr)
+    {
+        m_board->m_title_bytes += title.get_byte_length();
+        m_board->m_title_bytes -= m_title.get_byte_length();
+    }
+
+    m_title = title;
+    m_collation_key.clear();
+    invalidate_snapshot();
+    record_change(ChangeRecord::RETITLED);
+}
+
+void Task::set_attributes_internal(const TaskAttributes& attributes)
+{
+    bool was_done = is_done();
+    TaskAttributes old_attributes(get_attributes());
+    m_board->m_attributes.set(m_dense_index, attributes);
+    invalidate_snapshot();
+
+    // update the completion of the ancestors
+    if(m_parent != nullptr && was_done != is_done())
+    {
+        m_parent->adjust_descendant_counts(0, was_done ? -1 : 1);
+    }
+
+    // fire callback
+    if(attributes != old_attributes)
+    {
+        record_change(ChangeRecord::ATTRIBUTES_CHANGED);
+        m_board->m_domain->handle_task_attributes_changed(
+                this,
+                old_attributes,
+                attributes
+        );
+        m_board->m_domain->m_attributes_changed_callback.trigger(
+                this,
+                old_attributes,
+                attributes
+        );
+    }
+}
+
+void Task::set_board_internal(RootTask* board)
+{
+    // gather the subtree breadth first so the board can move it in one batch
+    std::vector<Task*> subtree;
+    subtree.reserve(get_descendant_count() + 1);
+    subtree.push_back(this);
+    for(std::size_t i = 0; i < subtree.size(); ++i)
+    {
+        ARC_CONST_FOR_EACH(it, subtree[i]->m_children)
+        {
+            subtree.push_back(*it);
+        }
+    }
+    m_board->transfer_tasks(subtree, board);
+}
+
+bool Task::archive_internal()
+{
+    // this Task's children are no longer loaded
+    m_board->forget_loaded(this);
+    if(m_children.empty())
+    {
+        return false;
+    }
+
+    std::vector<arc::uint8> archive;
+    TaskSerialiser::serialise_children(this, archive);
+    archive.shrink_to_fit();
+
+    // the children don't record their deletion, update the completion of this
+    // Task, or remove themselves from this Task while it is being destroyed,
+    // and since they still exist they keep their dependencies and tags
+    std::vector<Task*> children;
+    children.swap(m_children);
+    recount_children(children.size());
+    m_destroying = true;
+    m_board->m_archiving = true;
+    ++m_board->m_suspended_changes;
+    ARC_FOR_EACH(it, children)
+    {
+        delete *it;
+    }
+    --m_board->m_suspended_changes;
+    m_board->m_archiving = false;
+    m_destroying = false;
+
+    // the archived Tasks are found through this Task, including any that were
+    // already archived by one of the children
+    m_archive.swap(archive);
+    std::vector<arc::uint32> ids;
+    get_archived_ids(ids);
+    ARC_CONST_FOR_EACH(it, ids)
+    {
+        m_board->m_archived[*it] = this;
+    }
+
+    // the cached snapshot doesn't need to be invalidated since the content of
+    // the subtree is unchanged
+    record_change(ChangeRecord::ARCHIVED);
+    return true;
+}
+
+void Task::rehydrate_internal()
+{
+    if(!is_archived())
+    {
+        return;
+    }
+
+    std::vector<arc::uint8> archive;
+    archive.swap(m_archive);
+
+    // the restored Tasks add themselves back to the completion of this Task
+    // and its ancestors
+    adjust_descendant_counts(
+            -static_cast<std::ptrdiff_t>(m_descendant_count),
+            -static_cast<std::ptrdiff_t>(m_done_descendant_count)
+    );
+
+    // only the children are created, the descendants of each child stay
+    // archived by the child until they're accessed, and only the rehydration
+    // of this Task is recorded
+    m_board->m_archiving = true;
+    ++m_board->m_suspended_changes;
+    const arc::uint8* data = &archive[0];
+    const arc::uint8* end = data + archive.size();
+    arc::uint64 children_count = TaskSerialiser::read_uint(data, end);
+    for(arc::uint64 i = 0; i < children_count; ++i)
+    {
+        arc::uint32 id =
+            static_cast<arc::uint32>(TaskSerialiser::read_uint(data, end));
+        arc::str::UTF8String title(TaskSerialiser::read_string(data, end));
+        TaskAttributes attributes;
+        TaskSerialiser::read_attributes(data, end, attributes);
+        arc::uint64 grandchildren_count = TaskSerialiser::read_uint(data, end);
+        const arc::uint8* descendants = data;
+        std::vector<arc::uint32> ids;
+        std::size_t done =
+            TaskSerialiser::skip(data, end, grandchildren_count, ids);
+
+        m_board->m_archived.erase(id);
+        Task* child = new Task(this, title, id, APPEND);
+        child->set_attributes_internal(attributes);
+        m_board->m_domain->handle_task_rehydrated(child);
+        if(grandchildren_count == 0)
+        {
+            continue;
+        }
+
+        TaskSerialiser::write_uint(grandchildren_count, child->m_archive);
+        child->m_archive.insert(child->m_archive.end(), descendants, data);
+        ARC_CONST_FOR_EACH(it, ids)
+        {
+            m_board->m_archived[*it] = child;
+        }
+        child->adjust_descendant_counts(
+                static_cast<std::ptrdiff_t>(ids.size()),
+                static_cast<std::ptrdiff_t>(done)
+        );
+    }
+    --m_board->m_suspended_changes;
+    m_board->m_archiving = false;
+
+    m_board->mark_loaded(this);
+    record_change(ChangeRecord::REHYDRATED);
+}
+
+void Task::get_archived_ids(std::vector<arc::uint32>& out) const
+{
+    if(!is_archived())
+    {
+        return;
+    }
+
+    const arc::uint8* data = &m_archive[0];
+    const arc::uint8* end = data + m_archive.size();
+    TaskSerialiser::skip(
+            data,
+            end,
+            TaskSerialiser::read_uint(data, end),
+            out
+    );
+}
+
+void Task::load_archive(const arc::uint8* data, std::size_t length)
+{
+    const arc::uint8* current = data;
+    const arc::uint8* end = data + length;
+    std::vector<arc::uint32> ids;
+    std::size_t done = TaskSerialiser::skip(
+            current,
+            end,
+            TaskSerialiser::read_uint(current, end),
+            ids
+    );
+    if(current != end)
+    {
+        throw arc::ex::ParseError("Unexpected data after the encoded Tasks");
+    }
+
+    ScopedBoardLock lock(m_board);
+
+    if(is_archived() || !m_children.empty())
+    {
+        throw arc::ex::IllegalActionError(
+                "Tasks can only be loaded as the children of a Task without "
+                "children"
         );
+    }
+    arc::uint32 max_id = 0;
+    ARC_CONST_FOR_EACH(it, ids)
+    {
+        if(m_board->m_tasks.find(*it) != m_board->m_tasks.end() ||
+           m_board->m_archived.find(*it) != m_board->m_archived.end())
+        {
+            throw arc::ex::ValueError(
+                    "Loaded Tasks cannot use the ids of existing Tasks");
+        }
+        max_id = std::max(max_id, *it);
+    }
 
-        assert(location != m_parent->m_children.end());
+    if(ids.empty())
+    {
+        return;
+    }
+    m_archive.assign(data, end);
+    ARC_CONST_FOR_EACH(it, ids)
+    {
+        m_board->m_archived[*it] = this;
+    }
+    adjust_descendant_counts(
+            static_cast<std::ptrdiff_t>(ids.size()),
+            static_cast<std::ptrdiff_t>(done)
+    );
+    invalidate_snapshot();
+
+    // ensure newly allocated ids can't collide with the loaded ids
+    m_board->m_domain->reserve_id(max_id);
+}
 
-        m_parent->m_children.erase(location);
+void Task::get_archived_snapshots(std::vector<TaskSnapshot::Ptr>& out) const
+{
+    // a decoded Task that is waiting for its children to be decoded
+    struct Pending
+    {
+        arc::uint32 id;
+        arc::str::UTF8String title;
+        TaskAttributes attributes;
+        arc::uint64 remaining;
+        std::vector<TaskSnapshot::Ptr> children;
+    };
+
+    const arc::uint8* data = &m_archive[0];
+    const arc::uint8* end = data + m_archive.size();
+    Pending archived;
+    archived.remaining = TaskSerialiser::read_uint(data, end);
+
+    // snapshots are built bottom up, each Task is only built once all of its
+    // children have been
+    std::vector<Pending> stack;
+    stack.push_back(archived);
+    while(stack.back().remaining > 0 || stack.size() > 1)
+    {
+        if(stack.back().remaining > 0)
+        {
+            --stack.back().remaining;
+            Pending pending;
+            pending.id =
+                static_cast<arc::uint32>(TaskSerialiser::read_uint(data, end));
+            pending.title = TaskSerialiser::read_string(data, end);
+            TaskSerialiser::read_attributes(data, end, pending.attributes);
+            pending.remaining = TaskSerialiser::read_uint(data, end);
+            stack.push_back(pending);
+            continue;
+        }
+
+        Pending& complete = stack.back();
+        TaskSnapshot::Ptr snapshot(new TaskSnapshot(
+                complete.id,
+                complete.title,
+                complete.attributes,
+                complete.children
+        ));
+        stack.pop_back();
+        stack.back().children.push_back(snapshot);
+    }
+    out.swap(stack.back().children);
+}
+
+bool Task::is_done() const
+{
+    // the attributes of a Task aren't valid until it has been registered
+    return m_id != 0 &&
+           m_board->m_attributes.get_status(m_dense_index) == STATUS_DONE;
+}
+
+void Task::adjust_descendant_counts(std::ptrdiff_t count, std::ptrdiff_t done)
+{
+    for(Task* task = this; task != nullptr; task = task->m_parent)
+    {
+        task->m_descendant_count += count;
+        task->m_done_descendant_count += done;
+    }
+}
+
+void Task::invalidate_snapshot()
+{
+    Task* task = this;
+    while(task != nullptr && task->m_snapshot)
+    {
+        // the root's snapshot may be read concurrently by RootTask::snapshot
+        if(task->m_parent == nullptr)
+        {
+            std::atomic_store(&task->m_snapshot, TaskSnapshot::Ptr());
+            break;
+        }
+        task->m_snapshot.reset();
+        task = task->m_parent;
+    }
+}
+
+void Task::record_change(ChangeRecord::Type type) const
+{
+    if(m_id == 0 || m_board == nullptr || m_board->m_suspended_changes > 0)
+    {
+        return;
+    }
+    ++m_board->m_mutation_count;
+    m_board->m_domain->get_changes().append(type, m_board->get_id(), m_id);
+}
+
+TaskSnapshot::Ptr Task::build_snapshot() const
+{
+    if(m_snapshot)
+    {
+        return m_snapshot;
+    }
+
+    std::vector<TaskSnapshot::Ptr> children;
+    if(is_archived())
+    {
+        get_archived_snapshots(children);
+    }
+    children.reserve(m_children.size());
+    ARC_CONST_FOR_EACH(it, m_children)
+    {
+        children.push_back((*it)->build_snapshot());
+    }
+
+    TaskSnapshot::Ptr snapshot(new TaskSnapshot(
+            m_id,
+            m_title,
+            get_attributes(),
+            children
+    ));
+    if(m_parent == nullptr)
+    {
+        std::atomic_store(&m_snapshot, snapshot);
+    }
+    else
+    {
+        m_snapshot = snapshot;
+    }
+    return snapshot;
+}
+
+void Task::update_ancestry() const
+{
+    // find the ancestors that are out of date, the ancestors above the first
+    // up to date Task are up to date too
+    arc::uint64 epoch = m_board->m_ancestry_epoch;
+    std::vector<const Task*> stale;
+    for(const Task* task = this;
+        task != nullptr && task->m_ancestry_epoch != epoch;
+        task = task->m_parent)
+    {
+        stale.push_back(task);
+    }
+
+    // update from the top down so each Task can build on its parent's
+    // ancestors
+    for(std::size_t i = stale.size(); i-- > 0;)
+    {
+        const Task* task = stale[i];
+        task->m_ancestors.clear();
+        task->m_depth = 0;
+        if(task->m_parent != nullptr)
+        {
+            task->m_depth = task->m_parent->m_depth + 1;
+            Task* ancestor = task->m_parent;
+            for(std::size_t k = 0; ancestor != nullptr; ++k)
+            {
+                task->m_ancestors.push_back(ancestor);
+                ancestor = k < ancestor->m_ancestors.size() ?
+                    ancestor->m_ancestors[k] :
+                    nullptr;
+            }
+        }
+        task->m_ancestry_epoch = epoch;
+    }
+}
+
+Task* Task::find_ancestor_at_depth(std::size_t depth) const
+{
+    update_ancestry();
+
+    const Task* task = this;
+    std::size_t distance = m_depth - depth;
+    for(std::size_t k = 0; distance != 0; ++k, distance >>= 1)
+    {
+        if(distance & 1)
+        {
+            task = task->m_ancestors[k];
+        }
+    }
+    return const_cast<Task*>(task);
+}
+
+Task* Task::find_common_ancestor_internal(const Task* other) const
+{
+    update_ancestry();
+    other->update_ancestry();
+
+    // lift the deeper Task to the depth of the other
+    const Task* a = this;
+    const Task* b = other;
+    if(a->m_depth > b->m_depth)
+    {
+        a = a->find_ancestor_at_depth(b->m_depth);
+    }
+    else if(b->m_depth > a->m_depth)
+    {
+        b = b->find_ancestor_at_depth(a->m_depth);
+    }
+    if(a == b)
+    {
+        return const_cast<Task*>(a);
+    }
+
+    // take the largest jumps that keep the Tasks apart, Tasks at the same
+    // depth have the same number of ancestors
+    for(std::size_t k = a->m_ancestors.size(); k-- > 0;)
+    {
+        if(k < a->m_ancestors.size() && a->m_ancestors[k] != b->m_ancestors[k])
+        {
+            a = a->m_ancestors[k];
+            b = b->m_ancestors[k];
+        }
+    }
+    return a->m_parent;
+}
+
+bool Task::has_descendant(Task* const descendant) const
+{
+    // check if any of direct children match
+    ARC_FOR_EACH(it, m_children)
+    {
+        if(*it == descendant || (*it)->has_descendant(descendant))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Task::clean_up()
+{
+    // a RootTask destroys its children while its lock is still alive so there
+    // is nothing to lock for the root itself
+    RootTask* board = nullptr;
+    if(m_board != nullptr && static_cast<Task*>(m_board) != this)
+    {
+        board = m_board;
+    }
+    ScopedBoardLock lock(board);
+
+    m_destroying = true;
+
+    // record the deletion at the top of the deleted subtree, before any of it
+    // is destroyed
+    if(board != nullptr &&
+       m_id != 0 &&
+       m_parent != nullptr &&
+       !m_parent->m_destroying)
+    {
+        board->get_history().record_deleted(this);
+    }
+
+    // remove this subtree from the completion of the ancestors while the
+    // statuses can still be read
+    if(m_parent != nullptr && !m_parent->m_destroying)
+    {
+        m_parent->adjust_descendant_counts(
+                -static_cast<std::ptrdiff_t>(m_descendant_count + 1),
+                -static_cast<std::ptrdiff_t>(
+                        m_done_descendant_count + is_done())
+        );
+    }
+
+    // the archived descendants can no longer be found through this Task
+    if(board != nullptr)
+    {
+        board->forget_loaded(this);
+    }
+    if(board != nullptr && is_archived())
+    {
+        std::vector<arc::uint32> ids;
+        get_archived_ids(ids);
+        ARC_CONST_FOR_EACH(it, ids)
+        {
+            board->m_archived.erase(*it);
+            if(!board->m_archiving)
+            {
+                board->m_domain->handle_task_destroyed(*it);
+            }
+        }
+    }
+
+    // copy the list of children since deleting them will cause modifications
+    // on this Task's list of children
+    std::vector<Task*> children_copy(m_children);
+
+    // iterate over children and delete them
+    ARC_FOR_EACH(it, children_copy)
+    {
+        delete *it;
+    }
+    children_copy.clear();
+    std::size_t children_count = m_children.size();
+    m_children.clear();
+    if(board != nullptr)
+    {
+        recount_children(children_count);
+    }
+
+    // fire callback, archived Tasks still exist
+    if(board != nullptr && board->m_archiving)
+    {
+        board->m_domain->handle_task_archived(this);
+    }
+    else
+    {
+        // a RootTask fires its callback as it destroys its children, Tasks
+        // that failed to be created without a board have no domain
+        if(board != nullptr)
+        {
+            record_change(ChangeRecord::DESTROYED);
+            board->m_domain->handle_task_destroyed(m_id);
+            board->m_domain->m_destroyed_callback.trigger(this);
+        }
+    }
+
+    if(board != nullptr && m_id != 0)
+    {
+        board->unregister_task(this);
+    }
+
+    // clean up this task from it's parent (if it has one), a parent that is
+    // being destroyed clears its own children
+    if(m_parent != nullptr && !m_parent->m_destroying)
+    {
+        m_parent->m_children.erase(
+                m_parent->m_children.begin() +
+                m_parent->find_child_index(this)
+        );
+        m_parent->recount_children(m_parent->m_children.size() + 1);
+        m_parent->invalidate_snapshot();
     }
 }
 
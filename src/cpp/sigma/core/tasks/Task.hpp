@@ -5,11 +5,17 @@
 #ifndef SIGMA_CORE_TASKS_TASK_HPP_
 #define SIGMA_CORE_TASKS_TASK_HPP_
 
+#include <atomic>
 #include <cstddef>
+#include <functional>
+#include <string>
 
 #include <arcanecore/base/str/UTF8String.hpp>
 
 #include "sigma/core/Callback.hpp"
+#include "sigma/core/tasks/ChangeFeed.hpp"
+#include "sigma/core/tasks/TaskAttributes.hpp"
+#include "sigma/core/tasks/TaskSnapshot.hpp"
 
 namespace sigma
 {
@@ -18,10 +24,55 @@ namespace core
 namespace tasks
 {
 
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class RootTask;
+class Task;
+
+//------------------------------------------------------------------------------
+//                                  ENUMERATORS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief The built-in orderings the children of a Task can be sorted by, see
+ *        Task::sort_children().
+ */
+enum TaskOrdering
+{
+    /// Alphabetical by title, ignoring case.
+    ORDER_BY_TITLE,
+    /// Highest priority first.
+    ORDER_BY_PRIORITY,
+    /// Earliest due date first, Tasks without a due date last.
+    ORDER_BY_DUE_DATE
+};
+
+//------------------------------------------------------------------------------
+//                                    TYPEDEFS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Returns whether the first Task should be ordered before the second.
+ */
+typedef std::function<bool(const Task*, const Task*)> TaskComparator;
+
 /*!
  * \brief TODO
  *
  * TODO: about deleting
+ *
+ * \par Thread Safety
+ *
+ * Every Task belongs to the board of a single RootTask, and each board has its
+ * own sigma::core::util::ReadWriteLock (see RootTask::get_lock()). Functions
+ * that modify a Task acquire the write lock of the board (or boards) they
+ * affect, so different boards can be modified from different threads in
+ * parallel. Functions that only read a Task do not lock, callers that read a
+ * board while another thread may be modifying it should hold a
+ * sigma::core::util::ScopedReadLock on the board's lock for the duration of
+ * the read.
  */
 class Task
 {
@@ -93,6 +144,13 @@ public:
      */
     virtual bool is_root() const;
 
+    /*!
+     * \brief Returns the RootTask of the board this Task belongs to.
+     *
+     * For a RootTask this returns itself.
+     */
+    RootTask* get_board() const;
+
     /*!
      * \brief Returns the parent Task of this Task.
      *
@@ -100,22 +158,129 @@ public:
      */
     Task* const get_parent() const;
 
+    /*!
+     * \brief Returns the number of ancestors this Task has, a RootTask has a
+     *        depth of 0.
+     */
+    std::size_t get_depth() const;
+
+    /*!
+     * \brief Returns the ancestor of this Task at the given depth.
+     *
+     * Ancestors are found through an index of each Task's ancestors at
+     * power-of-two distances, so this takes O(log depth) time rather than
+     * walking the parents one at a time. The index is maintained lazily, after
+     * a Task on the board has been moved the index is rebuilt as Tasks are
+     * queried.
+     *
+     * \return The ancestor, or this Task if the depth is the depth of this
+     *         Task.
+     *
+     * \throws arc::ex::ValueError If the depth is greater than the depth of
+     *                             this Task.
+     */
+    Task* get_ancestor_at_depth(std::size_t depth) const;
+
+    /*!
+     * \brief Returns the deepest Task that is both this Task or one of its
+     *        ancestors, and the given Task or one of its ancestors.
+     *
+     * This takes O(log depth) time, see get_ancestor_at_depth(). Use
+     * RootTask::find_common_ancestors() to find the common ancestors of many
+     * pairs of Tasks.
+     *
+     * \return The common ancestor, or null if the given Task is null or on a
+     *         different board.
+     */
+    Task* find_common_ancestor(const Task* other) const;
+
+    /*!
+     * \brief Returns the number of Tasks below this Task in the hierarchy.
+     */
+    std::size_t get_descendant_count() const;
+
+    /*!
+     * \brief Returns the number of Tasks below this Task in the hierarchy that
+     *        have the status STATUS_DONE.
+     */
+    std::size_t get_done_descendant_count() const;
+
+    /*!
+     * \brief Returns the fraction of this Task that is complete, between 0 and
+     *        1.
+     *
+     * For a Task with descendants this is the fraction of its descendants that
+     * are done, otherwise it is 1 if this Task is done and 0 if not. The counts
+     * are maintained by the ancestors of each Task as statuses change and
+     * Tasks are moved or deleted, so this takes constant time.
+     */
+    float get_completion() const;
+
     /*!
      * \brief Sets the parent Task of this Task.
      *
+     * \warning If the parent belongs to a different board the move can't be
+     *          undone, and the undo and redo steps of both boards are
+     *          discarded, see TaskHistory.
+     *
      * \throws arc::ex::ValueError If ``parent`` is null. // TODO: REMOVE ME
      * \throws arc::ex::IllegalActionError If the given parent is already a
      *                                       descendant of this Task.
      */
     virtual void set_parent(Task* const parent);
 
+    /*!
+     * \brief Moves this Task so that it's positioned directly before the given
+     *        sibling.
+     *
+     * If the sibling has a different parent to this Task, this Task is
+     * reparented to the sibling's parent. Only the order key of this Task is
+     * changed, unless the keys of the siblings need rebalancing (see
+     * get_order_key()).
+     *
+     * \throws arc::ex::ValueError If ``sibling`` is null.
+     * \throws arc::ex::IllegalActionError If this is a RootTask, the sibling is
+     *                                       a RootTask, or the sibling is a
+     *                                       descendant of this Task.
+     */
+    void move_before(Task* const sibling);
+
+    /*!
+     * \brief Moves this Task so that it's positioned directly after the given
+     *        sibling.
+     *
+     * See move_before().
+     */
+    void move_after(Task* const sibling);
+
+    /*!
+     * \brief Returns the key which defines the position of this Task among its
+     *        siblings.
+     *
+     * The children of a Task are always ordered by ascending order keys.
+     * Keys are spaced apart so that a Task can be positioned between two
+     * siblings by only assigning it the key halfway between theirs, leaving
+     * the keys of all other siblings untouched. When there is no space left
+     * between two keys the keys of all the siblings are spread out again,
+     * which only happens after many insertions at the same position.
+     */
+    arc::uint64 get_order_key() const;
+
     /*!
      * \brief Returns the number of Tasks that have this Task as their parent.
+     *
+     * This does not rehydrate the children of an archived Task.
      */
     std::size_t get_children_count() const;
 
     /*!
      * \brief Returns the Tasks that have this Task as their parent.
+     *
+     * If this Task is archived its children are rehydrated first, which
+     * takes the write lock of the board.
+     *
+     * \throws arc::ex::StateError If this Task is archived and the calling
+     *                             thread holds a read lock on the board.
      */
     const std::vector<Task*>& get_chidren() const;
 
@@ -169,6 +334,84 @@ public:
      */
     void clear_children();
 
+    /*!
+     * \brief Reorders the children of this Task using the given comparator.
+     *
+     * The sort is stable, so children the comparator considers equal keep
+     * their relative order. Large sets of children are sorted by multiple
+     * threads, so the comparator must be safe to call concurrently and must
+     * not modify the board.
+     *
+     * The whole reorder is recorded in the board's TaskHistory as a single
+     * operation and on_children_reordered() is fired once for this Task,
+     * rather than once for each child that moved.
+     *
+     * \throws arc::ex::ValueError If the comparator is empty.
+     */
+    void sort_children(const TaskComparator& comparator);
+
+    /*!
+     * \brief Reorders the children of this Task by one of the built-in
+     *        orderings.
+     *
+     * Sorting by title compares case folded keys which are computed once per
+     * title and cached until the title changes, so sorting doesn't decode the
+     * titles for every comparison.
+     */
+    void sort_children(TaskOrdering ordering);
+
+    /*!
+     * \brief Moves the descendants of this Task into cold storage.
+     *
+     * The descendants are encoded with TaskSerialiser into a single buffer
+     * held by this Task and are then destroyed, leaving this Task as a stub
+     * that only keeps its own title and attributes resident. Long finished
+     * parts of a board can be archived so that the memory used by the board
+     * follows the Tasks that are still active.
+     *
+     * Archived Tasks are rehydrated transparently when they are needed again:
+     * by get_chidren(), by adding a child to this Task, by looking up one of
+     * them with RootTask::find_task() (which includes undoing their changes),
+     * and by searching the board. Other information about the descendants is
+     * kept without rehydrating them, such as get_children_count(),
+     * get_completion(), get_hash() and snapshots of the board.
+     *
+     * Rehydrating only creates the children of this Task, each child keeps
+     * its own descendants archived until they are accessed. Boards can also
+     * limit how many Tasks are resident by archiving the least recently used
+     * subtrees again, see RootTask::set_resident_budget().
+     *
+     * Archiving and rehydrating are not recorded in the board's TaskHistory.
+     *
+     * \warning Rehydrated Tasks are new objects with the same ids as the
+     *          archived Tasks, so pointers to archived Tasks are invalid.
+     *          Since the Tasks aren't deleted the destroyed and created
+     *          callbacks of the domain are not fired for them and their
+     *          dependencies and tags (see TasksDomain) are kept. Reminders
+     *          for their due dates are scheduled again once they are
+     *          rehydrated.
+     *
+     * \warning Rehydrating requires the write lock of the board, so archived
+     *          Tasks must not be accessed while holding only a read lock on
+     *          their board, doing so throws arc::ex::StateError.
+     *
+     * \return False if this Task has no children or is already archived.
+     */
+    bool archive();
+
+    /*!
+     * \brief Returns whether the descendants of this Task are archived, see
+     *        archive().
+     */
+    bool is_archived() const;
+
+    /*!
+     * \brief Recreates the archived children of this Task, see archive().
+     *
+     * This does nothing if this Task is not archived.
+     */
+    void rehydrate();
+
     /*!
      * \brief Returns the title string of this Task.
      */
@@ -179,39 +422,113 @@ public:
      */
     virtual void set_title(const arc::str::UTF8String& title);
 
-    //--------------------------------------------------------------------------
-    //                              CALLBACK EVENTS
-    //--------------------------------------------------------------------------
+    /*!
+     * \brief Returns the hash of this Task and its descendants.
+     *
+     * See TaskSnapshot::get_hash(). The hash is cached and only recomputed
+     * for Tasks that have been modified (or have modified descendants) since
+     * it was last computed.
+     */
+    arc::uint64 get_hash() const;
 
-    //----------------------------------GLOBAL----------------------------------
+    /*!
+     * \brief Returns the values of all of the typed attributes of this Task.
+     */
+    TaskAttributes get_attributes() const;
 
     /*!
-     * \brief For registering callbacks that handle when a new Task is created.
+     * \brief Sets the values of all of the typed attributes of this Task.
      *
-     * Relevant callback functions take one argument:
-     * - ``Task*`` - the Task that has just been created.
+     * \throws arc::ex::ValueError If the given attributes are not valid.
      */
-    static sigma::core::CallbackInterface<Task*>* on_created()
-    {
-        return &s_created_callback.get_interface();
-    }
+    void set_attributes(const TaskAttributes& attributes);
 
     /*!
-     * \brief For registering callbacks that handle when a Task is destroyed.
+     * \brief Returns the progress state of this Task.
+     */
+    TaskStatus get_status() const;
+
+    /*!
+     * \brief Sets the progress state of this Task.
      *
-     * Relevant callback functions take one argument:
-     * - ``Task*`` - the Task that is about to be destroyed.
+     * \throws arc::ex::ValueError If the status is not a TaskStatus value.
+     */
+    void set_status(TaskStatus status);
+
+    /*!
+     * \brief Returns the priority of this Task.
+     */
+    TaskPriority get_priority() const;
+
+    /*!
+     * \brief Sets the priority of this Task.
      *
-     * \warning Exceptions should be avoided in registered callback functions
-     *          since these functions will be called from within a Task's
-     *          destructor.
+     * \throws arc::ex::ValueError If the priority is not a TaskPriority value.
      */
-    static sigma::core::CallbackInterface<Task*>* on_destroyed()
-    {
-        return &s_destroyed_callback.get_interface();
-    }
+    void set_priority(TaskPriority priority);
+
+    /*!
+     * \brief Returns the estimated time to complete this Task in minutes, or 0
+     *        if there is no estimate.
+     */
+    arc::uint32 get_estimate() const;
+
+    /*!
+     * \brief Sets the estimated time to complete this Task in minutes, 0
+     *        removes the estimate.
+     */
+    void set_estimate(arc::uint32 minutes);
+
+    /*!
+     * \brief Returns the name this Task is assigned to, or an empty string if
+     *        it is not assigned.
+     */
+    const arc::str::UTF8String& get_assignee() const;
+
+    /*!
+     * \brief Assigns this Task to the given name, an empty name unassigns the
+     *        Task.
+     */
+    void set_assignee(const arc::str::UTF8String& assignee);
+
+    /*!
+     * \brief Returns whether this Task has a due date.
+     */
+    bool has_due_date() const;
+
+    /*!
+     * \brief Returns the due date of this Task in seconds since the Unix epoch.
+     *
+     * \throws arc::ex::StateError If this Task has no due date.
+     */
+    arc::int64 get_due_date() const;
+
+    /*!
+     * \brief Sets the due date of this Task in seconds since the Unix epoch.
+     */
+    void set_due_date(arc::int64 due_date);
 
-    //----------------------------------LOCAL-----------------------------------
+    /*!
+     * \brief Removes the due date of this Task.
+     */
+    void clear_due_date();
+
+    /*!
+     * \brief Returns whether the given TaskFlag is set on this Task.
+     */
+    bool has_flag(TaskFlag flag) const;
+
+    /*!
+     * \brief Sets or clears the given TaskFlag on this Task.
+     */
+    void set_flag(TaskFlag flag, bool value);
+
+    //--------------------------------------------------------------------------
+    //                              CALLBACK EVENTS
+    //--------------------------------------------------------------------------
+
+    // the callbacks for the creation and destruction of any Task are
+    // registered with its domain, see TasksDomain::on_task_created()
 
     /*!
      * \brief For registering callbacks that handle when a Task has its parent
@@ -247,8 +564,50 @@ public:
         return &m_title_changed_callback.get_interface();
     }
 
+    /*!
+     * \brief For registering callbacks that handle when a Task has any of its
+     *        typed attributes changed.
+     *
+     * Relevant callback functions take three arguments:
+     * - ``Task*`` - the Task thats attributes have changed.
+     * - ``const TaskAttributes&`` - the previous attributes of the Task.
+     * - ``const TaskAttributes&`` - the new attributes of the Task.
+     */
+    sigma::core::CallbackInterface<
+            Task*,
+            const TaskAttributes&,
+            const TaskAttributes&>*
+    on_attributes_changed()
+    {
+        return &m_attributes_changed_callback.get_interface();
+    }
+
+    /*!
+     * \brief For registering callbacks that handle when the children of a
+     *        Task have been reordered by sort_children().
+     *
+     * Relevant callback functions take one argument:
+     * - ``Task*`` - the Task thats children were reordered.
+     */
+    sigma::core::CallbackInterface<Task*>* on_children_reordered()
+    {
+        return &m_children_reordered_callback.get_interface();
+    }
+
 protected:
 
+    //--------------------------------------------------------------------------
+    //                                  FRIENDS
+    //--------------------------------------------------------------------------
+
+    friend class AttributeTable;
+    friend class BoardFile;
+    friend class RootTask;
+    friend class TaskHistory;
+    friend class TaskMerge;
+    friend class TaskQuery;
+    friend class TaskSerialiser;
+
     //--------------------------------------------------------------------------
     //                           PROTECTED CONSTRUCTOR
     //--------------------------------------------------------------------------
@@ -260,8 +619,9 @@ protected:
      * creates a Task which has a null parent.
      *
      * \param title The title of the task.
+     * \param id The id of the task, allocated by the board's domain.
      */
-    Task(const arc::str::UTF8String& title);
+    Task(const arc::str::UTF8String& title, arc::uint32 id);
 
     //--------------------------------------------------------------------------
     //                            PROTECTED ATTRIBUTES
@@ -271,19 +631,39 @@ protected:
      * \brief The title of this task.
      */
     arc::str::UTF8String m_title;
+    /*!
+     * \brief The RootTask of the board this task belongs to.
+     */
+    RootTask* m_board;
+    /*!
+     * \brief The case folded title of this Task used to sort by title, or
+     *        empty if it hasn't been computed since the title last changed.
+     */
+    mutable std::string m_collation_key;
 
 private:
 
     //--------------------------------------------------------------------------
-    //                          PRIVATE STATIC VARIABLES
+    //                          PRIVATE STATIC CONSTANTS
     //--------------------------------------------------------------------------
 
-    // global id counter
-    static arc::uint32 s_id;
+    /*!
+     * \brief Child index used to signify a Task should be added after the
+     *        existing children of its parent.
+     */
+    static const std::size_t APPEND;
+
+    /*!
+     * \brief The spacing between the order keys of consecutive children when
+     *        they are appended or rebalanced.
+     */
+    static const arc::uint64 ORDER_KEY_GAP;
 
-    // global callback handlers
-    static sigma::core::CallbackHandler<Task*> s_created_callback;
-    static sigma::core::CallbackHandler<Task*> s_destroyed_callback;
+    /*!
+     * \brief The number of children above which sort_children() sorts with
+     *        multiple threads.
+     */
+    static const std::size_t PARALLEL_SORT_THRESHOLD;
 
     //--------------------------------------------------------------------------
     //                             PRIVATE ATTRIBUTES
@@ -293,6 +673,15 @@ private:
      * \brief The globally unique identifier of this task.
      */
     arc::uint32 m_id;
+    /*!
+     * \brief The index of this Task in the AttributeTable of its board.
+     */
+    arc::uint32 m_dense_index;
+    /*!
+     * \brief The position of this Task among its siblings, see
+     *        get_order_key().
+     */
+    arc::uint64 m_order_key;
 
     /*!
      * \brief TODO:
@@ -302,6 +691,50 @@ private:
      * \brief TODO:
      */
     std::vector<Task*> m_children;
+    /*!
+     * \brief The encoded descendants of this Task while it is archived, this
+     *        is the number of children followed by the TaskSerialiser encoding
+     *        of each child, or empty if this Task is not archived.
+     */
+    std::vector<arc::uint8> m_archive;
+
+    /*!
+     * \brief The cached depth of this Task, see get_depth().
+     */
+    mutable std::size_t m_depth;
+    /*!
+     * \brief The cached ancestors of this Task, where element k is the
+     *        ancestor 2^k levels above this Task.
+     */
+    mutable std::vector<Task*> m_ancestors;
+    /*!
+     * \brief The ancestry epoch of the board when m_depth and m_ancestors were
+     *        computed, they are only valid while this matches the board.
+     */
+    mutable arc::uint64 m_ancestry_epoch;
+
+    /*!
+     * \brief The number of descendants of this Task.
+     */
+    std::size_t m_descendant_count;
+    /*!
+     * \brief The number of descendants of this Task that are done.
+     */
+    std::size_t m_done_descendant_count;
+
+    /*!
+     * \brief The persistent snapshot of this Task and its descendants.
+     *
+     * This is reset whenever this Task or any of its descendants are modified
+     * and rebuilt lazily by build_snapshot(). If this is null then the
+     * snapshots of all ancestors are null too.
+     */
+    mutable TaskSnapshot::Ptr m_snapshot;
+
+    /*!
+     * \brief Whether this Task is in the process of being destroyed.
+     */
+    bool m_destroying;
 
 
     // TODO: brief
@@ -318,19 +751,145 @@ private:
             const arc::str::UTF8String&,
             const arc::str::UTF8String&> m_title_changed_callback;
     sigma::core::CallbackHandler<Task*, Task*, Task*> m_parent_changed_callback;
+    sigma::core::CallbackHandler<
+            Task*,
+            const TaskAttributes&,
+            const TaskAttributes&> m_attributes_changed_callback;
+    sigma::core::CallbackHandler<Task*> m_children_reordered_callback;
+
+    //--------------------------------------------------------------------------
+    //                            PRIVATE CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Restoring constructor.
+     *
+     * Recreates a Task that previously existed with the given id, this is used
+     * to restore Tasks that have been serialised. The creation is not recorded
+     * in the board's TaskHistory.
+     *
+     * \param parent The Task this will be a child of.
+     * \param title The title of the task.
+     * \param id The id the Task had previously.
+     * \param index The position in the parent's children to insert this Task
+     *              at.
+     */
+    Task(
+            Task* parent,
+            const arc::str::UTF8String& title,
+            arc::uint32 id,
+            std::size_t index);
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Adds the change in the bytes used by the callbacks registered
+     *        with the given Task to the statistics of its board.
+     *
+     * This observes the local callback handlers of every Task, see
+     * observe_callbacks().
+     */
+    static void count_callback_usage(void* task, std::ptrdiff_t bytes);
 
     //--------------------------------------------------------------------------
     //                          PRIVATE MEMBER FUNCTIONS
     //--------------------------------------------------------------------------
 
+    /*!
+     * \brief Makes the local callback handlers of this Task report callbacks
+     *        being registered and unregistered to the statistics of its
+     *        board.
+     */
+    void observe_callbacks();
+
+    /*!
+     * \brief Returns the approximate number of bytes used by the callbacks
+     *        registered with this Task.
+     */
+    std::size_t get_callback_usage() const;
+
+    /*!
+     * \brief Updates the statistics of this Task's board once the number of
+     *        children of this Task has changed from the given number.
+     *
+     * Nothing is counted for Tasks that haven't been assigned an id yet.
+     */
+    void recount_children(std::size_t previous);
+
     /*!
      * \brief Internal function that sets this Task's parent but does not fire
      *        a callback.
      *
      * This function handles state checking and children assignment of the
      * parent task.
+     *
+     * \param parent The new parent of this Task.
+     * \param index The position in the parent's children to insert this Task
+     *              at, by default this Task is added after the existing
+     *              children. If the parent is unchanged this Task is only
+     *              repositioned when an explicit index is given.
+     */
+    void set_parent_internal(Task* const parent, std::size_t index = APPEND);
+
+    /*!
+     * \brief Moves this Task to the given position of the given parent and
+     *        fires the parent changed callback if the parent changed, without
+     *        recording the move.
      */
-    void set_parent_internal(Task* const parent);
+    void move_internal(Task* const parent, std::size_t index);
+
+    /*!
+     * \brief Moves this Task to the position of the given sibling, offset by
+     *        the given number of places, and records the move.
+     */
+    void move_next_to(Task* const sibling, std::size_t offset);
+
+    /*!
+     * \brief Returns the position of the given child in this Task's children.
+     *
+     * The position is found by a binary search of the children's order keys.
+     */
+    std::size_t find_child_index(const Task* child) const;
+
+    /*!
+     * \brief Returns the order key a child inserted at the given position of
+     *        this Task's children should have.
+     *
+     * If there's no space between the keys of the neighbouring children, the
+     * keys of all of the children are rebalanced first.
+     */
+    arc::uint64 allocate_order_key(std::size_t index);
+
+    /*!
+     * \brief Spreads the order keys of this Task's children evenly.
+     */
+    void rebalance_order_keys();
+
+    /*!
+     * \brief Reorders this Task's children to the given order, records the
+     *        reorder and fires the children reordered callback.
+     *
+     * Nothing happens if the order hasn't changed.
+     */
+    void reorder_children(const std::vector<Task*>& children);
+
+    /*!
+     * \brief Reorders this Task's children to the given order and fires the
+     *        children reordered callback, without recording the reorder.
+     *
+     * \param children The children of this Task in their new order.
+     *
+     * \throws arc::ex::StateError If the number of children differs.
+     */
+    void reorder_children_internal(const std::vector<Task*>& children);
+
+    /*!
+     * \brief Returns the case folded title of this Task, computing it if it
+     *        isn't cached.
+     */
+    const std::string& get_collation_key() const;
 
     /*!
      * \brief Internal function that sets this Task's title but does not fire a
@@ -340,6 +899,111 @@ private:
      */
     void set_title_internal(const arc::str::UTF8String& title);
 
+    /*!
+     * \brief Internal function that stores this Task's attributes in the
+     *        board's AttributeTable but does not record the change or fire the
+     *        local callback.
+     */
+    void set_attributes_internal(const TaskAttributes& attributes);
+
+    /*!
+     * \brief Sets the board of this Task and all of its descendants.
+     *
+     * This is used when a Task is moved under a parent that belongs to a
+     * different board.
+     */
+    void set_board_internal(RootTask* board);
+
+    /*!
+     * \brief Archives the descendants of this Task without locking.
+     */
+    bool archive_internal();
+
+    /*!
+     * \brief Recreates the archived children of this Task without locking or
+     *        enforcing the resident budget of the board.
+     */
+    void rehydrate_internal();
+
+    /*!
+     * \brief Makes data written by TaskSerialiser::serialise_children() the
+     *        archive of this Task, see TaskSerialiser::load_children().
+     */
+    void load_archive(const arc::uint8* data, std::size_t length);
+
+    /*!
+     * \brief Appends the ids of the archived descendants of this Task to the
+     *        given vector.
+     */
+    void get_archived_ids(std::vector<arc::uint32>& out) const;
+
+    /*!
+     * \brief Decodes snapshots of the archived children of this Task into the
+     *        given vector, without rehydrating them.
+     */
+    void get_archived_snapshots(std::vector<TaskSnapshot::Ptr>& out) const;
+
+    /*!
+     * \brief Returns whether this Task is registered with its board and has
+     *        the status STATUS_DONE.
+     */
+    bool is_done() const;
+
+    /*!
+     * \brief Adds the given number of descendants, and of done descendants, to
+     *        the counts of this Task and all of its ancestors.
+     *
+     * Negative values remove descendants.
+     */
+    void adjust_descendant_counts(std::ptrdiff_t count, std::ptrdiff_t done);
+
+    /*!
+     * \brief Discards the cached snapshots of this Task and its ancestors.
+     *
+     * This stops at the first Task that has no cached snapshot since its
+     * ancestors are guaranteed to have already been invalidated.
+     */
+    void invalidate_snapshot();
+
+    /*!
+     * \brief Appends a change to this Task to the feed of its board's domain.
+     *
+     * Nothing is recorded for Tasks that haven't been assigned an id yet, or
+     * while the board has suspended changes.
+     */
+    void record_change(ChangeRecord::Type type) const;
+
+    /*!
+     * \brief Returns the persistent snapshot of this Task, rebuilding it and
+     *        any modified descendants if it has been invalidated.
+     *
+     * Unmodified descendants reuse their existing snapshots, but each rebuilt
+     * snapshot copies the snapshot pointers of all of its children, so this
+     * is linear in the fan-out of every rebuilt Task. The caller must hold
+     * the read lock of the board.
+     */
+    TaskSnapshot::Ptr build_snapshot() const;
+
+    /*!
+     * \brief Recomputes the ancestry of this Task and any of its ancestors
+     *        if they are out of date.
+     *
+     * The caller must hold the board's ancestry mutex.
+     */
+    void update_ancestry() const;
+
+    /*!
+     * \brief Returns the ancestor at the given depth, which must not be greater
+     *        than the depth of this Task, without locking.
+     */
+    Task* find_ancestor_at_depth(std::size_t depth) const;
+
+    /*!
+     * \brief Returns the common ancestor of this Task and the given Task on the
+     *        same board, without locking.
+     */
+    Task* find_common_ancestor_internal(const Task* other) const;
+
     /*!
      * \brief Checks whether this task has the given task as a child.
      *
@@ -0,0 +1,69 @@
+#include "sigma/core/tasks/TaskAttributes.hpp"
+
+#include <arcanecore/base/Exceptions.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+TaskAttributes::TaskAttributes()
+    :
+    status      (STATUS_OPEN),
+    priority    (PRIORITY_NONE),
+    estimate    (0),
+    has_due_date(false),
+    due_date    (0),
+    flags       (0)
+{
+}
+
+//------------------------------------------------------------------------------
+//                                   OPERATORS
+//------------------------------------------------------------------------------
+
+bool TaskAttributes::operator==(const TaskAttributes& other) const
+{
+    return status       == other.status       &&
+           priority     == other.priority     &&
+           estimate     == other.estimate     &&
+           assignee     == other.assignee     &&
+           has_due_date == other.has_due_date &&
+           (!has_due_date || due_date == other.due_date) &&
+           flags        == other.flags;
+}
+
+bool TaskAttributes::operator!=(const TaskAttributes& other) const
+{
+    return !((*this) == other);
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void TaskAttributes::validate() const
+{
+    if(status < STATUS_OPEN || status > STATUS_DONE)
+    {
+        throw arc::ex::ValueError("Invalid Task status");
+    }
+    if(priority < PRIORITY_NONE || priority > PRIORITY_HIGH)
+    {
+        throw arc::ex::ValueError("Invalid Task priority");
+    }
+    if((flags & ~static_cast<arc::uint32>(FLAG_ALL)) != 0)
+    {
+        throw arc::ex::ValueError("Invalid Task flags");
+    }
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
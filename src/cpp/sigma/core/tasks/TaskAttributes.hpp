@@ -0,0 +1,129 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief The typed attributes every Task carries in addition to its title.
+ */
+#ifndef SIGMA_CORE_TASKS_TASKATTRIBUTES_HPP_
+#define SIGMA_CORE_TASKS_TASKATTRIBUTES_HPP_
+
+#include <arcanecore/base/Types.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                                  ENUMERATORS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief The progress states a Task can be in.
+ */
+enum TaskStatus
+{
+    /// The Task has not been started.
+    STATUS_OPEN        = 0,
+    /// The Task is being worked on.
+    STATUS_IN_PROGRESS = 1,
+    /// The Task cannot progress until something else is resolved.
+    STATUS_BLOCKED     = 2,
+    /// The Task has been completed.
+    STATUS_DONE        = 3
+};
+
+/*!
+ * \brief The priorities a Task can have, higher values are more important.
+ */
+enum TaskPriority
+{
+    /// The Task has not been prioritised.
+    PRIORITY_NONE   = 0,
+    PRIORITY_LOW    = 1,
+    PRIORITY_MEDIUM = 2,
+    PRIORITY_HIGH   = 3
+};
+
+/*!
+ * \brief Boolean markers that can be combined on a Task.
+ */
+enum TaskFlag
+{
+    /// The Task has been starred by the user.
+    FLAG_STARRED   = 1 << 0,
+    /// The Task marks a significant point of the board.
+    FLAG_MILESTONE = 1 << 1,
+    /// All of the valid flags.
+    FLAG_ALL       = FLAG_STARRED | FLAG_MILESTONE
+};
+
+/*!
+ * \brief The values of the typed attributes of a single Task.
+ *
+ * Within a board these values are not stored per Task but in the columns of
+ * the board's AttributeTable, this structure is only used to pass the values
+ * of a Task around as a whole.
+ */
+struct TaskAttributes
+{
+    //--------------------------------------------------------------------------
+    //                                 ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /// The progress state of the Task.
+    TaskStatus status;
+    /// The priority of the Task.
+    TaskPriority priority;
+    /// The estimated time to complete the Task in minutes, 0 if there is no
+    /// estimate.
+    arc::uint32 estimate;
+    /// The name of the person the Task is assigned to, empty if the Task is
+    /// not assigned.
+    arc::str::UTF8String assignee;
+    /// Whether the Task has a due date.
+    bool has_due_date;
+    /// The due date of the Task in seconds since the Unix epoch, this is only
+    /// meaningful if has_due_date is true.
+    arc::int64 due_date;
+    /// The TaskFlag values set on the Task.
+    arc::uint32 flags;
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates the attributes of a newly created Task: open, not
+     *        prioritised, estimated, assigned, or due and with no flags.
+     */
+    TaskAttributes();
+
+    //--------------------------------------------------------------------------
+    //                                 OPERATORS
+    //--------------------------------------------------------------------------
+
+    bool operator==(const TaskAttributes& other) const;
+
+    bool operator!=(const TaskAttributes& other) const;
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Checks that these values are valid.
+     *
+     * \throws arc::ex::ValueError If the status, priority or flags are not
+     *                             valid enumerator values.
+     */
+    void validate() const;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
@@ -0,0 +1,629 @@
+#include "sigma/core/tasks/TaskBitmap.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+#include <arcanecore/base/Preproc.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Returns the index of the lowest set bit of a non-zero word.
+ */
+inline std::size_t lowest_bit(arc::uint64 word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return static_cast<std::size_t>(__builtin_ctzll(word));
+#endif
+}
+
+/*!
+ * \brief Returns the number of set bits of a word.
+ */
+inline std::size_t count_bits(arc::uint64 word)
+{
+#ifdef _MSC_VER
+    return static_cast<std::size_t>(__popcnt64(word));
+#else
+    return static_cast<std::size_t>(__builtin_popcountll(word));
+#endif
+}
+
+/*!
+ * \brief Returns the number of set bits of the given words.
+ */
+std::size_t count_bits(const std::vector<arc::uint64>& words)
+{
+    std::size_t total = 0;
+    ARC_CONST_FOR_EACH(word, words)
+    {
+        total += count_bits(*word);
+    }
+    return total;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+TaskBitmap::TaskBitmap()
+{
+}
+
+//------------------------------------------------------------------------------
+//                                   OPERATORS
+//------------------------------------------------------------------------------
+
+bool TaskBitmap::operator==(const TaskBitmap& other) const
+{
+    // chunks are always in the form determined by their cardinality
+    if(m_chunks.size() != other.m_chunks.size())
+    {
+        return false;
+    }
+    for(std::size_t i = 0; i < m_chunks.size(); ++i)
+    {
+        const Chunk& a = m_chunks[i];
+        const Chunk& b = other.m_chunks[i];
+        if(a.key != b.key                 ||
+           a.cardinality != b.cardinality ||
+           a.array != b.array             ||
+           a.bits != b.bits)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TaskBitmap::operator!=(const TaskBitmap& other) const
+{
+    return !((*this) == other);
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool TaskBitmap::add(arc::uint32 id)
+{
+    arc::uint16 key = static_cast<arc::uint16>(id >> 16);
+    arc::uint16 low = static_cast<arc::uint16>(id & 0xFFFF);
+
+    std::vector<Chunk>::iterator chunk = find_chunk(key);
+    if(chunk == m_chunks.end() || chunk->key != key)
+    {
+        Chunk created;
+        created.key = key;
+        created.cardinality = 1;
+        created.array.push_back(low);
+        m_chunks.insert(chunk, created);
+        return true;
+    }
+
+    if(chunk->is_bitset())
+    {
+        arc::uint64& word = chunk->bits[low >> 6];
+        arc::uint64 bit = 1ULL << (low & 63);
+        if((word & bit) != 0)
+        {
+            return false;
+        }
+        word |= bit;
+    }
+    else
+    {
+        std::vector<arc::uint16>::iterator position =
+            std::lower_bound(chunk->array.begin(), chunk->array.end(), low);
+        if(position != chunk->array.end() && *position == low)
+        {
+            return false;
+        }
+        chunk->array.insert(position, low);
+    }
+    ++chunk->cardinality;
+    optimise(*chunk);
+    return true;
+}
+
+bool TaskBitmap::remove(arc::uint32 id)
+{
+    arc::uint16 key = static_cast<arc::uint16>(id >> 16);
+    arc::uint16 low = static_cast<arc::uint16>(id & 0xFFFF);
+
+    std::vector<Chunk>::iterator chunk = find_chunk(key);
+    if(chunk == m_chunks.end() || chunk->key != key)
+    {
+        return false;
+    }
+
+    if(chunk->is_bitset())
+    {
+        arc::uint64& word = chunk->bits[low >> 6];
+        arc::uint64 bit = 1ULL << (low & 63);
+        if((word & bit) == 0)
+        {
+            return false;
+        }
+        word &= ~bit;
+    }
+    else
+    {
+        std::vector<arc::uint16>::iterator position =
+            std::lower_bound(chunk->array.begin(), chunk->array.end(), low);
+        if(position == chunk->array.end() || *position != low)
+        {
+            return false;
+        }
+        chunk->array.erase(position);
+    }
+
+    if(--chunk->cardinality == 0)
+    {
+        m_chunks.erase(chunk);
+    }
+    else
+    {
+        optimise(*chunk);
+    }
+    return true;
+}
+
+bool TaskBitmap::contains(arc::uint32 id) const
+{
+    arc::uint16 key = static_cast<arc::uint16>(id >> 16);
+    std::vector<Chunk>::const_iterator chunk = find_chunk(key);
+    if(chunk == m_chunks.end() || chunk->key != key)
+    {
+        return false;
+    }
+    return chunk_contains(*chunk, static_cast<arc::uint16>(id & 0xFFFF));
+}
+
+bool TaskBitmap::is_empty() const
+{
+    return m_chunks.empty();
+}
+
+std::size_t TaskBitmap::get_cardinality() const
+{
+    std::size_t cardinality = 0;
+    ARC_CONST_FOR_EACH(chunk, m_chunks)
+    {
+        cardinality += chunk->cardinality;
+    }
+    return cardinality;
+}
+
+std::size_t TaskBitmap::get_memory_usage() const
+{
+    std::size_t usage =
+        sizeof(TaskBitmap) + m_chunks.capacity() * sizeof(Chunk);
+    ARC_CONST_FOR_EACH(chunk, m_chunks)
+    {
+        usage += chunk->array.capacity() * sizeof(arc::uint16);
+        usage += chunk->bits.capacity() * sizeof(arc::uint64);
+    }
+    return usage;
+}
+
+void TaskBitmap::get_ids(std::vector<arc::uint32>& out) const
+{
+    out.reserve(out.size() + get_cardinality());
+    ARC_CONST_FOR_EACH(chunk, m_chunks)
+    {
+        arc::uint32 high = static_cast<arc::uint32>(chunk->key) << 16;
+        if(!chunk->is_bitset())
+        {
+            ARC_CONST_FOR_EACH(low, chunk->array)
+            {
+                out.push_back(high | *low);
+            }
+            continue;
+        }
+        for(std::size_t i = 0; i < BITSET_WORDS; ++i)
+        {
+            arc::uint64 word = chunk->bits[i];
+            while(word != 0)
+            {
+                std::size_t bit = lowest_bit(word);
+                out.push_back(high | static_cast<arc::uint32>(i * 64 + bit));
+                word &= word - 1;
+            }
+        }
+    }
+}
+
+void TaskBitmap::clear()
+{
+    m_chunks.clear();
+}
+
+TaskBitmap& TaskBitmap::intersect(const TaskBitmap& other)
+{
+    std::vector<Chunk> result;
+    std::vector<Chunk>::const_iterator a = m_chunks.begin();
+    std::vector<Chunk>::const_iterator b = other.m_chunks.begin();
+    while(a != m_chunks.end() && b != other.m_chunks.end())
+    {
+        if(a->key < b->key)
+        {
+            ++a;
+        }
+        else if(b->key < a->key)
+        {
+            ++b;
+        }
+        else
+        {
+            Chunk chunk(intersect_chunks(*a, *b));
+            if(chunk.cardinality > 0)
+            {
+                result.push_back(chunk);
+            }
+            ++a;
+            ++b;
+        }
+    }
+    m_chunks.swap(result);
+    return *this;
+}
+
+TaskBitmap& TaskBitmap::unite(const TaskBitmap& other)
+{
+    std::vector<Chunk> result;
+    result.reserve(std::max(m_chunks.size(), other.m_chunks.size()));
+    std::vector<Chunk>::const_iterator a = m_chunks.begin();
+    std::vector<Chunk>::const_iterator b = other.m_chunks.begin();
+    while(a != m_chunks.end() || b != other.m_chunks.end())
+    {
+        if(b == other.m_chunks.end() ||
+           (a != m_chunks.end() && a->key < b->key))
+        {
+            result.push_back(*a);
+            ++a;
+        }
+        else if(a == m_chunks.end() || b->key < a->key)
+        {
+            result.push_back(*b);
+            ++b;
+        }
+        else
+        {
+            result.push_back(unite_chunks(*a, *b));
+            ++a;
+            ++b;
+        }
+    }
+    m_chunks.swap(result);
+    return *this;
+}
+
+TaskBitmap& TaskBitmap::subtract(const TaskBitmap& other)
+{
+    std::vector<Chunk> result;
+    result.reserve(m_chunks.size());
+    std::vector<Chunk>::const_iterator b = other.m_chunks.begin();
+    ARC_CONST_FOR_EACH(a, m_chunks)
+    {
+        while(b != other.m_chunks.end() && b->key < a->key)
+        {
+            ++b;
+        }
+        if(b == other.m_chunks.end() || b->key != a->key)
+        {
+            result.push_back(*a);
+            continue;
+        }
+        Chunk chunk(subtract_chunks(*a, *b));
+        if(chunk.cardinality > 0)
+        {
+            result.push_back(chunk);
+        }
+    }
+    m_chunks.swap(result);
+    return *this;
+}
+
+std::size_t TaskBitmap::get_intersection_cardinality(
+        const TaskBitmap& other) const
+{
+    std::size_t cardinality = 0;
+    std::vector<Chunk>::const_iterator a = m_chunks.begin();
+    std::vector<Chunk>::const_iterator b = other.m_chunks.begin();
+    while(a != m_chunks.end() && b != other.m_chunks.end())
+    {
+        if(a->key < b->key)
+        {
+            ++a;
+        }
+        else if(b->key < a->key)
+        {
+            ++b;
+        }
+        else
+        {
+            cardinality += count_intersection(*a, *b);
+            ++a;
+            ++b;
+        }
+    }
+    return cardinality;
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+void TaskBitmap::optimise(Chunk& chunk)
+{
+    if(!chunk.is_bitset() && chunk.cardinality > ARRAY_LIMIT)
+    {
+        to_bitset(chunk);
+    }
+    else if(chunk.is_bitset() && chunk.cardinality <= ARRAY_LIMIT)
+    {
+        chunk.array.reserve(chunk.cardinality);
+        for(std::size_t i = 0; i < BITSET_WORDS; ++i)
+        {
+            arc::uint64 word = chunk.bits[i];
+            while(word != 0)
+            {
+                chunk.array.push_back(
+                        static_cast<arc::uint16>(i * 64 + lowest_bit(word)));
+                word &= word - 1;
+            }
+        }
+        std::vector<arc::uint64>().swap(chunk.bits);
+    }
+}
+
+void TaskBitmap::to_bitset(Chunk& chunk)
+{
+    chunk.bits.assign(BITSET_WORDS, 0);
+    ARC_CONST_FOR_EACH(low, chunk.array)
+    {
+        chunk.bits[*low >> 6] |= 1ULL << (*low & 63);
+    }
+    std::vector<arc::uint16>().swap(chunk.array);
+}
+
+TaskBitmap::Chunk TaskBitmap::intersect_chunks(const Chunk& a, const Chunk& b)
+{
+    Chunk result;
+    result.key = a.key;
+    if(a.is_bitset() && b.is_bitset())
+    {
+        result.bits.resize(BITSET_WORDS);
+        for(std::size_t i = 0; i < BITSET_WORDS; ++i)
+        {
+            result.bits[i] = a.bits[i] & b.bits[i];
+        }
+        result.cardinality = count_bits(result.bits);
+        optimise(result);
+        return result;
+    }
+
+    if(!a.is_bitset() && !b.is_bitset())
+    {
+        std::set_intersection(
+            a.array.begin(), a.array.end(),
+            b.array.begin(), b.array.end(),
+            std::back_inserter(result.array)
+        );
+    }
+    else
+    {
+        // check the ids of the array against the bitset
+        const Chunk& array = a.is_bitset() ? b : a;
+        const Chunk& bitset = a.is_bitset() ? a : b;
+        ARC_CONST_FOR_EACH(low, array.array)
+        {
+            if(chunk_contains(bitset, *low))
+            {
+                result.array.push_back(*low);
+            }
+        }
+    }
+    result.cardinality = result.array.size();
+    return result;
+}
+
+TaskBitmap::Chunk TaskBitmap::unite_chunks(const Chunk& a, const Chunk& b)
+{
+    Chunk result;
+    result.key = a.key;
+    if(!a.is_bitset() && !b.is_bitset())
+    {
+        std::set_union(
+            a.array.begin(), a.array.end(),
+            b.array.begin(), b.array.end(),
+            std::back_inserter(result.array)
+        );
+        result.cardinality = result.array.size();
+        optimise(result);
+        return result;
+    }
+
+    const Chunk& bitset = a.is_bitset() ? a : b;
+    const Chunk& other = a.is_bitset() ? b : a;
+    result.bits = bitset.bits;
+    if(other.is_bitset())
+    {
+        for(std::size_t i = 0; i < BITSET_WORDS; ++i)
+        {
+            result.bits[i] |= other.bits[i];
+        }
+    }
+    else
+    {
+        ARC_CONST_FOR_EACH(low, other.array)
+        {
+            result.bits[*low >> 6] |= 1ULL << (*low & 63);
+        }
+    }
+    result.cardinality = count_bits(result.bits);
+    return result;
+}
+
+TaskBitmap::Chunk TaskBitmap::subtract_chunks(const Chunk& a, const Chunk& b)
+{
+    Chunk result;
+    result.key = a.key;
+    if(!a.is_bitset())
+    {
+        if(!b.is_bitset())
+        {
+            std::set_difference(
+                a.array.begin(), a.array.end(),
+                b.array.begin(), b.array.end(),
+                std::back_inserter(result.array)
+            );
+        }
+        else
+        {
+            ARC_CONST_FOR_EACH(low, a.array)
+            {
+                if(!chunk_contains(b, *low))
+                {
+                    result.array.push_back(*low);
+                }
+            }
+        }
+        result.cardinality = result.array.size();
+        return result;
+    }
+
+    result.bits = a.bits;
+    if(b.is_bitset())
+    {
+        for(std::size_t i = 0; i < BITSET_WORDS; ++i)
+        {
+            result.bits[i] &= ~b.bits[i];
+        }
+    }
+    else
+    {
+        ARC_CONST_FOR_EACH(low, b.array)
+        {
+            result.bits[*low >> 6] &= ~(1ULL << (*low & 63));
+        }
+    }
+    result.cardinality = count_bits(result.bits);
+    optimise(result);
+    return result;
+}
+
+std::size_t TaskBitmap::count_intersection(const Chunk& a, const Chunk& b)
+{
+    std::size_t count = 0;
+    if(a.is_bitset() && b.is_bitset())
+    {
+        for(std::size_t i = 0; i < BITSET_WORDS; ++i)
+        {
+            count += count_bits(a.bits[i] & b.bits[i]);
+        }
+    }
+    else if(!a.is_bitset() && !b.is_bitset())
+    {
+        std::vector<arc::uint16>::const_iterator x = a.array.begin();
+        std::vector<arc::uint16>::const_iterator y = b.array.begin();
+        while(x != a.array.end() && y != b.array.end())
+        {
+            if(*x < *y)
+            {
+                ++x;
+            }
+            else if(*y < *x)
+            {
+                ++y;
+            }
+            else
+            {
+                ++count;
+                ++x;
+                ++y;
+            }
+        }
+    }
+    else
+    {
+        const Chunk& array = a.is_bitset() ? b : a;
+        const Chunk& bitset = a.is_bitset() ? a : b;
+        ARC_CONST_FOR_EACH(low, array.array)
+        {
+            if(chunk_contains(bitset, *low))
+            {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+bool TaskBitmap::chunk_contains(const Chunk& chunk, arc::uint16 low)
+{
+    if(chunk.is_bitset())
+    {
+        return (chunk.bits[low >> 6] & (1ULL << (low & 63))) != 0;
+    }
+    return std::binary_search(chunk.array.begin(), chunk.array.end(), low);
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+std::vector<TaskBitmap::Chunk>::iterator TaskBitmap::find_chunk(
+        arc::uint16 key)
+{
+    return std::lower_bound(
+        m_chunks.begin(),
+        m_chunks.end(),
+        key,
+        [](const Chunk& chunk, arc::uint16 key)
+        {
+            return chunk.key < key;
+        }
+    );
+}
+
+std::vector<TaskBitmap::Chunk>::const_iterator TaskBitmap::find_chunk(
+        arc::uint16 key) const
+{
+    return std::lower_bound(
+        m_chunks.begin(),
+        m_chunks.end(),
+        key,
+        [](const Chunk& chunk, arc::uint16 key)
+        {
+            return chunk.key < key;
+        }
+    );
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
@@ -0,0 +1,236 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief A compressed set of Task ids.
+ */
+#ifndef SIGMA_CORE_TASKS_TASKBITMAP_HPP_
+#define SIGMA_CORE_TASKS_TASKBITMAP_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include <arcanecore/base/Types.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+/*!
+ * \brief A set of Task ids stored as a compressed bitmap.
+ *
+ * Task ids are assigned from a global counter, so the ids of the Tasks in a
+ * set tend to be clustered. The bitmap splits the 32 bit id space into chunks
+ * of 65536 ids by the high 16 bits of each id, and only stores the chunks that
+ * contain at least one id. Each chunk stores the low 16 bits of its ids
+ * either as a sorted array, while it contains at most 4096 ids, or otherwise
+ * as a bitset of 65536 bits. Neither form ever uses more than 8KB per chunk,
+ * so memory scales with the number of ids in the set rather than the range
+ * of the ids.
+ *
+ * Intersections, unions and differences are performed chunk by chunk,
+ * skipping chunks that are only in one of the operands where possible, and
+ * bitset chunks are combined 64 ids at a time.
+ */
+class TaskBitmap
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates an empty bitmap.
+     */
+    TaskBitmap();
+
+    //--------------------------------------------------------------------------
+    //                                 OPERATORS
+    //--------------------------------------------------------------------------
+
+    bool operator==(const TaskBitmap& other) const;
+
+    bool operator!=(const TaskBitmap& other) const;
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Adds the given id to the set.
+     *
+     * \return False if the id was already in the set.
+     */
+    bool add(arc::uint32 id);
+
+    /*!
+     * \brief Removes the given id from the set.
+     *
+     * \return False if the id was not in the set.
+     */
+    bool remove(arc::uint32 id);
+
+    /*!
+     * \brief Returns whether the given id is in the set.
+     */
+    bool contains(arc::uint32 id) const;
+
+    /*!
+     * \brief Returns whether the set contains no ids.
+     */
+    bool is_empty() const;
+
+    /*!
+     * \brief Returns the number of ids in the set.
+     */
+    std::size_t get_cardinality() const;
+
+    /*!
+     * \brief Returns the approximate number of bytes used to store the set.
+     */
+    std::size_t get_memory_usage() const;
+
+    /*!
+     * \brief Appends the ids in the set to the given vector in ascending
+     *        order.
+     */
+    void get_ids(std::vector<arc::uint32>& out) const;
+
+    /*!
+     * \brief Removes all ids from the set.
+     */
+    void clear();
+
+    /*!
+     * \brief Removes the ids that are not in the given set from this set.
+     */
+    TaskBitmap& intersect(const TaskBitmap& other);
+
+    /*!
+     * \brief Adds the ids of the given set to this set.
+     */
+    TaskBitmap& unite(const TaskBitmap& other);
+
+    /*!
+     * \brief Removes the ids of the given set from this set.
+     */
+    TaskBitmap& subtract(const TaskBitmap& other);
+
+    /*!
+     * \brief Returns the number of ids in both this and the given set, without
+     *        building the intersection.
+     */
+    std::size_t get_intersection_cardinality(const TaskBitmap& other) const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE STATIC CONSTANTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The most ids a chunk stores as an array.
+     */
+    static const std::size_t ARRAY_LIMIT = 4096;
+    /*!
+     * \brief The number of words of a chunk stored as a bitset.
+     */
+    static const std::size_t BITSET_WORDS = 1024;
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The ids of the set that share the same high 16 bits.
+     */
+    struct Chunk
+    {
+        /// The high 16 bits of the ids of the chunk.
+        arc::uint16 key;
+        /// The number of ids in the chunk.
+        std::size_t cardinality;
+        /// The sorted low 16 bits of the ids, if the chunk is an array.
+        std::vector<arc::uint16> array;
+        /// The bits of the low 16 bits of the ids, if the chunk is a bitset.
+        std::vector<arc::uint64> bits;
+
+        /// Returns whether the chunk is stored as a bitset.
+        bool is_bitset() const
+        {
+            return !bits.empty();
+        }
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The non-empty chunks ordered by their keys.
+     */
+    std::vector<Chunk> m_chunks;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Converts the given chunk to the cheaper of the two forms for its
+     *        cardinality.
+     */
+    static void optimise(Chunk& chunk);
+
+    /*!
+     * \brief Converts the given chunk to a bitset.
+     */
+    static void to_bitset(Chunk& chunk);
+
+    /*!
+     * \brief Returns the intersection of two chunks with the same key.
+     */
+    static Chunk intersect_chunks(const Chunk& a, const Chunk& b);
+
+    /*!
+     * \brief Returns the union of two chunks with the same key.
+     */
+    static Chunk unite_chunks(const Chunk& a, const Chunk& b);
+
+    /*!
+     * \brief Returns the ids of the first chunk that aren't in the second,
+     *        the chunks have the same key.
+     */
+    static Chunk subtract_chunks(const Chunk& a, const Chunk& b);
+
+    /*!
+     * \brief Returns the number of ids in both of two chunks with the same
+     *        key.
+     */
+    static std::size_t count_intersection(const Chunk& a, const Chunk& b);
+
+    /*!
+     * \brief Returns whether the given chunk contains the given low 16 bits of
+     *        an id.
+     */
+    static bool chunk_contains(const Chunk& chunk, arc::uint16 low);
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the position of the chunk with the given key, or the
+     *        position it would be inserted at.
+     */
+    std::vector<Chunk>::iterator find_chunk(arc::uint16 key);
+    std::vector<Chunk>::const_iterator find_chunk(arc::uint16 key) const;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
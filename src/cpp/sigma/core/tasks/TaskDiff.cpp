@@ -0,0 +1,512 @@
+#include "sigma/core/tasks/TaskDiff.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "sigma/core/tasks/RootTask.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                    CLASSES
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Performs a single diff.
+ *
+ * Subtrees are compared in pairs from the top down, skipping pairs with equal
+ * hashes. Children that can't be paired with a child of the same parent in
+ * the other version have been added, removed or moved. These are collected on
+ * each side, and any Tasks found on both sides are paired as moved. Unpaired
+ * Tasks are expanded one level at a time (since a moved Task may be a
+ * descendant of an added or removed Task) until nothing is left to expand,
+ * at which point any remaining unpaired Tasks have been added or removed.
+ */
+class Differ
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(Differ);
+
+public:
+
+    explicit Differ(std::vector<TaskChange>& changes)
+        :
+        m_changes(changes)
+    {
+    }
+
+    void run(const TaskSnapshot::Ptr& before, const TaskSnapshot::Ptr& after)
+    {
+        compare(Position(before), Position(after));
+
+        while(true)
+        {
+            if(match_fresh())
+            {
+                continue;
+            }
+            bool expanded_before =
+                expand(m_before, m_unexpanded_before, m_fresh_before);
+            bool expanded_after =
+                expand(m_after, m_unexpanded_after, m_fresh_after);
+            if(!expanded_before && !expanded_after)
+            {
+                break;
+            }
+        }
+
+        // anything left unpaired only exists on one side
+        std::vector<TaskChange> remaining;
+        ARC_CONST_FOR_EACH(it, m_before)
+        {
+            if(!it->second.matched)
+            {
+                remaining.push_back(make_change(
+                        TaskChange::REMOVED,
+                        &it->second.position,
+                        nullptr
+                ));
+            }
+        }
+        ARC_CONST_FOR_EACH(it, m_after)
+        {
+            if(!it->second.matched)
+            {
+                remaining.push_back(make_change(
+                        TaskChange::ADDED,
+                        nullptr,
+                        &it->second.position
+                ));
+            }
+        }
+        // keep the output independent of the hash map ordering
+        std::sort(
+                remaining.begin(),
+                remaining.end(),
+                [](const TaskChange& a, const TaskChange& b)
+                {
+                    return a.type != b.type ? a.type < b.type : a.id < b.id;
+                }
+        );
+        m_changes.insert(m_changes.end(), remaining.begin(), remaining.end());
+    }
+
+private:
+
+    /*!
+     * \brief A Task and where it's positioned in one of the versions.
+     */
+    struct Position
+    {
+        TaskSnapshot::Ptr node;
+        /// The parent of the Task, null for the top Task.
+        TaskSnapshot::Ptr parent;
+        /// The position of the Task among the children of the parent.
+        std::size_t index;
+
+        Position()
+            :
+            index(0)
+        {
+        }
+
+        explicit Position(
+                const TaskSnapshot::Ptr& node_,
+                const TaskSnapshot::Ptr& parent_ = TaskSnapshot::Ptr(),
+                std::size_t index_ = 0)
+            :
+            node  (node_),
+            parent(parent_),
+            index (index_)
+        {
+        }
+    };
+
+    /*!
+     * \brief A Task which couldn't be paired with the same Task under the same
+     *        parent in the other version.
+     */
+    struct Entry
+    {
+        Position position;
+        /// Whether the Task has been found in the other version.
+        bool matched;
+        /// Whether the children of the Task have been added as entries.
+        bool expanded;
+        /// The ids of the children that were added when expanding.
+        std::vector<arc::uint32> expansion;
+    };
+
+    typedef std::unordered_map<arc::uint32, Entry> EntryMap;
+
+    std::vector<TaskChange>& m_changes;
+
+    EntryMap m_before;
+    EntryMap m_after;
+    // entries that haven't been checked for a match yet
+    std::vector<arc::uint32> m_fresh_before;
+    std::vector<arc::uint32> m_fresh_after;
+    // unmatched entries that haven't been expanded yet
+    std::vector<arc::uint32> m_unexpanded_before;
+    std::vector<arc::uint32> m_unexpanded_after;
+
+    static TaskChange make_change(
+            TaskChange::Type type,
+            const Position* before,
+            const Position* after)
+    {
+        TaskChange change;
+        change.type = type;
+        change.id = before ? before->node->get_id() : after->node->get_id();
+        change.before_index = 0;
+        change.after_index = 0;
+        if(before != nullptr)
+        {
+            change.before = before->node;
+            change.before_parent = before->parent;
+            change.before_index = before->index;
+        }
+        if(after != nullptr)
+        {
+            change.after = after->node;
+            change.after_parent = after->parent;
+            change.after_index = after->index;
+        }
+        return change;
+    }
+
+    /*!
+     * \brief Compares two versions of the same Task.
+     */
+    void compare(
+            const Position& before_position,
+            const Position& after_position)
+    {
+        const TaskSnapshot::Ptr& before = before_position.node;
+        const TaskSnapshot::Ptr& after = after_position.node;
+
+        // identical subtrees are skipped entirely
+        if(before == after || before->get_hash() == after->get_hash())
+        {
+            return;
+        }
+
+        if(before->get_title() != after->get_title() ||
+           before->get_attributes() != after->get_attributes())
+        {
+            m_changes.push_back(make_change(
+                    TaskChange::MODIFIED,
+                    &before_position,
+                    &after_position
+            ));
+        }
+
+        const std::vector<TaskSnapshot::Ptr>& after_children =
+            after->get_children();
+        std::unordered_map<arc::uint32, std::size_t> after_indices;
+        for(std::size_t i = 0; i < after_children.size(); ++i)
+        {
+            after_indices[after_children[i]->get_id()] = i;
+        }
+        std::vector<bool> paired(after_children.size(), false);
+
+        // the after positions of the children that exist in both versions, in
+        // their before order
+        const std::vector<TaskSnapshot::Ptr>& before_children =
+            before->get_children();
+        std::vector<Position> kept;
+        std::vector<std::size_t> positions;
+        for(std::size_t i = 0; i < before_children.size(); ++i)
+        {
+            Position child(before_children[i], before, i);
+            std::unordered_map<arc::uint32, std::size_t>::const_iterator index =
+                after_indices.find(child.node->get_id());
+            if(index == after_indices.end())
+            {
+                insert(m_before, m_fresh_before, child);
+                continue;
+            }
+            paired[index->second] = true;
+            kept.push_back(child);
+            positions.push_back(index->second);
+        }
+
+        std::vector<bool> in_order;
+        find_in_order(positions, in_order);
+        for(std::size_t i = 0; i < kept.size(); ++i)
+        {
+            Position after_child(
+                    after_children[positions[i]],
+                    after,
+                    positions[i]
+            );
+            if(!in_order[i])
+            {
+                m_changes.push_back(make_change(
+                        TaskChange::MOVED,
+                        &kept[i],
+                        &after_child
+                ));
+            }
+            compare(kept[i], after_child);
+        }
+
+        for(std::size_t i = 0; i < after_children.size(); ++i)
+        {
+            if(!paired[i])
+            {
+                insert(m_after, m_fresh_after, Position(
+                        after_children[i],
+                        after,
+                        i
+                ));
+            }
+        }
+    }
+
+    /*!
+     * \brief Marks the largest set of the given positions that are still in
+     *        increasing order, the others have been reordered.
+     *
+     * This is a longest increasing subsequence, found in O(n log n). Where
+     * there is a choice, earlier positions are preferred to be kept in order.
+     */
+    static void find_in_order(
+            const std::vector<std::size_t>& positions,
+            std::vector<bool>& in_order)
+    {
+        in_order.assign(positions.size(), false);
+        if(positions.empty())
+        {
+            return;
+        }
+
+        // build a longest decreasing subsequence walking backwards, so the
+        // sequence read forwards increases and starts as early as possible.
+        // tails[k] is the index of the largest position ending a decreasing
+        // run of length k + 1
+        std::vector<std::size_t> tails;
+        std::vector<std::size_t> previous(positions.size());
+        for(std::size_t i = positions.size(); i-- > 0;)
+        {
+            std::size_t low = 0;
+            std::size_t high = tails.size();
+            while(low < high)
+            {
+                std::size_t middle = (low + high) / 2;
+                if(positions[tails[middle]] > positions[i])
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            previous[i] = low > 0 ? tails[low - 1] : positions.size();
+            if(low == tails.size())
+            {
+                tails.push_back(i);
+            }
+            else
+            {
+                tails[low] = i;
+            }
+        }
+
+        for(std::size_t i = tails.back(); i < positions.size(); i = previous[i])
+        {
+            in_order[i] = true;
+        }
+    }
+
+    /*!
+     * \brief Adds an unpaired Task, returning false if it was already added.
+     */
+    static bool insert(
+            EntryMap& entries,
+            std::vector<arc::uint32>& fresh,
+            const Position& position)
+    {
+        arc::uint32 id = position.node->get_id();
+        if(entries.find(id) != entries.end())
+        {
+            return false;
+        }
+
+        Entry& entry = entries[id];
+        entry.position = position;
+        entry.matched = false;
+        entry.expanded = false;
+        fresh.push_back(id);
+        return true;
+    }
+
+    /*!
+     * \brief Pairs up fresh entries that exist on both sides.
+     *
+     * \return Whether any entries were paired.
+     */
+    bool match_fresh()
+    {
+        bool matched = false;
+
+        std::vector<arc::uint32> fresh;
+        fresh.swap(m_fresh_before);
+        ARC_CONST_FOR_EACH(id, fresh)
+        {
+            if(try_pair(*id))
+            {
+                matched = true;
+            }
+            else
+            {
+                m_unexpanded_before.push_back(*id);
+            }
+        }
+
+        fresh.clear();
+        fresh.swap(m_fresh_after);
+        ARC_CONST_FOR_EACH(id, fresh)
+        {
+            if(try_pair(*id))
+            {
+                matched = true;
+            }
+            else
+            {
+                m_unexpanded_after.push_back(*id);
+            }
+        }
+
+        return matched;
+    }
+
+    /*!
+     * \brief Pairs the entries with the given id if they exist on both sides
+     *        and are not yet paired.
+     */
+    bool try_pair(arc::uint32 id)
+    {
+        EntryMap::iterator before = m_before.find(id);
+        EntryMap::iterator after = m_after.find(id);
+        if(before == m_before.end()    ||
+           after  == m_after.end()     ||
+           before->second.matched      ||
+           after->second.matched)
+        {
+            return false;
+        }
+
+        before->second.matched = true;
+        after->second.matched = true;
+        // the children will be paired by comparing the Task instead
+        discard_expansion(m_before, before->second);
+        discard_expansion(m_after, after->second);
+
+        Position before_position(before->second.position);
+        Position after_position(after->second.position);
+        m_changes.push_back(make_change(
+                TaskChange::MOVED,
+                &before_position,
+                &after_position
+        ));
+        compare(before_position, after_position);
+        return true;
+    }
+
+    /*!
+     * \brief Removes the unmatched entries that were added by expanding the
+     *        given entry.
+     */
+    static void discard_expansion(EntryMap& entries, Entry& entry)
+    {
+        ARC_CONST_FOR_EACH(id, entry.expansion)
+        {
+            EntryMap::iterator child = entries.find(*id);
+            if(child != entries.end() && !child->second.matched)
+            {
+                discard_expansion(entries, child->second);
+                entries.erase(child);
+            }
+        }
+        entry.expansion.clear();
+        entry.expanded = false;
+    }
+
+    /*!
+     * \brief Adds the children of the unexpanded entries as fresh entries.
+     *
+     * \return Whether any entries were added.
+     */
+    static bool expand(
+            EntryMap& entries,
+            std::vector<arc::uint32>& unexpanded,
+            std::vector<arc::uint32>& fresh)
+    {
+        bool added = false;
+
+        std::vector<arc::uint32> ids;
+        ids.swap(unexpanded);
+        ARC_CONST_FOR_EACH(id, ids)
+        {
+            EntryMap::iterator it = entries.find(*id);
+            if(it == entries.end() || it->second.matched || it->second.expanded)
+            {
+                continue;
+            }
+
+            Entry& entry = it->second;
+            entry.expanded = true;
+            const TaskSnapshot::Ptr& node = entry.position.node;
+            const std::vector<TaskSnapshot::Ptr>& children =
+                node->get_children();
+            for(std::size_t i = 0; i < children.size(); ++i)
+            {
+                if(insert(entries, fresh, Position(children[i], node, i)))
+                {
+                    entry.expansion.push_back(children[i]->get_id());
+                    added = true;
+                }
+            }
+        }
+
+        return added;
+    }
+};
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+void TaskDiff::compute(
+        const TaskSnapshot::Ptr& before,
+        const TaskSnapshot::Ptr& after,
+        std::vector<TaskChange>& changes)
+{
+    Differ differ(changes);
+    differ.run(before, after);
+}
+
+void TaskDiff::compute(
+        const RootTask* before,
+        const RootTask* after,
+        std::vector<TaskChange>& changes)
+{
+    compute(before->snapshot(), after->snapshot(), changes);
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
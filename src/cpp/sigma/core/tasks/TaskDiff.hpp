@@ -0,0 +1,127 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Computes the differences between two versions of a Task hierarchy.
+ */
+#ifndef SIGMA_CORE_TASKS_TASKDIFF_HPP_
+#define SIGMA_CORE_TASKS_TASKDIFF_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+
+#include "sigma/core/tasks/TaskSnapshot.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class RootTask;
+
+/*!
+ * \brief A single difference between two versions of a Task hierarchy.
+ */
+struct TaskChange
+{
+    //--------------------------------------------------------------------------
+    //                                ENUMERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The kinds of difference.
+     */
+    enum Type
+    {
+        /// The Task only exists in the after version.
+        ADDED,
+        /// The Task only exists in the before version.
+        REMOVED,
+        /// The title or attributes of the Task differ.
+        MODIFIED,
+        /// The Task has a different parent or position among its siblings.
+        MOVED
+    };
+
+    //--------------------------------------------------------------------------
+    //                                 ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /// The kind of difference.
+    Type type;
+    /// The id of the Task.
+    arc::uint32 id;
+    /// The Task in the before version, null if the Task was added.
+    TaskSnapshot::Ptr before;
+    /// The Task in the after version, null if the Task was removed.
+    TaskSnapshot::Ptr after;
+    /// The parent of the Task in the before version, null if the Task was
+    /// added or is the top Task.
+    TaskSnapshot::Ptr before_parent;
+    /// The position of the Task among the children of before_parent.
+    std::size_t before_index;
+    /// The parent of the Task in the after version, null if the Task was
+    /// removed or is the top Task.
+    TaskSnapshot::Ptr after_parent;
+    /// The position of the Task among the children of after_parent.
+    std::size_t after_index;
+};
+
+/*!
+ * \brief Computes the differences between two versions of a Task hierarchy.
+ *
+ * Tasks are matched between the versions by their ids. Subtrees which have
+ * the same hash in both versions (see TaskSnapshot::get_hash()) are skipped
+ * entirely, so the time taken is proportional to the number of Tasks that
+ * differ (and the size of added or removed subtrees) rather than the size of
+ * the hierarchies.
+ */
+class TaskDiff
+{
+private:
+
+    ARC_DISALLOW_CONSTRUCTION(TaskDiff);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Appends the differences between the two given snapshots to the
+     *        given vector.
+     *
+     * The top Tasks of the snapshots are always compared against each other,
+     * even if their ids differ, all other Tasks are matched by id. A Task that
+     * is both moved and modified produces a change of each type.
+     */
+    static void compute(
+            const TaskSnapshot::Ptr& before,
+            const TaskSnapshot::Ptr& after,
+            std::vector<TaskChange>& changes);
+
+    /*!
+     * \brief Appends the differences between the current states of the two
+     *        given boards to the given vector.
+     *
+     * This compares snapshots of the boards, see RootTask::snapshot().
+     */
+    static void compute(
+            const RootTask* before,
+            const RootTask* after,
+            std::vector<TaskChange>& changes);
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
@@ -0,0 +1,128 @@
+#include "sigma/core/tasks/TaskFilter.hpp"
+
+#include <limits>
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+TaskFilter::TaskFilter()
+    :
+    m_statuses          (0),
+    m_min_priority      (PRIORITY_NONE),
+    m_max_priority      (PRIORITY_HIGH),
+    m_has_estimate_range(false),
+    m_min_estimate      (0),
+    m_max_estimate      (std::numeric_limits<arc::uint32>::max()),
+    m_has_assignee      (false),
+    m_has_due_range     (false),
+    m_first_due         (std::numeric_limits<arc::int64>::min()),
+    m_last_due          (std::numeric_limits<arc::int64>::max()),
+    m_flags             (0),
+    m_ancestor          (nullptr)
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+TaskFilter& TaskFilter::with_status(TaskStatus status)
+{
+    m_statuses |= 1U << status;
+    return *this;
+}
+
+TaskFilter& TaskFilter::with_min_priority(TaskPriority priority)
+{
+    m_min_priority = priority;
+    return *this;
+}
+
+TaskFilter& TaskFilter::with_max_priority(TaskPriority priority)
+{
+    m_max_priority = priority;
+    return *this;
+}
+
+TaskFilter& TaskFilter::with_estimate_between(arc::uint32 min, arc::uint32 max)
+{
+    m_has_estimate_range = true;
+    m_min_estimate = min;
+    m_max_estimate = max;
+    return *this;
+}
+
+TaskFilter& TaskFilter::with_assignee(const arc::str::UTF8String& assignee)
+{
+    m_has_assignee = true;
+    m_assignee = assignee;
+    return *this;
+}
+
+TaskFilter& TaskFilter::with_due_between(arc::int64 first, arc::int64 last)
+{
+    m_has_due_range = true;
+    m_first_due = first;
+    m_last_due = last;
+    return *this;
+}
+
+TaskFilter& TaskFilter::with_flags(arc::uint32 flags)
+{
+    m_flags |= flags;
+    return *this;
+}
+
+TaskFilter& TaskFilter::under(const Task* ancestor)
+{
+    m_ancestor = ancestor;
+    return *this;
+}
+
+bool TaskFilter::matches(const TaskAttributes& attributes) const
+{
+    if(m_statuses != 0 && ((m_statuses >> attributes.status) & 1) == 0)
+    {
+        return false;
+    }
+    if(attributes.priority < m_min_priority ||
+       attributes.priority > m_max_priority)
+    {
+        return false;
+    }
+    if(m_has_estimate_range &&
+       (attributes.estimate < m_min_estimate ||
+        attributes.estimate > m_max_estimate))
+    {
+        return false;
+    }
+    if(m_has_assignee && attributes.assignee != m_assignee)
+    {
+        return false;
+    }
+    if(m_has_due_range &&
+       (!attributes.has_due_date          ||
+        attributes.due_date < m_first_due ||
+        attributes.due_date > m_last_due))
+    {
+        return false;
+    }
+    return (attributes.flags & m_flags) == m_flags;
+}
+
+const Task* TaskFilter::get_ancestor() const
+{
+    return m_ancestor;
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
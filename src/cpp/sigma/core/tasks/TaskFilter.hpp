@@ -0,0 +1,172 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Criteria for selecting the Tasks of a board by their attributes.
+ */
+#ifndef SIGMA_CORE_TASKS_TASKFILTER_HPP_
+#define SIGMA_CORE_TASKS_TASKFILTER_HPP_
+
+#include "sigma/core/tasks/TaskAttributes.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class AttributeTable;
+class Task;
+
+/*!
+ * \brief Describes which Tasks of a board should be selected by
+ *        RootTask::find_tasks() and RootTask::count_tasks().
+ *
+ * A default constructed filter matches every Task of a board (apart from the
+ * RootTask itself). Each criteria that is added further restricts the Tasks
+ * that match, so a Task must satisfy all of the criteria. The functions return
+ * the filter so criteria can be chained, for example open Tasks with at least
+ * medium priority below a Task are selected by:
+ *
+ * \code
+ * TaskFilter()
+ *     .with_status(STATUS_OPEN)
+ *     .with_min_priority(PRIORITY_MEDIUM)
+ *     .under(task);
+ * \endcode
+ */
+class TaskFilter
+{
+private:
+
+    friend class AttributeTable;
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a filter which matches every Task.
+     */
+    TaskFilter();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Adds the given status to the statuses a Task may have.
+     *
+     * If this is never called Tasks may have any status.
+     */
+    TaskFilter& with_status(TaskStatus status);
+
+    /*!
+     * \brief Only matches Tasks with at least the given priority.
+     */
+    TaskFilter& with_min_priority(TaskPriority priority);
+
+    /*!
+     * \brief Only matches Tasks with at most the given priority.
+     */
+    TaskFilter& with_max_priority(TaskPriority priority);
+
+    /*!
+     * \brief Only matches Tasks which have an estimate within the given range
+     *        of minutes (inclusive).
+     */
+    TaskFilter& with_estimate_between(arc::uint32 min, arc::uint32 max);
+
+    /*!
+     * \brief Only matches Tasks assigned to the given name, an empty name
+     *        matches unassigned Tasks.
+     */
+    TaskFilter& with_assignee(const arc::str::UTF8String& assignee);
+
+    /*!
+     * \brief Only matches Tasks which have a due date within the given range
+     *        (inclusive).
+     */
+    TaskFilter& with_due_between(arc::int64 first, arc::int64 last);
+
+    /*!
+     * \brief Only matches Tasks which have all of the given TaskFlag values
+     *        set.
+     */
+    TaskFilter& with_flags(arc::uint32 flags);
+
+    /*!
+     * \brief Only matches Tasks which are descendants of the given Task.
+     *
+     * The given Task itself does not match.
+     */
+    TaskFilter& under(const Task* ancestor);
+
+    /*!
+     * \brief Returns whether the given attributes satisfy the criteria of this
+     *        filter.
+     *
+     * This only checks the attributes, not whether a Task is a descendant of
+     * the Task given to under().
+     */
+    bool matches(const TaskAttributes& attributes) const;
+
+    /*!
+     * \brief Returns the Task that matching Tasks must be descendants of, or
+     *        null if Tasks are not restricted to a subtree.
+     */
+    const Task* get_ancestor() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Bit mask of the TaskStatus values that match, 0 matches all.
+     */
+    arc::uint32 m_statuses;
+    /*!
+     * \brief The inclusive priority range.
+     */
+    TaskPriority m_min_priority;
+    TaskPriority m_max_priority;
+    /*!
+     * \brief Whether Tasks must have an estimate within a range.
+     */
+    bool m_has_estimate_range;
+    arc::uint32 m_min_estimate;
+    arc::uint32 m_max_estimate;
+    /*!
+     * \brief Whether Tasks must be assigned to m_assignee.
+     */
+    bool m_has_assignee;
+    arc::str::UTF8String m_assignee;
+    /*!
+     * \brief Whether Tasks must have a due date within a range.
+     */
+    bool m_has_due_range;
+    arc::int64 m_first_due;
+    arc::int64 m_last_due;
+    /*!
+     * \brief The TaskFlag values that must be set.
+     */
+    arc::uint32 m_flags;
+    /*!
+     * \brief The Task matching Tasks must be descendants of, or null.
+     */
+    const Task* m_ancestor;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
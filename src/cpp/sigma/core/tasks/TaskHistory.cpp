@@ -0,0 +1,638 @@
+#include "sigma/core/tasks/TaskHistory.hpp"
+
+#include <algorithm>
+
+#include <arcanecore/base/Exceptions.hpp>
+
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TaskSerialiser.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                                PUBLIC CONSTANTS
+//------------------------------------------------------------------------------
+
+const std::size_t TaskHistory::DEFAULT_MEMORY_BUDGET = 16 * 1024 * 1024;
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void TaskHistory::begin_step(const arc::str::UTF8String& label)
+{
+    sigma::core::util::ScopedWriteLock lock(m_board->get_lock());
+
+    if(m_step_depth++ == 0)
+    {
+        m_undo_steps.push_back(Step());
+        m_undo_steps.back().label = label;
+        m_memory_usage += m_undo_steps.back().bytes;
+    }
+}
+
+void TaskHistory::end_step()
+{
+    sigma::core::util::ScopedWriteLock lock(m_board->get_lock());
+
+    if(m_step_depth == 0)
+    {
+        throw arc::ex::StateError("end_step called without a matching step");
+    }
+
+    if(--m_step_depth == 0)
+    {
+        // discard steps that didn't record anything
+        if(!m_undo_steps.empty() && m_undo_steps.back().operations.empty())
+        {
+            m_memory_usage -= m_undo_steps.back().bytes;
+            m_undo_steps.pop_back();
+        }
+        enforce_budget();
+    }
+}
+
+bool TaskHistory::can_undo() const
+{
+    return !m_undo_steps.empty() && m_step_depth == 0;
+}
+
+bool TaskHistory::can_redo() const
+{
+    return !m_redo_steps.empty() && m_step_depth == 0;
+}
+
+std::size_t TaskHistory::get_undo_count() const
+{
+    return m_undo_steps.size();
+}
+
+std::size_t TaskHistory::get_redo_count() const
+{
+    return m_redo_steps.size();
+}
+
+const arc::str::UTF8String& TaskHistory::get_undo_label() const
+{
+    if(m_undo_steps.empty())
+    {
+        throw arc::ex::StateError("There is no step to undo");
+    }
+    return m_undo_steps.back().label;
+}
+
+bool TaskHistory::undo()
+{
+    sigma::core::util::ScopedWriteLock lock(m_board->get_lock());
+
+    if(m_step_depth > 0)
+    {
+        throw arc::ex::StateError("Cannot undo while a step is in progress");
+    }
+    if(m_undo_steps.empty())
+    {
+        return false;
+    }
+
+    // move the step over before it's applied so it isn't lost if an
+    // operation fails
+    m_redo_steps.push_back(Step());
+    std::swap(m_redo_steps.back(), m_undo_steps.back());
+    m_undo_steps.pop_back();
+
+    ++m_suspended;
+    try
+    {
+        const std::vector<Operation>& operations =
+            m_redo_steps.back().operations;
+        std::vector<Operation>::const_reverse_iterator op = operations.rbegin();
+        for(; op != operations.rend(); ++op)
+        {
+            apply_inverse(*op);
+        }
+    }
+    catch(...)
+    {
+        --m_suspended;
+        // the board no longer matches the history
+        clear();
+        throw;
+    }
+    --m_suspended;
+
+    return true;
+}
+
+bool TaskHistory::redo()
+{
+    sigma::core::util::ScopedWriteLock lock(m_board->get_lock());
+
+    if(m_step_depth > 0)
+    {
+        throw arc::ex::StateError("Cannot redo while a step is in progress");
+    }
+    if(m_redo_steps.empty())
+    {
+        return false;
+    }
+
+    m_undo_steps.push_back(Step());
+    std::swap(m_undo_steps.back(), m_redo_steps.back());
+    m_redo_steps.pop_back();
+
+    ++m_suspended;
+    try
+    {
+        ARC_CONST_FOR_EACH(op, m_undo_steps.back().operations)
+        {
+            apply(*op);
+        }
+    }
+    catch(...)
+    {
+        --m_suspended;
+        clear();
+        throw;
+    }
+    --m_suspended;
+
+    return true;
+}
+
+void TaskHistory::clear()
+{
+    m_undo_steps.clear();
+    m_redo_steps.clear();
+    m_memory_usage = 0;
+
+    // keep the currently open step so that recording can continue into it
+    if(m_step_depth > 0)
+    {
+        m_undo_steps.push_back(Step());
+        m_memory_usage += m_undo_steps.back().bytes;
+    }
+}
+
+std::size_t TaskHistory::get_memory_usage() const
+{
+    return m_memory_usage;
+}
+
+std::size_t TaskHistory::get_memory_budget() const
+{
+    return m_memory_budget;
+}
+
+void TaskHistory::set_memory_budget(std::size_t bytes)
+{
+    sigma::core::util::ScopedWriteLock lock(m_board->get_lock());
+
+    m_memory_budget = bytes;
+    if(m_memory_budget == 0)
+    {
+        clear();
+    }
+    else
+    {
+        enforce_budget();
+    }
+}
+
+//------------------------------------------------------------------------------
+//                              PRIVATE CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+TaskHistory::TaskHistory(RootTask* board)
+    :
+    m_board        (board),
+    m_step_depth   (0),
+    m_suspended    (0),
+    m_memory_usage (0),
+    m_memory_budget(DEFAULT_MEMORY_BUDGET)
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool TaskHistory::is_recording() const
+{
+    return m_suspended == 0 && m_memory_budget > 0;
+}
+
+void TaskHistory::record_created(Task* task)
+{
+    if(!is_recording())
+    {
+        return;
+    }
+
+    Operation op;
+    op.type          = OP_CREATE;
+    op.id            = task->get_id();
+    op.parent_id     = task->get_parent()->get_id();
+    op.new_parent_id = 0;
+    op.index         = static_cast<arc::uint32>(
+            task->get_parent()->get_children_count() - 1);
+    op.new_index     = 0;
+    TaskSerialiser::write_string(task->get_title(), op.data);
+    record(op);
+}
+
+void TaskHistory::record_deleted(Task* task)
+{
+    if(!is_recording())
+    {
+        return;
+    }
+
+    Operation op;
+    op.type          = OP_DELETE;
+    op.id            = task->get_id();
+    op.parent_id     = task->get_parent()->get_id();
+    op.new_parent_id = 0;
+    op.index         = static_cast<arc::uint32>(
+            task->get_parent()->find_child_index(task));
+    op.new_index     = 0;
+    TaskSerialiser::serialise(task, op.data);
+
+    // the tags are looked up by id since some of the subtree may be archived
+    const arc::uint8* data = op.data.data();
+    std::vector<arc::uint32> ids;
+    TaskSerialiser::skip(data, data + op.data.size(), 1, ids);
+    const TagIndex& index = m_board->get_domain()->get_tags();
+    std::vector<arc::str::UTF8String> tags;
+    ARC_CONST_FOR_EACH(id, ids)
+    {
+        tags.clear();
+        index.get_tags(*id, tags);
+        if(tags.empty())
+        {
+            continue;
+        }
+        TaskSerialiser::write_uint(*id, op.tags);
+        TaskSerialiser::write_uint(tags.size(), op.tags);
+        ARC_CONST_FOR_EACH(tag, tags)
+        {
+            TaskSerialiser::write_string(*tag, op.tags);
+        }
+    }
+    record(op);
+}
+
+void TaskHistory::record_inserted(Task* task)
+{
+    if(!is_recording())
+    {
+        return;
+    }
+
+    Operation op;
+    op.type          = OP_INSERT;
+    op.id            = task->get_id();
+    op.parent_id     = task->get_parent()->get_id();
+    op.new_parent_id = 0;
+    op.index         = static_cast<arc::uint32>(
+            task->get_parent()->find_child_index(task));
+    op.new_index     = 0;
+    TaskSerialiser::serialise(task, op.data);
+    record(op);
+}
+
+void TaskHistory::record_moved(
+        Task* task,
+        Task* old_parent,
+        std::size_t old_index,
+        std::size_t new_index)
+{
+    if(!is_recording())
+    {
+        return;
+    }
+
+    Operation op;
+    op.type          = OP_MOVE;
+    op.id            = task->get_id();
+    op.parent_id     = old_parent->get_id();
+    op.new_parent_id = task->get_parent()->get_id();
+    op.index         = static_cast<arc::uint32>(old_index);
+    op.new_index     = static_cast<arc::uint32>(new_index);
+    record(op);
+}
+
+void TaskHistory::record_retitled(
+        Task* task,
+        const arc::str::UTF8String& old_title)
+{
+    if(!is_recording())
+    {
+        return;
+    }
+
+    Operation op;
+    op.type          = OP_RETITLE;
+    op.id            = task->get_id();
+    op.parent_id     = 0;
+    op.new_parent_id = 0;
+    op.index         = 0;
+    op.new_index     = 0;
+    TaskSerialiser::write_string(old_title, op.data);
+    TaskSerialiser::write_string(task->get_title(), op.data);
+    record(op);
+}
+
+void TaskHistory::record_attributes_changed(
+        Task* task,
+        const TaskAttributes& old_attributes)
+{
+    if(!is_recording())
+    {
+        return;
+    }
+
+    Operation op;
+    op.type          = OP_SET_ATTRIBUTES;
+    op.id            = task->get_id();
+    op.parent_id     = 0;
+    op.new_parent_id = 0;
+    op.index         = 0;
+    op.new_index     = 0;
+    TaskSerialiser::write_attributes(old_attributes, op.data);
+    TaskSerialiser::write_attributes(task->get_attributes(), op.data);
+    record(op);
+}
+
+void TaskHistory::record_reordered(
+        Task* parent,
+        const std::vector<Task*>& old_children)
+{
+    if(!is_recording())
+    {
+        return;
+    }
+
+    Operation op;
+    op.type          = OP_REORDER;
+    op.id            = parent->get_id();
+    op.parent_id     = 0;
+    op.new_parent_id = 0;
+    op.index         = 0;
+    op.new_index     = 0;
+    TaskSerialiser::write_uint(old_children.size(), op.data);
+    ARC_CONST_FOR_EACH(it, old_children)
+    {
+        TaskSerialiser::write_uint((*it)->get_id(), op.data);
+    }
+    ARC_CONST_FOR_EACH(it, parent->get_chidren())
+    {
+        TaskSerialiser::write_uint((*it)->get_id(), op.data);
+    }
+    record(op);
+}
+
+std::vector<Task*> TaskHistory::read_children(
+        const Operation& operation,
+        bool new_order) const
+{
+    const arc::uint8* data = operation.data.data();
+    const arc::uint8* end = data + operation.data.size();
+
+    // both orders share the count at the start of the data
+    std::size_t count =
+        static_cast<std::size_t>(TaskSerialiser::read_uint(data, end));
+    if(new_order)
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            TaskSerialiser::read_uint(data, end);
+        }
+    }
+
+    std::vector<Task*> children;
+    children.reserve(count);
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        children.push_back(lookup(
+                static_cast<arc::uint32>(TaskSerialiser::read_uint(data, end))
+        ));
+    }
+    return children;
+}
+
+void TaskHistory::record(Operation& operation)
+{
+    // new modifications invalidate anything that could be redone
+    ARC_CONST_FOR_EACH(it, m_redo_steps)
+    {
+        m_memory_usage -= it->bytes;
+    }
+    m_redo_steps.clear();
+
+    // ungrouped modifications are their own step
+    if(m_step_depth == 0)
+    {
+        m_undo_steps.push_back(Step());
+        m_memory_usage += m_undo_steps.back().bytes;
+    }
+
+    std::size_t bytes = get_operation_bytes(operation);
+    Step& step = m_undo_steps.back();
+    step.operations.push_back(Operation());
+    std::swap(step.operations.back(), operation);
+    step.bytes += bytes;
+    m_memory_usage += bytes;
+
+    enforce_budget();
+}
+
+Task* TaskHistory::lookup(arc::uint32 id) const
+{
+    Task* task = m_board->find_task(id);
+    if(task == nullptr)
+    {
+        throw arc::ex::StateError(
+                "Task history refers to a Task that no longer exists");
+    }
+    return task;
+}
+
+void TaskHistory::restore_tags(const Operation& operation)
+{
+    const arc::uint8* data = operation.tags.data();
+    const arc::uint8* end = data + operation.tags.size();
+    TagIndex& index = m_board->get_domain()->get_tags();
+    while(data != end)
+    {
+        arc::uint32 id =
+            static_cast<arc::uint32>(TaskSerialiser::read_uint(data, end));
+        Task* task = lookup(id);
+        arc::uint64 count = TaskSerialiser::read_uint(data, end);
+        for(arc::uint64 i = 0; i < count; ++i)
+        {
+            index.add_tag(task, TaskSerialiser::read_string(data, end));
+        }
+    }
+}
+
+void TaskHistory::apply_inverse(const Operation& operation)
+{
+    const arc::uint8* data = operation.data.data();
+    const arc::uint8* end = data + operation.data.size();
+
+    switch(operation.type)
+    {
+        case OP_CREATE:
+        {
+            delete lookup(operation.id);
+            break;
+        }
+        case OP_DELETE:
+        {
+            TaskSerialiser::deserialise(
+                    lookup(operation.parent_id),
+                    operation.index,
+                    data,
+                    operation.data.size()
+            );
+            restore_tags(operation);
+            break;
+        }
+        case OP_INSERT:
+        {
+            delete lookup(operation.id);
+            break;
+        }
+        case OP_MOVE:
+        {
+            lookup(operation.id)->move_internal(
+                    lookup(operation.parent_id),
+                    operation.index
+            );
+            break;
+        }
+        case OP_RETITLE:
+        {
+            arc::str::UTF8String old_title(
+                    TaskSerialiser::read_string(data, end));
+            lookup(operation.id)->set_title(old_title);
+            break;
+        }
+        case OP_SET_ATTRIBUTES:
+        {
+            TaskAttributes old_attributes;
+            TaskSerialiser::read_attributes(data, end, old_attributes);
+            lookup(operation.id)->set_attributes(old_attributes);
+            break;
+        }
+        case OP_REORDER:
+        {
+            Task* parent = lookup(operation.id);
+            parent->reorder_children_internal(read_children(operation, false));
+            break;
+        }
+    }
+}
+
+void TaskHistory::apply(const Operation& operation)
+{
+    const arc::uint8* data = operation.data.data();
+    const arc::uint8* end = data + operation.data.size();
+
+    switch(operation.type)
+    {
+        case OP_CREATE:
+        {
+            arc::str::UTF8String title(TaskSerialiser::read_string(data, end));
+            new Task(
+                    lookup(operation.parent_id),
+                    title,
+                    operation.id,
+                    operation.index
+            );
+            break;
+        }
+        case OP_DELETE:
+        {
+            delete lookup(operation.id);
+            break;
+        }
+        case OP_INSERT:
+        {
+            TaskSerialiser::deserialise(
+                    lookup(operation.parent_id),
+                    operation.index,
+                    data,
+                    operation.data.size()
+            );
+            break;
+        }
+        case OP_MOVE:
+        {
+            lookup(operation.id)->move_internal(
+                    lookup(operation.new_parent_id),
+                    operation.new_index
+            );
+            break;
+        }
+        case OP_RETITLE:
+        {
+            // skip the old title
+            TaskSerialiser::read_string(data, end);
+            arc::str::UTF8String new_title(
+                    TaskSerialiser::read_string(data, end));
+            lookup(operation.id)->set_title(new_title);
+            break;
+        }
+        case OP_SET_ATTRIBUTES:
+        {
+            // skip the old attributes
+            TaskAttributes attributes;
+            TaskSerialiser::read_attributes(data, end, attributes);
+            TaskSerialiser::read_attributes(data, end, attributes);
+            lookup(operation.id)->set_attributes(attributes);
+            break;
+        }
+        case OP_REORDER:
+        {
+            Task* parent = lookup(operation.id);
+            parent->reorder_children_internal(read_children(operation, true));
+            break;
+        }
+    }
+}
+
+std::size_t TaskHistory::get_operation_bytes(const Operation& operation)
+{
+    return sizeof(Operation) +
+           operation.data.capacity() +
+           operation.tags.capacity();
+}
+
+void TaskHistory::enforce_budget()
+{
+    // drop redo steps before undo steps, since they're less likely to be used
+    while(m_memory_usage > m_memory_budget && !m_redo_steps.empty())
+    {
+        m_memory_usage -= m_redo_steps.front().bytes;
+        m_redo_steps.erase(m_redo_steps.begin());
+    }
+
+    // the step currently being recorded can't be dropped until it's ended
+    std::size_t keep = m_step_depth > 0 ? 1 : 0;
+    while(m_memory_usage > m_memory_budget && m_undo_steps.size() > keep)
+    {
+        m_memory_usage -= m_undo_steps.front().bytes;
+        m_undo_steps.pop_front();
+    }
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
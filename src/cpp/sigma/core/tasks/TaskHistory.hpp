@@ -0,0 +1,403 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Undo and redo of modifications made to a Task board.
+ */
+#ifndef SIGMA_CORE_TASKS_TASKHISTORY_HPP_
+#define SIGMA_CORE_TASKS_TASKHISTORY_HPP_
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include "sigma/core/tasks/TaskAttributes.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class RootTask;
+class Task;
+
+/*!
+ * \brief Records the modifications made to the Tasks of a board so that they
+ *        can be undone and redone.
+ *
+ * Every board has its own TaskHistory which is accessed through
+ * RootTask::get_history(). Modifications are recorded as a compact log of
+ * operations rather than copies of the board:
+ *
+ * - Creating a Task records its id, parent, position and title.
+ * - Moving a Task records its previous and new parent and position.
+ * - Changing a title records the previous and new title.
+ * - Changing the typed attributes of a Task records the previous and new
+ *   TaskAttributes.
+ * - Sorting the children of a Task records the ids of the children in their
+ *   previous and new orders.
+ * - Deleting a Task records the deleted subtree encoded with the
+ *   TaskSerialiser, along with the tags of the subtree (see
+ *   TasksDomain::get_tags()).
+ * - Inserting a subtree that keeps its ids (see TaskMerge) records the
+ *   inserted subtree encoded with the TaskSerialiser.
+ *
+ * Undoing an operation therefore only costs time proportional to the Tasks it
+ * affected, for example undoing the deletion of a subtree is proportional to
+ * the size of that subtree.
+ *
+ * Operations are grouped into user visible steps. By default each
+ * modification is its own step, but any modifications made between
+ * begin_step() and end_step() are undone and redone together.
+ *
+ * The memory used by the history is bounded by a budget (see
+ * set_memory_budget()), once the budget is exceeded the oldest steps are
+ * discarded.
+ *
+ * \note Undoing the deletion of a Task creates new Task objects with the same
+ *       ids as the deleted Tasks. Pointers to the deleted Tasks remain
+ *       invalid, Tasks should be looked up again using RootTask::find_task().
+ *
+ * \warning Moving a Task to a different board cannot be undone, since the
+ *          move would belong to the histories of both boards. Instead the
+ *          undo and redo steps of both boards are discarded. This applies to
+ *          Task::set_parent() with a parent on another board and to
+ *          TasksDomain::move_subtree_to_board(),
+ *          TasksDomain::merge_boards() and TasksDomain::split_board().
+ */
+class TaskHistory
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(TaskHistory);
+
+    //--------------------------------------------------------------------------
+    //                                  FRIENDS
+    //--------------------------------------------------------------------------
+
+    friend class RootTask;
+    friend class Task;
+    friend class TaskMerge;
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                             PUBLIC CONSTANTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The default memory budget of a TaskHistory in bytes.
+     */
+    static const std::size_t DEFAULT_MEMORY_BUDGET;
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Begins a step that groups all following modifications until the
+     *        matching end_step() is called.
+     *
+     * Steps may be nested, in which case the modifications are grouped into
+     * the outermost step.
+     *
+     * \param label Optional user visible description of the step.
+     */
+    void begin_step(const arc::str::UTF8String& label = "");
+
+    /*!
+     * \brief Ends the current step.
+     *
+     * \throws arc::ex::StateError If there is no step to end.
+     */
+    void end_step();
+
+    /*!
+     * \brief Returns whether there is a step that can be undone.
+     */
+    bool can_undo() const;
+
+    /*!
+     * \brief Returns whether there is a step that can be redone.
+     */
+    bool can_redo() const;
+
+    /*!
+     * \brief Returns the number of steps that can be undone.
+     */
+    std::size_t get_undo_count() const;
+
+    /*!
+     * \brief Returns the number of steps that can be redone.
+     */
+    std::size_t get_redo_count() const;
+
+    /*!
+     * \brief Returns the label of the step that will be undone next.
+     *
+     * \throws arc::ex::StateError If there is no step to undo.
+     */
+    const arc::str::UTF8String& get_undo_label() const;
+
+    /*!
+     * \brief Undoes the most recent step.
+     *
+     * \return Whether there was a step to undo.
+     */
+    bool undo();
+
+    /*!
+     * \brief Redoes the most recently undone step.
+     *
+     * \return Whether there was a step to redo.
+     */
+    bool redo();
+
+    /*!
+     * \brief Discards all recorded steps.
+     */
+    void clear();
+
+    /*!
+     * \brief Returns the approximate number of bytes currently used by the
+     *        recorded steps.
+     */
+    std::size_t get_memory_usage() const;
+
+    /*!
+     * \brief Returns the maximum number of bytes the recorded steps may use.
+     */
+    std::size_t get_memory_budget() const;
+
+    /*!
+     * \brief Sets the maximum number of bytes the recorded steps may use.
+     *
+     * The oldest steps are discarded until the history fits within the
+     * budget. A budget of 0 disables recording.
+     */
+    void set_memory_budget(std::size_t bytes);
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                               ENUMERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The types of operation that can be recorded.
+     */
+    enum OperationType
+    {
+        OP_CREATE,
+        OP_DELETE,
+        OP_MOVE,
+        OP_RETITLE,
+        OP_SET_ATTRIBUTES,
+        OP_REORDER,
+        OP_INSERT
+    };
+
+    //--------------------------------------------------------------------------
+    //                            PRIVATE STRUCTURES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A single recorded operation.
+     *
+     * Titles and subtrees are stored encoded in the data buffer.
+     */
+    struct Operation
+    {
+        /// The type of the operation.
+        arc::uint8 type;
+        /// The id of the Task that was modified.
+        arc::uint32 id;
+        /// The parent of the Task (before the operation for moves).
+        arc::uint32 parent_id;
+        /// The parent of the Task after a move.
+        arc::uint32 new_parent_id;
+        /// The position of the Task (before the operation for moves).
+        arc::uint32 index;
+        /// The position of the Task after a move.
+        arc::uint32 new_index;
+        /// The encoded title(s), attributes, subtree or child ids.
+        std::vector<arc::uint8> data;
+        /// The encoded tags of a deleted subtree.
+        std::vector<arc::uint8> tags;
+    };
+
+    /*!
+     * \brief A user visible group of operations.
+     */
+    struct Step
+    {
+        /// The label of the step.
+        arc::str::UTF8String label;
+        /// The operations in the order they were performed.
+        std::vector<Operation> operations;
+        /// The approximate number of bytes used by this step.
+        std::size_t bytes;
+
+        Step() : bytes(sizeof(Step)) {}
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The board this history belongs to.
+     */
+    RootTask* m_board;
+    /*!
+     * \brief The steps that can be undone, from oldest to newest.
+     */
+    std::deque<Step> m_undo_steps;
+    /*!
+     * \brief The steps that can be redone, from oldest to newest undo.
+     */
+    std::vector<Step> m_redo_steps;
+    /*!
+     * \brief The depth of begin_step() calls.
+     */
+    arc::uint32 m_step_depth;
+    /*!
+     * \brief While greater than zero modifications are not recorded.
+     */
+    arc::uint32 m_suspended;
+    /*!
+     * \brief The bytes used by all recorded steps.
+     */
+    std::size_t m_memory_usage;
+    /*!
+     * \brief The maximum number of bytes recorded steps may use.
+     */
+    std::size_t m_memory_budget;
+
+    //--------------------------------------------------------------------------
+    //                            PRIVATE CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates an empty history for the given board.
+     */
+    explicit TaskHistory(RootTask* board);
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns whether modifications should currently be recorded.
+     */
+    bool is_recording() const;
+
+    /*!
+     * \brief Records that the given Task has been created.
+     */
+    void record_created(Task* task);
+
+    /*!
+     * \brief Records that the given Task and its descendants are about to be
+     *        deleted.
+     */
+    void record_deleted(Task* task);
+
+    /*!
+     * \brief Records that the given Task and its descendants have been
+     *        inserted with their existing ids.
+     */
+    void record_inserted(Task* task);
+
+    /*!
+     * \brief Records that the given Task has been moved.
+     */
+    void record_moved(
+            Task* task,
+            Task* old_parent,
+            std::size_t old_index,
+            std::size_t new_index);
+
+    /*!
+     * \brief Records that the given Task has had its title changed.
+     */
+    void record_retitled(Task* task, const arc::str::UTF8String& old_title);
+
+    /*!
+     * \brief Records that the given Task has had its typed attributes changed.
+     */
+    void record_attributes_changed(
+            Task* task,
+            const TaskAttributes& old_attributes);
+
+    /*!
+     * \brief Records that the children of the given Task have been reordered.
+     *
+     * \param old_children The children of the Task in their previous order.
+     */
+    void record_reordered(
+            Task* parent,
+            const std::vector<Task*>& old_children);
+
+    /*!
+     * \brief Returns the children in either the previous or the new order
+     *        encoded in the given reorder operation.
+     */
+    std::vector<Task*> read_children(
+            const Operation& operation,
+            bool new_order) const;
+
+    /*!
+     * \brief Adds the given operation to the current step.
+     */
+    void record(Operation& operation);
+
+    /*!
+     * \brief Returns the Task with the given id on this board.
+     *
+     * \throws arc::ex::StateError If the Task does not exist.
+     */
+    Task* lookup(arc::uint32 id) const;
+
+    /*!
+     * \brief Tags the Tasks of a restored subtree with the tags recorded by
+     *        the given delete operation.
+     */
+    void restore_tags(const Operation& operation);
+
+    /*!
+     * \brief Reverts the given operation.
+     */
+    void apply_inverse(const Operation& operation);
+
+    /*!
+     * \brief Performs the given operation again.
+     */
+    void apply(const Operation& operation);
+
+    /*!
+     * \brief Returns the approximate number of bytes used by an operation.
+     */
+    static std::size_t get_operation_bytes(const Operation& operation);
+
+    /*!
+     * \brief Discards the oldest steps until the history fits within the
+     *        memory budget.
+     */
+    void enforce_budget();
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
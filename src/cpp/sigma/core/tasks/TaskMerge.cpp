@@ -0,0 +1,580 @@
+#include "sigma/core/tasks/TaskMerge.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include <arcanecore/base/Exceptions.hpp>
+
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TaskDiff.hpp"
+#include "sigma/core/tasks/TaskSerialiser.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Three-way merges a single value, their value is only taken if our
+ *        value is unchanged from the base.
+ *
+ * \return False if both versions changed the value to different values.
+ */
+template<typename T>
+bool merge_value(const T& base, const T& theirs, T& ours)
+{
+    if(theirs == base || theirs == ours)
+    {
+        return true;
+    }
+    if(ours == base)
+    {
+        ours = theirs;
+        return true;
+    }
+    return false;
+}
+
+/*!
+ * \brief Orders changes by the position of the Task in the after version.
+ */
+bool by_after_index(const TaskChange* a, const TaskChange* b)
+{
+    return a->after_index < b->after_index;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                PRIVATE CLASSES
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Performs a single merge.
+ *
+ * Their changes are applied in an order that keeps each step valid: added
+ * subtrees first (since moved Tasks may be placed under them), then moves,
+ * then modifications and finally removals (since Tasks they moved out of a
+ * removed subtree must be moved before it's removed). Within each group
+ * changes are applied in order of their position in their version, so that
+ * the preceding sibling a Task is positioned after has already been placed.
+ */
+class TaskMerge::Merger
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(Merger);
+
+public:
+
+    Merger(RootTask* ours, std::vector<TaskConflict>& conflicts)
+        :
+        m_ours     (ours),
+        m_conflicts(conflicts)
+    {
+    }
+
+    void run(const TaskSnapshot::Ptr& base, const TaskSnapshot::Ptr& theirs)
+    {
+        TaskSnapshot::Ptr ours(m_ours->snapshot());
+        m_tops.insert(base->get_id());
+        m_tops.insert(ours->get_id());
+        m_tops.insert(theirs->get_id());
+
+        TaskDiff::compute(base, ours, m_our_changes);
+        TaskDiff::compute(base, theirs, m_their_changes);
+
+        ARC_CONST_FOR_EACH(it, m_our_changes)
+        {
+            if(it->type == TaskChange::MOVED)
+            {
+                m_our_moves[it->id] = &(*it);
+            }
+        }
+        ARC_CONST_FOR_EACH(it, m_their_changes)
+        {
+            if(it->type == TaskChange::ADDED)
+            {
+                m_their_added.insert(it->id);
+            }
+            else if(it->type == TaskChange::REMOVED)
+            {
+                m_their_removed.insert(it->id);
+            }
+        }
+
+        std::vector<const TaskChange*> adds;
+        std::vector<const TaskChange*> moves;
+        std::vector<const TaskChange*> modifications;
+        std::vector<Removal> removals;
+        ARC_CONST_FOR_EACH(it, m_their_changes)
+        {
+            switch(it->type)
+            {
+                case TaskChange::ADDED:
+                {
+                    // descendants are inserted along with the top added Task
+                    if(is_new(it->id) && !is_new(it->after_parent->get_id()))
+                    {
+                        adds.push_back(&(*it));
+                    }
+                    break;
+                }
+                case TaskChange::MOVED:
+                {
+                    moves.push_back(&(*it));
+                    break;
+                }
+                case TaskChange::MODIFIED:
+                {
+                    // the top Tasks aren't merged
+                    if(it->before_parent)
+                    {
+                        modifications.push_back(&(*it));
+                    }
+                    break;
+                }
+                case TaskChange::REMOVED:
+                {
+                    if(m_their_removed.find(it->before_parent->get_id()) ==
+                       m_their_removed.end())
+                    {
+                        prepare_removal(*it, removals);
+                    }
+                    break;
+                }
+            }
+        }
+
+        std::stable_sort(adds.begin(), adds.end(), by_after_index);
+        ARC_CONST_FOR_EACH(it, adds)
+        {
+            add(**it);
+        }
+
+        std::stable_sort(moves.begin(), moves.end(), by_after_index);
+        move_all(moves);
+
+        ARC_CONST_FOR_EACH(it, modifications)
+        {
+            modify(**it);
+        }
+
+        ARC_CONST_FOR_EACH(it, removals)
+        {
+            remove(*it);
+        }
+    }
+
+private:
+
+    /*!
+     * \brief A subtree they removed, checked against our version before any
+     *        of their changes are applied.
+     */
+    struct Removal
+    {
+        const TaskChange* change;
+        /// Whether our version of the subtree is the same as the base.
+        bool unchanged;
+        /// The number of Tasks of the base subtree they removed, the others
+        /// were moved out.
+        std::size_t removed_count;
+    };
+
+    RootTask* m_ours;
+    std::vector<TaskConflict>& m_conflicts;
+
+    /// The ids of the top Tasks of the versions.
+    std::unordered_set<arc::uint32> m_tops;
+    std::vector<TaskChange> m_our_changes;
+    std::vector<TaskChange> m_their_changes;
+    /// Our moves by the id of the moved Task.
+    std::unordered_map<arc::uint32, const TaskChange*> m_our_moves;
+    std::unordered_set<arc::uint32> m_their_added;
+    std::unordered_set<arc::uint32> m_their_removed;
+
+    void conflict(TaskConflict::Type type, const TaskChange& change)
+    {
+        TaskConflict conflict;
+        conflict.type = type;
+        conflict.id = change.id;
+        conflict.base = change.before;
+        conflict.theirs = change.after;
+        m_conflicts.push_back(conflict);
+    }
+
+    /*!
+     * \brief Returns the Task in our board with the given id, where the ids of
+     *        all the top Tasks refer to our board.
+     */
+    Task* resolve(arc::uint32 id) const
+    {
+        if(m_tops.find(id) != m_tops.end())
+        {
+            return m_ours;
+        }
+        return m_ours->find_task(id);
+    }
+
+    /*!
+     * \brief Returns the id of the given parent, where all the top Tasks have
+     *        the same id.
+     */
+    arc::uint32 get_parent_id(const TaskSnapshot::Ptr& parent) const
+    {
+        arc::uint32 id = parent->get_id();
+        return m_tops.find(id) != m_tops.end() ? 0 : id;
+    }
+
+    /*!
+     * \brief Returns whether the Task with the given id was added by them and
+     *        doesn't exist in our board yet.
+     *
+     * Their added Tasks may already exist in our board if their version was
+     *  merged before.
+     */
+    bool is_new(arc::uint32 id) const
+    {
+        return m_their_added.find(id) != m_their_added.end() &&
+               m_ours->find_task(id) == nullptr;
+    }
+
+    /*!
+     * \brief Returns the nearest sibling before the Task of the given change
+     *        in their version which is a child of the given parent in our
+     *        board, or null if there is none.
+     */
+    Task* find_anchor(const TaskChange& change, Task* parent) const
+    {
+        const std::vector<TaskSnapshot::Ptr>& siblings =
+            change.after_parent->get_children();
+        for(std::size_t i = change.after_index; i-- > 0;)
+        {
+            Task* sibling = m_ours->find_task(siblings[i]->get_id());
+            if(sibling != nullptr && sibling->get_parent() == parent)
+            {
+                return sibling;
+            }
+        }
+        return nullptr;
+    }
+
+    /*!
+     * \brief Encodes the given Task and its new descendants with the
+     *        TaskSerialiser encoding.
+     *
+     * Descendants that aren't new are left out, they were moved under the
+     * Task and are moved separately.
+     */
+    void encode_added(
+            const TaskSnapshot::Ptr& top,
+            std::vector<arc::uint8>& out) const
+    {
+        std::vector<const TaskSnapshot*> stack(1, top.get());
+        std::vector<const TaskSnapshot*> children;
+        while(!stack.empty())
+        {
+            const TaskSnapshot* node = stack.back();
+            stack.pop_back();
+
+            TaskSerialiser::write_uint(node->get_id(), out);
+            TaskSerialiser::write_string(node->get_title(), out);
+            TaskSerialiser::write_attributes(node->get_attributes(), out);
+
+            children.clear();
+            ARC_CONST_FOR_EACH(child, node->get_children())
+            {
+                if(is_new((*child)->get_id()))
+                {
+                    children.push_back(child->get());
+                }
+            }
+            TaskSerialiser::write_uint(children.size(), out);
+            // pushed in reverse so the children are encoded in order
+            stack.insert(stack.end(), children.rbegin(), children.rend());
+        }
+    }
+
+    void add(const TaskChange& change)
+    {
+        Task* parent = resolve(change.after_parent->get_id());
+        if(parent == nullptr)
+        {
+            conflict(TaskConflict::CHANGED_REMOVED, change);
+            return;
+        }
+
+        Task* anchor = find_anchor(change, parent);
+        std::size_t index = 0;
+        if(anchor != nullptr)
+        {
+            index = parent->find_child_index(anchor) + 1;
+        }
+
+        std::vector<arc::uint8> data;
+        encode_added(change.after, data);
+        Task* task = TaskSerialiser::deserialise(
+                parent,
+                index,
+                data.data(),
+                data.size()
+        );
+        m_ours->get_history().record_inserted(task);
+    }
+
+    /*!
+     * \brief Applies their moves, retrying moves that would currently create
+     *        a cycle until no more can be applied.
+     *
+     * A move can be blocked by another of their moves, for example when they
+     * swapped a parent and child.
+     */
+    void move_all(const std::vector<const TaskChange*>& moves)
+    {
+        std::vector<const TaskChange*> pending(moves);
+        while(!pending.empty())
+        {
+            std::vector<const TaskChange*> blocked;
+            ARC_CONST_FOR_EACH(it, pending)
+            {
+                if(!move(**it))
+                {
+                    blocked.push_back(*it);
+                }
+            }
+            if(blocked.size() == pending.size())
+            {
+                ARC_CONST_FOR_EACH(it, blocked)
+                {
+                    conflict(TaskConflict::CYCLE, **it);
+                }
+                break;
+            }
+            pending.swap(blocked);
+        }
+    }
+
+    /*!
+     * \return False if the move would create a cycle.
+     */
+    bool move(const TaskChange& change)
+    {
+        Task* task = m_ours->find_task(change.id);
+        Task* parent = resolve(change.after_parent->get_id());
+        if(task == nullptr || parent == nullptr)
+        {
+            conflict(TaskConflict::CHANGED_REMOVED, change);
+            return true;
+        }
+
+        // our move wins if we changed the parent, their reordering is only
+        // taken if we moved it within the same parent
+        std::unordered_map<arc::uint32, const TaskChange*>::const_iterator
+            ours = m_our_moves.find(change.id);
+        if(ours != m_our_moves.end())
+        {
+            arc::uint32 our_parent = get_parent_id(ours->second->after_parent);
+            if(our_parent != get_parent_id(ours->second->before_parent))
+            {
+                if(our_parent != get_parent_id(change.after_parent))
+                {
+                    conflict(TaskConflict::MOVED_BOTH, change);
+                }
+                return true;
+            }
+        }
+
+        if(parent == task || task->find_common_ancestor(parent) == task)
+        {
+            return false;
+        }
+
+        Task* anchor = find_anchor(change, parent);
+        if(anchor != nullptr)
+        {
+            task->move_after(anchor);
+        }
+        else if(parent->get_children_count() == 0)
+        {
+            task->set_parent(parent);
+        }
+        else
+        {
+            task->move_before(parent->get_chidren()[0]);
+        }
+        return true;
+    }
+
+    void modify(const TaskChange& change)
+    {
+        Task* task = m_ours->find_task(change.id);
+        if(task == nullptr)
+        {
+            conflict(TaskConflict::CHANGED_REMOVED, change);
+            return;
+        }
+
+        const TaskAttributes& base = change.before->get_attributes();
+        const TaskAttributes& theirs = change.after->get_attributes();
+        arc::str::UTF8String title(task->get_title());
+        TaskAttributes attributes(task->get_attributes());
+
+        bool merged = merge_value(
+                change.before->get_title(),
+                change.after->get_title(),
+                title
+        );
+        merged &= merge_value(base.status, theirs.status, attributes.status);
+        merged &= merge_value(
+                base.priority,
+                theirs.priority,
+                attributes.priority
+        );
+        merged &= merge_value(
+                base.estimate,
+                theirs.estimate,
+                attributes.estimate
+        );
+        merged &= merge_value(
+                base.assignee,
+                theirs.assignee,
+                attributes.assignee
+        );
+        // the due date is merged as a whole
+        std::pair<bool, arc::int64> due_date(
+                attributes.has_due_date,
+                attributes.due_date
+        );
+        merged &= merge_value(
+                std::make_pair(base.has_due_date, base.due_date),
+                std::make_pair(theirs.has_due_date, theirs.due_date),
+                due_date
+        );
+        attributes.has_due_date = due_date.first;
+        attributes.due_date = due_date.second;
+        // flags are merged bit by bit, bits changed by both versions have the
+        // same value in both
+        attributes.flags ^=
+            (theirs.flags ^ base.flags) & ~(attributes.flags ^ base.flags);
+
+        if(title != task->get_title())
+        {
+            task->set_title(title);
+        }
+        task->set_attributes(attributes);
+        if(!merged)
+        {
+            conflict(TaskConflict::MODIFIED_BOTH, change);
+        }
+    }
+
+    void prepare_removal(const TaskChange& change, std::vector<Removal>& out)
+    {
+        Task* task = m_ours->find_task(change.id);
+        if(task == nullptr)
+        {
+            // we removed it too
+            return;
+        }
+
+        Removal removal;
+        removal.change = &change;
+        removal.unchanged = task->get_hash() == change.before->get_hash();
+        removal.removed_count = 0;
+        std::vector<const TaskSnapshot*> stack(1, change.before.get());
+        while(!stack.empty())
+        {
+            const TaskSnapshot* node = stack.back();
+            stack.pop_back();
+            if(m_their_removed.find(node->get_id()) != m_their_removed.end())
+            {
+                ++removal.removed_count;
+            }
+            ARC_CONST_FOR_EACH(child, node->get_children())
+            {
+                stack.push_back(child->get());
+            }
+        }
+        out.push_back(removal);
+    }
+
+    void remove(const Removal& removal)
+    {
+        Task* task = m_ours->find_task(removal.change->id);
+        if(task == nullptr)
+        {
+            return;
+        }
+
+        // Tasks they moved out of the subtree but that couldn't be moved in
+        // our board would be removed along with it
+        if(!removal.unchanged ||
+           task->get_descendant_count() + 1 != removal.removed_count)
+        {
+            conflict(TaskConflict::REMOVED_CHANGED, *removal.change);
+            return;
+        }
+        task->get_parent()->remove_child(task);
+    }
+};
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+void TaskMerge::merge(
+        const TaskSnapshot::Ptr& base,
+        RootTask* ours,
+        const TaskSnapshot::Ptr& theirs,
+        std::vector<TaskConflict>& conflicts)
+{
+    if(!base || ours == nullptr || !theirs)
+    {
+        throw arc::ex::ValueError("Cannot merge a null version of a board");
+    }
+
+    sigma::core::util::ScopedWriteLock lock(ours->get_lock());
+
+    TaskHistory& history = ours->get_history();
+    history.begin_step("Merge");
+    try
+    {
+        Merger merger(ours, conflicts);
+        merger.run(base, theirs);
+    }
+    catch(...)
+    {
+        history.end_step();
+        throw;
+    }
+    history.end_step();
+}
+
+void TaskMerge::merge(
+        const RootTask* base,
+        RootTask* ours,
+        const RootTask* theirs,
+        std::vector<TaskConflict>& conflicts)
+{
+    if(base == nullptr || ours == nullptr || theirs == nullptr)
+    {
+        throw arc::ex::ValueError("Cannot merge a null version of a board");
+    }
+    merge(base->snapshot(), ours, theirs->snapshot(), conflicts);
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
@@ -0,0 +1,164 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Three-way merging of divergent versions of a Task board.
+ */
+#ifndef SIGMA_CORE_TASKS_TASKMERGE_HPP_
+#define SIGMA_CORE_TASKS_TASKMERGE_HPP_
+
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+
+#include "sigma/core/tasks/TaskSnapshot.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class RootTask;
+
+/*!
+ * \brief A change from their version of a board that couldn't be merged into
+ *        our version.
+ */
+struct TaskConflict
+{
+    //--------------------------------------------------------------------------
+    //                                ENUMERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The kinds of conflict.
+     */
+    enum Type
+    {
+        /// Both versions changed the same title or attribute of the Task to
+        /// different values.
+        MODIFIED_BOTH,
+        /// Both versions moved the Task to different parents.
+        MOVED_BOTH,
+        /// Their version modified, moved or added the Task but our version
+        /// removed it or the parent it was placed under.
+        CHANGED_REMOVED,
+        /// Their version removed the Task but our version changed it or its
+        /// descendants.
+        REMOVED_CHANGED,
+        /// Their move would make the Task a descendant of itself in our
+        /// version.
+        CYCLE
+    };
+
+    //--------------------------------------------------------------------------
+    //                                 ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /// The kind of conflict.
+    Type type;
+    /// The id of the Task.
+    arc::uint32 id;
+    /// The Task in the base version, null if their version added the Task.
+    TaskSnapshot::Ptr base;
+    /// The Task in their version, null if their version removed the Task.
+    TaskSnapshot::Ptr theirs;
+};
+
+/*!
+ * \brief Merges the changes made to one version of a board into another
+ *        version of the board.
+ *
+ * A merge takes three versions of the board: the base version the other two
+ * were derived from, our version, which is a live board the merge is applied
+ * to, and their version. Versions of a board are typically copies made with
+ * TaskSerialiser::serialise_children() and TaskSerialiser::load_children(),
+ * or earlier snapshots of the same board. Tasks are matched between the
+ * versions by their ids, except for the top Tasks which are always matched
+ * with each other and are not merged themselves.
+ *
+ * The changes of both versions are found with TaskDiff, so the time taken is
+ * proportional to the number of changes rather than to the size of the board.
+ * Their changes are then applied to our board:
+ *
+ * - Tasks they added are inserted with the ids they have in their version.
+ * - Tasks they moved are moved to the same parent, positioned after the
+ *   nearest preceding sibling that is under that parent in our board.
+ * - Titles and attributes they modified are merged field by field, a field is
+ *   only taken from their version if our version didn't change it.
+ * - Tasks they removed are removed if our version didn't change them.
+ *
+ * Where both versions made incompatible changes our change is kept and a
+ * TaskConflict is reported.
+ *
+ * The merge is recorded as a single step of our board's TaskHistory, so it can
+ * be undone as a whole.
+ */
+class TaskMerge
+{
+private:
+
+    ARC_DISALLOW_CONSTRUCTION(TaskMerge);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Merges the changes between the base snapshot and their snapshot
+     *        into our board.
+     *
+     * \param base The version both other versions were derived from.
+     * \param ours The board to apply the changes to.
+     * \param theirs The version to take changes from.
+     * \param conflicts The changes of their version that couldn't be applied
+     *                  are appended to this vector.
+     *
+     * \throws arc::ex::ValueError If any of the versions are null.
+     */
+    static void merge(
+            const TaskSnapshot::Ptr& base,
+            RootTask* ours,
+            const TaskSnapshot::Ptr& theirs,
+            std::vector<TaskConflict>& conflicts);
+
+    /*!
+     * \brief Merges the changes between the base board and their board into
+     *        our board.
+     *
+     * This merges snapshots of the base and their boards, see
+     * RootTask::snapshot().
+     *
+     * \throws arc::ex::ValueError If any of the boards are null.
+     */
+    static void merge(
+            const RootTask* base,
+            RootTask* ours,
+            const RootTask* theirs,
+            std::vector<TaskConflict>& conflicts);
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE CLASSES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Performs a single merge, this is nested so that it shares the
+     *        access TaskMerge has to Task and TaskHistory.
+     */
+    class Merger;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
@@ -0,0 +1,728 @@
+#include "sigma/core/tasks/TaskQuery.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "sigma/core/tasks/RootTask.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                    CLASSES
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief A single ``field op value`` term of a query.
+ */
+struct Term
+{
+    std::string field;
+    std::string op;
+    std::string value;
+    bool quoted;
+    /// The position of the term in the query, for error messages.
+    std::size_t position;
+};
+
+/*!
+ * \brief Splits query text into terms.
+ */
+class Tokeniser
+{
+public:
+
+    explicit Tokeniser(const std::string& text)
+        :
+        m_text    (text),
+        m_position(0)
+    {
+    }
+
+    /*!
+     * \brief Reads the next term, returning false at the end of the query.
+     */
+    bool next(Term& term)
+    {
+        skip_whitespace();
+        if(m_position >= m_text.size())
+        {
+            return false;
+        }
+
+        term.position = m_position;
+        term.field.clear();
+        while(m_position < m_text.size() &&
+              ((m_text[m_position] >= 'a' && m_text[m_position] <= 'z') ||
+               m_text[m_position] == '_'))
+        {
+            term.field += m_text[m_position++];
+        }
+        if(term.field.empty())
+        {
+            error("Expected a field name");
+        }
+
+        term.op.clear();
+        if(m_position < m_text.size())
+        {
+            char c = m_text[m_position];
+            if(c == ':' || c == '~' || c == '=')
+            {
+                term.op += c;
+                ++m_position;
+            }
+            else if(c == '<' || c == '>')
+            {
+                term.op += c;
+                ++m_position;
+                if(m_position < m_text.size() && m_text[m_position] == '=')
+                {
+                    term.op += '=';
+                    ++m_position;
+                }
+            }
+        }
+        if(term.op.empty())
+        {
+            error("Expected an operator after \"" + term.field + "\"");
+        }
+
+        term.value.clear();
+        term.quoted = m_position < m_text.size() && m_text[m_position] == '"';
+        if(term.quoted)
+        {
+            read_quoted(term.value);
+        }
+        else
+        {
+            while(m_position < m_text.size() && !is_whitespace(m_position))
+            {
+                term.value += m_text[m_position++];
+            }
+        }
+        if(term.value.empty())
+        {
+            error("Expected a value after \"" + term.field + term.op + "\"");
+        }
+        return true;
+    }
+
+private:
+
+    const std::string& m_text;
+    std::size_t m_position;
+
+    bool is_whitespace(std::size_t position) const
+    {
+        char c = m_text[position];
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    void skip_whitespace()
+    {
+        while(m_position < m_text.size() && is_whitespace(m_position))
+        {
+            ++m_position;
+        }
+    }
+
+    void read_quoted(std::string& value)
+    {
+        std::size_t start = m_position++;
+        while(m_position < m_text.size())
+        {
+            char c = m_text[m_position++];
+            if(c == '"')
+            {
+                return;
+            }
+            if(c == '\\' && m_position < m_text.size())
+            {
+                c = m_text[m_position++];
+            }
+            value += c;
+        }
+        m_position = start;
+        error("Unterminated quoted value");
+    }
+
+    void error(const std::string& message) const
+    {
+        arc::str::UTF8String full(message.c_str());
+        full << " at position " << static_cast<arc::uint32>(m_position);
+        throw arc::ex::ParseError(full);
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+void term_error(const Term& term, const std::string& message)
+{
+    arc::str::UTF8String full(message.c_str());
+    full << " in term \"" << term.field.c_str() << term.op.c_str()
+         << term.value.c_str() << "\" at position "
+         << static_cast<arc::uint32>(term.position);
+    throw arc::ex::ParseError(full);
+}
+
+/*!
+ * \brief Returns whether the term uses one of the comparison operators, an
+ *        ``=`` is treated the same as a ``:``.
+ */
+bool is_comparison(const Term& term)
+{
+    return term.op == ":" || term.op == "=" || term.op == "<" ||
+           term.op == "<=" || term.op == ">" || term.op == ">=";
+}
+
+/*!
+ * \brief Narrows the inclusive range [min, max] by the comparison of the
+ *        given term against the given value.
+ */
+template<typename T>
+void narrow(const Term& term, T value, T& min, T& max)
+{
+    T lowest = std::numeric_limits<T>::min();
+    T highest = std::numeric_limits<T>::max();
+    if(term.op == "<")
+    {
+        if(value == lowest)
+        {
+            // nothing can match
+            min = highest;
+            max = lowest;
+            return;
+        }
+        max = std::min(max, static_cast<T>(value - 1));
+    }
+    else if(term.op == "<=")
+    {
+        max = std::min(max, value);
+    }
+    else if(term.op == ">")
+    {
+        if(value == highest)
+        {
+            min = highest;
+            max = lowest;
+            return;
+        }
+        min = std::max(min, static_cast<T>(value + 1));
+    }
+    else if(term.op == ">=")
+    {
+        min = std::max(min, value);
+    }
+    else
+    {
+        min = std::max(min, value);
+        max = std::min(max, value);
+    }
+}
+
+arc::uint32 parse_uint(const Term& term)
+{
+    arc::str::UTF8String value(term.value.c_str());
+    if(term.quoted || !value.is_uint())
+    {
+        term_error(term, "Expected a whole number");
+    }
+    return value.to_uint32();
+}
+
+arc::int64 parse_int(const Term& term)
+{
+    arc::str::UTF8String value(term.value.c_str());
+    if(term.quoted || !value.is_int())
+    {
+        term_error(term, "Expected a whole number");
+    }
+    return value.to_int64();
+}
+
+/*!
+ * \brief Returns the depth of the given Task below its RootTask.
+ */
+std::size_t get_depth(const Task* task)
+{
+    std::size_t depth = 0;
+    for(const Task* t = task; !t->is_root(); t = t->get_parent())
+    {
+        ++depth;
+    }
+    return depth;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC ATTRIBUTES
+//------------------------------------------------------------------------------
+
+const std::size_t TaskQuery::NO_LIMIT = std::numeric_limits<std::size_t>::max();
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+TaskQuery::TaskQuery(const arc::str::UTF8String& text)
+    :
+    m_text       (text),
+    m_indexed    (false),
+    m_has_under  (false),
+    m_under_is_id(false),
+    m_under_id   (0),
+    m_min_depth  (1),
+    m_max_depth  (std::numeric_limits<std::size_t>::max())
+{
+    parse();
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+const arc::str::UTF8String& TaskQuery::get_text() const
+{
+    return m_text;
+}
+
+const TaskFilter& TaskQuery::get_filter() const
+{
+    return m_filter;
+}
+
+bool TaskQuery::is_indexed() const
+{
+    return m_indexed;
+}
+
+bool TaskQuery::is_filter_only() const
+{
+    return m_boards.empty()           &&
+           !m_has_under               &&
+           m_titles.empty()           &&
+           m_title_substrings.empty() &&
+           m_min_depth <= 1           &&
+           m_max_depth == std::numeric_limits<std::size_t>::max();
+}
+
+bool TaskQuery::matches(const Task* task) const
+{
+    if(task == nullptr || task->is_root())
+    {
+        return false;
+    }
+
+    ARC_CONST_FOR_EACH(title, m_boards)
+    {
+        if(task->get_board()->get_title() != *title)
+        {
+            return false;
+        }
+    }
+
+    if(m_has_under)
+    {
+        bool found = false;
+        for(const Task* t = task->get_parent(); !found && !t->is_root();
+            t = t->get_parent())
+        {
+            found = m_under_is_id ?
+                t->get_id() == m_under_id :
+                t->get_title() == m_under_title;
+        }
+        if(!found)
+        {
+            return false;
+        }
+    }
+
+    return m_filter.matches(task->get_attributes()) &&
+           matches_residual(task, get_depth(task));
+}
+
+bool TaskQuery::stream(const RootTask* board, const TaskVisitor& visitor) const
+{
+    ARC_CONST_FOR_EACH(title, m_boards)
+    {
+        if(board->get_title() != *title)
+        {
+            return true;
+        }
+    }
+
+    if(board->get_archived_count() == 0)
+    {
+        return stream_resident(board, visitor);
+    }
+
+    // archived Tasks can't be rehydrated once the board is read locked, so
+    // they're rehydrated first and the board is brought back within its
+    // resident budget afterwards, keeping the Tasks that were visited
+    RootTask* mutable_board = const_cast<RootTask*>(board);
+    mutable_board->rehydrate_all();
+    std::vector<const Task*> visited;
+    bool complete = stream_resident(board, [&](Task* task)
+    {
+        visited.push_back(task);
+        return visitor(task);
+    });
+
+    sigma::core::util::ScopedWriteLock lock(board->get_lock());
+    mutable_board->enforce_resident_budget(visited);
+    return complete;
+}
+
+std::size_t TaskQuery::find(
+        const RootTask* board,
+        std::vector<Task*>& out,
+        std::size_t limit) const
+{
+    std::size_t found = 0;
+    if(limit == 0)
+    {
+        return found;
+    }
+
+    stream(board, [&](Task* task)
+    {
+        out.push_back(task);
+        return ++found < limit;
+    });
+    return found;
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool TaskQuery::stream_resident(
+        const RootTask* board,
+        const TaskVisitor& visitor) const
+{
+    // the walks below read the children directly so they never rehydrate
+    sigma::core::util::ScopedReadLock lock(board->get_lock());
+
+    std::vector<const Task*> anchors;
+    find_anchors(board, anchors);
+    ARC_CONST_FOR_EACH(anchor, anchors)
+    {
+        if(!m_indexed)
+        {
+            if(!scan(*anchor, get_depth(*anchor), visitor))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        // select by the attribute columns, then check the remaining terms
+        TaskFilter filter(m_filter);
+        if(*anchor != board)
+        {
+            filter.under(*anchor);
+        }
+        std::vector<Task*> candidates;
+        board->find_tasks(filter, candidates);
+        ARC_CONST_FOR_EACH(it, candidates)
+        {
+            if(matches_residual(*it, get_depth(*it)) && !visitor(*it))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void TaskQuery::parse()
+{
+    std::string text(m_text.get_raw());
+    Tokeniser tokeniser(text);
+
+    arc::uint32 min_priority = PRIORITY_NONE;
+    arc::uint32 max_priority = PRIORITY_HIGH;
+    bool has_estimate = false;
+    arc::uint32 min_estimate = 0;
+    arc::uint32 max_estimate = std::numeric_limits<arc::uint32>::max();
+    bool has_due = false;
+    arc::int64 first_due = std::numeric_limits<arc::int64>::min();
+    arc::int64 last_due = std::numeric_limits<arc::int64>::max();
+
+    Term term;
+    while(tokeniser.next(term))
+    {
+        arc::str::UTF8String value(term.value.c_str());
+
+        if(term.field == "title")
+        {
+            if(term.op == ":" || term.op == "=")
+            {
+                m_titles.push_back(value);
+            }
+            else if(term.op == "~")
+            {
+                m_title_substrings.push_back(value);
+            }
+            else
+            {
+                term_error(term, "Titles can only be matched with : or ~");
+            }
+        }
+        else if(term.field == "under" || term.field == "board")
+        {
+            if(term.op != ":" && term.op != "=")
+            {
+                term_error(term, "Expected :");
+            }
+            if(term.field == "board")
+            {
+                m_boards.push_back(value);
+            }
+            else if(m_has_under)
+            {
+                term_error(term, "Queries may only have one under term");
+            }
+            else
+            {
+                m_has_under = true;
+                m_under_is_id = !term.quoted && value.is_uint();
+                if(m_under_is_id)
+                {
+                    m_under_id = value.to_uint32();
+                }
+                m_under_title = value;
+            }
+        }
+        else if(term.field == "depth")
+        {
+            if(!is_comparison(term))
+            {
+                term_error(term, "Expected a comparison");
+            }
+            std::size_t depth = parse_uint(term);
+            narrow<std::size_t>(term, depth, m_min_depth, m_max_depth);
+        }
+        else if(term.field == "status")
+        {
+            if(term.op != ":" && term.op != "=")
+            {
+                term_error(term, "Expected :");
+            }
+            static const char* names[] = {
+                "open", "in_progress", "blocked", "done"
+            };
+            std::size_t status = 0;
+            for(; status < 4 && term.value != names[status]; ++status);
+            if(status == 4)
+            {
+                term_error(term, "Unknown status");
+            }
+            m_filter.with_status(static_cast<TaskStatus>(status));
+            m_indexed = true;
+        }
+        else if(term.field == "priority")
+        {
+            if(!is_comparison(term))
+            {
+                term_error(term, "Expected a comparison");
+            }
+            static const char* names[] = {"none", "low", "medium", "high"};
+            arc::uint32 priority = 0;
+            for(; priority < 4 && term.value != names[priority]; ++priority);
+            if(priority == 4)
+            {
+                term_error(term, "Unknown priority");
+            }
+            narrow<arc::uint32>(term, priority, min_priority, max_priority);
+            m_indexed = true;
+        }
+        else if(term.field == "estimate")
+        {
+            if(!is_comparison(term))
+            {
+                term_error(term, "Expected a comparison");
+            }
+            narrow<arc::uint32>(
+                    term,
+                    parse_uint(term),
+                    min_estimate,
+                    max_estimate
+            );
+            has_estimate = true;
+            m_indexed = true;
+        }
+        else if(term.field == "due")
+        {
+            if(!is_comparison(term))
+            {
+                term_error(term, "Expected a comparison");
+            }
+            narrow<arc::int64>(term, parse_int(term), first_due, last_due);
+            has_due = true;
+            m_indexed = true;
+        }
+        else if(term.field == "assignee")
+        {
+            if(term.op != ":" && term.op != "=")
+            {
+                term_error(term, "Expected :");
+            }
+            m_filter.with_assignee(value);
+            m_indexed = true;
+        }
+        else if(term.field == "flag")
+        {
+            if(term.op != ":" && term.op != "=")
+            {
+                term_error(term, "Expected :");
+            }
+            if(term.value == "starred")
+            {
+                m_filter.with_flags(FLAG_STARRED);
+            }
+            else if(term.value == "milestone")
+            {
+                m_filter.with_flags(FLAG_MILESTONE);
+            }
+            else
+            {
+                term_error(term, "Unknown flag");
+            }
+            m_indexed = true;
+        }
+        else
+        {
+            term_error(term, "Unknown field");
+        }
+    }
+
+    if(min_priority > max_priority)
+    {
+        // an empty range that no priority is within
+        min_priority = PRIORITY_HIGH;
+        max_priority = PRIORITY_NONE;
+    }
+    m_filter.with_min_priority(static_cast<TaskPriority>(min_priority));
+    m_filter.with_max_priority(static_cast<TaskPriority>(max_priority));
+    if(has_estimate)
+    {
+        m_filter.with_estimate_between(min_estimate, max_estimate);
+    }
+    if(has_due)
+    {
+        m_filter.with_due_between(first_due, last_due);
+    }
+}
+
+bool TaskQuery::matches_residual(const Task* task, std::size_t depth) const
+{
+    if(depth < m_min_depth || depth > m_max_depth)
+    {
+        return false;
+    }
+    ARC_CONST_FOR_EACH(title, m_titles)
+    {
+        if(task->get_title() != *title)
+        {
+            return false;
+        }
+    }
+    ARC_CONST_FOR_EACH(substring, m_title_substrings)
+    {
+        if(task->get_title().find_first(*substring) == arc::str::npos)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TaskQuery::find_anchors(
+        const RootTask* board,
+        std::vector<const Task*>& anchors) const
+{
+    if(!m_has_under)
+    {
+        anchors.push_back(board);
+        return;
+    }
+
+    if(m_under_is_id)
+    {
+        const Task* anchor = board->find_task(m_under_id);
+        if(anchor != nullptr && anchor != board)
+        {
+            anchors.push_back(anchor);
+        }
+        return;
+    }
+
+    // find the Tasks with the title in pre-order, the descendants of a Task
+    // that is already an anchor are covered by that anchor, and Tasks at the
+    // maximum depth have no descendants that could match
+    std::vector<std::pair<const Task*, std::size_t>> stack;
+    stack.push_back(std::make_pair(board, 0));
+    while(!stack.empty())
+    {
+        const Task* task = stack.back().first;
+        std::size_t depth = stack.back().second;
+        stack.pop_back();
+        if(task != board && task->get_title() == m_under_title)
+        {
+            anchors.push_back(task);
+            continue;
+        }
+        if(depth >= m_max_depth)
+        {
+            continue;
+        }
+
+        const std::vector<Task*>& children = task->m_children;
+        for(std::size_t i = children.size(); i-- > 0;)
+        {
+            stack.push_back(std::make_pair(children[i], depth + 1));
+        }
+    }
+}
+
+bool TaskQuery::scan(
+        const Task* task,
+        std::size_t depth,
+        const TaskVisitor& visitor) const
+{
+    std::size_t child_depth = depth + 1;
+    if(child_depth > m_max_depth)
+    {
+        return true;
+    }
+
+    ARC_CONST_FOR_EACH(child, task->m_children)
+    {
+        if(matches_residual(*child, child_depth) && !visitor(*child))
+        {
+            return false;
+        }
+        if(!scan(*child, child_depth, visitor))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
@@ -0,0 +1,259 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief A compiled textual query for selecting Tasks.
+ */
+#ifndef SIGMA_CORE_TASKS_TASKQUERY_HPP_
+#define SIGMA_CORE_TASKS_TASKQUERY_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include "sigma/core/tasks/TaskFilter.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class RootTask;
+class Task;
+
+//------------------------------------------------------------------------------
+//                                TYPE DEFINITIONS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Function that is passed each Task selected by a TaskQuery, returning
+ *        false stops the query.
+ */
+typedef std::function<bool(Task*)> TaskVisitor;
+
+/*!
+ * \brief A query for selecting Tasks, parsed once from text into a plan that
+ *        can be executed any number of times.
+ *
+ * A query is a whitespace separated list of terms, and a Task must match all
+ * of the terms to be selected. Each term is a field, an operator and a value,
+ * values containing whitespace must be quoted. For example:
+ *
+ * \code
+ * under:"Release 3" title~"flaky" depth<4
+ * \endcode
+ *
+ * The supported terms are:
+ *
+ * - ``title:value`` the title of the Task is the value.
+ * - ``title~value`` the title of the Task contains the value.
+ * - ``under:value`` the Task is a descendant of a Task with the value as its
+ *   title, or with the value as its id if the value is an unquoted number.
+ * - ``board:value`` the Task is on the board with the value as its title.
+ * - ``depth`` compared with ``:``, ``<``, ``<=``, ``>`` or ``>=`` against the
+ *   depth of the Task, where the children of a RootTask have a depth of 1.
+ * - ``status:value`` the Task has the status ``open``, ``in_progress``,
+ *   ``blocked`` or ``done``. Multiple status terms match any of the statuses.
+ * - ``priority`` compared against ``none``, ``low``, ``medium`` or ``high``.
+ * - ``estimate`` compared against a number of minutes.
+ * - ``due`` compared against a due date, Tasks without a due date don't
+ *   match.
+ * - ``assignee:value`` the Task is assigned to the value.
+ * - ``flag:value`` the Task has the ``starred`` or ``milestone`` flag set.
+ *
+ * \par Plans
+ *
+ * The terms on the typed attributes of Tasks are compiled into a TaskFilter
+ * (see get_filter()), which is evaluated against the attribute columns of a
+ * board without visiting each Task. When a query has such terms the Tasks
+ * selected by the filter are then checked against the remaining terms.
+ * Queries without attribute terms instead walk the hierarchy below the
+ * ``under`` Task (or the whole board), skipping subtrees that are too deep to
+ * match.
+ *
+ * Queries are executed over all boards of a domain through
+ * TasksDomain::find_tasks() and TasksDomain::stream_tasks(), or over a single
+ * board with find() and stream(). Archived Tasks (see Task::archive()) are
+ * rehydrated before a board is queried, after which the board is brought
+ * back within its resident budget (see RootTask::set_resident_budget())
+ * keeping the Tasks that were visited.
+ */
+class TaskQuery
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //                         PUBLIC STATIC ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Limit for selecting every matching Task.
+     */
+    static const std::size_t NO_LIMIT;
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Parses and compiles the given query text.
+     *
+     * \throws arc::ex::ParseError If the text is not a valid query.
+     */
+    explicit TaskQuery(const arc::str::UTF8String& text);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the text this query was compiled from.
+     */
+    const arc::str::UTF8String& get_text() const;
+
+    /*!
+     * \brief Returns the TaskFilter the attribute terms of this query were
+     *        compiled to.
+     */
+    const TaskFilter& get_filter() const;
+
+    /*!
+     * \brief Returns whether this query is executed by evaluating its
+     *        TaskFilter, rather than by walking the hierarchy.
+     */
+    bool is_indexed() const;
+
+    /*!
+     * \brief Returns whether every term of this query is represented by its
+     *        TaskFilter, in which case RootTask::find_tasks() with the filter
+     *        selects the same Tasks as this query.
+     */
+    bool is_filter_only() const;
+
+    /*!
+     * \brief Returns whether the given Task matches this query.
+     */
+    bool matches(const Task* task) const;
+
+    /*!
+     * \brief Passes the Tasks of the given board that match this query to the
+     *        given visitor until the visitor returns false.
+     *
+     * The board is read locked while the query executes, so the visitor must
+     * not modify the board.
+     *
+     * \return False if the visitor stopped the query.
+     */
+    bool stream(const RootTask* board, const TaskVisitor& visitor) const;
+
+    /*!
+     * \brief Appends at most limit of the Tasks of the given board that match
+     *        this query to the given vector.
+     *
+     * \return The number of Tasks appended.
+     */
+    std::size_t find(
+            const RootTask* board,
+            std::vector<Task*>& out,
+            std::size_t limit = NO_LIMIT) const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The text of the query.
+     */
+    arc::str::UTF8String m_text;
+    /*!
+     * \brief The attribute terms of the query.
+     */
+    TaskFilter m_filter;
+    /*!
+     * \brief Whether the query has any attribute terms.
+     */
+    bool m_indexed;
+    /*!
+     * \brief The titles that the board must have.
+     */
+    std::vector<arc::str::UTF8String> m_boards;
+    /*!
+     * \brief Whether Tasks must be below a Task given by an under term.
+     */
+    bool m_has_under;
+    /*!
+     * \brief Whether the under term refers to a Task id rather than a title.
+     */
+    bool m_under_is_id;
+    arc::uint32 m_under_id;
+    arc::str::UTF8String m_under_title;
+    /*!
+     * \brief The titles that Tasks must have.
+     */
+    std::vector<arc::str::UTF8String> m_titles;
+    /*!
+     * \brief Text that the titles of Tasks must contain.
+     */
+    std::vector<arc::str::UTF8String> m_title_substrings;
+    /*!
+     * \brief The inclusive range of depths Tasks must be at.
+     */
+    std::size_t m_min_depth;
+    std::size_t m_max_depth;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Executes stream() over the Tasks of the given board that are not
+     *        archived while holding the board's read lock.
+     */
+    bool stream_resident(
+            const RootTask* board,
+            const TaskVisitor& visitor) const;
+
+    /*!
+     * \brief Parses the query text.
+     */
+    void parse();
+
+    /*!
+     * \brief Returns whether the given Task matches the title and depth terms.
+     */
+    bool matches_residual(const Task* task, std::size_t depth) const;
+
+    /*!
+     * \brief Appends the Tasks of the given board the query is restricted to
+     *        the descendants of.
+     */
+    void find_anchors(
+            const RootTask* board,
+            std::vector<const Task*>& anchors) const;
+
+    /*!
+     * \brief Walks the subtree below the given Task passing matching Tasks to
+     *        the visitor.
+     *
+     * \return False if the visitor stopped the query.
+     */
+    bool scan(
+            const Task* task,
+            std::size_t depth,
+            const TaskVisitor& visitor) const;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
@@ -0,0 +1,313 @@
+#include "sigma/core/tasks/TaskSerialiser.hpp"
+
+#include <utility>
+
+#include <arcanecore/base/Exceptions.hpp>
+
+#include "sigma/core/tasks/Task.hpp"
+#include "sigma/core/tasks/TaskFilter.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+void TaskSerialiser::serialise(const Task* task, std::vector<arc::uint8>& out)
+{
+    // iterative pre-order traversal so deep hierarchies can't overflow the
+    // stack
+    std::vector<const Task*> stack;
+    stack.push_back(task);
+    while(!stack.empty())
+    {
+        const Task* current = stack.back();
+        stack.pop_back();
+
+        write_uint(current->get_id(), out);
+        write_string(current->get_title(), out);
+        write_attributes(current->get_attributes(), out);
+
+        // the archive is the children count followed by the encoded children
+        if(current->is_archived())
+        {
+            out.insert(
+                    out.end(),
+                    current->m_archive.begin(),
+                    current->m_archive.end()
+            );
+            continue;
+        }
+
+        const std::vector<Task*>& children = current->m_children;
+        write_uint(children.size(), out);
+
+        // push in reverse so the children are written in order
+        std::vector<Task*>::const_reverse_iterator child = children.rbegin();
+        for(; child != children.rend(); ++child)
+        {
+            stack.push_back(*child);
+        }
+    }
+}
+
+Task* TaskSerialiser::deserialise(
+        Task* parent,
+        std::size_t index,
+        const arc::uint8* data,
+        std::size_t length)
+{
+    return deserialise(parent, index, data, data + length);
+}
+
+Task* TaskSerialiser::deserialise(
+        Task* parent,
+        std::size_t index,
+        const arc::uint8*& data,
+        const arc::uint8* end)
+{
+    Task* top = nullptr;
+    // tasks that are still waiting to have children decoded, paired with the
+    // number of children still to decode
+    std::vector<std::pair<Task*, arc::uint64>> stack;
+    do
+    {
+        Task* current_parent = parent;
+        std::size_t current_index = index;
+        if(!stack.empty())
+        {
+            current_parent = stack.back().first;
+            current_index = Task::APPEND;
+            --stack.back().second;
+        }
+
+        arc::uint32 id = static_cast<arc::uint32>(read_uint(data, end));
+        arc::str::UTF8String title(read_string(data, end));
+        TaskAttributes attributes;
+        read_attributes(data, end, attributes);
+        arc::uint64 children_count = read_uint(data, end);
+
+        Task* task = new Task(current_parent, title, id, current_index);
+        task->set_attributes_internal(attributes);
+        if(top == nullptr)
+        {
+            top = task;
+        }
+
+        if(children_count > 0)
+        {
+            stack.push_back(std::make_pair(task, children_count));
+        }
+        // pop tasks that have had all of their children decoded
+        while(!stack.empty() && stack.back().second == 0)
+        {
+            stack.pop_back();
+        }
+    }
+    while(!stack.empty());
+
+    return top;
+}
+
+void TaskSerialiser::serialise_children(
+        const Task* task,
+        std::vector<arc::uint8>& out)
+{
+    // the archive of an archived Task is already in this format
+    if(task->is_archived())
+    {
+        out.insert(out.end(), task->m_archive.begin(), task->m_archive.end());
+        return;
+    }
+
+    write_uint(task->m_children.size(), out);
+    ARC_CONST_FOR_EACH(child, task->m_children)
+    {
+        serialise(*child, out);
+    }
+}
+
+void TaskSerialiser::load_children(
+        Task* task,
+        const arc::uint8* data,
+        std::size_t length)
+{
+    task->load_archive(data, length);
+}
+
+std::size_t TaskSerialiser::skip(
+        const arc::uint8*& data,
+        const arc::uint8* end,
+        arc::uint64 count,
+        std::vector<arc::uint32>& ids)
+{
+    // the number of Tasks still to be skipped grows by the number of children
+    // of each skipped Task
+    std::size_t done = 0;
+    while(count > 0)
+    {
+        --count;
+        ids.push_back(static_cast<arc::uint32>(read_uint(data, end)));
+        // skip the title
+        arc::uint64 length = read_uint(data, end);
+        if(length > static_cast<arc::uint64>(end - data))
+        {
+            throw arc::ex::ParseError("String extends beyond the end of data");
+        }
+        data += length;
+        TaskAttributes attributes;
+        read_attributes(data, end, attributes);
+        if(attributes.status == STATUS_DONE)
+        {
+            ++done;
+        }
+        count += read_uint(data, end);
+    }
+    return done;
+}
+
+void TaskSerialiser::select(
+        const arc::uint8*& data,
+        const arc::uint8* end,
+        arc::uint64 count,
+        const TaskFilter& filter,
+        std::vector<arc::uint32>& ids)
+{
+    while(count > 0)
+    {
+        --count;
+        arc::uint32 id = static_cast<arc::uint32>(read_uint(data, end));
+        // skip the title
+        arc::uint64 length = read_uint(data, end);
+        if(length > static_cast<arc::uint64>(end - data))
+        {
+            throw arc::ex::ParseError("String extends beyond the end of data");
+        }
+        data += length;
+        TaskAttributes attributes;
+        read_attributes(data, end, attributes);
+        if(filter.matches(attributes))
+        {
+            ids.push_back(id);
+        }
+        count += read_uint(data, end);
+    }
+}
+
+void TaskSerialiser::write_uint(arc::uint64 value, std::vector<arc::uint8>& out)
+{
+    while(value >= 0x80)
+    {
+        out.push_back(static_cast<arc::uint8>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<arc::uint8>(value));
+}
+
+arc::uint64 TaskSerialiser::read_uint(
+        const arc::uint8*& data,
+        const arc::uint8* end)
+{
+    arc::uint64 value = 0;
+    for(arc::uint32 shift = 0; shift < 64; shift += 7)
+    {
+        if(data >= end)
+        {
+            throw arc::ex::ParseError(
+                    "Unexpected end of data while reading integer");
+        }
+        arc::uint8 byte = *data++;
+        value |= static_cast<arc::uint64>(byte & 0x7F) << shift;
+        if((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    throw arc::ex::ParseError("Malformed variable length integer");
+}
+
+void TaskSerialiser::write_string(
+        const arc::str::UTF8String& value,
+        std::vector<arc::uint8>& out)
+{
+    // the byte length includes the NULL terminator which isn't written
+    std::size_t length = value.get_byte_length() - 1;
+    write_uint(length, out);
+    const arc::uint8* raw =
+        reinterpret_cast<const arc::uint8*>(value.get_raw());
+    out.insert(out.end(), raw, raw + length);
+}
+
+arc::str::UTF8String TaskSerialiser::read_string(
+        const arc::uint8*& data,
+        const arc::uint8* end)
+{
+    arc::uint64 length = read_uint(data, end);
+    if(length > static_cast<arc::uint64>(end - data))
+    {
+        throw arc::ex::ParseError("String extends beyond the end of data");
+    }
+
+    arc::str::UTF8String value;
+    value.assign(reinterpret_cast<const char*>(data), length);
+    data += length;
+    return value;
+}
+
+void TaskSerialiser::write_attributes(
+        const TaskAttributes& attributes,
+        std::vector<arc::uint8>& out)
+{
+    arc::uint64 packed =
+        static_cast<arc::uint64>(attributes.status)            |
+        static_cast<arc::uint64>(attributes.priority)     << 2 |
+        static_cast<arc::uint64>(attributes.has_due_date) << 4 |
+        static_cast<arc::uint64>(attributes.flags)        << 5;
+    write_uint(packed, out);
+    write_uint(attributes.estimate, out);
+    write_string(attributes.assignee, out);
+    if(attributes.has_due_date)
+    {
+        // zig-zag encode so dates before the epoch stay small
+        arc::uint64 due = static_cast<arc::uint64>(attributes.due_date);
+        write_uint((due << 1) ^ (attributes.due_date < 0 ? ~0ULL : 0ULL), out);
+    }
+}
+
+void TaskSerialiser::read_attributes(
+        const arc::uint8*& data,
+        const arc::uint8* end,
+        TaskAttributes& attributes)
+{
+    arc::uint64 packed = read_uint(data, end);
+    attributes.status = static_cast<TaskStatus>(packed & 3);
+    attributes.priority = static_cast<TaskPriority>((packed >> 2) & 3);
+    attributes.has_due_date = ((packed >> 4) & 1) != 0;
+    attributes.flags = static_cast<arc::uint32>(packed >> 5);
+    attributes.estimate = static_cast<arc::uint32>(read_uint(data, end));
+    attributes.assignee = read_string(data, end);
+    attributes.due_date = 0;
+    if(attributes.has_due_date)
+    {
+        arc::uint64 due = read_uint(data, end);
+        attributes.due_date = static_cast<arc::int64>(due >> 1) ^
+                              -static_cast<arc::int64>(due & 1);
+    }
+    try
+    {
+        attributes.validate();
+    }
+    catch(const arc::ex::ValueError&)
+    {
+        throw arc::ex::ParseError("Invalid Task attributes");
+    }
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
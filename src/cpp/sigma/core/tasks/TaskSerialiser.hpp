@@ -0,0 +1,226 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Compact binary encoding of Task hierarchies.
+ */
+#ifndef SIGMA_CORE_TASKS_TASKSERIALISER_HPP_
+#define SIGMA_CORE_TASKS_TASKSERIALISER_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include "sigma/core/tasks/TaskAttributes.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class Task;
+class TaskFilter;
+
+/*!
+ * \brief Encodes and decodes Task subtrees to and from a compact byte stream.
+ *
+ * Subtrees are written in pre-order, each Task is stored as its id, its title,
+ * its TaskAttributes and the number of children it has. All integers are written as variable
+ * length unsigned integers (7 bits per byte) so that small values only take a
+ * single byte.
+ *
+ * Decoded Tasks keep the ids they were encoded with, this allows deleted
+ * subtrees to be restored exactly as they were.
+ *
+ * The descendants of an archived Task (see Task::archive()) are already held
+ * in this encoding, so they are copied into the output as they are rather than
+ * being rehydrated.
+ */
+class TaskSerialiser
+{
+private:
+
+    ARC_DISALLOW_CONSTRUCTION(TaskSerialiser);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                           PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Appends the encoding of the given Task and all of its descendants
+     *        to the given buffer.
+     */
+    static void serialise(const Task* task, std::vector<arc::uint8>& out);
+
+    /*!
+     * \brief Recreates a Task subtree from data written by serialise().
+     *
+     * \param parent The Task the decoded subtree will be a child of.
+     * \param index The position in the parent's children the decoded Task will
+     *              be inserted at.
+     * \param data The encoded data.
+     * \param length The number of bytes of encoded data.
+     *
+     * \throws arc::ex::ParseError If the data is malformed.
+     *
+     * \return The top Task of the decoded subtree.
+     */
+    static Task* deserialise(
+            Task* parent,
+            std::size_t index,
+            const arc::uint8* data,
+            std::size_t length);
+
+    /*!
+     * \brief Recreates a Task subtree from data written by serialise() and
+     *        advances the data pointer past it.
+     *
+     * This allows several subtrees written one after another to be decoded,
+     * see deserialise().
+     *
+     * \throws arc::ex::ParseError If the data is malformed.
+     */
+    static Task* deserialise(
+            Task* parent,
+            std::size_t index,
+            const arc::uint8*& data,
+            const arc::uint8* end);
+
+    /*!
+     * \brief Appends the number of children the given Task has, followed by
+     *        the encoding of each child and its descendants, to the given
+     *        buffer.
+     *
+     * This is the format read by load_children().
+     */
+    static void serialise_children(
+            const Task* task,
+            std::vector<arc::uint8>& out);
+
+    /*!
+     * \brief Loads Tasks written by serialise_children() as the children of
+     *        the given Task, without creating them.
+     *
+     * The given Task becomes archived (see Task::archive()) with the data as
+     * its archive. Its children are only created once they're accessed, and
+     * each child keeps its own descendants archived until they're accessed in
+     * turn, so a large hierarchy can be opened without decoding all of it.
+     * The loading is not recorded in the board's TaskHistory.
+     *
+     * \throws arc::ex::ParseError If the data is malformed.
+     * \throws arc::ex::IllegalActionError If the Task already has children.
+     * \throws arc::ex::ValueError If any of the encoded ids are already used
+     *                             by Tasks of the board.
+     */
+    static void load_children(
+            Task* task,
+            const arc::uint8* data,
+            std::size_t length);
+
+    /*!
+     * \brief Advances the data pointer past the given number of consecutive
+     *        subtrees written by serialise(), appending the ids of their Tasks
+     *        to the given vector.
+     *
+     * \throws arc::ex::ParseError If the data is malformed.
+     *
+     * \return The number of the skipped Tasks that have the status
+     *         STATUS_DONE.
+     */
+    static std::size_t skip(
+            const arc::uint8*& data,
+            const arc::uint8* end,
+            arc::uint64 count,
+            std::vector<arc::uint32>& ids);
+
+    /*!
+     * \brief Advances the data pointer past the given number of consecutive
+     *        subtrees written by serialise(), appending the ids of the Tasks
+     *        whose attributes match the given filter to the given vector.
+     *
+     * The Tasks are not created, and the ancestor of the filter (see
+     * TaskFilter::under()) is ignored.
+     *
+     * \throws arc::ex::ParseError If the data is malformed.
+     */
+    static void select(
+            const arc::uint8*& data,
+            const arc::uint8* end,
+            arc::uint64 count,
+            const TaskFilter& filter,
+            std::vector<arc::uint32>& ids);
+
+    /*!
+     * \brief Appends the given unsigned integer to the buffer as a variable
+     *        length integer.
+     */
+    static void write_uint(arc::uint64 value, std::vector<arc::uint8>& out);
+
+    /*!
+     * \brief Reads a variable length unsigned integer and advances the data
+     *        pointer past it.
+     *
+     * \throws arc::ex::ParseError If the end of the data is reached before
+     *                             the integer is complete.
+     */
+    static arc::uint64 read_uint(
+            const arc::uint8*& data,
+            const arc::uint8* end);
+
+    /*!
+     * \brief Appends the given string to the buffer as its byte length
+     *        followed by its UTF-8 bytes.
+     */
+    static void write_string(
+            const arc::str::UTF8String& value,
+            std::vector<arc::uint8>& out);
+
+    /*!
+     * \brief Reads a string written by write_string() and advances the data
+     *        pointer past it.
+     *
+     * \throws arc::ex::ParseError If the string extends beyond the end of the
+     *                             data.
+     */
+    static arc::str::UTF8String read_string(
+            const arc::uint8*& data,
+            const arc::uint8* end);
+
+    /*!
+     * \brief Appends the given attributes to the buffer.
+     *
+     * The status, priority, flags and due date presence are packed into a
+     * single integer, followed by the estimate, the assignee and the due date
+     * (if there is one).
+     */
+    static void write_attributes(
+            const TaskAttributes& attributes,
+            std::vector<arc::uint8>& out);
+
+    /*!
+     * \brief Reads attributes written by write_attributes() and advances the
+     *        data pointer past them.
+     *
+     * \throws arc::ex::ParseError If the data is malformed.
+     */
+    static void read_attributes(
+            const arc::uint8*& data,
+            const arc::uint8* end,
+            TaskAttributes& attributes);
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
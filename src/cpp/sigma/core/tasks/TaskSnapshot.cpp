@@ -0,0 +1,126 @@
+#include "sigma/core/tasks/TaskSnapshot.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Mixes the given value into the given hash.
+ *
+ * Uses the splitmix64 finaliser so that the result depends on the order
+ * values are mixed in.
+ */
+inline arc::uint64 mix(arc::uint64 hash, arc::uint64 value)
+{
+    arc::uint64 x = hash ^ (value + 0x9E3779B97F4A7C15ULL);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/*!
+ * \brief FNV-1a hash of the bytes of the given string.
+ */
+arc::uint64 hash_string(const arc::str::UTF8String& value)
+{
+    arc::uint64 hash = 0xCBF29CE484222325ULL;
+    const char* raw = value.get_raw();
+    // the byte length includes the NULL terminator
+    for(std::size_t i = 0; i + 1 < value.get_byte_length(); ++i)
+    {
+        hash ^= static_cast<arc::uint8>(raw[i]);
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+arc::uint32 TaskSnapshot::get_id() const
+{
+    return m_id;
+}
+
+const arc::str::UTF8String& TaskSnapshot::get_title() const
+{
+    return m_title;
+}
+
+const TaskAttributes& TaskSnapshot::get_attributes() const
+{
+    return m_attributes;
+}
+
+arc::uint64 TaskSnapshot::get_hash() const
+{
+    return m_hash;
+}
+
+std::size_t TaskSnapshot::get_children_count() const
+{
+    return m_children.size();
+}
+
+const std::vector<TaskSnapshot::Ptr>& TaskSnapshot::get_children() const
+{
+    return m_children;
+}
+
+//------------------------------------------------------------------------------
+//                              PRIVATE CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+TaskSnapshot::TaskSnapshot(
+        arc::uint32 id,
+        const arc::str::UTF8String& title,
+        const TaskAttributes& attributes,
+        std::vector<Ptr>& children)
+    :
+    m_id        (id),
+    m_title     (title),
+    m_attributes(attributes),
+    m_hash      (0)
+{
+    // take ownership of the children rather than copying them
+    m_children.swap(children);
+
+    m_hash = mix(m_hash, m_id);
+    m_hash = mix(m_hash, hash_string(m_title));
+    m_hash = mix(
+            m_hash,
+            static_cast<arc::uint64>(m_attributes.status)         |
+            static_cast<arc::uint64>(m_attributes.priority) << 8  |
+            static_cast<arc::uint64>(m_attributes.flags)    << 16 |
+            static_cast<arc::uint64>(m_attributes.estimate) << 32
+    );
+    m_hash = mix(m_hash, hash_string(m_attributes.assignee));
+    m_hash = mix(
+            m_hash,
+            m_attributes.has_due_date ?
+                static_cast<arc::uint64>(m_attributes.due_date) : 0
+    );
+    m_hash = mix(m_hash, m_attributes.has_due_date ? 1 : 0);
+    ARC_CONST_FOR_EACH(child, m_children)
+    {
+        m_hash = mix(m_hash, (*child)->m_hash);
+    }
+    m_hash = mix(m_hash, m_children.size());
+}
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
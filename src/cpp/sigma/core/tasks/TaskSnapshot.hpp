@@ -0,0 +1,158 @@
+/*!
+ * \file
+ * \author David Saxon
+ * \brief Immutable, structurally shared views of Task hierarchies.
+ */
+#ifndef SIGMA_CORE_TASKS_TASKSNAPSHOT_HPP_
+#define SIGMA_CORE_TASKS_TASKSNAPSHOT_HPP_
+
+#include <memory>
+#include <vector>
+
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include "sigma/core/tasks/TaskAttributes.hpp"
+
+namespace sigma
+{
+namespace core
+{
+namespace tasks
+{
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+class Task;
+
+/*!
+ * \brief An immutable copy of a Task and its descendants at a single point in
+ *        time.
+ *
+ * Snapshots are obtained through RootTask::snapshot(). They are persistent:
+ * once created a snapshot never changes, no matter how the board it was taken
+ * from is modified afterwards. Because of this snapshots can be read from any
+ * thread without taking any locks. Taking a new snapshot after the board has
+ * been modified does take the board's read lock though, see
+ * RootTask::snapshot().
+ *
+ * Snapshots are structurally shared, any subtree that has not been modified
+ * between two snapshots is represented by the same TaskSnapshot object in
+ * both of them. Only the modified Tasks and their ancestors are copied when a
+ * new snapshot is taken, but since each copy holds the full list of its
+ * children's snapshots the cost is proportional to the number of children of
+ * the copied Tasks, not just to the number of Tasks that changed.
+ *
+ * Each snapshot also carries a Merkle hash of its subtree (see get_hash()),
+ * which is computed once when the snapshot is created from the hashes of its
+ * children. Since only modified Tasks and their ancestors are recreated, the
+ * hashes are maintained along the modified ancestor paths only.
+ */
+class TaskSnapshot
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(TaskSnapshot);
+
+    friend class Task;
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                              TYPE DEFINITIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Shared pointer to a TaskSnapshot.
+     */
+    typedef std::shared_ptr<const TaskSnapshot> Ptr;
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the id of the Task this is a snapshot of.
+     */
+    arc::uint32 get_id() const;
+
+    /*!
+     * \brief Returns the title the Task had when this snapshot was taken.
+     */
+    const arc::str::UTF8String& get_title() const;
+
+    /*!
+     * \brief Returns the typed attributes the Task had when this snapshot was
+     *        taken.
+     */
+    const TaskAttributes& get_attributes() const;
+
+    /*!
+     * \brief Returns the hash of the Task and its descendants.
+     *
+     * The hash covers the id, title and attributes of the Task and the hashes
+     * of its children in order, so two snapshots with the same hash can be
+     * assumed to have identical subtrees.
+     */
+    arc::uint64 get_hash() const;
+
+    /*!
+     * \brief Returns the number of children the Task had when this snapshot
+     *        was taken.
+     */
+    std::size_t get_children_count() const;
+
+    /*!
+     * \brief Returns the snapshots of the children of the Task.
+     */
+    const std::vector<Ptr>& get_children() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                            PRIVATE CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new snapshot of a Task.
+     *
+     * Snapshots are only created by Tasks.
+     */
+    TaskSnapshot(
+            arc::uint32 id,
+            const arc::str::UTF8String& title,
+            const TaskAttributes& attributes,
+            std::vector<Ptr>& children);
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The id of the Task.
+     */
+    const arc::uint32 m_id;
+    /*!
+     * \brief The title of the Task.
+     */
+    const arc::str::UTF8String m_title;
+    /*!
+     * \brief The typed attributes of the Task.
+     */
+    const TaskAttributes m_attributes;
+    /*!
+     * \brief The hash of the subtree.
+     */
+    arc::uint64 m_hash;
+    /*!
+     * \brief The snapshots of the Task's children.
+     */
+    std::vector<Ptr> m_children;
+};
+
+} // namespace tasks
+} // namespace core
+} // namespace sigma
+
+#endif
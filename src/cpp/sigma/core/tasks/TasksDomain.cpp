@@ -1,5 +1,7 @@
 #include "sigma/core/tasks/TasksDomain.hpp"
 
+#include <arcanecore/base/Exceptions.hpp>
+
 #include "sigma/core/tasks/RootTask.hpp"
 
 namespace sigma
@@ -8,60 +10,87 @@ namespace core
 {
 namespace tasks
 {
-namespace domain
-{
 
 //------------------------------------------------------------------------------
-//                                   VARIABLES
+//                                  CONSTRUCTOR
 //------------------------------------------------------------------------------
 
-namespace
+TasksDomain::TasksDomain()
+    :
+    m_last_id            (0),
+    m_last_ancestry_epoch(0),
+    m_next_shard         (0)
 {
-
- /*!
-  * \brief The existing Task boards stored by their root nodes.
-  */
-std::set<std::unique_ptr<RootTask>> m_boards;
-
-} // namespace anonymous
+}
 
 //------------------------------------------------------------------------------
-//                                   PROTOTYPES
+//                                   DESTRUCTOR
 //------------------------------------------------------------------------------
 
-/*!
- * \brief Resolves the given board title so that it is unique, by appending
- *        a number to the end of the title.
- *
- * \param original the board title to resolve.
- * \param resolved Returns title once it has been resolved, if there is no board
- *                 with the original title then this will return the original
- *                 title.
- */
-void resolve_unique_board_title(
-        const arc::str::UTF8String& original,
-        arc::str::UTF8String& resolved);
+TasksDomain::~TasksDomain()
+{
+    // the boards must be destroyed while the rest of the domain still exists,
+    // and after any jobs that use them
+    stop_shards();
+    clear();
+}
 
 //------------------------------------------------------------------------------
-//                                   FUNCTIONS
+//                            PUBLIC MEMBER FUNCTIONS
 //------------------------------------------------------------------------------
 
-void init()
+void TasksDomain::clear()
 {
-}
+    if(m_shards)
+    {
+        // a job's own board would be destroyed while it is still running
+        if(m_shards->get_current_shard() < m_shards->get_shard_count())
+        {
+            throw arc::ex::StateError(
+                "A domain cannot be cleared from one of its jobs");
+        }
+        for(std::size_t i = 0; i < m_shards->get_shard_count(); ++i)
+        {
+            m_shards->drain(i);
+        }
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-void clean_up()
-{
     // delete all the current boards
     m_boards.clear();
+
+    m_dependencies.clear();
+    m_reminders.clear();
+    m_tags.clear();
 }
 
-const std::set<std::unique_ptr<RootTask>>& get_boards()
+std::vector<RootTask*> TasksDomain::get_boards() const
 {
-    return m_boards;
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    BoardRegistry::Range boards(m_boards.get_boards());
+    return std::vector<RootTask*>(boards.begin(), boards.end());
 }
 
-RootTask* new_board(const arc::str::UTF8String& title)
+RootTask* TasksDomain::get_board(BoardHandle handle) const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_boards.get_board(handle);
+}
+
+BoardHandle TasksDomain::get_board_handle(const RootTask* board) const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_boards.get_handle(board);
+}
+
+RootTask* TasksDomain::find_board(const arc::str::UTF8String& title) const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_boards.find_board(title);
+}
+
+RootTask* TasksDomain::new_board(const arc::str::UTF8String& title)
 {
     // check the title is not empty
     if(title.is_empty())
@@ -69,129 +98,444 @@ RootTask* new_board(const arc::str::UTF8String& title)
         throw arc::ex::ValueError("Task Boards cannot have a blank title");
     }
 
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
     // ensure we have a unique title
     arc::str::UTF8String resolved_title;
-    resolve_unique_board_title(title, resolved_title);
+    m_boards.get_titles().resolve(title, resolved_title);
     // create the Root Task
-    std::unique_ptr<RootTask> root(
-        new RootTask(resolved_title, resolve_unique_board_title));
+    std::unique_ptr<RootTask> root(new RootTask(resolved_title, this));
     RootTask* r = root.get();
+    r->m_shard = m_next_shard++;
     // store
-    m_boards.insert(std::move(root));
+    m_boards.add(std::move(root));
     // return pointer
     return r;
 }
 
-void resolve_unique_board_title(
-        const arc::str::UTF8String& original,
-        arc::str::UTF8String& resolved)
+bool TasksDomain::delete_board(RootTask* board_root)
 {
-    resolved = original;
-
-    // search over the current titles to find titles that match
-    bool hard_match = false;
-    std::set<arc::uint32> reserved_numbers;
-    ARC_CONST_FOR_EACH(board_it, m_boards)
+    std::unique_ptr<RootTask> board;
     {
-        // check for an exact match
-        if((*board_it)->get_title() == original)
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        if(m_boards.get_handle(board_root) == BoardRegistry::NULL_HANDLE)
         {
-            hard_match = true;
+            return false;
         }
-        // check for a match with a suffix
-        else if((*board_it)->get_title().starts_with(original))
+
+        std::size_t shard = 0;
+        std::size_t current = 0;
+        if(m_shards)
         {
-            arc::str::UTF8String conflicting((*board_it)->get_title());
-
-            // read the suffix
-            std::size_t par_end_i   = conflicting.find_last(")");
-            std::size_t par_begin_i = conflicting.find_last("(");
-            if(par_end_i   != arc::str::npos &&
-                par_begin_i != arc::str::npos &&
-                par_begin_i < par_end_i         &&
-                par_begin_i - 1 == original.get_length() )
+            shard = board_root->m_shard % m_shards->get_shard_count();
+            current = m_shards->get_current_shard();
+            if(current < m_shards->get_shard_count() && current != shard)
             {
-                arc::str::UTF8String par_contents(conflicting.substring(
-                    par_begin_i + 1,
-                    par_end_i - (par_begin_i + 1)
-                ));
-                // is this a number?
-                if(par_contents.is_uint())
-                {
-                    reserved_numbers.insert(par_contents.to_uint32());
-                }
+                throw arc::ex::StateError(
+                    "A board cannot be deleted from a job of another shard");
             }
         }
+
+        // no more jobs can be submitted for the board once it's closed
+        board_root->m_closed = true;
+        board = m_boards.release(board_root);
+
+        // the jobs queued behind this one may still use the board, so it's
+        // destroyed by a job that is queued behind them
+        if(m_shards && current == shard)
+        {
+            RootTask* deferred = board.release();
+            m_shards->post(shard, [this, deferred]()
+            {
+                std::lock_guard<std::recursive_mutex> lock(m_mutex);
+                delete deferred;
+            });
+            return true;
+        }
     }
 
-    // has there are conflict?
-    if(hard_match)
-    {
-        // find a unique suffix
-        arc::uint32 s = 1;
-        for(; reserved_numbers.find(s) != reserved_numbers.end(); ++s);
-        // append the unique suffix
-        resolved << " (" << s << ")";
-    }
-    // // search over current boards and check their titles
-    // ARC_CONST_FOR_EACH(board_it, m_boards)
-    // {
-    //     if((*board_it)->get_title() == original)
-    //     {
-    //         arc::str::UTF8String conflicting((*board_it)->get_title());
-
-    //         // the number that will be used to make this title unique
-    //         arc::uint32 num = 1;
-
-    //         // match found, check if this title already has a unique number
-    //         std::size_t par_end_i = conflicting.find_last(")");
-    //         if(par_end_i != arc::str::npos)
-    //         {
-    //             std::size_t par_begin_i = conflicting.find_last("(");
-    //             if( par_begin_i != arc::str::npos)
-    //             {
-    //                 // get the contents of the parentheses
-    //                 arc::str::UTF8String par_contents(conflicting.substring(
-    //                     par_begin_i + 1,
-    //                     par_end_i - (par_begin_i + 1)
-    //                 ));
-    //                 // is this a number
-    //                 if(par_contents.is_uint())
-    //                 {
-    //                     num = par_contents.to_uint32() + 1;
-    //                     // FUCK
-    //                     // strip the parentheses from the title
-    //                     // resolved = original.substring(0, par_begin_i - 1);
-    //                     // std::cout << "stripped: " << resolved << std::endl;
-    //                 }
-    //             }
-    //         }
-
-    //         arc::str::UTF8String modified(resolved);
-    //         modified << " (" << num << ")";
-    //         // check the new title
-    //         resolve_unique_board_title(modified, resolved);
-    //         return;
-    //     }
-    // }
+    // the domain isn't locked while waiting since the jobs may use it
+    drain(board.get());
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    board.reset();
+    return true;
 }
 
-bool delete_board(RootTask* board_root)
+void TasksDomain::move_subtree_to_board(Task* task, RootTask* board)
+{
+    if(task == nullptr || task->get_parent() == nullptr)
+    {
+        throw arc::ex::ValueError(
+            "Only non-root Tasks can be moved to another board"
+        );
+    }
+    if(get_board_handle(board) == BoardRegistry::NULL_HANDLE)
+    {
+        throw arc::ex::ValueError(
+            "Cannot move a Task to a board that isn't in this domain"
+        );
+    }
+
+    // jobs that were submitted for either board must not see the move, this
+    // throws before anything is moved if called from another shard's job
+    drain(task->get_board());
+    drain(board);
+
+    // the Task is relinked as a whole, only its own parent changes
+    task->set_parent(board);
+}
+
+void TasksDomain::merge_boards(RootTask* target, RootTask* source)
+{
+    if(get_board_handle(target) == BoardRegistry::NULL_HANDLE ||
+       get_board_handle(source) == BoardRegistry::NULL_HANDLE)
+    {
+        throw arc::ex::ValueError(
+            "Cannot merge boards that aren't in this domain"
+        );
+    }
+    if(target == source)
+    {
+        throw arc::ex::ValueError("Cannot merge a board into itself");
+    }
+
+    // copy the top-level Tasks since moving them modifies the source
+    std::vector<Task*> children(source->get_chidren());
+    ARC_CONST_FOR_EACH(it, children)
+    {
+        move_subtree_to_board(*it, target);
+    }
+    delete_board(source);
+}
+
+RootTask* TasksDomain::split_board(Task* task)
 {
-    std::set<std::unique_ptr<RootTask>>::iterator it = m_boards.begin();
-    for (; it != m_boards.end();)
+    if(task == nullptr || task->get_parent() == nullptr)
     {
-        if(it->get() == board_root)
+        throw arc::ex::ValueError(
+            "Only non-root Tasks can be split into a new board"
+        );
+    }
+
+    RootTask* board = new_board(task->get_title());
+    move_subtree_to_board(task, board);
+    return board;
+}
+
+DependencyGraph& TasksDomain::get_dependencies()
+{
+    return m_dependencies;
+}
+
+ReminderWheel& TasksDomain::get_reminders()
+{
+    return m_reminders;
+}
+
+TagIndex& TasksDomain::get_tags()
+{
+    return m_tags;
+}
+
+ChangeFeed& TasksDomain::get_changes()
+{
+    return m_changes;
+}
+
+DomainStats TasksDomain::get_stats(bool audit)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    DomainStats stats;
+    stats.audited = audit;
+    stats.mutations = m_changes.get_head() - 1;
+    stats.boards.reserve(m_boards.size());
+    ARC_CONST_FOR_EACH(board_it, m_boards.get_boards())
+    {
+        if(audit)
         {
-            it = m_boards.erase(it);
-            return true;
+            stats.boards.push_back(board_it->audit_stats());
         }
         else
         {
-            ++it;
+            stats.boards.push_back(board_it->get_stats());
+        }
+        stats.totals.accumulate(stats.boards.back());
+    }
+    return stats;
+}
+
+bool TasksDomain::stream_tasks(
+        const TaskQuery& query,
+        const TaskVisitor& visitor)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    ARC_CONST_FOR_EACH(board_it, m_boards.get_boards())
+    {
+        if(!query.stream(*board_it, visitor))
+        {
+            return false;
         }
     }
-    return false;
+    return true;
+}
+
+std::size_t TasksDomain::find_tasks(
+        const TaskQuery& query,
+        std::vector<Task*>& out,
+        std::size_t limit)
+{
+    std::size_t found = 0;
+    if(limit == 0)
+    {
+        return found;
+    }
+
+    stream_tasks(query, [&](Task* task)
+    {
+        out.push_back(task);
+        return ++found < limit;
+    });
+    return found;
+}
+
+void TasksDomain::start_shards(std::size_t shard_count)
+{
+    if(m_shards)
+    {
+        throw arc::ex::StateError("The shards have already been started");
+    }
+    m_shards.reset(new ShardPool(shard_count));
+}
+
+void TasksDomain::stop_shards()
+{
+    // the pool finishes the submitted jobs before its threads exit
+    m_shards.reset();
+}
+
+std::size_t TasksDomain::get_shard_count() const
+{
+    if(!m_shards)
+    {
+        return 0;
+    }
+    return m_shards->get_shard_count();
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void TasksDomain::post(RootTask* board, std::function<void()> job)
+{
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        if(board->m_closed)
+        {
+            throw arc::ex::StateError(
+                "Jobs cannot be submitted for a board that is being deleted");
+        }
+        if(m_shards)
+        {
+            m_shards->post(board->m_shard % m_shards->get_shard_count(), job);
+            return;
+        }
+    }
+    job();
+}
+
+void TasksDomain::drain(const RootTask* board)
+{
+    if(m_shards)
+    {
+        m_shards->drain(board->m_shard % m_shards->get_shard_count());
+    }
+}
+
+arc::uint32 TasksDomain::allocate_id()
+{
+    return ++m_last_id;
+}
+
+void TasksDomain::reserve_id(arc::uint32 id)
+{
+    arc::uint32 current = m_last_id.load();
+    while(current < id && !m_last_id.compare_exchange_weak(current, id));
+}
+
+arc::uint64 TasksDomain::allocate_ancestry_epoch()
+{
+    return ++m_last_ancestry_epoch;
+}
+
+void TasksDomain::handle_task_destroyed(arc::uint32 id)
+{
+    m_dependencies.remove_task(id);
+    m_reminders.cancel(id);
+    m_tags.remove_task(id);
+}
+
+void TasksDomain::handle_task_archived(Task* task)
+{
+    // the dependencies are kept by id, and the reminder is scheduled again by
+    // the attributes of the rehydrated Task
+    m_reminders.cancel(task->get_id());
+    m_tags.set_task(task->get_id(), nullptr);
+}
+
+void TasksDomain::handle_task_rehydrated(Task* task)
+{
+    m_tags.set_task(task->get_id(), task);
+}
+
+void TasksDomain::handle_task_attributes_changed(
+        Task* task,
+        const TaskAttributes& old_attributes,
+        const TaskAttributes& attributes)
+{
+    m_dependencies.on_attributes_changed(task, old_attributes, attributes);
+
+    if(attributes.has_due_date && attributes.status != STATUS_DONE)
+    {
+        if(!old_attributes.has_due_date ||
+           old_attributes.due_date != attributes.due_date ||
+           old_attributes.status == STATUS_DONE)
+        {
+            m_reminders.schedule(task, attributes.due_date);
+        }
+    }
+    else
+    {
+        m_reminders.cancel(task->get_id());
+    }
+}
+
+namespace domain
+{
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+TasksDomain& get_default()
+{
+    static TasksDomain instance;
+    return instance;
+}
+
+void init()
+{
+    get_default();
+}
+
+void clean_up()
+{
+    get_default().stop_shards();
+    get_default().clear();
+}
+
+std::vector<RootTask*> get_boards()
+{
+    return get_default().get_boards();
+}
+
+RootTask* get_board(BoardHandle handle)
+{
+    return get_default().get_board(handle);
+}
+
+BoardHandle get_board_handle(const RootTask* board)
+{
+    return get_default().get_board_handle(board);
+}
+
+RootTask* find_board(const arc::str::UTF8String& title)
+{
+    return get_default().find_board(title);
+}
+
+RootTask* new_board(const arc::str::UTF8String& title)
+{
+    return get_default().new_board(title);
+}
+
+bool delete_board(RootTask* board_root)
+{
+    return get_default().delete_board(board_root);
+}
+
+void move_subtree_to_board(Task* task, RootTask* board)
+{
+    get_default().move_subtree_to_board(task, board);
+}
+
+void merge_boards(RootTask* target, RootTask* source)
+{
+    get_default().merge_boards(target, source);
+}
+
+RootTask* split_board(Task* task)
+{
+    return get_default().split_board(task);
+}
+
+DependencyGraph& get_dependencies()
+{
+    return get_default().get_dependencies();
+}
+
+ReminderWheel& get_reminders()
+{
+    return get_default().get_reminders();
+}
+
+TagIndex& get_tags()
+{
+    return get_default().get_tags();
+}
+
+ChangeFeed& get_changes()
+{
+    return get_default().get_changes();
+}
+
+DomainStats get_stats(bool audit)
+{
+    return get_default().get_stats(audit);
+}
+
+bool stream_tasks(const TaskQuery& query, const TaskVisitor& visitor)
+{
+    return get_default().stream_tasks(query, visitor);
+}
+
+std::size_t find_tasks(
+        const TaskQuery& query,
+        std::vector<Task*>& out,
+        std::size_t limit)
+{
+    return get_default().find_tasks(query, out, limit);
+}
+
+sigma::core::CallbackInterface<Task*>* on_task_created()
+{
+    return get_default().on_task_created();
+}
+
+sigma::core::CallbackInterface<Task*>* on_task_destroyed()
+{
+    return get_default().on_task_destroyed();
+}
+
+sigma::core::CallbackInterface<
+        Task*,
+        const TaskAttributes&,
+        const TaskAttributes&>* on_task_attributes_changed()
+{
+    return get_default().on_task_attributes_changed();
 }
 
 } // namespace domain
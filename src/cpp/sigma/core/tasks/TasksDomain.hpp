@@ -7,11 +7,27 @@
 #ifndef SIGMA_CORE_TASKS_TASKSDOMAIN_HPP_
 #define SIGMA_CORE_TASKS_TASKSDOMAIN_HPP_
 
+#include <atomic>
+#include <functional>
+#include <future>
 #include <memory>
-#include <set>
+#include <mutex>
+#include <vector>
 
+#include <arcanecore/base/Preproc.hpp>
 #include <arcanecore/base/str/UTF8String.hpp>
 
+#include "sigma/core/Callback.hpp"
+#include "sigma/core/tasks/BoardRegistry.hpp"
+#include "sigma/core/tasks/ChangeFeed.hpp"
+#include "sigma/core/tasks/DependencyGraph.hpp"
+#include "sigma/core/tasks/DomainStats.hpp"
+#include "sigma/core/tasks/ReminderWheel.hpp"
+#include "sigma/core/tasks/ShardPool.hpp"
+#include "sigma/core/tasks/TagIndex.hpp"
+#include "sigma/core/tasks/TaskAttributes.hpp"
+#include "sigma/core/tasks/TaskQuery.hpp"
+
 namespace sigma
 {
 namespace core
@@ -29,9 +45,517 @@ namespace tasks
 //------------------------------------------------------------------------------
 
 class RootTask;
+class Task;
+
+/*!
+ * \brief An isolated instance of the task management API.
+ *
+ * A domain owns a set of boards along with the id space of their Tasks and
+ * the dependencies, reminders and tags of their Tasks. Nothing is shared
+ * between domains, so separate domains can be used from separate threads
+ * without contending with each other, and Task ids are only unique within a
+ * domain. Tasks can't be moved between the boards of different domains.
+ *
+ * The free functions of the domain namespace operate on a default domain
+ * that exists for the lifetime of the process, see domain::get_default().
+ *
+ * Callbacks for the creation, destruction and attribute changes of any Task
+ * are also registered with the domain, such as on_task_created(), and are
+ * only fired by the Tasks of that domain.
+ */
+class TasksDomain
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(TasksDomain);
+
+    friend class BoardFile;
+    friend class RootTask;
+    friend class Task;
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new domain with no boards.
+     */
+    TasksDomain();
+
+    //--------------------------------------------------------------------------
+    //                                 DESTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Destroys the boards of this domain.
+     */
+    ~TasksDomain();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Deletes every board of this domain and clears its dependencies,
+     *        reminders and tags.
+     *
+     * Task ids are not reused after clearing.
+     *
+     * \throws arc::ex::StateError If called from a job, see submit().
+     */
+    void clear();
+
+    /*!
+     * \brief Returns the boards of this domain in the order they were
+     *        created.
+     *
+     * The boards are copied while the domain is locked, so the returned
+     * boards don't change as boards are created and deleted, although the
+     * boards themselves may have been deleted by other threads since.
+     *
+     * This function is safe to call from multiple threads.
+     */
+    std::vector<RootTask*> get_boards() const;
+
+    /*!
+     * \brief Returns the board with the given handle, or null if the board has
+     *        been deleted.
+     *
+     * This function is safe to call from multiple threads.
+     */
+    RootTask* get_board(BoardHandle handle) const;
+
+    /*!
+     * \brief Returns the handle of the given board, or
+     *        BoardRegistry::NULL_HANDLE if the board isn't in this domain.
+     *
+     * This function is safe to call from multiple threads.
+     */
+    BoardHandle get_board_handle(const RootTask* board) const;
+
+    /*!
+     * \brief Returns the board with the given title, or null if there is no
+     *        such board.
+     *
+     * This function is safe to call from multiple threads.
+     */
+    RootTask* find_board(const arc::str::UTF8String& title) const;
+
+    /*!
+     * \brief Creates a new board in this domain.
+     *
+     * If there is already a board with the title then the new board's title
+     * is made unique by appending a number, see BoardTitleIndex.
+     *
+     * This function is safe to call from multiple threads.
+     *
+     * \throws arc::ex::ValueError If the title is empty.
+     */
+    RootTask* new_board(const arc::str::UTF8String& title);
+
+    /*!
+     * \brief Deletes the given board and all of its Tasks.
+     *
+     * No more jobs can be submitted for the board once this is called, and
+     * the board is only destroyed once the jobs that were submitted for it
+     * before have been executed. This waits for them, unless called from a
+     * job on the board's own shard, in which case the board is removed from
+     * the domain immediately but destroyed after the jobs queued behind the
+     * calling job.
+     *
+     * This function is safe to call from multiple threads.
+     *
+     * \return False if the board isn't in this domain.
+     *
+     * \throws arc::ex::StateError If called from a job of a board that is on
+     *                             a different shard, see submit().
+     */
+    bool delete_board(RootTask* board_root);
+
+    /*!
+     * \brief Moves the given Task and its descendants to the end of the
+     *        top-level Tasks of the given board.
+     *
+     * The Task objects are relinked to the board rather than recreated, so
+     * pointers, ids, callbacks, dependencies and tags are kept and
+     * on_parent_changed() is only fired for the given Task.
+     *
+     * \warning Moves between boards can't be undone, the undo and redo steps
+     *          of both boards are discarded, see TaskHistory.
+     *
+     * \throws arc::ex::ValueError If the Task is null or a RootTask, or if
+     *                             the board isn't in this domain.
+     * \throws arc::ex::StateError If called from a job and either board is
+     *                             on a different shard to the job, see
+     *                             submit().
+     */
+    void move_subtree_to_board(Task* task, RootTask* board);
+
+    /*!
+     * \brief Moves the top-level Tasks of the source board to the end of the
+     *        top-level Tasks of the target board then deletes the source
+     *        board, see move_subtree_to_board().
+     *
+     * \warning The merge can't be undone, the undo and redo steps of the
+     *          target board are discarded.
+     *
+     * \throws arc::ex::ValueError If either board isn't in this domain or if
+     *                             the boards are the same.
+     */
+    void merge_boards(RootTask* target, RootTask* source);
+
+    /*!
+     * \brief Creates a new board with the title of the given Task and moves
+     *        the Task and its descendants to it, see move_subtree_to_board().
+     *
+     * The Task becomes the only top-level Task of the new board.
+     *
+     * \warning The split can't be undone, the undo and redo steps of the
+     *          Task's previous board are discarded and the new board starts
+     *          with an empty history.
+     *
+     * \throws arc::ex::ValueError If the Task is null or a RootTask.
+     */
+    RootTask* split_board(Task* task);
+
+    /*!
+     * \brief Returns the dependencies between the Tasks of this domain.
+     *
+     * Tasks are removed from the graph when they are destroyed, but not when
+     * they are archived (see Task::archive()).
+     */
+    DependencyGraph& get_dependencies();
+
+    /*!
+     * \brief Returns the reminders for the due dates of the Tasks of this
+     *        domain.
+     *
+     * Tasks that have a due date and aren't done are scheduled for their due
+     * date, and are cancelled when they're done, their due date is cleared,
+     * or they are destroyed. The wheel's time must be moved forward by
+     * calling ReminderWheel::advance() with the current time.
+     */
+    ReminderWheel& get_reminders();
+
+    /*!
+     * \brief Returns the tags of the Tasks of this domain.
+     *
+     * Tasks are removed from the index when they are destroyed, their tags
+     * are kept while they are archived (see Task::archive()) and are restored
+     * by undoing their deletion.
+     */
+    TagIndex& get_tags();
+
+    /*!
+     * \brief Returns the feed of the changes made to the boards and Tasks of
+     *        this domain.
+     *
+     * Consumers read the changes through their own ChangeFeed::Cursor rather
+     * than registering callbacks that are fired while each change is made.
+     */
+    ChangeFeed& get_changes();
+
+    /*!
+     * \brief Returns the statistics of every board of this domain.
+     *
+     * By default the statistics are read from counters that are maintained
+     * as the boards change, which takes constant time per board, see
+     * RootTask::get_stats(). An audit visits every resident Task of every
+     * board to compute exact statistics, see RootTask::audit_stats().
+     *
+     * The mutation rate of the domain is measured by comparing two sets of
+     * statistics, see DomainStats::get_mutation_rate().
+     *
+     * This function is safe to call from multiple threads.
+     */
+    DomainStats get_stats(bool audit = false);
+
+    /*!
+     * \brief Starts the given number of worker threads, called shards, that
+     *        execute the jobs passed to submit().
+     *
+     * Every board is assigned to a shard when it is created, in turn, so the
+     * jobs of a board always run on the same thread in the order they were
+     * submitted while the jobs of boards on other shards run in parallel.
+     * Shards are not started by default.
+     *
+     * \warning This must not be called while other threads are submitting
+     *          jobs.
+     *
+     * \throws arc::ex::ValueError If the shard count is zero.
+     * \throws arc::ex::StateError If the shards have already been started.
+     */
+    void start_shards(std::size_t shard_count);
+
+    /*!
+     * \brief Executes the jobs that have already been submitted then stops
+     *        the shards.
+     *
+     * Jobs submitted after the shards have stopped are executed by the
+     * thread that submits them. Does nothing if the shards aren't running.
+     *
+     * \warning This must not be called while other threads are submitting
+     *          jobs, or from a shard.
+     */
+    void stop_shards();
+
+    /*!
+     * \brief Returns the number of shards that are running, or 0 if the shards
+     *        have not been started.
+     */
+    std::size_t get_shard_count() const;
+
+    /*!
+     * \brief Executes the given function with the given board on the shard
+     *        the board is assigned to.
+     *
+     * The function is called as function(board) and its result, or the
+     * exception it throws, is returned through the future. If the shards
+     * aren't running the function is executed immediately by the calling
+     * thread.
+     *
+     * Jobs for a board can't be submitted once the board is being deleted,
+     * delete_board() only destroys the board once the jobs that were
+     * submitted before it have been executed. A job may only wait for the
+     * jobs of boards on its own shard, so it may only move Tasks between or
+     * delete such boards.
+     *
+     * \note The Task locks are still taken by the function, but since a
+     *       board's jobs are executed by a single thread they are only
+     *       contended by threads that change the board directly.
+     *
+     * \throws arc::ex::StateError If the board is being deleted.
+     */
+    template<typename Function>
+    auto submit(RootTask* board, Function function)
+        -> std::future<decltype(function(board))>
+    {
+        typedef decltype(function(board)) Result;
+
+        std::shared_ptr<std::packaged_task<Result()>> job(
+                new std::packaged_task<Result()>(std::bind(function, board)));
+        std::future<Result> result(job->get_future());
+        post(board, [job]()
+        {
+            (*job)();
+        });
+        return result;
+    }
+
+    /*!
+     * \brief Passes the Tasks of every board that match the given query to
+     *        the given visitor until the visitor returns false.
+     *
+     * Boards are queried one at a time, see TaskQuery::stream().
+     *
+     * \return False if the visitor stopped the query.
+     */
+    bool stream_tasks(const TaskQuery& query, const TaskVisitor& visitor);
+
+    /*!
+     * \brief Appends at most limit of the Tasks of every board that match the
+     *        given query to the given vector.
+     *
+     * \return The number of Tasks appended.
+     */
+    std::size_t find_tasks(
+            const TaskQuery& query,
+            std::vector<Task*>& out,
+            std::size_t limit = TaskQuery::NO_LIMIT);
+
+    //--------------------------------------------------------------------------
+    //                              CALLBACK EVENTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief For registering callbacks that handle when a new Task is created
+     *        on a board of this domain, including the RootTasks of new
+     *        boards.
+     *
+     * Relevant callback functions take one argument:
+     * - ``Task*`` - the Task that has just been created.
+     */
+    sigma::core::CallbackInterface<Task*>* on_task_created()
+    {
+        return &m_created_callback.get_interface();
+    }
+
+    /*!
+     * \brief For registering callbacks that handle when a Task of this domain
+     *        is destroyed.
+     *
+     * Relevant callback functions take one argument:
+     * - ``Task*`` - the Task that is about to be destroyed.
+     *
+     * \warning Exceptions should be avoided in registered callback functions
+     *          since these functions will be called from within a Task's
+     *          destructor.
+     */
+    sigma::core::CallbackInterface<Task*>* on_task_destroyed()
+    {
+        return &m_destroyed_callback.get_interface();
+    }
+
+    /*!
+     * \brief For registering callbacks that handle when any Task of this
+     *        domain has any of its typed attributes changed.
+     *
+     * Unlike Task::on_attributes_changed() this is also fired when attributes
+     * are restored by deserialising or rehydrating a Task.
+     *
+     * Relevant callback functions take three arguments:
+     * - ``Task*`` - the Task thats attributes have changed.
+     * - ``const TaskAttributes&`` - the previous attributes of the Task.
+     * - ``const TaskAttributes&`` - the new attributes of the Task.
+     */
+    sigma::core::CallbackInterface<
+            Task*,
+            const TaskAttributes&,
+            const TaskAttributes&>*
+    on_task_attributes_changed()
+    {
+        return &m_attributes_changed_callback.get_interface();
+    }
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The last Task id that was allocated, atomic so that boards can be
+     *        populated from multiple threads.
+     */
+    std::atomic<arc::uint32> m_last_id;
+    /*!
+     * \brief The last ancestry epoch that was allocated, shared by all boards
+     *        of the domain so that Tasks moved between boards can't appear to
+     *        have a valid ancestry.
+     */
+    std::atomic<arc::uint64> m_last_ancestry_epoch;
+
+    /*!
+     * \brief The dependencies between Tasks.
+     *
+     * This is declared before the boards so that it outlives any Tasks that
+     * are destroyed with the boards.
+     */
+    DependencyGraph m_dependencies;
+    /*!
+     * \brief The due dates of Tasks, declared before the boards for the same
+     *        reason as the dependencies.
+     */
+    ReminderWheel m_reminders;
+    /*!
+     * \brief The tags of Tasks, also declared before the boards.
+     */
+    TagIndex m_tags;
+    /*!
+     * \brief The changes made to the boards, also declared before the boards
+     *        since boards record their deletion.
+     */
+    ChangeFeed m_changes;
+
+    // callback handlers, these are declared before the boards since Tasks
+    // fire them as they are destroyed with the boards
+    sigma::core::CallbackHandler<Task*> m_created_callback;
+    sigma::core::CallbackHandler<Task*> m_destroyed_callback;
+    sigma::core::CallbackHandler<
+            Task*,
+            const TaskAttributes&,
+            const TaskAttributes&> m_attributes_changed_callback;
+
+    /*!
+     * \brief Guards the boards collection and board title resolution.
+     *
+     * This is recursive since Task callbacks fired while a board is being
+     * created may call back into the domain.
+     */
+    mutable std::recursive_mutex m_mutex;
+    /*!
+     * \brief The existing Task boards.
+     */
+    BoardRegistry m_boards;
+    /*!
+     * \brief The shard that will be assigned to the next board.
+     */
+    std::size_t m_next_shard;
+    /*!
+     * \brief The shards that execute submitted jobs, or null if they have not
+     *        been started.
+     *
+     * This is declared after the boards so that the shards are stopped
+     * before the boards are destroyed.
+     */
+    std::unique_ptr<ShardPool> m_shards;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Executes the given job on the shard the board is assigned to, or
+     *        immediately if the shards aren't running.
+     */
+    void post(RootTask* board, std::function<void()> job);
+
+    /*!
+     * \brief Waits for the jobs that have been submitted for the given board
+     *        to be executed.
+     */
+    void drain(const RootTask* board);
+
+    /*!
+     * \brief Returns a new Task id.
+     */
+    arc::uint32 allocate_id();
+
+    /*!
+     * \brief Ensures that newly allocated Task ids are greater than the given
+     *        id, which has been restored.
+     */
+    void reserve_id(arc::uint32 id);
+
+    /*!
+     * \brief Returns a new ancestry epoch.
+     */
+    arc::uint64 allocate_ancestry_epoch();
+
+    /*!
+     * \brief Removes a Task of this domain that is being destroyed from the
+     *        dependencies, the reminders and the tags.
+     */
+    void handle_task_destroyed(arc::uint32 id);
+
+    /*!
+     * \brief Detaches a Task of this domain that is being archived from the
+     *        reminders and the tags, its dependencies and tags are kept.
+     */
+    void handle_task_archived(Task* task);
+
+    /*!
+     * \brief Attaches the tags of a Task of this domain to the object that was
+     *        created for it by rehydrating.
+     */
+    void handle_task_rehydrated(Task* task);
+
+    /*!
+     * \brief Updates the dependencies and reminders of a Task of this domain
+     *        whose attributes have changed.
+     */
+    void handle_task_attributes_changed(
+            Task* task,
+            const TaskAttributes& old_attributes,
+            const TaskAttributes& attributes);
+};
 
 /*!
  * \brief The domain for interacting with the task management module.
+ *
+ * These functions operate on the default TasksDomain.
  */
 namespace domain
 {
@@ -40,6 +564,12 @@ namespace domain
 //                                   FUNCTIONS
 //------------------------------------------------------------------------------
 
+/*!
+ * \brief Returns the default domain, which exists for the lifetime of the
+ *        process.
+ */
+TasksDomain& get_default();
+
 // TODO: doxygen hide
 
 /*!
@@ -52,29 +582,124 @@ void init();
 /*!
  * \brief Uninitialises the task management API component.
  *
- * TODO:
+ * This stops the shards of the default domain and clears it, see
+ * TasksDomain::stop_shards() and TasksDomain::clear().
  */
 void clean_up();
 
 // TODO: doxygen hide end??
 
 /*!
- * \brief TODO:
+ * \brief See TasksDomain::get_boards().
+ */
+std::vector<RootTask*> get_boards();
+
+/*!
+ * \brief See TasksDomain::get_board().
  */
-const std::set<std::unique_ptr<RootTask>>& get_boards();
+RootTask* get_board(BoardHandle handle);
 
 /*!
- * \brief TODO:
+ * \brief See TasksDomain::get_board_handle().
+ */
+BoardHandle get_board_handle(const RootTask* board);
+
+/*!
+ * \brief See TasksDomain::find_board().
+ */
+RootTask* find_board(const arc::str::UTF8String& title);
+
+/*!
+ * \brief See TasksDomain::new_board().
  */
 RootTask* new_board(const arc::str::UTF8String& title);
 
 /*!
- * \brief TODO
- *
- * TODO
+ * \brief See TasksDomain::delete_board().
  */
 bool delete_board(RootTask* board_root);
 
+/*!
+ * \brief See TasksDomain::move_subtree_to_board().
+ */
+void move_subtree_to_board(Task* task, RootTask* board);
+
+/*!
+ * \brief See TasksDomain::merge_boards().
+ */
+void merge_boards(RootTask* target, RootTask* source);
+
+/*!
+ * \brief See TasksDomain::split_board().
+ */
+RootTask* split_board(Task* task);
+
+/*!
+ * \brief See TasksDomain::get_dependencies().
+ */
+DependencyGraph& get_dependencies();
+
+/*!
+ * \brief See TasksDomain::get_reminders().
+ */
+ReminderWheel& get_reminders();
+
+/*!
+ * \brief See TasksDomain::get_tags().
+ */
+TagIndex& get_tags();
+
+/*!
+ * \brief See TasksDomain::get_changes().
+ */
+ChangeFeed& get_changes();
+
+/*!
+ * \brief See TasksDomain::get_stats().
+ */
+DomainStats get_stats(bool audit = false);
+
+/*!
+ * \brief See TasksDomain::submit().
+ */
+template<typename Function>
+auto submit(RootTask* board, Function function)
+    -> std::future<decltype(function(board))>
+{
+    return get_default().submit(board, function);
+}
+
+/*!
+ * \brief See TasksDomain::stream_tasks().
+ */
+bool stream_tasks(const TaskQuery& query, const TaskVisitor& visitor);
+
+/*!
+ * \brief See TasksDomain::find_tasks().
+ */
+std::size_t find_tasks(
+        const TaskQuery& query,
+        std::vector<Task*>& out,
+        std::size_t limit = TaskQuery::NO_LIMIT);
+
+/*!
+ * \brief See TasksDomain::on_task_created().
+ */
+sigma::core::CallbackInterface<Task*>* on_task_created();
+
+/*!
+ * \brief See TasksDomain::on_task_destroyed().
+ */
+sigma::core::CallbackInterface<Task*>* on_task_destroyed();
+
+/*!
+ * \brief See TasksDomain::on_task_attributes_changed().
+ */
+sigma::core::CallbackInterface<
+        Task*,
+        const TaskAttributes&,
+        const TaskAttributes&>* on_task_attributes_changed();
+
 } // namespace domain
 } // namespace tasks
 } // namespace core
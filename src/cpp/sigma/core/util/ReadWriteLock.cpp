@@ -0,0 +1,150 @@
+#include "sigma/core/util/ReadWriteLock.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <arcanecore/base/Exceptions.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace util
+{
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                   VARIABLES
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief The locks the calling thread holds read locks on, once for each
+ *        read lock it holds.
+ */
+thread_local std::vector<const ReadWriteLock*> t_read_locks;
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+ReadWriteLock::ReadWriteLock()
+    :
+    m_readers    (0),
+    m_write_depth(0)
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void ReadWriteLock::lock_read()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // reads from the writing thread are treated as nested writes
+    if(m_write_depth > 0 && m_writer == std::this_thread::get_id())
+    {
+        ++m_write_depth;
+        return;
+    }
+
+    // only writers block readers
+    while(m_write_depth > 0)
+    {
+        m_condition.wait(lock);
+    }
+    ++m_readers;
+    t_read_locks.push_back(this);
+}
+
+void ReadWriteLock::unlock_read()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // was this a nested write?
+    if(m_write_depth > 0 && m_writer == std::this_thread::get_id())
+    {
+        --m_write_depth;
+        if(m_write_depth == 0)
+        {
+            m_writer = std::thread::id();
+            m_condition.notify_all();
+        }
+        return;
+    }
+
+    assert(m_readers > 0);
+    t_read_locks.erase(std::find(
+            t_read_locks.rbegin(),
+            t_read_locks.rend(),
+            this
+    ).base() - 1);
+    if(--m_readers == 0)
+    {
+        m_condition.notify_all();
+    }
+}
+
+void ReadWriteLock::lock_write()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // re-entrant for the writing thread
+    if(m_write_depth > 0 && m_writer == std::this_thread::get_id())
+    {
+        ++m_write_depth;
+        return;
+    }
+
+    // the readers would never include this thread
+    if(is_read_locked_by_this_thread())
+    {
+        throw arc::ex::StateError(
+                "The write lock can't be acquired by a thread that holds "
+                "the read lock");
+    }
+
+    while(m_write_depth > 0 || m_readers > 0)
+    {
+        m_condition.wait(lock);
+    }
+    m_writer = std::this_thread::get_id();
+    m_write_depth = 1;
+}
+
+void ReadWriteLock::unlock_write()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    assert(m_write_depth > 0);
+    assert(m_writer == std::this_thread::get_id());
+
+    if(--m_write_depth == 0)
+    {
+        m_writer = std::thread::id();
+        m_condition.notify_all();
+    }
+}
+
+bool ReadWriteLock::is_write_locked_by_this_thread() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_write_depth > 0 && m_writer == std::this_thread::get_id();
+}
+
+bool ReadWriteLock::is_read_locked_by_this_thread() const
+{
+    // only the calling thread accesses its read locks
+    return std::find(t_read_locks.begin(), t_read_locks.end(), this) !=
+           t_read_locks.end();
+}
+
+} // namespace util
+} // namespace core
+} // namespace sigma
@@ -0,0 +1,187 @@
+/*!
+ * \file
+ * \brief Reader/writer locking primitives used to synchronise access to Sigma
+ *        data structures.
+ * \author David Saxon
+ */
+#ifndef SIGMA_CORE_UTIL_READWRITELOCK_HPP_
+#define SIGMA_CORE_UTIL_READWRITELOCK_HPP_
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+
+namespace sigma
+{
+namespace core
+{
+namespace util
+{
+
+/*!
+ * \brief A reader/writer lock which allows any number of concurrent readers or
+ *        a single writer.
+ *
+ * Readers never wait on other readers, they only wait while a writer holds the
+ * lock. The write lock is re-entrant for the thread that holds it, and that
+ * thread may also acquire read locks while it is writing (these are treated as
+ * nested write locks).
+ *
+ * \warning Upgrading is not supported, a thread holding a read lock can't
+ *          acquire the write lock since it would wait for itself. This is
+ *          reported by lock_write() rather than deadlocking.
+ */
+class ReadWriteLock
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(ReadWriteLock);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new unlocked ReadWriteLock.
+     */
+    ReadWriteLock();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Acquires shared read access, blocking while another thread holds
+     *        the write lock.
+     */
+    void lock_read();
+
+    /*!
+     * \brief Releases shared read access previously acquired with
+     *        lock_read().
+     */
+    void unlock_read();
+
+    /*!
+     * \brief Acquires exclusive write access, blocking while any other thread
+     *        holds a read or write lock.
+     *
+     * \throws arc::ex::StateError If the calling thread holds a read lock
+     *                             but not the write lock.
+     */
+    void lock_write();
+
+    /*!
+     * \brief Releases exclusive write access previously acquired with
+     *        lock_write().
+     */
+    void unlock_write();
+
+    /*!
+     * \brief Returns whether the calling thread currently holds the write
+     *        lock.
+     */
+    bool is_write_locked_by_this_thread() const;
+
+    /*!
+     * \brief Returns whether the calling thread currently holds a read lock,
+     *        not counting read locks nested within its write lock.
+     */
+    bool is_read_locked_by_this_thread() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Protects the internal state of the lock.
+     */
+    mutable std::mutex m_mutex;
+    /*!
+     * \brief Signalled whenever the lock becomes available.
+     */
+    std::condition_variable m_condition;
+    /*!
+     * \brief The number of threads currently holding read access.
+     */
+    arc::uint32 m_readers;
+    /*!
+     * \brief The number of nested write locks held by the writing thread.
+     */
+    arc::uint32 m_write_depth;
+    /*!
+     * \brief The thread that currently holds the write lock.
+     */
+    std::thread::id m_writer;
+};
+
+/*!
+ * \brief Acquires a read lock on the given ReadWriteLock for the lifetime of
+ *        this object.
+ */
+class ScopedReadLock
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(ScopedReadLock);
+
+public:
+
+    explicit ScopedReadLock(ReadWriteLock& lock)
+        :
+        m_lock(lock)
+    {
+        m_lock.lock_read();
+    }
+
+    ~ScopedReadLock()
+    {
+        m_lock.unlock_read();
+    }
+
+private:
+
+    ReadWriteLock& m_lock;
+};
+
+/*!
+ * \brief Acquires a write lock on the given ReadWriteLock for the lifetime of
+ *        this object.
+ */
+class ScopedWriteLock
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(ScopedWriteLock);
+
+public:
+
+    explicit ScopedWriteLock(ReadWriteLock& lock)
+        :
+        m_lock(lock)
+    {
+        m_lock.lock_write();
+    }
+
+    ~ScopedWriteLock()
+    {
+        m_lock.unlock_write();
+    }
+
+private:
+
+    ReadWriteLock& m_lock;
+};
+
+} // namespace util
+} // namespace core
+} // namespace sigma
+
+#endif
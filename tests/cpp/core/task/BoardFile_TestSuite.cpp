@@ -0,0 +1,375 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.BoardFile)
+
+#include <cstring>
+
+#include <arcanecore/io/sys/FileSystemOperations.hpp>
+
+#include "sigma/core/tasks/BoardFile.hpp"
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class BoardFileFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::RootTask* board;
+    sigma::core::tasks::Task* a;
+    sigma::core::tasks::Task* b;
+    sigma::core::tasks::Task* c;
+    sigma::core::tasks::Task* d;
+    sigma::core::tasks::Task* archived;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    void setup()
+    {
+        sigma::core::tasks::domain::init();
+
+        // Board
+        //  |- a
+        //  |  |- c
+        //  |  |- d
+        //  |- b
+        //  |- archived (with archived descendants)
+        board = sigma::core::tasks::domain::new_board("Board");
+        board->set_estimate(5);
+        a = new sigma::core::tasks::Task(board, "a");
+        b = new sigma::core::tasks::Task(board, "b \xE2\x9C\x93");
+        c = new sigma::core::tasks::Task(a, "c");
+        d = new sigma::core::tasks::Task(a, "d");
+        archived = new sigma::core::tasks::Task(board, "archived");
+        sigma::core::tasks::Task* cold =
+            new sigma::core::tasks::Task(archived, "cold");
+        new sigma::core::tasks::Task(cold, "colder");
+
+        a->set_status(sigma::core::tasks::STATUS_IN_PROGRESS);
+        a->set_assignee("alice");
+        b->set_priority(sigma::core::tasks::PRIORITY_HIGH);
+        b->set_due_date(-86400);
+        b->set_flag(sigma::core::tasks::FLAG_STARRED, true);
+        c->set_assignee("alice");
+        c->set_status(sigma::core::tasks::STATUS_DONE);
+        d->set_assignee("bob");
+        d->set_estimate(90);
+        archived->archive();
+    }
+
+    virtual void teardown()
+    {
+        sigma::core::tasks::domain::clean_up();
+    }
+
+    /*!
+     * Checks the given loaded board matches the fixture's board.
+     */
+    void check_loaded(sigma::core::tasks::RootTask* loaded)
+    {
+        ARC_CHECK_TRUE(loaded != board);
+        ARC_CHECK_EQUAL(loaded->get_estimate(), 5);
+        ARC_CHECK_EQUAL(loaded->get_children_count(), 3);
+
+        sigma::core::tasks::Task* loaded_a = loaded->find_task(a->get_id());
+        sigma::core::tasks::Task* loaded_b = loaded->find_task(b->get_id());
+        sigma::core::tasks::Task* loaded_c = loaded->find_task(c->get_id());
+        sigma::core::tasks::Task* loaded_d = loaded->find_task(d->get_id());
+        ARC_CHECK_EQUAL(loaded->get_chidren()[0], loaded_a);
+        ARC_CHECK_EQUAL(loaded->get_chidren()[1], loaded_b);
+        ARC_CHECK_EQUAL(loaded_a->get_chidren()[0], loaded_c);
+        ARC_CHECK_EQUAL(loaded_a->get_chidren()[1], loaded_d);
+        ARC_CHECK_EQUAL(loaded_b->get_title(), b->get_title());
+        ARC_CHECK_TRUE(loaded_a->get_attributes() == a->get_attributes());
+        ARC_CHECK_TRUE(loaded_b->get_attributes() == b->get_attributes());
+        ARC_CHECK_TRUE(loaded_c->get_attributes() == c->get_attributes());
+        ARC_CHECK_TRUE(loaded_d->get_attributes() == d->get_attributes());
+
+        ARC_TEST_MESSAGE("Checking archived Tasks stay archived");
+        sigma::core::tasks::Task* loaded_archived = loaded->get_chidren()[2];
+        ARC_CHECK_EQUAL(loaded_archived->get_id(), archived->get_id());
+        ARC_CHECK_TRUE(loaded_archived->is_archived());
+        ARC_CHECK_EQUAL(loaded_archived->get_descendant_count(), 2);
+        loaded_archived->rehydrate();
+        ARC_CHECK_EQUAL(
+            loaded_archived->get_chidren()[0]->get_title(),
+            "cold"
+        );
+        ARC_CHECK_EQUAL(
+            loaded_archived->get_chidren()[0]->get_chidren()[0]->get_title(),
+            "colder"
+        );
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                     ENCODE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(encode, BoardFileFixture)
+{
+    std::vector<arc::uint8> data;
+    sigma::core::tasks::BoardFile::encode(fixture->board, data);
+    ARC_CHECK_EQUAL(data.size() % 8, 0);
+    sigma::core::tasks::BoardFile file(&data[0], data.size());
+
+    ARC_TEST_MESSAGE("Checking the node table");
+    // the descendants of the archived Task are not nodes
+    ARC_CHECK_EQUAL(file.get_node_count(), 6);
+    ARC_CHECK_EQUAL(file.get_id(0), fixture->board->get_id());
+    ARC_CHECK_EQUAL(file.get_parent(0), sigma::core::tasks::BoardFile::NONE);
+    ARC_CHECK_EQUAL(file.get_children_count(0), 3);
+    ARC_CHECK_EQUAL(file.get_title(0).to_string(), "Board");
+
+    // nodes are in pre-order: Board, a, c, d, b, archived
+    arc::uint32 a = file.get_first_child(0);
+    ARC_CHECK_EQUAL(a, 1);
+    ARC_CHECK_EQUAL(file.get_id(a), fixture->a->get_id());
+    ARC_CHECK_EQUAL(file.get_parent(a), 0);
+    arc::uint32 c = file.get_first_child(a);
+    ARC_CHECK_EQUAL(c, 2);
+    ARC_CHECK_EQUAL(file.get_next_sibling(c), 3);
+    ARC_CHECK_EQUAL(
+        file.get_next_sibling(3),
+        sigma::core::tasks::BoardFile::NONE
+    );
+    arc::uint32 b = file.get_next_sibling(a);
+    ARC_CHECK_EQUAL(b, 4);
+    ARC_CHECK_EQUAL(file.get_id(b), fixture->b->get_id());
+    ARC_CHECK_EQUAL(
+        file.get_first_child(b),
+        sigma::core::tasks::BoardFile::NONE
+    );
+    ARC_CHECK_EQUAL(file.get_next_sibling(b), 5);
+    ARC_CHECK_TRUE(file.is_archived(5));
+    ARC_CHECK_FALSE(file.is_archived(b));
+    ARC_CHECK_EQUAL(file.get_children_count(5), 0);
+
+    ARC_TEST_MESSAGE("Checking titles are read in place");
+    sigma::core::tasks::BoardFile::StringRef title = file.get_title(b);
+    ARC_CHECK_TRUE(
+        reinterpret_cast<const arc::uint8*>(title.data) > &data[0]);
+    ARC_CHECK_TRUE(
+        reinterpret_cast<const arc::uint8*>(title.data) <
+        &data[0] + data.size()
+    );
+    ARC_CHECK_EQUAL(title.length, 5);
+    ARC_CHECK_EQUAL(std::memcmp(title.data, "b \xE2\x9C\x93", 5), 0);
+
+    ARC_TEST_MESSAGE("Checking attributes");
+    sigma::core::tasks::TaskAttributes attributes;
+    file.get_attributes(b, attributes);
+    ARC_CHECK_TRUE(attributes == fixture->b->get_attributes());
+    file.get_attributes(3, attributes);
+    ARC_CHECK_TRUE(attributes == fixture->d->get_attributes());
+    file.get_attributes(c, attributes);
+    ARC_CHECK_EQUAL(attributes.assignee, "alice");
+    // the assignee is only stored once
+    sigma::core::tasks::TaskAttributes a_attributes;
+    file.get_attributes(a, a_attributes);
+    ARC_CHECK_TRUE(a_attributes == fixture->a->get_attributes());
+
+    ARC_TEST_MESSAGE("Checking the id index");
+    ARC_CHECK_EQUAL(file.find_node(fixture->d->get_id()), 3);
+    ARC_CHECK_EQUAL(file.find_node(fixture->board->get_id()), 0);
+    ARC_CHECK_EQUAL(
+        file.find_node(fixture->archived->get_id() + 100),
+        sigma::core::tasks::BoardFile::NONE
+    );
+
+    ARC_TEST_MESSAGE("Checking invalid nodes");
+    ARC_CHECK_THROW(file.get_id(6), arc::ex::IndexOutOfBoundsError);
+    ARC_CHECK_THROW(
+        file.get_title(sigma::core::tasks::BoardFile::NONE),
+        arc::ex::IndexOutOfBoundsError
+    );
+
+    ARC_TEST_MESSAGE("Checking encoding doesn't rehydrate");
+    ARC_CHECK_TRUE(fixture->archived->is_archived());
+}
+
+//------------------------------------------------------------------------------
+//                                      LOAD
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(load, BoardFileFixture)
+{
+    std::vector<arc::uint8> data;
+    sigma::core::tasks::BoardFile::encode(fixture->board, data);
+    sigma::core::tasks::BoardFile file(&data[0], data.size());
+
+    ARC_TEST_MESSAGE("Checking loading into another domain");
+    sigma::core::tasks::TasksDomain domain;
+    sigma::core::tasks::ChangeFeed::Cursor cursor(domain.get_changes());
+    sigma::core::tasks::RootTask* loaded = file.load(domain);
+    ARC_CHECK_EQUAL(loaded->get_domain(), &domain);
+    ARC_CHECK_EQUAL(loaded->get_title(), "Board");
+    fixture->check_loaded(loaded);
+    // the loading isn't recorded in the history
+    ARC_CHECK_FALSE(loaded->get_history().can_undo());
+
+    // only the creation of the board is recorded
+    sigma::core::tasks::ChangeRecord record;
+    ARC_CHECK_EQUAL(
+        cursor.read(record),
+        sigma::core::tasks::ChangeFeed::READ_CHANGE
+    );
+    ARC_CHECK_EQUAL(
+        record.type,
+        sigma::core::tasks::ChangeRecord::BOARD_CREATED
+    );
+    ARC_CHECK_EQUAL(record.board_id, loaded->get_id());
+
+    ARC_TEST_MESSAGE("Checking new ids don't collide with loaded ids");
+    sigma::core::tasks::Task* added =
+        new sigma::core::tasks::Task(loaded, "added");
+    ARC_CHECK_TRUE(added->get_id() > fixture->archived->get_id());
+    ARC_CHECK_TRUE(loaded->get_id() > fixture->archived->get_id());
+
+    ARC_TEST_MESSAGE("Checking the loaded board is independent");
+    loaded->find_task(fixture->c->get_id())->set_title("changed");
+    ARC_CHECK_EQUAL(
+        loaded->find_task(fixture->c->get_id())->get_title(),
+        "changed"
+    );
+    ARC_CHECK_EQUAL(fixture->c->get_title(), "c");
+}
+
+//------------------------------------------------------------------------------
+//                                  MAPPED FILE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(mapped_file, BoardFileFixture)
+{
+    arc::io::sys::Path path;
+    path << "board_file_test.sigma";
+    sigma::core::tasks::BoardFile::save(fixture->board, path);
+
+    {
+        sigma::core::tasks::BoardFile file(path);
+        ARC_CHECK_EQUAL(file.get_node_count(), 6);
+        ARC_CHECK_EQUAL(file.get_title(1).to_string(), "a");
+
+        sigma::core::tasks::TasksDomain domain;
+        fixture->check_loaded(file.load(domain));
+    }
+    arc::io::sys::delete_path(path);
+
+    ARC_TEST_MESSAGE("Checking missing files");
+    ARC_CHECK_THROW(
+        sigma::core::tasks::BoardFile(path),
+        arc::ex::InvalidPathError
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                   MALFORMED
+//------------------------------------------------------------------------------
+
+/*!
+ * Interrupts loading with an exception that isn't a parsing error.
+ */
+void interrupt_load(
+        sigma::core::tasks::Task*,
+        const sigma::core::tasks::TaskAttributes&,
+        const sigma::core::tasks::TaskAttributes&)
+{
+    throw arc::ex::StateError("Loading interrupted");
+}
+
+ARC_TEST_UNIT_FIXTURE(malformed, BoardFileFixture)
+{
+    std::vector<arc::uint8> data;
+    sigma::core::tasks::BoardFile::encode(fixture->board, data);
+
+    ARC_TEST_MESSAGE("Checking malformed headers");
+    ARC_CHECK_THROW(
+        sigma::core::tasks::BoardFile(&data[0], 32),
+        arc::ex::ParseError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::BoardFile(&data[0], data.size() - 8),
+        arc::ex::ParseError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::BoardFile(&data[0] + 4, data.size() - 4),
+        arc::ex::ValueError
+    );
+    std::vector<arc::uint8> copy(data);
+    copy[0] = 'X';
+    ARC_CHECK_THROW(
+        sigma::core::tasks::BoardFile(&copy[0], copy.size()),
+        arc::ex::ParseError
+    );
+    copy = data;
+    // the version follows the magic and byte order mark
+    copy[12] = 2;
+    ARC_CHECK_THROW(
+        sigma::core::tasks::BoardFile(&copy[0], copy.size()),
+        arc::ex::ParseError
+    );
+    copy = data;
+    // give the node table more nodes than the file holds
+    copy[23] = 0x7F;
+    ARC_CHECK_THROW(
+        sigma::core::tasks::BoardFile(&copy[0], copy.size()),
+        arc::ex::ParseError
+    );
+
+    ARC_TEST_MESSAGE("Checking malformed nodes");
+    std::size_t boards = sigma::core::tasks::domain::get_boards().size();
+    copy = data;
+    // make the parent of the node of c (72 byte header, 64 byte nodes) refer
+    // to a later node
+    arc::uint32 parent = 4;
+    std::memcpy(&copy[72 + 2 * 64 + 4], &parent, sizeof(parent));
+    {
+        sigma::core::tasks::BoardFile file(&copy[0], copy.size());
+        // opening doesn't visit the nodes
+        ARC_CHECK_EQUAL(file.get_parent(2), 4);
+        ARC_CHECK_THROW(
+            file.load(sigma::core::tasks::domain::get_default()),
+            arc::ex::ParseError
+        );
+    }
+    copy = data;
+    // move the title of c beyond the heap
+    arc::uint32 title_offset = 0x7FFFFFFF;
+    std::memcpy(&copy[72 + 2 * 64 + 28], &title_offset, sizeof(title_offset));
+    {
+        sigma::core::tasks::BoardFile file(&copy[0], copy.size());
+        ARC_CHECK_THROW(file.get_title(2), arc::ex::ParseError);
+        ARC_CHECK_THROW(
+            file.load(sigma::core::tasks::domain::get_default()),
+            arc::ex::ParseError
+        );
+    }
+    // failed loads don't leave a board behind
+    ARC_CHECK_EQUAL(sigma::core::tasks::domain::get_boards().size(), boards);
+
+    ARC_TEST_MESSAGE("Checking other errors don't leave a board behind");
+    {
+        sigma::core::ScopedCallback callback =
+            sigma::core::tasks::domain::on_task_attributes_changed()->
+                register_function(&interrupt_load);
+        sigma::core::tasks::BoardFile file(&data[0], data.size());
+        ARC_CHECK_THROW(
+            file.load(sigma::core::tasks::domain::get_default()),
+            arc::ex::StateError
+        );
+    }
+    ARC_CHECK_EQUAL(sigma::core::tasks::domain::get_boards().size(), boards);
+    sigma::core::tasks::BoardFile file(&data[0], data.size());
+    fixture->check_loaded(
+        file.load(sigma::core::tasks::domain::get_default()));
+}
+
+} // namespace anonymous
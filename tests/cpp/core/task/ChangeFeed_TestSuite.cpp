@@ -0,0 +1,337 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.ChangeFeed)
+
+#include <thread>
+
+#include "sigma/core/tasks/ChangeFeed.hpp"
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class ChangeFeedFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    void setup()
+    {
+        sigma::core::tasks::domain::init();
+    }
+
+    virtual void teardown()
+    {
+        sigma::core::tasks::domain::clean_up();
+    }
+
+    /*!
+     * Reads the next change from the cursor and checks its type and Task.
+     */
+    void check_next(
+            sigma::core::tasks::ChangeFeed::Cursor& cursor,
+            sigma::core::tasks::ChangeRecord::Type type,
+            const sigma::core::tasks::Task* task)
+    {
+        sigma::core::tasks::ChangeRecord record;
+        ARC_CHECK_EQUAL(
+            cursor.read(record),
+            sigma::core::tasks::ChangeFeed::READ_CHANGE
+        );
+        ARC_CHECK_EQUAL(record.type, type);
+        ARC_CHECK_EQUAL(record.task_id, task->get_id());
+        ARC_CHECK_EQUAL(record.board_id, task->get_board()->get_id());
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                      RING
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(ring, ChangeFeedFixture)
+{
+    ARC_CHECK_THROW(
+        sigma::core::tasks::ChangeFeed(0),
+        arc::ex::ValueError
+    );
+
+    sigma::core::tasks::ChangeFeed feed(6);
+    ARC_CHECK_EQUAL(feed.get_capacity(), 8);
+    ARC_CHECK_EQUAL(feed.get_head(), 1);
+
+    ARC_TEST_MESSAGE("Checking reading changes in order");
+    sigma::core::tasks::ChangeFeed::Cursor cursor(feed);
+    sigma::core::tasks::ChangeRecord record;
+    ARC_CHECK_EQUAL(
+        cursor.read(record),
+        sigma::core::tasks::ChangeFeed::READ_EMPTY
+    );
+    for(arc::uint32 i = 0; i < 5; ++i)
+    {
+        ARC_CHECK_EQUAL(
+            feed.append(sigma::core::tasks::ChangeRecord::CREATED, 1, i + 2),
+            i + 1
+        );
+    }
+    for(arc::uint32 i = 0; i < 5; ++i)
+    {
+        ARC_CHECK_EQUAL(
+            cursor.read(record),
+            sigma::core::tasks::ChangeFeed::READ_CHANGE
+        );
+        ARC_CHECK_EQUAL(record.sequence, i + 1);
+        ARC_CHECK_EQUAL(record.type, sigma::core::tasks::ChangeRecord::CREATED);
+        ARC_CHECK_EQUAL(record.board_id, 1);
+        ARC_CHECK_EQUAL(record.task_id, i + 2);
+    }
+    ARC_CHECK_EQUAL(
+        cursor.read(record),
+        sigma::core::tasks::ChangeFeed::READ_EMPTY
+    );
+    ARC_CHECK_EQUAL(cursor.get_sequence(), 6);
+
+    ARC_TEST_MESSAGE("Checking cursors only see later changes");
+    sigma::core::tasks::ChangeFeed::Cursor late(feed);
+    ARC_CHECK_EQUAL(late.get_sequence(), 6);
+    ARC_CHECK_EQUAL(
+        late.read(record),
+        sigma::core::tasks::ChangeFeed::READ_EMPTY
+    );
+
+    ARC_TEST_MESSAGE("Checking the ring wraps while the cursor keeps up");
+    for(arc::uint32 i = 0; i < 20; ++i)
+    {
+        feed.append(sigma::core::tasks::ChangeRecord::MOVED, 1, i);
+        ARC_CHECK_EQUAL(
+            cursor.read(record),
+            sigma::core::tasks::ChangeFeed::READ_CHANGE
+        );
+        ARC_CHECK_EQUAL(record.task_id, i);
+    }
+
+    ARC_TEST_MESSAGE("Checking slow cursors are overrun");
+    ARC_CHECK_EQUAL(
+        late.read(record),
+        sigma::core::tasks::ChangeFeed::READ_OVERRUN
+    );
+    // the cursor doesn't move past changes it missed
+    ARC_CHECK_EQUAL(
+        late.read(record),
+        sigma::core::tasks::ChangeFeed::READ_OVERRUN
+    );
+    late.resync();
+    ARC_CHECK_EQUAL(late.get_sequence(), feed.get_head());
+    ARC_CHECK_EQUAL(
+        late.read(record),
+        sigma::core::tasks::ChangeFeed::READ_EMPTY
+    );
+    feed.append(sigma::core::tasks::ChangeRecord::DESTROYED, 1, 7);
+    ARC_CHECK_EQUAL(
+        late.read(record),
+        sigma::core::tasks::ChangeFeed::READ_CHANGE
+    );
+    ARC_CHECK_EQUAL(record.task_id, 7);
+
+    ARC_TEST_MESSAGE("Checking a cursor exactly one ring behind");
+    sigma::core::tasks::ChangeFeed::Cursor full(feed);
+    for(arc::uint32 i = 0; i < 8; ++i)
+    {
+        feed.append(sigma::core::tasks::ChangeRecord::MOVED, 1, i);
+    }
+    ARC_CHECK_EQUAL(
+        full.read(record),
+        sigma::core::tasks::ChangeFeed::READ_CHANGE
+    );
+    ARC_CHECK_EQUAL(record.task_id, 0);
+    feed.append(sigma::core::tasks::ChangeRecord::MOVED, 1, 8);
+    feed.append(sigma::core::tasks::ChangeRecord::MOVED, 1, 9);
+    ARC_CHECK_EQUAL(
+        full.read(record),
+        sigma::core::tasks::ChangeFeed::READ_OVERRUN
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                 DOMAIN CHANGES
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(domain_changes, ChangeFeedFixture)
+{
+    sigma::core::tasks::ChangeFeed& feed =
+        sigma::core::tasks::domain::get_changes();
+    sigma::core::tasks::ChangeFeed::Cursor cursor(feed);
+    sigma::core::tasks::ChangeRecord record;
+
+    ARC_TEST_MESSAGE("Checking board and Task changes are recorded");
+    sigma::core::tasks::RootTask* board =
+        sigma::core::tasks::domain::new_board("Board");
+    fixture->check_next(
+        cursor,
+        sigma::core::tasks::ChangeRecord::BOARD_CREATED,
+        board
+    );
+    sigma::core::tasks::Task* a = new sigma::core::tasks::Task(board, "a");
+    sigma::core::tasks::Task* b = new sigma::core::tasks::Task(board, "b");
+    sigma::core::tasks::Task* c = new sigma::core::tasks::Task(a, "c");
+    fixture->check_next(cursor, sigma::core::tasks::ChangeRecord::CREATED, a);
+    fixture->check_next(cursor, sigma::core::tasks::ChangeRecord::CREATED, b);
+    fixture->check_next(cursor, sigma::core::tasks::ChangeRecord::CREATED, c);
+
+    b->set_title("renamed");
+    b->set_estimate(30);
+    // unchanged attributes aren't recorded
+    b->set_estimate(30);
+    c->set_parent(b);
+    board->sort_children([](
+            const sigma::core::tasks::Task* x,
+            const sigma::core::tasks::Task* y)
+    {
+        return x->get_id() > y->get_id();
+    });
+    board->set_title("Renamed Board");
+    fixture->check_next(cursor, sigma::core::tasks::ChangeRecord::RETITLED, b);
+    fixture->check_next(
+        cursor,
+        sigma::core::tasks::ChangeRecord::ATTRIBUTES_CHANGED,
+        b
+    );
+    fixture->check_next(cursor, sigma::core::tasks::ChangeRecord::MOVED, c);
+    fixture->check_next(
+        cursor,
+        sigma::core::tasks::ChangeRecord::REORDERED,
+        board
+    );
+    fixture->check_next(
+        cursor,
+        sigma::core::tasks::ChangeRecord::RETITLED,
+        board
+    );
+
+    ARC_TEST_MESSAGE("Checking undo is recorded");
+    board->get_history().undo();
+    fixture->check_next(
+        cursor,
+        sigma::core::tasks::ChangeRecord::RETITLED,
+        board
+    );
+
+    ARC_TEST_MESSAGE("Checking archiving only records the archived Task");
+    ARC_CHECK_TRUE(b->archive());
+    fixture->check_next(cursor, sigma::core::tasks::ChangeRecord::ARCHIVED, b);
+    ARC_CHECK_EQUAL(
+        cursor.read(record),
+        sigma::core::tasks::ChangeFeed::READ_EMPTY
+    );
+    b->rehydrate();
+    fixture->check_next(
+        cursor,
+        sigma::core::tasks::ChangeRecord::REHYDRATED,
+        b
+    );
+    ARC_CHECK_EQUAL(
+        cursor.read(record),
+        sigma::core::tasks::ChangeFeed::READ_EMPTY
+    );
+
+    ARC_TEST_MESSAGE("Checking destruction is recorded");
+    arc::uint32 a_id = a->get_id();
+    delete a;
+    ARC_CHECK_EQUAL(
+        cursor.read(record),
+        sigma::core::tasks::ChangeFeed::READ_CHANGE
+    );
+    ARC_CHECK_EQUAL(record.type, sigma::core::tasks::ChangeRecord::DESTROYED);
+    ARC_CHECK_EQUAL(record.task_id, a_id);
+
+    ARC_TEST_MESSAGE("Checking deleting a board only records the board");
+    arc::uint32 board_id = board->get_id();
+    sigma::core::tasks::domain::delete_board(board);
+    ARC_CHECK_EQUAL(
+        cursor.read(record),
+        sigma::core::tasks::ChangeFeed::READ_CHANGE
+    );
+    ARC_CHECK_EQUAL(
+        record.type,
+        sigma::core::tasks::ChangeRecord::BOARD_DELETED
+    );
+    ARC_CHECK_EQUAL(record.board_id, board_id);
+    ARC_CHECK_EQUAL(record.task_id, board_id);
+    ARC_CHECK_EQUAL(
+        cursor.read(record),
+        sigma::core::tasks::ChangeFeed::READ_EMPTY
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                   CONCURRENCY
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(concurrency, ChangeFeedFixture)
+{
+    static const std::size_t PRODUCERS = 4;
+    static const arc::uint32 CHANGES = 50000;
+
+    sigma::core::tasks::ChangeFeed feed(1024);
+    sigma::core::tasks::ChangeFeed::Cursor cursor(feed);
+
+    std::vector<std::thread> producers;
+    for(std::size_t i = 0; i < PRODUCERS; ++i)
+    {
+        producers.emplace_back([&feed, i]()
+        {
+            arc::uint32 producer = static_cast<arc::uint32>(i);
+            for(arc::uint32 j = 0; j < CHANGES; ++j)
+            {
+                // the Task id can be checked against the board id to detect
+                // torn records
+                feed.append(
+                    sigma::core::tasks::ChangeRecord::MOVED,
+                    producer,
+                    producer * CHANGES + j
+                );
+            }
+        });
+    }
+
+    // read while the producers are running, resyncing when overrun
+    std::size_t torn = 0;
+    std::size_t out_of_order = 0;
+    arc::uint64 last = 0;
+    sigma::core::tasks::ChangeRecord record;
+    while(feed.get_head() <= PRODUCERS * CHANGES)
+    {
+        sigma::core::tasks::ChangeFeed::ReadResult result =
+            cursor.read(record);
+        if(result == sigma::core::tasks::ChangeFeed::READ_OVERRUN)
+        {
+            cursor.resync();
+        }
+        else if(result == sigma::core::tasks::ChangeFeed::READ_CHANGE)
+        {
+            if(record.task_id / CHANGES != record.board_id)
+            {
+                ++torn;
+            }
+            if(record.sequence <= last)
+            {
+                ++out_of_order;
+            }
+            last = record.sequence;
+        }
+    }
+    ARC_FOR_EACH(it, producers)
+    {
+        it->join();
+    }
+    ARC_CHECK_EQUAL(torn, 0);
+    ARC_CHECK_EQUAL(out_of_order, 0);
+    ARC_CHECK_EQUAL(feed.get_head(), PRODUCERS * CHANGES + 1);
+}
+
+} // namespace anonymous
@@ -0,0 +1,325 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.DependencyGraph)
+
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_map>
+
+#include "sigma/core/tasks/DependencyGraph.hpp"
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class DependencyGraphFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::RootTask* board;
+    std::vector<sigma::core::tasks::Task*> tasks;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    void setup()
+    {
+        sigma::core::tasks::domain::init();
+
+        board = sigma::core::tasks::domain::new_board("root");
+        for(std::size_t i = 0; i < 6; ++i)
+        {
+            tasks.push_back(new sigma::core::tasks::Task(board, "task"));
+        }
+    }
+
+    virtual void teardown()
+    {
+        sigma::core::tasks::domain::clean_up();
+    }
+
+    sigma::core::tasks::DependencyGraph& graph()
+    {
+        return sigma::core::tasks::domain::get_dependencies();
+    }
+
+    // returns whether every dependency is satisfied by the topological order
+    bool order_is_valid()
+    {
+        std::vector<arc::uint32> order;
+        graph().get_topological_order(order);
+        std::unordered_map<arc::uint32, std::size_t> positions;
+        for(std::size_t i = 0; i < order.size(); ++i)
+        {
+            positions[order[i]] = i;
+        }
+        if(positions.size() != graph().get_task_count())
+        {
+            return false;
+        }
+
+        ARC_CONST_FOR_EACH(id, order)
+        {
+            std::vector<arc::uint32> blocked;
+            graph().get_blocked(board->find_task(*id), blocked);
+            ARC_CONST_FOR_EACH(it, blocked)
+            {
+                if(positions[*it] <= positions[*id])
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // computes the finish time of the given task from scratch
+    arc::uint64 expected_finish(
+            sigma::core::tasks::Task* task,
+            std::unordered_map<arc::uint32, arc::uint64>& finishes)
+    {
+        if(finishes.find(task->get_id()) != finishes.end())
+        {
+            return finishes[task->get_id()];
+        }
+
+        std::vector<arc::uint32> blockers;
+        graph().get_blockers(task, blockers);
+        arc::uint64 start = 0;
+        ARC_CONST_FOR_EACH(it, blockers)
+        {
+            start = std::max(
+                    start,
+                    expected_finish(board->find_task(*it), finishes)
+            );
+        }
+        finishes[task->get_id()] = start + task->get_estimate();
+        return finishes[task->get_id()];
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                  DEPENDENCIES
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(dependencies, DependencyGraphFixture)
+{
+    sigma::core::tasks::DependencyGraph& graph = fixture->graph();
+    std::vector<sigma::core::tasks::Task*>& tasks = fixture->tasks;
+
+    ARC_TEST_MESSAGE("Checking adding dependencies");
+    ARC_CHECK_TRUE(graph.add_dependency(tasks[0], tasks[1]));
+    ARC_CHECK_TRUE(graph.add_dependency(tasks[1], tasks[2]));
+    ARC_CHECK_FALSE(graph.add_dependency(tasks[0], tasks[1]));
+    ARC_CHECK_TRUE(graph.has_dependency(tasks[0], tasks[1]));
+    ARC_CHECK_FALSE(graph.has_dependency(tasks[1], tasks[0]));
+    ARC_CHECK_EQUAL(graph.get_task_count(), 3);
+    std::vector<arc::uint32> blockers;
+    graph.get_blockers(tasks[2], blockers);
+    ARC_CHECK_EQUAL(blockers.size(), 1);
+    ARC_CHECK_EQUAL(blockers[0], tasks[1]->get_id());
+
+    ARC_TEST_MESSAGE("Checking invalid dependencies");
+    ARC_CHECK_THROW(
+        graph.add_dependency(tasks[0], tasks[0]),
+        arc::ex::ValueError
+    );
+    ARC_CHECK_THROW(
+        graph.add_dependency(nullptr, tasks[0]),
+        arc::ex::ValueError
+    );
+    ARC_CHECK_THROW(
+        graph.add_dependency(tasks[2], tasks[0]),
+        arc::ex::IllegalActionError
+    );
+    ARC_CHECK_FALSE(graph.has_dependency(tasks[2], tasks[0]));
+    ARC_CHECK_TRUE(fixture->order_is_valid());
+
+    ARC_TEST_MESSAGE("Checking a rejected dependency doesn't add Tasks");
+    graph.add_dependency(tasks[3], tasks[4]);
+    ARC_CHECK_THROW(
+        graph.add_dependency(tasks[4], tasks[3]),
+        arc::ex::IllegalActionError
+    );
+    ARC_CHECK_EQUAL(graph.get_task_count(), 5);
+
+    ARC_TEST_MESSAGE("Checking dependencies across boards");
+    sigma::core::tasks::RootTask* board_2 =
+        sigma::core::tasks::domain::new_board("board_2");
+    sigma::core::tasks::Task* other =
+        new sigma::core::tasks::Task(board_2, "other");
+    ARC_CHECK_TRUE(graph.add_dependency(other, tasks[0]));
+
+    ARC_TEST_MESSAGE("Checking removing dependencies");
+    ARC_CHECK_TRUE(graph.remove_dependency(tasks[3], tasks[4]));
+    ARC_CHECK_FALSE(graph.remove_dependency(tasks[3], tasks[4]));
+    ARC_CHECK_EQUAL(graph.get_task_count(), 4);
+
+    ARC_TEST_MESSAGE("Checking destroyed Tasks are removed");
+    sigma::core::tasks::domain::delete_board(board_2);
+    ARC_CHECK_EQUAL(graph.get_task_count(), 3);
+    fixture->board->remove_child(tasks[1]);
+    ARC_CHECK_EQUAL(graph.get_task_count(), 0);
+    ARC_CHECK_FALSE(graph.has_dependency(tasks[0], tasks[2]));
+}
+
+//------------------------------------------------------------------------------
+//                                     ORDER
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(order, DependencyGraphFixture)
+{
+    sigma::core::tasks::DependencyGraph& graph = fixture->graph();
+    std::vector<sigma::core::tasks::Task*>& tasks = fixture->tasks;
+
+    ARC_TEST_MESSAGE("Checking dependencies against the current order");
+    graph.add_dependency(tasks[3], tasks[4]);
+    graph.add_dependency(tasks[0], tasks[1]);
+    graph.add_dependency(tasks[4], tasks[0]);
+    graph.add_dependency(tasks[2], tasks[3]);
+    ARC_CHECK_TRUE(fixture->order_is_valid());
+    std::vector<arc::uint32> order;
+    graph.get_topological_order(order);
+    ARC_CHECK_EQUAL(order.size(), 5);
+    ARC_CHECK_EQUAL(order[0], tasks[2]->get_id());
+    ARC_CHECK_EQUAL(order[4], tasks[1]->get_id());
+
+    ARC_TEST_MESSAGE("Checking random dependencies");
+    std::srand(7);
+    for(std::size_t i = 0; i < 100; ++i)
+    {
+        tasks.push_back(new sigma::core::tasks::Task(fixture->board, "task"));
+    }
+    std::size_t cycles = 0;
+    for(std::size_t i = 0; i < 1000; ++i)
+    {
+        sigma::core::tasks::Task* a = tasks[std::rand() % tasks.size()];
+        sigma::core::tasks::Task* b = tasks[std::rand() % tasks.size()];
+        if(a == b)
+        {
+            continue;
+        }
+        if(i % 5 == 4)
+        {
+            graph.remove_dependency(a, b);
+            continue;
+        }
+        try
+        {
+            graph.add_dependency(a, b);
+        }
+        catch(const arc::ex::IllegalActionError&)
+        {
+            ++cycles;
+        }
+    }
+    ARC_CHECK_TRUE(cycles > 0);
+    ARC_CHECK_TRUE(fixture->order_is_valid());
+}
+
+//------------------------------------------------------------------------------
+//                                 CRITICAL PATH
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(critical_path, DependencyGraphFixture)
+{
+    sigma::core::tasks::DependencyGraph& graph = fixture->graph();
+    std::vector<sigma::core::tasks::Task*>& tasks = fixture->tasks;
+
+    // 0 -> 1 -> 3 and 0 -> 2 -> 3
+    tasks[0]->set_estimate(10);
+    tasks[1]->set_estimate(20);
+    tasks[2]->set_estimate(5);
+    tasks[3]->set_estimate(1);
+    graph.add_dependency(tasks[0], tasks[1]);
+    graph.add_dependency(tasks[0], tasks[2]);
+    graph.add_dependency(tasks[1], tasks[3]);
+    graph.add_dependency(tasks[2], tasks[3]);
+
+    ARC_TEST_MESSAGE("Checking finish times");
+    ARC_CHECK_EQUAL(graph.get_finish_time(tasks[2]), 15);
+    ARC_CHECK_EQUAL(graph.get_finish_time(tasks[3]), 31);
+    ARC_CHECK_EQUAL(graph.get_finish_time(tasks[5]), 0);
+    ARC_CHECK_EQUAL(graph.get_critical_path_length(), 31);
+    std::vector<arc::uint32> path;
+    graph.get_critical_path(path);
+    ARC_CHECK_EQUAL(path.size(), 3);
+    ARC_CHECK_EQUAL(path[0], tasks[0]->get_id());
+    ARC_CHECK_EQUAL(path[1], tasks[1]->get_id());
+    ARC_CHECK_EQUAL(path[2], tasks[3]->get_id());
+
+    ARC_TEST_MESSAGE("Checking estimate changes");
+    tasks[2]->set_estimate(40);
+    ARC_CHECK_EQUAL(graph.get_critical_path_length(), 51);
+    path.clear();
+    graph.get_critical_path(path);
+    ARC_CHECK_EQUAL(path[1], tasks[2]->get_id());
+    ARC_CHECK_TRUE(fixture->board->get_history().undo());
+    ARC_CHECK_EQUAL(graph.get_critical_path_length(), 31);
+
+    ARC_TEST_MESSAGE("Checking dependency changes");
+    graph.remove_dependency(tasks[1], tasks[3]);
+    ARC_CHECK_EQUAL(graph.get_finish_time(tasks[3]), 16);
+    ARC_CHECK_EQUAL(graph.get_critical_path_length(), 30);
+    tasks[4]->set_estimate(100);
+    graph.add_dependency(tasks[4], tasks[0]);
+    ARC_CHECK_EQUAL(graph.get_critical_path_length(), 130);
+
+    ARC_TEST_MESSAGE("Checking random changes");
+    std::srand(11);
+    for(std::size_t i = 0; i < 50; ++i)
+    {
+        tasks.push_back(new sigma::core::tasks::Task(fixture->board, "task"));
+    }
+    for(std::size_t i = 0; i < 500; ++i)
+    {
+        sigma::core::tasks::Task* a = tasks[std::rand() % tasks.size()];
+        sigma::core::tasks::Task* b = tasks[std::rand() % tasks.size()];
+        switch(i % 4)
+        {
+            case 0:
+                a->set_estimate(std::rand() % 100);
+                break;
+            case 1:
+                graph.remove_dependency(a, b);
+                break;
+            default:
+                if(a != b && !graph.has_dependency(b, a))
+                {
+                    try
+                    {
+                        graph.add_dependency(a, b);
+                    }
+                    catch(const arc::ex::IllegalActionError&)
+                    {
+                    }
+                }
+                break;
+        }
+    }
+    std::unordered_map<arc::uint32, arc::uint64> finishes;
+    arc::uint64 longest = 0;
+    bool finishes_match = true;
+    ARC_CONST_FOR_EACH(it, tasks)
+    {
+        arc::uint64 expected = fixture->expected_finish(*it, finishes);
+        finishes_match &= graph.get_finish_time(*it) == expected;
+        std::vector<arc::uint32> edges;
+        graph.get_blockers(*it, edges);
+        graph.get_blocked(*it, edges);
+        if(!edges.empty())
+        {
+            longest = std::max(longest, expected);
+        }
+    }
+    ARC_CHECK_TRUE(finishes_match);
+    ARC_CHECK_EQUAL(graph.get_critical_path_length(), longest);
+}
+
+} // namespace anonymous
@@ -0,0 +1,246 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.ReminderWheel)
+
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "sigma/core/tasks/ReminderWheel.hpp"
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class ReminderWheelFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::RootTask* board;
+    std::vector<sigma::core::tasks::Task*> tasks;
+    // the tasks and times fired by the wheel
+    std::vector<std::pair<sigma::core::tasks::Task*, arc::int64>> fired;
+    sigma::core::ScopedCallback due_callback;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    void setup()
+    {
+        sigma::core::tasks::domain::init();
+
+        board = sigma::core::tasks::domain::new_board("root");
+        for(std::size_t i = 0; i < 6; ++i)
+        {
+            tasks.push_back(new sigma::core::tasks::Task(board, "task"));
+        }
+        due_callback = wheel().on_due()->register_member_function<
+                ReminderWheelFixture,
+                &ReminderWheelFixture::on_due
+        >(this);
+    }
+
+    virtual void teardown()
+    {
+        due_callback.unregister();
+        sigma::core::tasks::domain::clean_up();
+    }
+
+    sigma::core::tasks::ReminderWheel& wheel()
+    {
+        return sigma::core::tasks::domain::get_reminders();
+    }
+
+    void on_due(sigma::core::tasks::Task* task, arc::int64 due)
+    {
+        fired.push_back(std::make_pair(task, due));
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                    SCHEDULE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(schedule, ReminderWheelFixture)
+{
+    sigma::core::tasks::ReminderWheel& wheel = fixture->wheel();
+    std::vector<sigma::core::tasks::Task*>& tasks = fixture->tasks;
+    wheel.advance(1000);
+
+    ARC_TEST_MESSAGE("Checking scheduling Tasks");
+    wheel.schedule(tasks[0], 1010);
+    wheel.schedule(tasks[1], 1005);
+    wheel.schedule(tasks[2], 1000 + 70000);
+    ARC_CHECK_EQUAL(wheel.get_scheduled_count(), 3);
+    ARC_CHECK_TRUE(wheel.is_scheduled(tasks[0]->get_id()));
+    ARC_CHECK_EQUAL(wheel.get_due(tasks[1]->get_id()), 1005);
+    ARC_CHECK_THROW(wheel.schedule(nullptr, 0), arc::ex::ValueError);
+    ARC_CHECK_THROW(wheel.get_due(tasks[3]->get_id()), arc::ex::KeyError);
+
+    ARC_TEST_MESSAGE("Checking advancing fires due Tasks in order");
+    ARC_CHECK_EQUAL(wheel.advance(1004), 0);
+    ARC_CHECK_EQUAL(wheel.advance(1010), 2);
+    ARC_CHECK_EQUAL(fixture->fired.size(), 2);
+    ARC_CHECK_EQUAL(fixture->fired[0].first, tasks[1]);
+    ARC_CHECK_EQUAL(fixture->fired[1].first, tasks[0]);
+    ARC_CHECK_EQUAL(fixture->fired[1].second, 1010);
+    ARC_CHECK_FALSE(wheel.is_scheduled(tasks[0]->get_id()));
+    ARC_CHECK_EQUAL(wheel.get_time(), 1010);
+
+    ARC_TEST_MESSAGE("Checking going back in time does nothing");
+    ARC_CHECK_EQUAL(wheel.advance(0), 0);
+    ARC_CHECK_EQUAL(wheel.get_time(), 1010);
+
+    ARC_TEST_MESSAGE("Checking rescheduling and cancelling");
+    wheel.schedule(tasks[2], 1020);
+    wheel.schedule(tasks[3], 1015);
+    ARC_CHECK_EQUAL(wheel.get_scheduled_count(), 2);
+    ARC_CHECK_TRUE(wheel.cancel(tasks[3]->get_id()));
+    ARC_CHECK_FALSE(wheel.cancel(tasks[3]->get_id()));
+    ARC_CHECK_EQUAL(wheel.advance(2000), 1);
+    ARC_CHECK_EQUAL(fixture->fired[2].first, tasks[2]);
+    ARC_CHECK_EQUAL(fixture->fired[2].second, 1020);
+
+    ARC_TEST_MESSAGE("Checking Tasks scheduled in the past");
+    wheel.schedule(tasks[4], 1500);
+    wheel.schedule(tasks[5], 2000);
+    ARC_CHECK_EQUAL(wheel.advance(2000), 2);
+    ARC_CHECK_EQUAL(fixture->fired[3].first, tasks[4]);
+    ARC_CHECK_EQUAL(fixture->fired[4].first, tasks[5]);
+    ARC_CHECK_EQUAL(wheel.get_scheduled_count(), 0);
+}
+
+//------------------------------------------------------------------------------
+//                                   RANDOMISED
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(randomised, ReminderWheelFixture)
+{
+    std::vector<sigma::core::tasks::Task*>& tasks = fixture->tasks;
+    for(std::size_t i = 0; i < 2000; ++i)
+    {
+        tasks.push_back(new sigma::core::tasks::Task(fixture->board, "task"));
+    }
+
+    // dates either side of the epoch, and beyond the range of the levels
+    const arc::int64 start = -(1LL << 34);
+    sigma::core::tasks::ReminderWheel wheel(start);
+    sigma::core::ScopedCallback due_callback =
+        wheel.on_due()->register_member_function<
+                ReminderWheelFixture,
+                &ReminderWheelFixture::on_due
+        >(fixture);
+    std::srand(13);
+    std::unordered_map<arc::uint32, arc::int64> expected;
+    ARC_CONST_FOR_EACH(it, tasks)
+    {
+        arc::int64 offset = std::rand() % 1000;
+        switch(std::rand() % 4)
+        {
+            case 0:
+                break;
+            case 1:
+                offset *= std::rand() % 100000;
+                break;
+            case 2:
+                offset *= static_cast<arc::int64>(std::rand() % 100000) << 16;
+                break;
+            default:
+                offset *= static_cast<arc::int64>(std::rand() % 100000) << 24;
+                break;
+        }
+        wheel.schedule(*it, start + offset + 1);
+        expected[(*it)->get_id()] = start + offset + 1;
+    }
+    ARC_TEST_MESSAGE("Checking cancelled Tasks don't fire");
+    for(std::size_t i = 0; i < tasks.size(); i += 7)
+    {
+        wheel.cancel(tasks[i]->get_id());
+        expected.erase(tasks[i]->get_id());
+    }
+    ARC_CHECK_EQUAL(wheel.get_scheduled_count(), expected.size());
+
+    ARC_TEST_MESSAGE("Checking Tasks fire once, in order, when due");
+    arc::int64 time = start;
+    bool fired_when_due = true;
+    std::size_t advances = 0;
+    while(wheel.get_scheduled_count() > 0 && advances < 10000)
+    {
+        arc::int64 previous = time;
+        time += 1 + (static_cast<arc::int64>(std::rand() % 1000) <<
+                (std::rand() % 36));
+        std::size_t before = fixture->fired.size();
+        wheel.advance(time);
+        for(std::size_t i = before; i < fixture->fired.size(); ++i)
+        {
+            arc::int64 due = fixture->fired[i].second;
+            fired_when_due &= due > previous && due <= time;
+            fired_when_due &= i == 0 || fixture->fired[i - 1].second <= due;
+        }
+        ++advances;
+    }
+    ARC_CHECK_TRUE(fired_when_due);
+    ARC_CHECK_EQUAL(fixture->fired.size(), expected.size());
+    bool fired_at_due = true;
+    std::set<sigma::core::tasks::Task*> unique;
+    ARC_CONST_FOR_EACH(it, fixture->fired)
+    {
+        fired_at_due &= expected[it->first->get_id()] == it->second;
+        unique.insert(it->first);
+    }
+    ARC_CHECK_TRUE(fired_at_due);
+    ARC_CHECK_EQUAL(unique.size(), expected.size());
+}
+
+//------------------------------------------------------------------------------
+//                                   DUE DATES
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(due_dates, ReminderWheelFixture)
+{
+    sigma::core::tasks::ReminderWheel& wheel = fixture->wheel();
+    std::vector<sigma::core::tasks::Task*>& tasks = fixture->tasks;
+    wheel.advance(100);
+
+    ARC_TEST_MESSAGE("Checking Tasks with due dates are scheduled");
+    tasks[0]->set_due_date(200);
+    tasks[1]->set_due_date(300);
+    tasks[2]->set_due_date(400);
+    tasks[3]->set_due_date(500);
+    ARC_CHECK_EQUAL(wheel.get_scheduled_count(), 4);
+    tasks[0]->set_due_date(250);
+    ARC_CHECK_EQUAL(wheel.get_due(tasks[0]->get_id()), 250);
+
+    ARC_TEST_MESSAGE("Checking undo reschedules");
+    ARC_CHECK_TRUE(fixture->board->get_history().undo());
+    ARC_CHECK_EQUAL(wheel.get_due(tasks[0]->get_id()), 200);
+
+    ARC_TEST_MESSAGE("Checking other attributes don't reschedule");
+    tasks[0]->set_priority(sigma::core::tasks::PRIORITY_HIGH);
+    ARC_CHECK_EQUAL(wheel.advance(200), 1);
+    tasks[0]->set_priority(sigma::core::tasks::PRIORITY_LOW);
+    ARC_CHECK_FALSE(wheel.is_scheduled(tasks[0]->get_id()));
+
+    ARC_TEST_MESSAGE("Checking cleared, done and deleted Tasks are cancelled");
+    tasks[1]->clear_due_date();
+    tasks[2]->set_status(sigma::core::tasks::STATUS_DONE);
+    fixture->board->remove_child(tasks[3]);
+    ARC_CHECK_EQUAL(wheel.get_scheduled_count(), 0);
+    ARC_CHECK_EQUAL(wheel.advance(1000), 0);
+
+    ARC_TEST_MESSAGE("Checking reopened Tasks are scheduled");
+    tasks[2]->set_status(sigma::core::tasks::STATUS_OPEN);
+    ARC_CHECK_TRUE(wheel.is_scheduled(tasks[2]->get_id()));
+    ARC_CHECK_EQUAL(wheel.advance(1000), 1);
+    ARC_CHECK_EQUAL(fixture->fired.back().first, tasks[2]);
+}
+
+} // namespace anonymous
@@ -0,0 +1,187 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.TagIndex)
+
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TagIndex.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class TagIndexFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::RootTask* board;
+    std::vector<sigma::core::tasks::Task*> tasks;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    void setup()
+    {
+        sigma::core::tasks::domain::init();
+
+        board = sigma::core::tasks::domain::new_board("root");
+        for(std::size_t i = 0; i < 6; ++i)
+        {
+            tasks.push_back(new sigma::core::tasks::Task(board, "task"));
+        }
+    }
+
+    virtual void teardown()
+    {
+        sigma::core::tasks::domain::clean_up();
+    }
+
+    sigma::core::tasks::TagIndex& index()
+    {
+        return sigma::core::tasks::domain::get_tags();
+    }
+
+    std::vector<arc::str::UTF8String> tags(
+            const char* a,
+            const char* b = nullptr)
+    {
+        std::vector<arc::str::UTF8String> tags;
+        tags.push_back(a);
+        if(b != nullptr)
+        {
+            tags.push_back(b);
+        }
+        return tags;
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                    TAGGING
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(tagging, TagIndexFixture)
+{
+    sigma::core::tasks::TagIndex& index = fixture->index();
+    std::vector<sigma::core::tasks::Task*>& tasks = fixture->tasks;
+
+    ARC_TEST_MESSAGE("Checking adding tags");
+    ARC_CHECK_TRUE(index.add_tag(tasks[0], "backend"));
+    ARC_CHECK_FALSE(index.add_tag(tasks[0], "backend"));
+    ARC_CHECK_TRUE(index.add_tag(tasks[0], "p1"));
+    ARC_CHECK_TRUE(index.add_tag(tasks[1], "backend"));
+    ARC_CHECK_TRUE(index.has_tag(tasks[0], "p1"));
+    ARC_CHECK_FALSE(index.has_tag(tasks[1], "p1"));
+    ARC_CHECK_FALSE(index.has_tag(tasks[1], "missing"));
+    ARC_CHECK_EQUAL(index.get_tagged_count("backend"), 2);
+    ARC_CHECK_THROW(index.add_tag(nullptr, "p1"), arc::ex::ValueError);
+    ARC_CHECK_THROW(index.add_tag(tasks[0], ""), arc::ex::ValueError);
+
+    std::vector<arc::str::UTF8String> tags;
+    index.get_tags(tasks[0], tags);
+    ARC_CHECK_EQUAL(tags.size(), 2);
+    ARC_CHECK_EQUAL(tags[0], "backend");
+    ARC_CHECK_EQUAL(tags[1], "p1");
+
+    ARC_TEST_MESSAGE("Checking removing tags");
+    ARC_CHECK_TRUE(index.remove_tag(tasks[0], "backend"));
+    ARC_CHECK_FALSE(index.remove_tag(tasks[0], "backend"));
+    ARC_CHECK_FALSE(index.remove_tag(tasks[2], "p1"));
+    ARC_CHECK_FALSE(index.has_tag(tasks[0], "backend"));
+    index.add_tag(tasks[2], "frontend");
+    index.remove_tag(tasks[2], "frontend");
+    tags.clear();
+    index.get_all_tags(tags);
+    ARC_CHECK_EQUAL(tags.size(), 2);
+    ARC_CHECK_EQUAL(tags[0], "backend");
+    ARC_CHECK_EQUAL(tags[1], "p1");
+
+    ARC_TEST_MESSAGE("Checking destroyed Tasks are removed");
+    arc::uint32 deleted_id = tasks[1]->get_id();
+    fixture->board->remove_child(tasks[1]);
+    ARC_CHECK_EQUAL(index.get_tagged_count("backend"), 0);
+
+    ARC_TEST_MESSAGE("Checking undoing a deletion restores the tags");
+    ARC_CHECK_TRUE(fixture->board->get_history().undo());
+    ARC_CHECK_TRUE(index.has_tag(
+            fixture->board->find_task(deleted_id),
+            "backend"
+    ));
+    ARC_CHECK_TRUE(fixture->board->get_history().redo());
+    ARC_CHECK_EQUAL(index.get_tagged_count("backend"), 0);
+    sigma::core::tasks::RootTask* board_2 =
+        sigma::core::tasks::domain::new_board("board_2");
+    index.add_tag(new sigma::core::tasks::Task(board_2, "other"), "p1");
+    ARC_CHECK_EQUAL(index.get_tagged_count("p1"), 2);
+    sigma::core::tasks::domain::delete_board(board_2);
+    ARC_CHECK_EQUAL(index.get_tagged_count("p1"), 1);
+}
+
+//------------------------------------------------------------------------------
+//                                    QUERIES
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(queries, TagIndexFixture)
+{
+    sigma::core::tasks::TagIndex& index = fixture->index();
+    std::vector<sigma::core::tasks::Task*>& tasks = fixture->tasks;
+
+    // tag many Tasks so that bitsets are used
+    for(std::size_t i = 0; i < 10000; ++i)
+    {
+        tasks.push_back(new sigma::core::tasks::Task(fixture->board, "task"));
+    }
+    for(std::size_t i = 0; i < tasks.size(); ++i)
+    {
+        index.add_tag(tasks[i], "backend");
+        if(i % 2 == 0)
+        {
+            index.add_tag(tasks[i], "p1");
+        }
+        if(i % 3 == 0)
+        {
+            index.add_tag(tasks[i], "blocked");
+        }
+    }
+
+    ARC_TEST_MESSAGE("Checking and not queries");
+    sigma::core::tasks::TaskBitmap found = index.find(
+            fixture->tags("backend", "p1"),
+            fixture->tags("blocked")
+    );
+    ARC_CHECK_EQUAL(found.get_cardinality(), 3335);
+    ARC_CHECK_TRUE(found.contains(tasks[2]->get_id()));
+    ARC_CHECK_FALSE(found.contains(tasks[6]->get_id()));
+    ARC_CHECK_FALSE(found.contains(tasks[1]->get_id()));
+    std::vector<sigma::core::tasks::Task*> found_tasks;
+    index.get_tasks(found, found_tasks);
+    ARC_CHECK_EQUAL(found_tasks.size(), 3335);
+    ARC_CHECK_EQUAL(found_tasks[0], tasks[2]);
+
+    ARC_TEST_MESSAGE("Checking missing tags");
+    ARC_CHECK_TRUE(index.find(fixture->tags("backend", "missing")).is_empty());
+    ARC_CHECK_EQUAL(
+        index.find(fixture->tags("p1"), fixture->tags("missing"))
+            .get_cardinality(),
+        5003
+    );
+    ARC_CHECK_TRUE(
+        index.find(std::vector<arc::str::UTF8String>()).is_empty());
+
+    ARC_TEST_MESSAGE("Checking or queries");
+    ARC_CHECK_EQUAL(
+        index.find_any(fixture->tags("p1", "blocked")).get_cardinality(),
+        6671
+    );
+    ARC_CHECK_EQUAL(
+        index.get_tagged("p1").get_intersection_cardinality(
+                index.get_tagged("blocked")),
+        1668
+    );
+    ARC_CHECK_TRUE(index.get_memory_usage() < 100000);
+}
+
+} // namespace anonymous
@@ -0,0 +1,313 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.TaskAttributes)
+
+#include <algorithm>
+
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class TaskAttributesFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::RootTask* board;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    void setup()
+    {
+        sigma::core::tasks::domain::init();
+
+        board = sigma::core::tasks::domain::new_board("root");
+    }
+
+    virtual void teardown()
+    {
+        sigma::core::tasks::domain::clean_up();
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                   ACCESSORS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(accessors, TaskAttributesFixture)
+{
+    sigma::core::tasks::Task* task =
+        new sigma::core::tasks::Task(fixture->board, "task");
+
+    ARC_TEST_MESSAGE("Checking default attributes");
+    ARC_CHECK_EQUAL(task->get_status(), sigma::core::tasks::STATUS_OPEN);
+    ARC_CHECK_EQUAL(task->get_priority(), sigma::core::tasks::PRIORITY_NONE);
+    ARC_CHECK_EQUAL(task->get_estimate(), 0);
+    ARC_CHECK_EQUAL(task->get_assignee(), "");
+    ARC_CHECK_FALSE(task->has_due_date());
+    ARC_CHECK_THROW(task->get_due_date(), arc::ex::StateError);
+    ARC_CHECK_FALSE(task->has_flag(sigma::core::tasks::FLAG_STARRED));
+
+    ARC_TEST_MESSAGE("Checking setting attributes");
+    task->set_status(sigma::core::tasks::STATUS_BLOCKED);
+    task->set_priority(sigma::core::tasks::PRIORITY_HIGH);
+    task->set_estimate(90);
+    task->set_assignee("david");
+    task->set_due_date(-3600);
+    task->set_flag(sigma::core::tasks::FLAG_MILESTONE, true);
+    ARC_CHECK_EQUAL(task->get_status(), sigma::core::tasks::STATUS_BLOCKED);
+    ARC_CHECK_EQUAL(task->get_priority(), sigma::core::tasks::PRIORITY_HIGH);
+    ARC_CHECK_EQUAL(task->get_estimate(), 90);
+    ARC_CHECK_EQUAL(task->get_assignee(), "david");
+    ARC_CHECK_EQUAL(task->get_due_date(), -3600);
+    ARC_CHECK_TRUE(task->has_flag(sigma::core::tasks::FLAG_MILESTONE));
+    ARC_CHECK_FALSE(task->has_flag(sigma::core::tasks::FLAG_STARRED));
+
+    ARC_TEST_MESSAGE("Checking invalid values");
+    ARC_CHECK_THROW(
+        task->set_status(static_cast<sigma::core::tasks::TaskStatus>(7)),
+        arc::ex::ValueError
+    );
+    ARC_CHECK_EQUAL(task->get_status(), sigma::core::tasks::STATUS_BLOCKED);
+
+    ARC_TEST_MESSAGE("Checking attribute changes can be undone");
+    sigma::core::tasks::TaskHistory& history = fixture->board->get_history();
+    ARC_CHECK_TRUE(history.undo());
+    ARC_CHECK_FALSE(task->has_flag(sigma::core::tasks::FLAG_MILESTONE));
+    ARC_CHECK_TRUE(history.undo());
+    ARC_CHECK_FALSE(task->has_due_date());
+    ARC_CHECK_TRUE(history.redo());
+    ARC_CHECK_EQUAL(task->get_due_date(), -3600);
+
+    ARC_TEST_MESSAGE("Checking snapshots contain attributes");
+    ARC_CHECK_TRUE(
+        fixture->board->snapshot()->get_children()[0]->get_attributes() ==
+        task->get_attributes()
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                   LIFECYCLE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(lifecycle, TaskAttributesFixture)
+{
+    sigma::core::tasks::Task* parent =
+        new sigma::core::tasks::Task(fixture->board, "parent");
+    sigma::core::tasks::Task* child =
+        new sigma::core::tasks::Task(parent, "child");
+    sigma::core::tasks::Task* other =
+        new sigma::core::tasks::Task(fixture->board, "other");
+    parent->set_priority(sigma::core::tasks::PRIORITY_LOW);
+    child->set_assignee("sam");
+    child->set_estimate(30);
+    other->set_status(sigma::core::tasks::STATUS_DONE);
+    arc::uint32 child_id = child->get_id();
+
+    ARC_TEST_MESSAGE("Checking removal keeps other Tasks' attributes");
+    fixture->board->remove_child(parent);
+    ARC_CHECK_EQUAL(other->get_status(), sigma::core::tasks::STATUS_DONE);
+    ARC_CHECK_EQUAL(other->get_priority(), sigma::core::tasks::PRIORITY_NONE);
+
+    ARC_TEST_MESSAGE("Checking undoing a deletion restores attributes");
+    ARC_CHECK_TRUE(fixture->board->get_history().undo());
+    child = fixture->board->find_task(child_id);
+    ARC_CHECK_EQUAL(child->get_assignee(), "sam");
+    ARC_CHECK_EQUAL(child->get_estimate(), 30);
+    ARC_CHECK_EQUAL(
+        child->get_parent()->get_priority(),
+        sigma::core::tasks::PRIORITY_LOW
+    );
+
+    ARC_TEST_MESSAGE("Checking moving boards keeps attributes");
+    sigma::core::tasks::RootTask* board_2 =
+        sigma::core::tasks::domain::new_board("board_2");
+    child->set_parent(board_2);
+    ARC_CHECK_EQUAL(child->get_assignee(), "sam");
+    ARC_CHECK_EQUAL(child->get_estimate(), 30);
+    ARC_CHECK_EQUAL(
+        board_2->count_tasks(sigma::core::tasks::TaskFilter()),
+        1
+    );
+    ARC_CHECK_EQUAL(
+        fixture->board->count_tasks(sigma::core::tasks::TaskFilter()),
+        2
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                     FILTER
+//------------------------------------------------------------------------------
+
+class FilterFixture : public TaskAttributesFixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    std::vector<sigma::core::tasks::Task*> tasks;
+    sigma::core::tasks::Task* subtree;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    virtual void setup()
+    {
+        TaskAttributesFixture::setup();
+
+        // enough tasks to span multiple words of the bitsets
+        subtree = new sigma::core::tasks::Task(board, "subtree");
+        for(std::size_t i = 0; i < 300; ++i)
+        {
+            sigma::core::tasks::Task* parent = board;
+            if(i % 3 == 0)
+            {
+                parent = subtree;
+            }
+            sigma::core::tasks::Task* task =
+                new sigma::core::tasks::Task(parent, "task");
+            sigma::core::tasks::TaskAttributes attributes;
+            attributes.status =
+                static_cast<sigma::core::tasks::TaskStatus>(i % 4);
+            attributes.priority =
+                static_cast<sigma::core::tasks::TaskPriority>((i / 4) % 4);
+            attributes.estimate = static_cast<arc::uint32>(i);
+            attributes.assignee = (i % 5 == 0) ? "alex" : "";
+            attributes.has_due_date = (i % 2 == 0);
+            attributes.due_date = static_cast<arc::int64>(i) * 100;
+            attributes.flags =
+                (i % 7 == 0) ? sigma::core::tasks::FLAG_STARRED : 0;
+            task->set_attributes(attributes);
+            tasks.push_back(task);
+        }
+        // delete some tasks so the table has been compacted
+        for(std::size_t i = 0; i < tasks.size(); i += 11)
+        {
+            delete tasks[i];
+            tasks[i] = nullptr;
+        }
+        tasks.erase(
+            std::remove(
+                tasks.begin(),
+                tasks.end(),
+                static_cast<sigma::core::tasks::Task*>(nullptr)
+            ),
+            tasks.end()
+        );
+    }
+
+    // checks the board's result matches checking each task individually
+    template<typename Predicate>
+    bool matches(
+            const sigma::core::tasks::TaskFilter& filter,
+            Predicate predicate)
+    {
+        std::vector<sigma::core::tasks::Task*> expected;
+        ARC_FOR_EACH(it, tasks)
+        {
+            if(predicate(*it))
+            {
+                expected.push_back(*it);
+            }
+        }
+
+        std::vector<sigma::core::tasks::Task*> found;
+        board->find_tasks(filter, found);
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        return !expected.empty() &&
+               found == expected &&
+               board->count_tasks(filter) == expected.size();
+    }
+};
+
+bool is_open_priority_under(sigma::core::tasks::Task* task)
+{
+    return task->get_status() == sigma::core::tasks::STATUS_OPEN &&
+           task->get_priority() >= sigma::core::tasks::PRIORITY_MEDIUM &&
+           task->get_parent()->get_title() == "subtree";
+}
+
+bool is_active_low(sigma::core::tasks::Task* task)
+{
+    return (task->get_status() == sigma::core::tasks::STATUS_IN_PROGRESS ||
+            task->get_status() == sigma::core::tasks::STATUS_BLOCKED) &&
+           task->get_priority() >= sigma::core::tasks::PRIORITY_LOW &&
+           task->get_priority() <= sigma::core::tasks::PRIORITY_MEDIUM;
+}
+
+bool is_assigned_starred(sigma::core::tasks::Task* task)
+{
+    return task->get_assignee() == "alex" &&
+           task->has_flag(sigma::core::tasks::FLAG_STARRED);
+}
+
+bool is_due_estimated(sigma::core::tasks::Task* task)
+{
+    return task->has_due_date() &&
+           task->get_due_date() >= 5000 &&
+           task->get_due_date() <= 20000 &&
+           task->get_estimate() <= 150;
+}
+
+ARC_TEST_UNIT_FIXTURE(filter, FilterFixture)
+{
+    ARC_TEST_MESSAGE("Checking status, priority and subtree filter");
+    ARC_CHECK_TRUE(fixture->matches(
+        sigma::core::tasks::TaskFilter()
+            .with_status(sigma::core::tasks::STATUS_OPEN)
+            .with_min_priority(sigma::core::tasks::PRIORITY_MEDIUM)
+            .under(fixture->subtree),
+        is_open_priority_under
+    ));
+
+    ARC_TEST_MESSAGE("Checking multiple statuses and priority range");
+    ARC_CHECK_TRUE(fixture->matches(
+        sigma::core::tasks::TaskFilter()
+            .with_status(sigma::core::tasks::STATUS_IN_PROGRESS)
+            .with_status(sigma::core::tasks::STATUS_BLOCKED)
+            .with_min_priority(sigma::core::tasks::PRIORITY_LOW)
+            .with_max_priority(sigma::core::tasks::PRIORITY_MEDIUM),
+        is_active_low
+    ));
+
+    ARC_TEST_MESSAGE("Checking assignee and flags filter");
+    ARC_CHECK_TRUE(fixture->matches(
+        sigma::core::tasks::TaskFilter()
+            .with_assignee("alex")
+            .with_flags(sigma::core::tasks::FLAG_STARRED),
+        is_assigned_starred
+    ));
+
+    ARC_TEST_MESSAGE("Checking due date and estimate filter");
+    ARC_CHECK_TRUE(fixture->matches(
+        sigma::core::tasks::TaskFilter()
+            .with_due_between(5000, 20000)
+            .with_estimate_between(0, 150),
+        is_due_estimated
+    ));
+
+    ARC_TEST_MESSAGE("Checking unknown assignee matches nothing");
+    ARC_CHECK_EQUAL(
+        fixture->board->count_tasks(
+            sigma::core::tasks::TaskFilter().with_assignee("nobody")),
+        0
+    );
+
+    ARC_TEST_MESSAGE("Checking filtering by a subtree of another board");
+    sigma::core::tasks::RootTask* board_2 =
+        sigma::core::tasks::domain::new_board("board_2");
+    ARC_CHECK_THROW(
+        fixture->board->count_tasks(
+            sigma::core::tasks::TaskFilter().under(board_2)),
+        arc::ex::ValueError
+    );
+}
+
+} // namespace anonymous
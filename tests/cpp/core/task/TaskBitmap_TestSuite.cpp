@@ -0,0 +1,197 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.TaskBitmap)
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <set>
+
+#include "sigma/core/tasks/TaskBitmap.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class TaskBitmapFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    // fills the bitmap and the reference set with random ids, clustered so
+    // that chunks are stored both as arrays and as bitsets
+    void fill(
+            sigma::core::tasks::TaskBitmap& bitmap,
+            std::set<arc::uint32>& reference,
+            std::size_t count)
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            arc::uint32 id;
+            switch(std::rand() % 3)
+            {
+                case 0:
+                    // dense chunk
+                    id = std::rand() % 8192;
+                    break;
+                case 1:
+                    // sparse chunk
+                    id = (1 << 16) + (std::rand() % 60000);
+                    break;
+                default:
+                    // anywhere
+                    id = (static_cast<arc::uint32>(std::rand()) << 8) ^
+                         static_cast<arc::uint32>(std::rand());
+                    break;
+            }
+            bitmap.add(id);
+            reference.insert(id);
+        }
+    }
+
+    // returns whether the bitmap contains exactly the reference ids
+    bool matches(
+            const sigma::core::tasks::TaskBitmap& bitmap,
+            const std::set<arc::uint32>& reference)
+    {
+        std::vector<arc::uint32> ids;
+        bitmap.get_ids(ids);
+        return bitmap.get_cardinality() == reference.size() &&
+               ids.size() == reference.size() &&
+               std::equal(ids.begin(), ids.end(), reference.begin());
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                   MEMBERSHIP
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(membership, TaskBitmapFixture)
+{
+    sigma::core::tasks::TaskBitmap bitmap;
+
+    ARC_TEST_MESSAGE("Checking an empty bitmap");
+    ARC_CHECK_TRUE(bitmap.is_empty());
+    ARC_CHECK_EQUAL(bitmap.get_cardinality(), 0);
+    ARC_CHECK_FALSE(bitmap.contains(0));
+    ARC_CHECK_FALSE(bitmap.remove(0));
+
+    ARC_TEST_MESSAGE("Checking adding and removing ids");
+    ARC_CHECK_TRUE(bitmap.add(7));
+    ARC_CHECK_FALSE(bitmap.add(7));
+    ARC_CHECK_TRUE(bitmap.add(0xFFFFFFFF));
+    ARC_CHECK_TRUE(bitmap.add(70000));
+    ARC_CHECK_EQUAL(bitmap.get_cardinality(), 3);
+    ARC_CHECK_TRUE(bitmap.contains(70000));
+    ARC_CHECK_FALSE(bitmap.contains(70001));
+    ARC_CHECK_TRUE(bitmap.remove(70000));
+    ARC_CHECK_FALSE(bitmap.contains(70000));
+    std::vector<arc::uint32> ids;
+    bitmap.get_ids(ids);
+    ARC_CHECK_EQUAL(ids.size(), 2);
+    ARC_CHECK_EQUAL(ids[0], 7);
+    ARC_CHECK_EQUAL(ids[1], 0xFFFFFFFF);
+
+    ARC_TEST_MESSAGE("Checking chunks convert between forms");
+    for(arc::uint32 id = 0; id < 65536; id += 2)
+    {
+        bitmap.add(id);
+    }
+    ARC_CHECK_EQUAL(bitmap.get_cardinality(), 32770);
+    ARC_CHECK_TRUE(bitmap.contains(4000));
+    ARC_CHECK_FALSE(bitmap.contains(4001));
+    for(arc::uint32 id = 0; id < 65536; id += 2)
+    {
+        if(id != 7 && id % 16 != 0)
+        {
+            bitmap.remove(id);
+        }
+    }
+    ARC_CHECK_EQUAL(bitmap.get_cardinality(), 4098);
+    ARC_CHECK_TRUE(bitmap.contains(7));
+    ARC_CHECK_TRUE(bitmap.contains(65520));
+    ARC_CHECK_FALSE(bitmap.contains(65522));
+    ARC_CHECK_TRUE(bitmap.remove(16));
+    ARC_CHECK_TRUE(bitmap.contains(32));
+    ARC_CHECK_FALSE(bitmap.contains(16));
+    ARC_CHECK_EQUAL(bitmap.get_cardinality(), 4097);
+
+    ARC_TEST_MESSAGE("Checking memory scales with the number of ids");
+    sigma::core::tasks::TaskBitmap sparse;
+    for(arc::uint32 id = 0; id < 1000; ++id)
+    {
+        sparse.add(id * 4000000);
+    }
+    sigma::core::tasks::TaskBitmap dense;
+    for(arc::uint32 id = 0; id < 65536; ++id)
+    {
+        dense.add(id);
+    }
+    ARC_CHECK_TRUE(sparse.get_memory_usage() < 100000);
+    ARC_CHECK_TRUE(dense.get_memory_usage() < 10000);
+    bitmap.clear();
+    ARC_CHECK_TRUE(bitmap.is_empty());
+}
+
+//------------------------------------------------------------------------------
+//                                   OPERATIONS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(operations, TaskBitmapFixture)
+{
+    std::srand(17);
+    for(std::size_t round = 0; round < 10; ++round)
+    {
+        sigma::core::tasks::TaskBitmap a;
+        sigma::core::tasks::TaskBitmap b;
+        std::set<arc::uint32> a_ids;
+        std::set<arc::uint32> b_ids;
+        fixture->fill(a, a_ids, 2000 + round * 2000);
+        fixture->fill(b, b_ids, 20000 - round * 2000);
+
+        std::set<arc::uint32> expected;
+        std::set_intersection(
+            a_ids.begin(), a_ids.end(),
+            b_ids.begin(), b_ids.end(),
+            std::inserter(expected, expected.end())
+        );
+        sigma::core::tasks::TaskBitmap intersection(a);
+        intersection.intersect(b);
+        ARC_CHECK_TRUE(fixture->matches(intersection, expected));
+        ARC_CHECK_EQUAL(a.get_intersection_cardinality(b), expected.size());
+
+        expected.clear();
+        std::set_union(
+            a_ids.begin(), a_ids.end(),
+            b_ids.begin(), b_ids.end(),
+            std::inserter(expected, expected.end())
+        );
+        sigma::core::tasks::TaskBitmap united(a);
+        united.unite(b);
+        ARC_CHECK_TRUE(fixture->matches(united, expected));
+
+        expected.clear();
+        std::set_difference(
+            a_ids.begin(), a_ids.end(),
+            b_ids.begin(), b_ids.end(),
+            std::inserter(expected, expected.end())
+        );
+        sigma::core::tasks::TaskBitmap difference(a);
+        difference.subtract(b);
+        ARC_CHECK_TRUE(fixture->matches(difference, expected));
+
+        // results compare equal to bitmaps built one id at a time
+        sigma::core::tasks::TaskBitmap rebuilt;
+        ARC_CONST_FOR_EACH(it, expected)
+        {
+            rebuilt.add(*it);
+        }
+        ARC_CHECK_TRUE(rebuilt == difference);
+    }
+}
+
+} // namespace anonymous
@@ -0,0 +1,199 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.TaskDiff)
+
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TaskDiff.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class TaskDiffFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::RootTask* board;
+    sigma::core::tasks::Task* task_1;
+    sigma::core::tasks::Task* task_2;
+    sigma::core::tasks::Task* task_3;
+    sigma::core::tasks::Task* task_4;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    void setup()
+    {
+        sigma::core::tasks::domain::init();
+
+        board = sigma::core::tasks::domain::new_board("root");
+        task_1 = new sigma::core::tasks::Task(board, "task_1");
+        task_2 = new sigma::core::tasks::Task(board, "task_2");
+        task_3 = new sigma::core::tasks::Task(task_1, "task_3");
+        task_4 = new sigma::core::tasks::Task(task_3, "task_4");
+    }
+
+    virtual void teardown()
+    {
+        sigma::core::tasks::domain::clean_up();
+    }
+
+    // returns a string describing the changes since the given snapshot, e.g.
+    // "M2 A6" for task 2 modified and task 6 added
+    arc::str::UTF8String describe(
+            const sigma::core::tasks::TaskSnapshot::Ptr& before)
+    {
+        std::vector<sigma::core::tasks::TaskChange> changes;
+        sigma::core::tasks::TaskDiff::compute(before, board->snapshot(), changes);
+
+        arc::str::UTF8String description;
+        ARC_CONST_FOR_EACH(it, changes)
+        {
+            if(!description.is_empty())
+            {
+                description << " ";
+            }
+            switch(it->type)
+            {
+                case sigma::core::tasks::TaskChange::ADDED:
+                    description << "A";
+                    break;
+                case sigma::core::tasks::TaskChange::REMOVED:
+                    description << "R";
+                    break;
+                case sigma::core::tasks::TaskChange::MODIFIED:
+                    description << "M";
+                    break;
+                case sigma::core::tasks::TaskChange::MOVED:
+                    description << "V";
+                    break;
+            }
+            description << it->id;
+        }
+        return description;
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                      HASH
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(hash, TaskDiffFixture)
+{
+    arc::uint64 root_hash = fixture->board->get_hash();
+    arc::uint64 hash_1 = fixture->task_1->get_hash();
+    arc::uint64 hash_2 = fixture->task_2->get_hash();
+
+    ARC_TEST_MESSAGE("Checking hashes are stable");
+    ARC_CHECK_EQUAL(fixture->board->get_hash(), root_hash);
+    ARC_CHECK_EQUAL(fixture->board->snapshot()->get_hash(), root_hash);
+    ARC_CHECK_TRUE(hash_1 != hash_2);
+
+    ARC_TEST_MESSAGE("Checking changes update the ancestor path only");
+    fixture->task_4->set_title("renamed");
+    ARC_CHECK_TRUE(fixture->board->get_hash() != root_hash);
+    ARC_CHECK_TRUE(fixture->task_1->get_hash() != hash_1);
+    ARC_CHECK_EQUAL(fixture->task_2->get_hash(), hash_2);
+
+    ARC_TEST_MESSAGE("Checking reverting a change restores the hash");
+    fixture->task_4->set_title("task_4");
+    ARC_CHECK_EQUAL(fixture->board->get_hash(), root_hash);
+
+    ARC_TEST_MESSAGE("Checking attributes and order contribute to the hash");
+    fixture->task_4->set_priority(sigma::core::tasks::PRIORITY_HIGH);
+    ARC_CHECK_TRUE(fixture->task_1->get_hash() != hash_1);
+    fixture->task_4->set_priority(sigma::core::tasks::PRIORITY_NONE);
+    fixture->task_2->move_before(fixture->task_1);
+    ARC_CHECK_TRUE(fixture->board->get_hash() != root_hash);
+    ARC_CHECK_EQUAL(fixture->task_1->get_hash(), hash_1);
+}
+
+//------------------------------------------------------------------------------
+//                                      DIFF
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(diff, TaskDiffFixture)
+{
+    // ids: board 1, task_1 2, task_2 3, task_3 4, task_4 5
+    sigma::core::tasks::TaskSnapshot::Ptr before =
+        fixture->board->snapshot();
+
+    ARC_TEST_MESSAGE("Checking identical versions have no changes");
+    ARC_CHECK_EQUAL(fixture->describe(before), "");
+
+    ARC_TEST_MESSAGE("Checking modifications");
+    fixture->task_4->set_title("renamed");
+    fixture->task_2->set_status(sigma::core::tasks::STATUS_DONE);
+    ARC_CHECK_EQUAL(fixture->describe(before), "M5 M3");
+
+    ARC_TEST_MESSAGE("Checking additions and removals");
+    before = fixture->board->snapshot();
+    sigma::core::tasks::Task* task_5 =
+        new sigma::core::tasks::Task(fixture->task_2, "task_5");
+    new sigma::core::tasks::Task(task_5, "task_6");
+    fixture->task_1->remove_child(fixture->task_3);
+    ARC_CHECK_EQUAL(fixture->describe(before), "A6 A7 R4 R5");
+
+    ARC_TEST_MESSAGE("Checking moves and reorders");
+    before = fixture->board->snapshot();
+    task_5->set_parent(fixture->task_1);
+    fixture->task_2->move_before(fixture->task_1);
+    ARC_CHECK_EQUAL(fixture->describe(before), "V3 V6");
+
+    ARC_TEST_MESSAGE("Checking moves into added Tasks");
+    before = fixture->board->snapshot();
+    sigma::core::tasks::Task* task_8 =
+        new sigma::core::tasks::Task(fixture->board, "task_8");
+    sigma::core::tasks::Task* task_9 =
+        new sigma::core::tasks::Task(task_8, "task_9");
+    task_5->set_parent(task_9);
+    ARC_CHECK_EQUAL(fixture->describe(before), "V6 A8 A9");
+
+    ARC_TEST_MESSAGE("Checking moves out of removed Tasks");
+    before = fixture->board->snapshot();
+    task_5->set_parent(fixture->board);
+    task_5->set_title("retitled");
+    fixture->board->remove_child(task_8);
+    ARC_CHECK_EQUAL(fixture->describe(before), "V6 M6 R8 R9");
+}
+
+//------------------------------------------------------------------------------
+//                                     SCALE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(scale, TaskDiffFixture)
+{
+    // a wide and deep board where only a few tasks change
+    std::vector<sigma::core::tasks::Task*> tasks;
+    for(std::size_t i = 0; i < 100; ++i)
+    {
+        sigma::core::tasks::Task* branch =
+            new sigma::core::tasks::Task(fixture->board, "branch");
+        for(std::size_t j = 0; j < 100; ++j)
+        {
+            tasks.push_back(new sigma::core::tasks::Task(branch, "leaf"));
+        }
+    }
+    sigma::core::tasks::TaskSnapshot::Ptr before = fixture->board->snapshot();
+
+    tasks[1234]->set_title("changed");
+    tasks[9876]->set_estimate(60);
+
+    std::vector<sigma::core::tasks::TaskChange> changes;
+    sigma::core::tasks::TaskDiff::compute(
+            before,
+            fixture->board->snapshot(),
+            changes
+    );
+    ARC_CHECK_EQUAL(changes.size(), 2);
+    ARC_CHECK_EQUAL(changes[0].id, tasks[1234]->get_id());
+    ARC_CHECK_EQUAL(changes[0].after->get_title(), "changed");
+    ARC_CHECK_EQUAL(changes[1].id, tasks[9876]->get_id());
+}
+
+} // namespace anonymous
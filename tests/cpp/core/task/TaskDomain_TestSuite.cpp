@@ -2,6 +2,11 @@
 
 ARC_TEST_MODULE(core.tasks.TaskDomain)
 
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <thread>
+
 #include "sigma/core/tasks/RootTask.hpp"
 #include "sigma/core/tasks/TasksDomain.hpp"
 
@@ -33,13 +38,12 @@ public:
     }
 
     bool has_board(
-            const std::set<std::unique_ptr<
-                sigma::core::tasks::RootTask>>& boards,
+            const std::vector<sigma::core::tasks::RootTask*>& boards,
             sigma::core::tasks::RootTask* board)
     {
         ARC_FOR_EACH(it, boards)
         {
-            if (it->get() == board)
+            if (*it == board)
             {
                 return true;
             }
@@ -48,8 +52,7 @@ public:
     }
 
     bool has_board_with_title(
-            const std::set<std::unique_ptr<
-                sigma::core::tasks::RootTask>>& boards,
+            const std::vector<sigma::core::tasks::RootTask*>& boards,
             const arc::str::UTF8String& title)
     {
         ARC_FOR_EACH(it, boards)
@@ -69,8 +72,8 @@ public:
 
 ARC_TEST_UNIT_FIXTURE(boards, TaskDomainBaseFixture)
 {
-    // get a reference to the boards
-    const std::set<std::unique_ptr<sigma::core::tasks::RootTask>>& boards(
+    // get a copy of the boards
+    std::vector<sigma::core::tasks::RootTask*> boards(
         sigma::core::tasks::domain::get_boards());
 
     ARC_TEST_MESSAGE("Checking number of boards is 0");
@@ -84,6 +87,7 @@ ARC_TEST_UNIT_FIXTURE(boards, TaskDomainBaseFixture)
     ARC_CHECK_TRUE(board_1->is_root());
 
     ARC_TEST_MESSAGE("Checking number of boards is 1");
+    boards = sigma::core::tasks::domain::get_boards();
     ARC_CHECK_EQUAL(boards.size(), 1);
     ARC_CHECK_TRUE((fixture->has_board(boards, board_1)));
 
@@ -107,6 +111,7 @@ ARC_TEST_UNIT_FIXTURE(boards, TaskDomainBaseFixture)
     );
 
     ARC_TEST_MESSAGE("Checking number of boards is 2");
+    boards = sigma::core::tasks::domain::get_boards();
     ARC_CHECK_EQUAL(boards.size(), 2);
     ARC_CHECK_TRUE((fixture->has_board(boards, board_2)));
 
@@ -149,16 +154,848 @@ ARC_TEST_UNIT_FIXTURE(boards, TaskDomainBaseFixture)
 
     ARC_TEST_MESSAGE("Checking deleting boards");
     ARC_CHECK_TRUE(sigma::core::tasks::domain::delete_board(board_1));
+    boards = sigma::core::tasks::domain::get_boards();
     ARC_CHECK_EQUAL(boards.size(), 4);
     ARC_CHECK_FALSE(fixture->has_board_with_title(boards, "Second"));
     ARC_CHECK_TRUE(sigma::core::tasks::domain::delete_board(board_5));
+    boards = sigma::core::tasks::domain::get_boards();
     ARC_CHECK_EQUAL(boards.size(), 3);
     ARC_CHECK_FALSE(fixture->has_board_with_title(boards, "First (1)"));
     ARC_CHECK_TRUE(sigma::core::tasks::domain::delete_board(board_3));
+    boards = sigma::core::tasks::domain::get_boards();
     ARC_CHECK_EQUAL(boards.size(), 2);
     ARC_CHECK_FALSE(fixture->has_board_with_title(boards, "Second (1)"));
     ARC_CHECK_FALSE(sigma::core::tasks::domain::delete_board(board_1));
+    boards = sigma::core::tasks::domain::get_boards();
     ARC_CHECK_EQUAL(boards.size(), 2);
 }
 
+//------------------------------------------------------------------------------
+//                                 BOARD REGISTRY
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(board_registry, TaskDomainBaseFixture)
+{
+    std::vector<sigma::core::tasks::RootTask*> created;
+    std::vector<sigma::core::tasks::BoardHandle> handles;
+    for(std::size_t i = 0; i < 100; ++i)
+    {
+        arc::str::UTF8String title("board_");
+        title << i;
+        created.push_back(sigma::core::tasks::domain::new_board(title));
+        handles.push_back(
+            sigma::core::tasks::domain::get_board_handle(created.back()));
+    }
+
+    ARC_TEST_MESSAGE("Checking boards are iterated in creation order");
+    std::vector<sigma::core::tasks::RootTask*> boards(
+        sigma::core::tasks::domain::get_boards());
+    ARC_CHECK_EQUAL(boards.size(), 100);
+    ARC_CHECK_TRUE(std::equal(boards.begin(), boards.end(), created.begin()));
+    sigma::core::tasks::domain::delete_board(created[50]);
+    created.erase(created.begin() + 50);
+    created.push_back(sigma::core::tasks::domain::new_board("last"));
+    boards = sigma::core::tasks::domain::get_boards();
+    ARC_CHECK_EQUAL(boards.size(), 100);
+    ARC_CHECK_TRUE(std::equal(boards.begin(), boards.end(), created.begin()));
+
+    ARC_TEST_MESSAGE("Checking lookups by handle");
+    ARC_CHECK_EQUAL(handles[0], 1);
+    ARC_CHECK_EQUAL(
+        sigma::core::tasks::domain::get_board(handles[7]),
+        created[7]
+    );
+    ARC_CHECK_TRUE(
+        sigma::core::tasks::domain::get_board(handles[50]) == nullptr);
+    ARC_CHECK_EQUAL(
+        sigma::core::tasks::domain::get_board_handle(created.back()),
+        101
+    );
+    ARC_CHECK_EQUAL(
+        sigma::core::tasks::domain::get_board_handle(nullptr),
+        sigma::core::tasks::BoardRegistry::NULL_HANDLE
+    );
+
+    ARC_TEST_MESSAGE("Checking lookups by title");
+    ARC_CHECK_EQUAL(
+        sigma::core::tasks::domain::find_board("board_7"),
+        created[7]
+    );
+    ARC_CHECK_TRUE(
+        sigma::core::tasks::domain::find_board("board_50") == nullptr);
+    created[7]->set_title("renamed");
+    ARC_CHECK_TRUE(
+        sigma::core::tasks::domain::find_board("board_7") == nullptr);
+    ARC_CHECK_EQUAL(
+        sigma::core::tasks::domain::find_board("renamed"),
+        created[7]
+    );
+    ARC_CHECK_EQUAL(
+        sigma::core::tasks::domain::get_board(handles[7]),
+        created[7]
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                  BOARD TITLES
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(board_titles, TaskDomainBaseFixture)
+{
+    ARC_TEST_MESSAGE("Checking which titles use a suffix");
+    sigma::core::tasks::domain::new_board("Notes");
+    sigma::core::tasks::RootTask* underscore =
+        sigma::core::tasks::domain::new_board("Notes_(1)");
+    sigma::core::tasks::domain::new_board("Notes (2) tail");
+    sigma::core::tasks::domain::new_board("Notes (x)");
+    sigma::core::tasks::domain::new_board("Notes (4))");
+    sigma::core::tasks::RootTask* resolved =
+        sigma::core::tasks::domain::new_board("Notes");
+    ARC_CHECK_EQUAL(resolved->get_title(), "Notes (3)");
+    resolved = sigma::core::tasks::domain::new_board("Notes");
+    ARC_CHECK_EQUAL(resolved->get_title(), "Notes (4)");
+
+    ARC_TEST_MESSAGE("Checking renames release their suffix");
+    underscore->set_title("Other");
+    resolved = sigma::core::tasks::domain::new_board("Notes");
+    ARC_CHECK_EQUAL(resolved->get_title(), "Notes (1)");
+    underscore->get_history().undo();
+    ARC_CHECK_EQUAL(underscore->get_title(), "Notes_(1)");
+    resolved = sigma::core::tasks::domain::new_board("Other");
+    ARC_CHECK_EQUAL(resolved->get_title(), "Other");
+
+    ARC_TEST_MESSAGE("Checking many boards with the same title");
+    std::vector<sigma::core::tasks::RootTask*> boards;
+    for(std::size_t i = 0; i < 100000; ++i)
+    {
+        boards.push_back(sigma::core::tasks::domain::new_board("Board"));
+    }
+    ARC_CHECK_EQUAL(boards[0]->get_title(), "Board");
+    ARC_CHECK_EQUAL(boards[99999]->get_title(), "Board (99999)");
+    sigma::core::tasks::domain::delete_board(boards[500]);
+    resolved = sigma::core::tasks::domain::new_board("Board");
+    ARC_CHECK_EQUAL(resolved->get_title(), "Board (500)");
+    resolved = sigma::core::tasks::domain::new_board("Board");
+    ARC_CHECK_EQUAL(resolved->get_title(), "Board (100000)");
+    boards[7]->set_title("Board");
+    ARC_CHECK_EQUAL(boards[7]->get_title(), "Board (100001)");
+    resolved = sigma::core::tasks::domain::new_board("Board");
+    ARC_CHECK_EQUAL(resolved->get_title(), "Board (7)");
+
+    ARC_TEST_MESSAGE("Checking deleting and creating many boards");
+    // each freed suffix is reused without visiting the suffixes after it,
+    // visiting them would take minutes rather than milliseconds
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    bool reused = true;
+    for(std::size_t i = 1000; i < 51000; ++i)
+    {
+        sigma::core::tasks::domain::delete_board(boards[i]);
+        resolved = sigma::core::tasks::domain::new_board("Board");
+        arc::str::UTF8String expected("Board (");
+        expected << static_cast<arc::uint32>(i) << ")";
+        reused = reused && resolved->get_title() == expected;
+    }
+    ARC_CHECK_TRUE(reused);
+    ARC_CHECK_TRUE(
+        std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+    resolved = sigma::core::tasks::domain::new_board("Board");
+    ARC_CHECK_EQUAL(resolved->get_title(), "Board (100002)");
+
+    ARC_TEST_MESSAGE("Checking renaming while the domain is read");
+    sigma::core::tasks::TasksDomain domain;
+    sigma::core::tasks::RootTask* renamed = domain.new_board("Renamed");
+    domain.new_board("Other");
+    std::future<std::size_t> reader = std::async(
+        std::launch::async,
+        [&domain]()
+        {
+            std::size_t count = 0;
+            for(std::size_t i = 0; i < 1000; ++i)
+            {
+                count += domain.get_stats().boards.size();
+            }
+            return count;
+        }
+    );
+    for(std::size_t i = 0; i < 1000; ++i)
+    {
+        renamed->set_title(i % 2 == 0 ? "Other" : "Renamed");
+    }
+    ARC_CHECK_EQUAL(reader.get(), 2000);
+    ARC_CHECK_EQUAL(renamed->get_title(), "Renamed");
+}
+
+//------------------------------------------------------------------------------
+//                                 DOMAIN INSTANCES
+//------------------------------------------------------------------------------
+
+std::size_t created_count = 0;
+std::size_t destroyed_count = 0;
+
+void count_created(sigma::core::tasks::Task*)
+{
+    ++created_count;
+}
+
+void count_destroyed(sigma::core::tasks::Task*)
+{
+    ++destroyed_count;
+}
+
+ARC_TEST_UNIT_FIXTURE(domain_instances, TaskDomainBaseFixture)
+{
+    sigma::core::tasks::TasksDomain first;
+    sigma::core::tasks::TasksDomain second;
+
+    ARC_TEST_MESSAGE("Checking boards are owned by their domain");
+    sigma::core::tasks::RootTask* first_board = first.new_board("Notes");
+    sigma::core::tasks::RootTask* second_board = second.new_board("Notes");
+    ARC_CHECK_EQUAL(first_board->get_title(), "Notes");
+    ARC_CHECK_EQUAL(second_board->get_title(), "Notes");
+    ARC_CHECK_EQUAL(first_board->get_domain(), &first);
+    ARC_CHECK_EQUAL(second_board->get_domain(), &second);
+    ARC_CHECK_EQUAL(first.find_board("Notes"), first_board);
+    ARC_CHECK_EQUAL(second.find_board("Notes"), second_board);
+    ARC_CHECK_TRUE(sigma::core::tasks::domain::get_boards().empty());
+    ARC_CHECK_FALSE(second.delete_board(first_board));
+    ARC_CHECK_EQUAL(second.get_boards().size(), 1);
+
+    ARC_TEST_MESSAGE("Checking each domain has its own ids");
+    sigma::core::tasks::Task* first_task =
+        new sigma::core::tasks::Task(first_board, "Task");
+    sigma::core::tasks::Task* second_task =
+        new sigma::core::tasks::Task(second_board, "Task");
+    ARC_CHECK_EQUAL(first_board->get_id(), 1);
+    ARC_CHECK_EQUAL(second_board->get_id(), 1);
+    ARC_CHECK_EQUAL(first_task->get_id(), 2);
+    ARC_CHECK_EQUAL(second_task->get_id(), 2);
+
+    ARC_TEST_MESSAGE("Checking each domain has its own tags");
+    first.get_tags().add_tag(first_task, "urgent");
+    ARC_CHECK_EQUAL(first.get_tags().get_tagged_count("urgent"), 1);
+    ARC_CHECK_EQUAL(second.get_tags().get_tagged_count("urgent"), 0);
+    delete second_task;
+    ARC_CHECK_TRUE(first.get_tags().has_tag(first_task, "urgent"));
+    delete first_task;
+    ARC_CHECK_EQUAL(first.get_tags().get_tagged_count("urgent"), 0);
+
+    ARC_TEST_MESSAGE("Checking each domain has its own callbacks");
+    created_count = 0;
+    destroyed_count = 0;
+    {
+        sigma::core::ScopedCallback created =
+            first.on_task_created()->register_function(&count_created);
+        sigma::core::ScopedCallback destroyed =
+            first.on_task_destroyed()->register_function(&count_destroyed);
+        delete new sigma::core::tasks::Task(second_board, "Other");
+        ARC_CHECK_EQUAL(created_count, 0);
+        ARC_CHECK_EQUAL(destroyed_count, 0);
+        delete new sigma::core::tasks::Task(first_board, "Own");
+        ARC_CHECK_EQUAL(created_count, 1);
+        ARC_CHECK_EQUAL(destroyed_count, 1);
+        second.delete_board(second.new_board("Board"));
+        ARC_CHECK_EQUAL(created_count, 1);
+        ARC_CHECK_EQUAL(destroyed_count, 1);
+        first.delete_board(first.new_board("Board"));
+        ARC_CHECK_EQUAL(created_count, 2);
+        ARC_CHECK_EQUAL(destroyed_count, 2);
+    }
+
+    ARC_TEST_MESSAGE("Checking Tasks can't move between domains");
+    sigma::core::tasks::Task* task =
+        new sigma::core::tasks::Task(first_board, "Moving");
+    ARC_CHECK_THROW(
+        task->set_parent(second_board),
+        arc::ex::IllegalActionError
+    );
+    ARC_CHECK_EQUAL(task->get_parent(), first_board);
+    ARC_CHECK_EQUAL(second_board->get_children_count(), 0);
+
+    ARC_TEST_MESSAGE("Checking domains can be populated concurrently");
+    std::vector<sigma::core::tasks::RootTask*> boards;
+    boards.push_back(first.new_board("Concurrent"));
+    boards.push_back(second.new_board("Concurrent"));
+    std::vector<std::thread> threads;
+    ARC_FOR_EACH(it, boards)
+    {
+        sigma::core::tasks::RootTask* board = *it;
+        threads.emplace_back([board]()
+        {
+            for(std::size_t i = 0; i < 10000; ++i)
+            {
+                sigma::core::tasks::Task* child =
+                    new sigma::core::tasks::Task(board, "Child");
+                board->get_domain()->get_tags().add_tag(child, "child");
+            }
+        });
+    }
+    ARC_FOR_EACH(it, threads)
+    {
+        it->join();
+    }
+    ARC_CHECK_EQUAL(boards[0]->get_children_count(), 10000);
+    ARC_CHECK_EQUAL(boards[1]->get_children_count(), 10000);
+    ARC_CHECK_EQUAL(first.get_tags().get_tagged_count("child"), 10000);
+    ARC_CHECK_EQUAL(second.get_tags().get_tagged_count("child"), 10000);
+    ARC_CHECK_EQUAL(
+        first.get_board_handle(boards[0]),
+        second.get_board_handle(boards[1])
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                     STATS
+//------------------------------------------------------------------------------
+
+void ignore_parent_changed(
+        sigma::core::tasks::Task*,
+        sigma::core::tasks::Task*,
+        sigma::core::tasks::Task*)
+{
+}
+
+ARC_TEST_UNIT_FIXTURE(stats, TaskDomainBaseFixture)
+{
+    sigma::core::tasks::DomainStats before =
+        sigma::core::tasks::domain::get_stats();
+
+    sigma::core::tasks::RootTask* wide =
+        sigma::core::tasks::domain::new_board("Wide");
+    sigma::core::tasks::RootTask* deep =
+        sigma::core::tasks::domain::new_board("Deep");
+    std::vector<sigma::core::tasks::Task*> children;
+    for(std::size_t i = 0; i < 100; ++i)
+    {
+        children.push_back(new sigma::core::tasks::Task(wide, "child"));
+    }
+    sigma::core::tasks::Task* chain = deep;
+    for(std::size_t i = 0; i < 10; ++i)
+    {
+        chain = new sigma::core::tasks::Task(chain, "link");
+    }
+
+    ARC_TEST_MESSAGE("Checking the maintained statistics");
+    sigma::core::tasks::DomainStats stats =
+        sigma::core::tasks::domain::get_stats();
+    ARC_CHECK_FALSE(stats.audited);
+    ARC_CHECK_TRUE(stats.totals.estimated);
+    ARC_CHECK_EQUAL(stats.boards.size(), 2);
+    const sigma::core::tasks::BoardStats& wide_stats = stats.boards[0];
+    ARC_CHECK_EQUAL(wide_stats.board_id, wide->get_id());
+    ARC_CHECK_EQUAL(wide_stats.title, "Wide");
+    ARC_CHECK_EQUAL(wide_stats.task_count, 101);
+    ARC_CHECK_EQUAL(wide_stats.archived_count, 0);
+    ARC_CHECK_EQUAL(wide_stats.max_depth, 1);
+    ARC_CHECK_EQUAL(wide_stats.max_children, 100);
+    // each "child" title is 5 bytes and a null terminator
+    ARC_CHECK_EQUAL(wide_stats.title_bytes, 5 + 100 * 6);
+    ARC_CHECK_EQUAL(wide_stats.mutations, 101);
+    ARC_CHECK_EQUAL(wide_stats.callback_bytes, 0);
+    const sigma::core::tasks::BoardStats& deep_stats = stats.boards[1];
+    ARC_CHECK_EQUAL(deep_stats.task_count, 11);
+    ARC_CHECK_EQUAL(deep_stats.max_depth, 10);
+    ARC_CHECK_EQUAL(deep_stats.max_children, 1);
+    ARC_CHECK_EQUAL(stats.totals.task_count, 112);
+    ARC_CHECK_EQUAL(stats.totals.max_depth, 10);
+    ARC_CHECK_EQUAL(stats.totals.max_children, 100);
+    ARC_CHECK_EQUAL(stats.mutations - before.mutations, 112);
+    ARC_CHECK_TRUE(stats.totals.get_total_bytes() > 0);
+    ARC_CHECK_TRUE(stats.get_mutation_rate(before) >= 0.0);
+
+    ARC_TEST_MESSAGE("Checking the statistics are updated by changes");
+    children[0]->set_title("renamed");
+    children[1]->set_title("c");
+    for(std::size_t i = 2; i < 50; ++i)
+    {
+        delete children[i];
+    }
+    stats = sigma::core::tasks::domain::get_stats();
+    ARC_CHECK_EQUAL(stats.boards[0].task_count, 53);
+    ARC_CHECK_EQUAL(stats.boards[0].title_bytes, 5 + 8 + 2 + 50 * 6);
+    ARC_CHECK_EQUAL(stats.boards[0].max_children, 52);
+
+    ARC_TEST_MESSAGE("Checking moved subtrees are measured");
+    children[0]->set_parent(children[1]);
+    deep->get_chidren()[0]->set_parent(children[0]);
+    sigma::core::ScopedCallback callback =
+        children[1]->on_parent_changed()->register_function(
+            &ignore_parent_changed);
+    stats = sigma::core::tasks::domain::get_stats();
+    ARC_CHECK_EQUAL(stats.boards[0].task_count, 63);
+    ARC_CHECK_EQUAL(stats.boards[0].max_depth, 12);
+    ARC_CHECK_EQUAL(stats.boards[0].max_children, 51);
+    ARC_CHECK_TRUE(stats.boards[0].callback_bytes > 0);
+    ARC_CHECK_EQUAL(stats.boards[1].max_depth, 0);
+    ARC_CHECK_EQUAL(stats.boards[1].max_children, 0);
+
+    ARC_TEST_MESSAGE("Checking removed Tasks are measured");
+    sigma::core::tasks::Task* link = children[0]->get_chidren()[0];
+    sigma::core::tasks::Task* tail = link->get_chidren()[0];
+    delete tail;
+    stats = sigma::core::tasks::domain::get_stats();
+    ARC_CHECK_EQUAL(stats.boards[0].task_count, 54);
+    ARC_CHECK_EQUAL(stats.boards[0].max_depth, 3);
+    tail = new sigma::core::tasks::Task(link, "link");
+    for(std::size_t i = 0; i < 8; ++i)
+    {
+        tail = new sigma::core::tasks::Task(tail, "link");
+    }
+    stats = sigma::core::tasks::domain::get_stats();
+    ARC_CHECK_EQUAL(stats.boards[0].max_depth, 12);
+
+    ARC_TEST_MESSAGE("Checking unregistered callbacks are measured");
+    std::size_t callback_bytes = stats.boards[0].callback_bytes;
+    callback.unregister();
+    stats = sigma::core::tasks::domain::get_stats();
+    ARC_CHECK_EQUAL(stats.boards[0].callback_bytes, 0);
+    callback = children[1]->on_parent_changed()->register_function(
+            &ignore_parent_changed);
+    stats = sigma::core::tasks::domain::get_stats();
+    ARC_CHECK_EQUAL(stats.boards[0].callback_bytes, callback_bytes);
+
+    ARC_TEST_MESSAGE("Checking auditing");
+    sigma::core::tasks::DomainStats audited =
+        sigma::core::tasks::domain::get_stats(true);
+    ARC_CHECK_TRUE(audited.audited);
+    ARC_CHECK_FALSE(audited.totals.estimated);
+    ARC_CHECK_EQUAL(audited.boards[0].task_count, 63);
+    ARC_CHECK_EQUAL(audited.boards[0].max_depth, 12);
+    ARC_CHECK_EQUAL(audited.boards[0].max_children, 51);
+    ARC_CHECK_EQUAL(
+        audited.boards[0].title_bytes,
+        stats.boards[0].title_bytes
+    );
+    ARC_CHECK_TRUE(
+        audited.boards[0].children_bytes >= stats.boards[0].children_bytes);
+    ARC_CHECK_EQUAL(
+        audited.boards[0].callback_bytes,
+        stats.boards[0].callback_bytes
+    );
+    ARC_CHECK_EQUAL(audited.boards[1].task_count, 1);
+    ARC_CHECK_EQUAL(audited.boards[1].max_depth, 0);
+
+    ARC_TEST_MESSAGE("Checking moved callbacks are measured");
+    children[1]->set_parent(deep);
+    stats = sigma::core::tasks::domain::get_stats();
+    ARC_CHECK_EQUAL(stats.boards[0].callback_bytes, 0);
+    ARC_CHECK_EQUAL(stats.boards[1].callback_bytes, callback_bytes);
+    ARC_CHECK_EQUAL(stats.boards[0].max_depth, 1);
+    ARC_CHECK_EQUAL(stats.boards[0].max_children, 50);
+    ARC_CHECK_EQUAL(stats.boards[1].max_depth, 12);
+    ARC_CHECK_EQUAL(stats.boards[1].max_children, 1);
+    audited = sigma::core::tasks::domain::get_stats(true);
+    ARC_CHECK_EQUAL(audited.boards[0].max_depth, 1);
+    ARC_CHECK_EQUAL(audited.boards[0].max_children, 50);
+    ARC_CHECK_EQUAL(audited.boards[1].max_depth, 12);
+    ARC_CHECK_EQUAL(audited.boards[1].max_children, 1);
+    ARC_CHECK_EQUAL(
+        audited.boards[1].callback_bytes,
+        stats.boards[1].callback_bytes
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                 BOARD RELINKING
+//------------------------------------------------------------------------------
+
+std::size_t parent_changed_count = 0;
+
+void count_parent_changed(
+        sigma::core::tasks::Task*,
+        sigma::core::tasks::Task*,
+        sigma::core::tasks::Task*)
+{
+    ++parent_changed_count;
+}
+
+ARC_TEST_UNIT_FIXTURE(board_relinking, TaskDomainBaseFixture)
+{
+    static const std::size_t BRANCHES = 100;
+    static const std::size_t LEAVES = 1000;
+
+    sigma::core::tasks::RootTask* board =
+        sigma::core::tasks::domain::new_board("Board");
+    sigma::core::tasks::Task* kept =
+        new sigma::core::tasks::Task(board, "kept");
+    kept->set_status(sigma::core::tasks::STATUS_IN_PROGRESS);
+    kept->set_assignee("alice");
+    sigma::core::tasks::Task* project =
+        new sigma::core::tasks::Task(board, "project");
+    std::vector<sigma::core::tasks::Task*> branches;
+    for(std::size_t i = 0; i < BRANCHES; ++i)
+    {
+        sigma::core::tasks::Task* branch =
+            new sigma::core::tasks::Task(project, "branch");
+        branches.push_back(branch);
+        for(std::size_t j = 0; j < LEAVES; ++j)
+        {
+            sigma::core::tasks::Task* leaf =
+                new sigma::core::tasks::Task(branch, "leaf");
+            if(j % 2 == 0)
+            {
+                leaf->set_status(sigma::core::tasks::STATUS_DONE);
+                leaf->set_assignee("bob");
+            }
+        }
+        // interleave Tasks that stay behind
+        new sigma::core::tasks::Task(kept, "kept child");
+    }
+    const std::size_t subtree_size = 1 + BRANCHES * (LEAVES + 1);
+    const arc::uint32 project_id = project->get_id();
+    const arc::uint32 leaf_id = branches[7]->get_chidren()[3]->get_id();
+
+    parent_changed_count = 0;
+    sigma::core::ScopedCallback project_callback =
+        project->on_parent_changed()->register_function(
+            &count_parent_changed);
+    sigma::core::ScopedCallback branch_callback =
+        branches[0]->on_parent_changed()->register_function(
+            &count_parent_changed);
+
+    ARC_TEST_MESSAGE("Checking splitting a subtree into a new board");
+    sigma::core::tasks::RootTask* split =
+        sigma::core::tasks::domain::split_board(project);
+    ARC_CHECK_EQUAL(split->get_title(), "project");
+    ARC_CHECK_EQUAL(split->get_children_count(), 1);
+    ARC_CHECK_EQUAL(split->get_chidren()[0], project);
+    ARC_CHECK_EQUAL(project->get_id(), project_id);
+    ARC_CHECK_EQUAL(project->get_board(), split);
+    ARC_CHECK_EQUAL(branches[50]->get_board(), split);
+    ARC_CHECK_EQUAL(parent_changed_count, 1);
+    ARC_CHECK_EQUAL(split->find_task(leaf_id)->get_board(), split);
+    ARC_CHECK_TRUE(board->find_task(leaf_id) == nullptr);
+    ARC_CHECK_EQUAL(project->get_descendant_count(), subtree_size - 1);
+
+    sigma::core::tasks::DomainStats stats =
+        sigma::core::tasks::domain::get_stats();
+    ARC_CHECK_EQUAL(stats.boards[0].task_count, 2 + BRANCHES);
+    ARC_CHECK_EQUAL(stats.boards[1].task_count, 1 + subtree_size);
+
+    ARC_TEST_MESSAGE("Checking attributes moved with the Tasks");
+    // counting Tasks doesn't include the RootTask
+    ARC_CHECK_EQUAL(
+        split->count_tasks(sigma::core::tasks::TaskFilter()),
+        subtree_size
+    );
+    ARC_CHECK_EQUAL(
+        split->count_tasks(
+            sigma::core::tasks::TaskFilter().with_status(
+                sigma::core::tasks::STATUS_DONE)),
+        BRANCHES * LEAVES / 2
+    );
+    ARC_CHECK_EQUAL(
+        split->count_tasks(
+            sigma::core::tasks::TaskFilter().with_assignee("bob")),
+        BRANCHES * LEAVES / 2
+    );
+    ARC_CHECK_EQUAL(
+        split->count_tasks(
+            sigma::core::tasks::TaskFilter().with_assignee("alice")),
+        0
+    );
+    ARC_CHECK_EQUAL(
+        board->count_tasks(sigma::core::tasks::TaskFilter()),
+        1 + BRANCHES
+    );
+    ARC_CHECK_EQUAL(
+        board->count_tasks(
+            sigma::core::tasks::TaskFilter().with_status(
+                sigma::core::tasks::STATUS_DONE)),
+        0
+    );
+    ARC_CHECK_EQUAL(
+        board->count_tasks(
+            sigma::core::tasks::TaskFilter().with_assignee("alice")),
+        1
+    );
+    ARC_CHECK_EQUAL(
+        kept->get_status(),
+        sigma::core::tasks::STATUS_IN_PROGRESS
+    );
+    std::vector<sigma::core::tasks::Task*> found;
+    split->find_tasks(
+        sigma::core::tasks::TaskFilter().with_assignee("bob"),
+        found
+    );
+    std::size_t misplaced = 0;
+    ARC_CONST_FOR_EACH(it, found)
+    {
+        if((*it)->get_board() != split || (*it)->get_assignee() != "bob")
+        {
+            ++misplaced;
+        }
+    }
+    ARC_CHECK_EQUAL(found.size(), BRANCHES * LEAVES / 2);
+    ARC_CHECK_EQUAL(misplaced, 0);
+
+    ARC_TEST_MESSAGE("Checking moving a subtree between boards");
+    sigma::core::tasks::domain::move_subtree_to_board(branches[0], board);
+    ARC_CHECK_EQUAL(branches[0]->get_parent(), board);
+    ARC_CHECK_EQUAL(branches[0]->get_board(), board);
+    ARC_CHECK_EQUAL(parent_changed_count, 2);
+    ARC_CHECK_EQUAL(
+        board->count_tasks(
+            sigma::core::tasks::TaskFilter().with_status(
+                sigma::core::tasks::STATUS_DONE)),
+        LEAVES / 2
+    );
+
+    ARC_TEST_MESSAGE("Checking merging boards");
+    std::size_t board_count = sigma::core::tasks::domain::get_boards().size();
+    sigma::core::tasks::domain::merge_boards(board, split);
+    ARC_CHECK_EQUAL(
+        sigma::core::tasks::domain::get_boards().size(),
+        board_count - 1
+    );
+    ARC_CHECK_EQUAL(project->get_board(), board);
+    ARC_CHECK_EQUAL(project->get_parent(), board);
+    ARC_CHECK_EQUAL(board->find_task(leaf_id)->get_board(), board);
+    ARC_CHECK_EQUAL(parent_changed_count, 3);
+    ARC_CHECK_EQUAL(
+        board->count_tasks(sigma::core::tasks::TaskFilter()),
+        1 + BRANCHES + subtree_size
+    );
+    ARC_CHECK_EQUAL(
+        board->count_tasks(
+            sigma::core::tasks::TaskFilter().with_status(
+                sigma::core::tasks::STATUS_DONE)),
+        BRANCHES * LEAVES / 2
+    );
+
+    ARC_TEST_MESSAGE("Checking invalid arguments");
+    ARC_CHECK_THROW(
+        sigma::core::tasks::domain::split_board(nullptr),
+        arc::ex::ValueError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::domain::split_board(board),
+        arc::ex::ValueError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::domain::move_subtree_to_board(kept, nullptr),
+        arc::ex::ValueError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::domain::merge_boards(board, board),
+        arc::ex::ValueError
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                     SHARDS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(shards, TaskDomainBaseFixture)
+{
+    sigma::core::tasks::TasksDomain domain;
+
+    ARC_TEST_MESSAGE("Checking jobs run immediately without shards");
+    sigma::core::tasks::RootTask* inline_board = domain.new_board("Inline");
+    ARC_CHECK_EQUAL(domain.get_shard_count(), 0);
+    std::future<std::thread::id> inline_thread = domain.submit(
+        inline_board,
+        [](sigma::core::tasks::RootTask*)
+        {
+            return std::this_thread::get_id();
+        }
+    );
+    ARC_CHECK_TRUE(inline_thread.get() == std::this_thread::get_id());
+
+    ARC_CHECK_THROW(domain.start_shards(0), arc::ex::ValueError);
+    domain.start_shards(4);
+    ARC_CHECK_EQUAL(domain.get_shard_count(), 4);
+    ARC_CHECK_THROW(domain.start_shards(2), arc::ex::StateError);
+
+    ARC_TEST_MESSAGE("Checking each board's jobs run on one shard");
+    std::vector<sigma::core::tasks::RootTask*> boards;
+    for(std::size_t i = 0; i < 8; ++i)
+    {
+        boards.push_back(domain.new_board("Board"));
+    }
+    std::vector<std::future<arc::uint32>> created;
+    std::vector<std::future<std::thread::id>> threads;
+    for(std::size_t i = 0; i < 1000; ++i)
+    {
+        ARC_FOR_EACH(it, boards)
+        {
+            created.push_back(domain.submit(
+                *it,
+                [](sigma::core::tasks::RootTask* board)
+                {
+                    return (new sigma::core::tasks::Task(board, "job"))->
+                        get_id();
+                }
+            ));
+            threads.push_back(domain.submit(
+                *it,
+                [](sigma::core::tasks::RootTask*)
+                {
+                    return std::this_thread::get_id();
+                }
+            ));
+        }
+    }
+    std::vector<arc::uint32> ids;
+    ARC_FOR_EACH(it, created)
+    {
+        ids.push_back(it->get());
+    }
+    std::sort(ids.begin(), ids.end());
+    ARC_CHECK_TRUE(std::unique(ids.begin(), ids.end()) == ids.end());
+    std::vector<std::thread::id> board_threads;
+    std::size_t moved = 0;
+    for(std::size_t i = 0; i < threads.size(); ++i)
+    {
+        std::thread::id thread = threads[i].get();
+        if(i < boards.size())
+        {
+            board_threads.push_back(thread);
+        }
+        else if(thread != board_threads[i % boards.size()])
+        {
+            ++moved;
+        }
+    }
+    ARC_CHECK_EQUAL(moved, 0);
+    ARC_CHECK_TRUE(board_threads[0] != std::this_thread::get_id());
+    ARC_CHECK_TRUE(board_threads[0] != board_threads[1]);
+    ARC_CHECK_TRUE(board_threads[0] == board_threads[4]);
+    ARC_FOR_EACH(it, boards)
+    {
+        ARC_CHECK_EQUAL((*it)->get_children_count(), 1000);
+    }
+
+    ARC_TEST_MESSAGE("Checking exceptions are returned through the future");
+    std::future<void> failed = domain.submit(
+        boards[0],
+        [](sigma::core::tasks::RootTask* board)
+        {
+            board->get_chidren()[0]->set_title("");
+        }
+    );
+    ARC_CHECK_THROW(failed.get(), arc::ex::ValueError);
+
+    ARC_TEST_MESSAGE("Checking jobs only wait for their own shard");
+    std::future<void> crossed = domain.submit(
+        boards[0],
+        [&domain, &boards](sigma::core::tasks::RootTask* board)
+        {
+            domain.move_subtree_to_board(board->get_chidren()[0], boards[1]);
+        }
+    );
+    ARC_CHECK_THROW(crossed.get(), arc::ex::StateError);
+    ARC_CHECK_EQUAL(boards[0]->get_children_count(), 1000);
+    ARC_CHECK_EQUAL(boards[1]->get_children_count(), 1000);
+    std::future<void> shared = domain.submit(
+        boards[0],
+        [&domain, &boards](sigma::core::tasks::RootTask* board)
+        {
+            domain.move_subtree_to_board(board->get_chidren()[0], boards[4]);
+        }
+    );
+    shared.get();
+    ARC_CHECK_EQUAL(boards[0]->get_children_count(), 999);
+    ARC_CHECK_EQUAL(boards[4]->get_children_count(), 1001);
+
+    ARC_TEST_MESSAGE("Checking deleting a board waits for its jobs");
+    std::future<std::size_t> last = domain.submit(
+        boards[1],
+        [](sigma::core::tasks::RootTask* board)
+        {
+            for(std::size_t i = 0; i < 1000; ++i)
+            {
+                new sigma::core::tasks::Task(board, "late");
+            }
+            return board->get_children_count();
+        }
+    );
+    ARC_CHECK_TRUE(domain.delete_board(boards[1]));
+    ARC_CHECK_TRUE(
+        last.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    ARC_CHECK_EQUAL(last.get(), 2000);
+
+    ARC_TEST_MESSAGE("Checking a job can delete its own board");
+    std::promise<void> go;
+    std::shared_future<void> started(go.get_future());
+    std::future<bool> deleted = domain.submit(
+        boards[3],
+        [&domain, started](sigma::core::tasks::RootTask* board)
+        {
+            started.wait();
+            return domain.delete_board(board);
+        }
+    );
+    // this is queued behind the deletion so the board must still exist
+    std::future<std::size_t> queued = domain.submit(
+        boards[3],
+        [](sigma::core::tasks::RootTask* board)
+        {
+            return board->get_children_count();
+        }
+    );
+    go.set_value();
+    ARC_CHECK_TRUE(deleted.get());
+    ARC_CHECK_EQUAL(queued.get(), 1000);
+    ARC_CHECK_EQUAL(
+        domain.get_board_handle(boards[3]),
+        sigma::core::tasks::BoardRegistry::NULL_HANDLE
+    );
+
+    ARC_TEST_MESSAGE("Checking jobs can't be submitted while deleting");
+    std::promise<void> release;
+    std::shared_future<void> released(release.get_future());
+    std::future<void> blocking = domain.submit(
+        boards[5],
+        [released](sigma::core::tasks::RootTask*)
+        {
+            released.wait();
+        }
+    );
+    std::future<bool> deleting = std::async(
+        std::launch::async,
+        [&domain, &boards]()
+        {
+            return domain.delete_board(boards[5]);
+        }
+    );
+    while(domain.get_board_handle(boards[5]) !=
+          sigma::core::tasks::BoardRegistry::NULL_HANDLE)
+    {
+        std::this_thread::yield();
+    }
+    ARC_CHECK_THROW(
+        domain.submit(
+            boards[5],
+            [](sigma::core::tasks::RootTask*)
+            {
+            }
+        ),
+        arc::ex::StateError
+    );
+    ARC_CHECK_TRUE(
+        deleting.wait_for(std::chrono::seconds(0)) ==
+        std::future_status::timeout
+    );
+    release.set_value();
+    blocking.get();
+    ARC_CHECK_TRUE(deleting.get());
+
+    ARC_TEST_MESSAGE("Checking stopping the shards");
+    std::future<std::size_t> pending = domain.submit(
+        boards[2],
+        [](sigma::core::tasks::RootTask* board)
+        {
+            return board->get_children_count();
+        }
+    );
+    domain.stop_shards();
+    ARC_CHECK_EQUAL(domain.get_shard_count(), 0);
+    ARC_CHECK_TRUE(
+        pending.wait_for(std::chrono::seconds(0)) ==
+        std::future_status::ready
+    );
+    ARC_CHECK_EQUAL(pending.get(), 1000);
+}
+
 } // namespace anonymous
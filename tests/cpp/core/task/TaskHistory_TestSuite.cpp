@@ -0,0 +1,291 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.TaskHistory)
+
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class TaskHistoryFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::RootTask* board;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    void setup()
+    {
+        sigma::core::tasks::domain::init();
+
+        board = sigma::core::tasks::domain::new_board("root");
+    }
+
+    virtual void teardown()
+    {
+        sigma::core::tasks::domain::clean_up();
+    }
+
+    sigma::core::tasks::Task* find(arc::uint32 id)
+    {
+        return board->find_task(id);
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                CREATE AND MOVE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(create_and_move, TaskHistoryFixture)
+{
+    sigma::core::tasks::TaskHistory& history = fixture->board->get_history();
+
+    ARC_TEST_MESSAGE("Checking history is initially empty");
+    ARC_CHECK_FALSE(history.can_undo());
+    ARC_CHECK_FALSE(history.can_redo());
+
+    sigma::core::tasks::Task* task_1 =
+        new sigma::core::tasks::Task(fixture->board, "task_1");
+    sigma::core::tasks::Task* task_2 =
+        new sigma::core::tasks::Task(fixture->board, "task_2");
+    arc::uint32 id_1 = task_1->get_id();
+    arc::uint32 id_2 = task_2->get_id();
+    task_2->set_parent(task_1);
+    ARC_CHECK_EQUAL(history.get_undo_count(), 3);
+
+    ARC_TEST_MESSAGE("Checking undoing a move");
+    ARC_CHECK_TRUE(history.undo());
+    ARC_CHECK_EQUAL(task_2->get_parent(), fixture->board);
+    ARC_CHECK_EQUAL(fixture->board->get_chidren()[1], task_2);
+
+    ARC_TEST_MESSAGE("Checking undoing a creation");
+    ARC_CHECK_TRUE(history.undo());
+    ARC_CHECK_EQUAL(fixture->board->get_children_count(), 1);
+    ARC_CHECK_EQUAL(fixture->find(id_2), nullptr);
+
+    ARC_TEST_MESSAGE("Checking redoing a creation and move");
+    ARC_CHECK_TRUE(history.redo());
+    ARC_CHECK_TRUE(history.redo());
+    ARC_CHECK_FALSE(history.redo());
+    task_2 = fixture->find(id_2);
+    ARC_CHECK_TRUE(task_2 != nullptr);
+    ARC_CHECK_EQUAL(task_2->get_title(), "task_2");
+    ARC_CHECK_EQUAL(task_2->get_parent(), fixture->find(id_1));
+
+    ARC_TEST_MESSAGE("Checking new modifications clear redo");
+    ARC_CHECK_TRUE(history.undo());
+    new sigma::core::tasks::Task(fixture->board, "task_3");
+    ARC_CHECK_FALSE(history.can_redo());
+}
+
+//------------------------------------------------------------------------------
+//                                    RETITLE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(retitle, TaskHistoryFixture)
+{
+    sigma::core::tasks::TaskHistory& history = fixture->board->get_history();
+
+    sigma::core::tasks::Task* task_1 =
+        new sigma::core::tasks::Task(fixture->board, "before");
+    task_1->set_title("after");
+    fixture->board->set_title("renamed");
+
+    ARC_TEST_MESSAGE("Checking undoing title changes");
+    ARC_CHECK_TRUE(history.undo());
+    ARC_CHECK_EQUAL(fixture->board->get_title(), "root");
+    ARC_CHECK_TRUE(history.undo());
+    ARC_CHECK_EQUAL(task_1->get_title(), "before");
+
+    ARC_TEST_MESSAGE("Checking redoing title changes");
+    ARC_CHECK_TRUE(history.redo());
+    ARC_CHECK_EQUAL(task_1->get_title(), "after");
+}
+
+//------------------------------------------------------------------------------
+//                                     DELETE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(delete_subtree, TaskHistoryFixture)
+{
+    sigma::core::tasks::TaskHistory& history = fixture->board->get_history();
+
+    sigma::core::tasks::Task* first =
+        new sigma::core::tasks::Task(fixture->board, "first");
+    sigma::core::tasks::Task* task_1 =
+        new sigma::core::tasks::Task(fixture->board, "task_1");
+    new sigma::core::tasks::Task(fixture->board, "last");
+    sigma::core::tasks::Task* task_2 =
+        new sigma::core::tasks::Task(task_1, "task_2");
+    sigma::core::tasks::Task* task_3 =
+        new sigma::core::tasks::Task(task_1, "task_3");
+    new sigma::core::tasks::Task(task_2, "task_4");
+
+    arc::uint32 id_1 = task_1->get_id();
+    arc::uint32 id_2 = task_2->get_id();
+    arc::uint32 id_3 = task_3->get_id();
+    std::size_t steps = history.get_undo_count();
+
+    fixture->board->remove_child(task_1);
+    ARC_CHECK_EQUAL(history.get_undo_count(), steps + 1);
+    ARC_CHECK_EQUAL(fixture->find(id_2), nullptr);
+
+    ARC_TEST_MESSAGE("Checking undoing a deletion restores the subtree");
+    ARC_CHECK_TRUE(history.undo());
+    task_1 = fixture->find(id_1);
+    ARC_CHECK_TRUE(task_1 != nullptr);
+    ARC_CHECK_EQUAL(fixture->board->get_children_count(), 3);
+    ARC_CHECK_EQUAL(fixture->board->get_chidren()[0], first);
+    ARC_CHECK_EQUAL(fixture->board->get_chidren()[1], task_1);
+    ARC_CHECK_EQUAL(task_1->get_title(), "task_1");
+    ARC_CHECK_EQUAL(task_1->get_children_count(), 2);
+    ARC_CHECK_EQUAL(task_1->get_chidren()[0]->get_id(), id_2);
+    ARC_CHECK_EQUAL(task_1->get_chidren()[1]->get_id(), id_3);
+    ARC_CHECK_EQUAL(task_1->get_chidren()[0]->get_children_count(), 1);
+    ARC_CHECK_EQUAL(
+        task_1->get_chidren()[0]->get_chidren()[0]->get_title(),
+        "task_4"
+    );
+
+    ARC_TEST_MESSAGE("Checking redoing the deletion");
+    ARC_CHECK_TRUE(history.redo());
+    ARC_CHECK_EQUAL(fixture->board->get_children_count(), 2);
+    ARC_CHECK_EQUAL(fixture->find(id_3), nullptr);
+
+    ARC_TEST_MESSAGE("Checking new ids don't collide with restored ids");
+    ARC_CHECK_TRUE(history.undo());
+    sigma::core::tasks::Task* fresh =
+        new sigma::core::tasks::Task(fixture->board, "fresh");
+    ARC_CHECK_TRUE(fresh->get_id() > id_3);
+}
+
+//------------------------------------------------------------------------------
+//                                     STEPS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(steps, TaskHistoryFixture)
+{
+    sigma::core::tasks::TaskHistory& history = fixture->board->get_history();
+
+    history.begin_step("populate");
+    sigma::core::tasks::Task* task_1 =
+        new sigma::core::tasks::Task(fixture->board, "task_1");
+    history.begin_step("nested");
+    new sigma::core::tasks::Task(task_1, "task_2");
+    history.end_step();
+    task_1->set_title("renamed");
+    history.end_step();
+
+    ARC_TEST_MESSAGE("Checking grouped modifications are a single step");
+    ARC_CHECK_EQUAL(history.get_undo_count(), 1);
+    ARC_CHECK_EQUAL(history.get_undo_label(), "populate");
+
+    ARC_TEST_MESSAGE("Checking undoing a step");
+    ARC_CHECK_TRUE(history.undo());
+    ARC_CHECK_EQUAL(fixture->board->get_children_count(), 0);
+    ARC_CHECK_TRUE(history.redo());
+    ARC_CHECK_EQUAL(fixture->board->get_children_count(), 1);
+    ARC_CHECK_EQUAL(
+        fixture->board->get_chidren()[0]->get_title(),
+        "renamed"
+    );
+
+    ARC_TEST_MESSAGE("Checking unbalanced end_step");
+    ARC_CHECK_THROW(history.end_step(), arc::ex::StateError);
+}
+
+//------------------------------------------------------------------------------
+//                              MOVE BETWEEN BOARDS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(move_between_boards, TaskHistoryFixture)
+{
+    sigma::core::tasks::TaskHistory& history = fixture->board->get_history();
+    sigma::core::tasks::RootTask* other =
+        sigma::core::tasks::domain::new_board("other");
+    sigma::core::tasks::TaskHistory& other_history = other->get_history();
+
+    sigma::core::tasks::Task* task =
+        new sigma::core::tasks::Task(fixture->board, "task");
+    new sigma::core::tasks::Task(fixture->board, "sibling");
+    sigma::core::tasks::Task* parent =
+        new sigma::core::tasks::Task(other, "parent");
+    new sigma::core::tasks::Task(other, "undone");
+    ARC_CHECK_TRUE(other_history.undo());
+    ARC_CHECK_EQUAL(history.get_undo_count(), 2);
+    ARC_CHECK_EQUAL(other_history.get_undo_count(), 1);
+    ARC_CHECK_EQUAL(other_history.get_redo_count(), 1);
+
+    ARC_TEST_MESSAGE("Checking moving between boards clears both histories");
+    task->set_parent(parent);
+    ARC_CHECK_FALSE(history.can_undo());
+    ARC_CHECK_FALSE(history.can_redo());
+    ARC_CHECK_FALSE(other_history.can_undo());
+    ARC_CHECK_FALSE(other_history.can_redo());
+
+    ARC_TEST_MESSAGE("Checking later moves within a board are recorded");
+    task->set_parent(other);
+    ARC_CHECK_EQUAL(other_history.get_undo_count(), 1);
+    ARC_CHECK_TRUE(other_history.undo());
+    ARC_CHECK_EQUAL(task->get_parent(), parent);
+    ARC_CHECK_FALSE(history.can_undo());
+
+    ARC_TEST_MESSAGE("Checking moving a subtree to a board clears both "
+                     "histories");
+    new sigma::core::tasks::Task(fixture->board, "task");
+    ARC_CHECK_TRUE(history.can_undo());
+    sigma::core::tasks::domain::move_subtree_to_board(parent, fixture->board);
+    ARC_CHECK_FALSE(history.can_undo());
+    ARC_CHECK_FALSE(other_history.can_undo());
+    ARC_CHECK_FALSE(other_history.can_redo());
+
+    ARC_TEST_MESSAGE("Checking splitting a board clears its history");
+    new sigma::core::tasks::Task(fixture->board, "task");
+    sigma::core::tasks::RootTask* split =
+        sigma::core::tasks::domain::split_board(parent);
+    ARC_CHECK_FALSE(history.can_undo());
+    ARC_CHECK_FALSE(split->get_history().can_undo());
+
+    ARC_TEST_MESSAGE("Checking merging boards clears the target's history");
+    new sigma::core::tasks::Task(fixture->board, "task");
+    sigma::core::tasks::domain::merge_boards(fixture->board, split);
+    ARC_CHECK_FALSE(history.can_undo());
+    ARC_CHECK_EQUAL(fixture->find(parent->get_id()), parent);
+}
+
+//------------------------------------------------------------------------------
+//                                  MEMORY BUDGET
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(memory_budget, TaskHistoryFixture)
+{
+    sigma::core::tasks::TaskHistory& history = fixture->board->get_history();
+
+    for(std::size_t i = 0; i < 100; ++i)
+    {
+        new sigma::core::tasks::Task(fixture->board, "task");
+    }
+    ARC_CHECK_EQUAL(history.get_undo_count(), 100);
+
+    ARC_TEST_MESSAGE("Checking reducing the budget drops the oldest steps");
+    std::size_t budget = history.get_memory_usage() / 2;
+    history.set_memory_budget(budget);
+    ARC_CHECK_TRUE(history.get_memory_usage() <= budget);
+    ARC_CHECK_TRUE(history.get_undo_count() < 100);
+    ARC_CHECK_TRUE(history.get_undo_count() > 0);
+
+    ARC_TEST_MESSAGE("Checking a budget of 0 disables recording");
+    history.set_memory_budget(0);
+    new sigma::core::tasks::Task(fixture->board, "task");
+    ARC_CHECK_FALSE(history.can_undo());
+}
+
+} // namespace anonymous
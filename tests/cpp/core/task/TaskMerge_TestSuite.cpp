@@ -0,0 +1,352 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.TaskMerge)
+
+#include <algorithm>
+
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TaskMerge.hpp"
+#include "sigma/core/tasks/TaskSerialiser.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class TaskMergeFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::RootTask* board;
+    sigma::core::tasks::Task* a;
+    sigma::core::tasks::Task* b;
+    sigma::core::tasks::Task* c;
+    sigma::core::tasks::Task* d;
+    sigma::core::tasks::Task* e;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    void setup()
+    {
+        sigma::core::tasks::domain::init();
+
+        board = sigma::core::tasks::domain::new_board("root");
+        a = new sigma::core::tasks::Task(board, "a");
+        b = new sigma::core::tasks::Task(board, "b");
+        c = new sigma::core::tasks::Task(a, "c");
+        d = new sigma::core::tasks::Task(board, "d");
+        e = new sigma::core::tasks::Task(board, "e");
+    }
+
+    virtual void teardown()
+    {
+        sigma::core::tasks::domain::clean_up();
+    }
+
+    // returns a copy of the board which keeps the ids of the Tasks
+    sigma::core::tasks::RootTask* copy()
+    {
+        std::vector<arc::uint8> data;
+        sigma::core::tasks::TaskSerialiser::serialise_children(board, data);
+        sigma::core::tasks::RootTask* theirs =
+            sigma::core::tasks::domain::new_board("theirs");
+        sigma::core::tasks::TaskSerialiser::load_children(
+                theirs,
+                data.data(),
+                data.size()
+        );
+        return theirs;
+    }
+
+    // returns the Task in the given copy with the same id as the given Task
+    static sigma::core::tasks::Task* in(
+            sigma::core::tasks::RootTask* copy,
+            sigma::core::tasks::Task* task)
+    {
+        return copy->find_task(task->get_id());
+    }
+
+    // returns the titles of the hierarchy below the given Task, e.g.
+    // "a[c] b" for a Task with the children a and b where a has the child c
+    static arc::str::UTF8String describe(sigma::core::tasks::Task* task)
+    {
+        arc::str::UTF8String description;
+        ARC_CONST_FOR_EACH(it, task->get_chidren())
+        {
+            if(!description.is_empty())
+            {
+                description << " ";
+            }
+            description << (*it)->get_title();
+            if((*it)->get_children_count() > 0)
+            {
+                description << "[" << describe(*it) << "]";
+            }
+        }
+        return description;
+    }
+
+    // returns the conflicts as a string ordered by id, e.g. "M3 R5" for a
+    // modified conflict of Task 3 and a removed conflict of Task 5
+    static arc::str::UTF8String describe(
+            std::vector<sigma::core::tasks::TaskConflict> conflicts)
+    {
+        std::sort(
+            conflicts.begin(),
+            conflicts.end(),
+            [](
+                    const sigma::core::tasks::TaskConflict& a,
+                    const sigma::core::tasks::TaskConflict& b)
+            {
+                return a.id < b.id;
+            }
+        );
+
+        arc::str::UTF8String description;
+        ARC_CONST_FOR_EACH(it, conflicts)
+        {
+            if(!description.is_empty())
+            {
+                description << " ";
+            }
+            switch(it->type)
+            {
+                case sigma::core::tasks::TaskConflict::MODIFIED_BOTH:
+                    description << "M";
+                    break;
+                case sigma::core::tasks::TaskConflict::MOVED_BOTH:
+                    description << "V";
+                    break;
+                case sigma::core::tasks::TaskConflict::CHANGED_REMOVED:
+                    description << "C";
+                    break;
+                case sigma::core::tasks::TaskConflict::REMOVED_CHANGED:
+                    description << "R";
+                    break;
+                case sigma::core::tasks::TaskConflict::CYCLE:
+                    description << "Y";
+                    break;
+            }
+            description << it->id;
+        }
+        return description;
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                     MERGE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(merge, TaskMergeFixture)
+{
+    sigma::core::tasks::RootTask* board = fixture->board;
+    sigma::core::tasks::TaskSnapshot::Ptr base = board->snapshot();
+    sigma::core::tasks::RootTask* theirs = fixture->copy();
+
+    // their changes
+    fixture->in(theirs, fixture->a)->set_title("a2");
+    fixture->in(theirs, fixture->b)->set_priority(
+            sigma::core::tasks::PRIORITY_HIGH);
+    sigma::core::tasks::Task* added = new sigma::core::tasks::Task(
+            fixture->in(theirs, fixture->b), "n");
+    new sigma::core::tasks::Task(added, "n_child");
+    fixture->in(theirs, fixture->e)->set_parent(
+            fixture->in(theirs, fixture->a));
+    theirs->remove_child(fixture->in(theirs, fixture->d));
+
+    // our changes
+    fixture->c->set_title("c2");
+    fixture->a->set_estimate(30);
+    new sigma::core::tasks::Task(board, "f");
+    arc::uint64 hash = board->get_hash();
+
+    ARC_TEST_MESSAGE("Checking merging changes to different Tasks");
+    std::vector<sigma::core::tasks::TaskConflict> conflicts;
+    sigma::core::tasks::TaskMerge::merge(
+            base,
+            board,
+            theirs->snapshot(),
+            conflicts
+    );
+    ARC_CHECK_EQUAL(conflicts.size(), 0);
+    ARC_CHECK_EQUAL(fixture->describe(board), "a2[c2 e] b[n[n_child]] f");
+    ARC_CHECK_EQUAL(fixture->a->get_estimate(), 30);
+    ARC_CHECK_EQUAL(
+        fixture->b->get_priority(),
+        sigma::core::tasks::PRIORITY_HIGH
+    );
+
+    ARC_TEST_MESSAGE("Checking added Tasks keep their ids");
+    ARC_CHECK_EQUAL(board->find_task(added->get_id())->get_title(), "n");
+
+    ARC_TEST_MESSAGE("Checking undoing and redoing a merge");
+    ARC_CHECK_TRUE(board->get_history().undo());
+    ARC_CHECK_EQUAL(fixture->describe(board), "a[c2] b d e f");
+    ARC_CHECK_EQUAL(board->get_hash(), hash);
+    ARC_CHECK_TRUE(board->get_history().redo());
+    ARC_CHECK_EQUAL(fixture->describe(board), "a2[c2 e] b[n[n_child]] f");
+
+    ARC_TEST_MESSAGE("Checking merging the same changes again");
+    hash = board->get_hash();
+    std::size_t undo_count = board->get_history().get_undo_count();
+    sigma::core::tasks::TaskMerge::merge(
+            base,
+            board,
+            theirs->snapshot(),
+            conflicts
+    );
+    ARC_CHECK_EQUAL(conflicts.size(), 0);
+    ARC_CHECK_EQUAL(board->get_hash(), hash);
+    ARC_CHECK_EQUAL(board->get_history().get_undo_count(), undo_count);
+
+    ARC_TEST_MESSAGE("Checking positions follow their siblings");
+    sigma::core::tasks::Task* theirs_a = fixture->in(theirs, fixture->a);
+    sigma::core::tasks::Task* g = new sigma::core::tasks::Task(theirs, "g");
+    g->move_after(theirs_a);
+    fixture->in(theirs, fixture->b)->move_before(theirs_a);
+    sigma::core::tasks::TaskMerge::merge(
+            base,
+            board,
+            theirs->snapshot(),
+            conflicts
+    );
+    ARC_CHECK_EQUAL(conflicts.size(), 0);
+    ARC_CHECK_EQUAL(fixture->describe(board), "b[n[n_child]] a2[c2 e] g f");
+
+    ARC_CHECK_THROW(
+        sigma::core::tasks::TaskMerge::merge(base, nullptr, base, conflicts),
+        arc::ex::ValueError
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                   CONFLICTS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(conflicts, TaskMergeFixture)
+{
+    sigma::core::tasks::RootTask* board = fixture->board;
+    sigma::core::tasks::Task* f = new sigma::core::tasks::Task(board, "f");
+    sigma::core::tasks::Task* g = new sigma::core::tasks::Task(board, "g");
+    sigma::core::tasks::Task* h = new sigma::core::tasks::Task(g, "h");
+    sigma::core::tasks::Task* i = new sigma::core::tasks::Task(board, "i");
+    sigma::core::tasks::Task* j = new sigma::core::tasks::Task(board, "j");
+    sigma::core::tasks::Task* k = new sigma::core::tasks::Task(board, "k");
+    sigma::core::tasks::Task* l = new sigma::core::tasks::Task(k, "l");
+    sigma::core::tasks::TaskSnapshot::Ptr base = board->snapshot();
+    sigma::core::tasks::RootTask* theirs = fixture->copy();
+
+    // both retitle a, they also change its estimate
+    fixture->a->set_title("ours");
+    fixture->in(theirs, fixture->a)->set_title("theirs");
+    fixture->in(theirs, fixture->a)->set_estimate(45);
+    // both move e to different parents
+    fixture->e->set_parent(fixture->d);
+    fixture->in(theirs, fixture->e)->set_parent(
+            fixture->in(theirs, fixture->b));
+    // we remove f while they retitle it
+    board->remove_child(f);
+    fixture->in(theirs, f)->set_title("f2");
+    // we retitle h while they remove g
+    h->set_title("h2");
+    theirs->remove_child(fixture->in(theirs, g));
+    // we move j under i while they move i under j
+    j->set_parent(i);
+    fixture->in(theirs, i)->set_parent(fixture->in(theirs, j));
+    // they swap k and l, which only needs the moves to be ordered
+    fixture->in(theirs, l)->set_parent(theirs);
+    fixture->in(theirs, k)->set_parent(fixture->in(theirs, l));
+
+    std::vector<sigma::core::tasks::TaskConflict> conflicts;
+    sigma::core::tasks::TaskMerge::merge(
+            base,
+            board,
+            theirs->snapshot(),
+            conflicts
+    );
+
+    ARC_TEST_MESSAGE("Checking the conflicts");
+    arc::str::UTF8String expected;
+    expected << "M" << fixture->a->get_id() << " V" << fixture->e->get_id()
+             << " C" << f->get_id() << " R" << g->get_id()
+             << " Y" << i->get_id();
+    ARC_CHECK_EQUAL(fixture->describe(conflicts), expected);
+    ARC_CONST_FOR_EACH(it, conflicts)
+    {
+        if(it->type == sigma::core::tasks::TaskConflict::MODIFIED_BOTH)
+        {
+            ARC_CHECK_EQUAL(it->base->get_title(), "a");
+            ARC_CHECK_EQUAL(it->theirs->get_title(), "theirs");
+        }
+    }
+
+    ARC_TEST_MESSAGE("Checking our changes are kept");
+    ARC_CHECK_EQUAL(
+        fixture->describe(board),
+        "ours[c] b d[e] l[k] g[h2] i[j]"
+    );
+
+    ARC_TEST_MESSAGE("Checking non-conflicting fields are merged");
+    ARC_CHECK_EQUAL(fixture->a->get_estimate(), 45);
+}
+
+//------------------------------------------------------------------------------
+//                                     SCALE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(scale, TaskMergeFixture)
+{
+    sigma::core::tasks::RootTask* board = fixture->board;
+    std::vector<sigma::core::tasks::Task*> branches;
+    std::vector<arc::uint32> leaves;
+    for(std::size_t i = 0; i < 200; ++i)
+    {
+        branches.push_back(new sigma::core::tasks::Task(board, "branch"));
+        for(std::size_t j = 0; j < 500; ++j)
+        {
+            leaves.push_back((new sigma::core::tasks::Task(
+                    branches.back(), "leaf"))->get_id());
+        }
+    }
+    sigma::core::tasks::TaskSnapshot::Ptr base = board->snapshot();
+
+    // their version is a branch of the board's history
+    board->get_history().begin_step();
+    board->find_task(leaves[123])->set_title("theirs");
+    arc::uint32 added =
+        (new sigma::core::tasks::Task(branches[5], "added"))->get_id();
+    board->find_task(leaves[50000])->set_parent(branches[0]);
+    branches[7]->remove_child(board->find_task(leaves[3600]));
+    board->get_history().end_step();
+    sigma::core::tasks::TaskSnapshot::Ptr theirs = board->snapshot();
+    board->get_history().undo();
+
+    board->find_task(leaves[777])->set_title("ours");
+    board->find_task(leaves[50001])->set_parent(branches[1]);
+
+    std::vector<sigma::core::tasks::TaskConflict> conflicts;
+    sigma::core::tasks::TaskMerge::merge(base, board, theirs, conflicts);
+
+    ARC_CHECK_EQUAL(conflicts.size(), 0);
+    ARC_CHECK_EQUAL(board->find_task(leaves[123])->get_title(), "theirs");
+    ARC_CHECK_EQUAL(board->find_task(leaves[777])->get_title(), "ours");
+    ARC_CHECK_EQUAL(board->find_task(added)->get_parent(), branches[5]);
+    ARC_CHECK_EQUAL(branches[5]->get_chidren().back()->get_id(), added);
+    ARC_CHECK_EQUAL(
+        board->find_task(leaves[50000])->get_parent(),
+        branches[0]
+    );
+    ARC_CHECK_EQUAL(
+        board->find_task(leaves[50001])->get_parent(),
+        branches[1]
+    );
+    ARC_CHECK_TRUE(board->find_task(leaves[3600]) == nullptr);
+    ARC_CHECK_EQUAL(board->get_descendant_count(), 100205);
+}
+
+} // namespace anonymous
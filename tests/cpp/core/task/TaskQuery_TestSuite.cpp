@@ -0,0 +1,255 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.TaskQuery)
+
+#include <algorithm>
+
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TaskQuery.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class TaskQueryFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::RootTask* board;
+    sigma::core::tasks::RootTask* board_2;
+    sigma::core::tasks::Task* release;
+    sigma::core::tasks::Task* flaky_1;
+    sigma::core::tasks::Task* flaky_2;
+    sigma::core::tasks::Task* flaky_deep;
+    sigma::core::tasks::Task* flaky_outside;
+    sigma::core::tasks::Task* flaky_other_board;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    void setup()
+    {
+        sigma::core::tasks::domain::init();
+
+        // root
+        //   Release 3                          depth 1
+        //     fix flaky test                   depth 2, high priority
+        //     triage                           depth 2
+        //       flaky build                    depth 3
+        //         deeper                       depth 4
+        //           very flaky                 depth 5
+        //   flaky outside                      depth 1
+        // other
+        //   Release 3
+        //     flaky on other board             depth 2, high priority
+        board = sigma::core::tasks::domain::new_board("root");
+        release = new sigma::core::tasks::Task(board, "Release 3");
+        flaky_1 = new sigma::core::tasks::Task(release, "fix flaky test");
+        flaky_1->set_priority(sigma::core::tasks::PRIORITY_HIGH);
+        sigma::core::tasks::Task* triage =
+            new sigma::core::tasks::Task(release, "triage");
+        flaky_2 = new sigma::core::tasks::Task(triage, "flaky build");
+        sigma::core::tasks::Task* deeper =
+            new sigma::core::tasks::Task(flaky_2, "deeper");
+        flaky_deep = new sigma::core::tasks::Task(deeper, "very flaky");
+        flaky_outside = new sigma::core::tasks::Task(board, "flaky outside");
+
+        board_2 = sigma::core::tasks::domain::new_board("other");
+        sigma::core::tasks::Task* release_2 =
+            new sigma::core::tasks::Task(board_2, "Release 3");
+        flaky_other_board =
+            new sigma::core::tasks::Task(release_2, "flaky on other board");
+        flaky_other_board->set_priority(sigma::core::tasks::PRIORITY_HIGH);
+    }
+
+    virtual void teardown()
+    {
+        sigma::core::tasks::domain::clean_up();
+    }
+
+    // returns the sorted tasks matching the query over all boards
+    std::vector<sigma::core::tasks::Task*> find(const char* text)
+    {
+        std::vector<sigma::core::tasks::Task*> found;
+        sigma::core::tasks::domain::find_tasks(
+                sigma::core::tasks::TaskQuery(text), found);
+        std::sort(found.begin(), found.end());
+        return found;
+    }
+
+    std::vector<sigma::core::tasks::Task*> expect(
+            sigma::core::tasks::Task* a,
+            sigma::core::tasks::Task* b = nullptr,
+            sigma::core::tasks::Task* c = nullptr)
+    {
+        std::vector<sigma::core::tasks::Task*> expected;
+        expected.push_back(a);
+        if(b != nullptr)
+        {
+            expected.push_back(b);
+        }
+        if(c != nullptr)
+        {
+            expected.push_back(c);
+        }
+        std::sort(expected.begin(), expected.end());
+        return expected;
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                     PARSE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(parse, TaskQueryFixture)
+{
+    ARC_TEST_MESSAGE("Checking valid queries");
+    sigma::core::tasks::TaskQuery tree("under:\"Release 3\" title~flaky");
+    ARC_CHECK_FALSE(tree.is_indexed());
+    ARC_CHECK_FALSE(tree.is_filter_only());
+    sigma::core::tasks::TaskQuery indexed(
+            "status:open priority>=medium title~\"fix \\\"it\\\"\"");
+    ARC_CHECK_TRUE(indexed.is_indexed());
+    ARC_CHECK_FALSE(indexed.is_filter_only());
+    sigma::core::tasks::TaskQuery filter_only(
+            "  estimate<=30\tassignee:\"sam smith\" flag:starred ");
+    ARC_CHECK_TRUE(filter_only.is_filter_only());
+    ARC_CHECK_EQUAL(
+        filter_only.get_text(),
+        "  estimate<=30\tassignee:\"sam smith\" flag:starred "
+    );
+    ARC_CHECK_TRUE(sigma::core::tasks::TaskQuery("").is_filter_only());
+
+    ARC_TEST_MESSAGE("Checking invalid queries");
+    ARC_CHECK_THROW(
+        sigma::core::tasks::TaskQuery("colour:red"),
+        arc::ex::ParseError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::TaskQuery("title"),
+        arc::ex::ParseError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::TaskQuery("title:"),
+        arc::ex::ParseError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::TaskQuery("title:\"unterminated"),
+        arc::ex::ParseError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::TaskQuery("depth<four"),
+        arc::ex::ParseError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::TaskQuery("title<a"),
+        arc::ex::ParseError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::TaskQuery("status:sleeping"),
+        arc::ex::ParseError
+    );
+    ARC_CHECK_THROW(
+        sigma::core::tasks::TaskQuery("under:a under:b"),
+        arc::ex::ParseError
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                   EXECUTION
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(execution, TaskQueryFixture)
+{
+    ARC_TEST_MESSAGE("Checking a tree scan query");
+    ARC_CHECK_TRUE(
+        fixture->find("under:\"Release 3\" title~\"flaky\" depth<4") ==
+        fixture->expect(
+                fixture->flaky_1,
+                fixture->flaky_2,
+                fixture->flaky_other_board
+        )
+    );
+
+    ARC_TEST_MESSAGE("Checking an indexed query");
+    ARC_CHECK_TRUE(
+        fixture->find("under:\"Release 3\" title~flaky priority:high") ==
+        fixture->expect(fixture->flaky_1, fixture->flaky_other_board)
+    );
+
+    ARC_TEST_MESSAGE("Checking board and depth terms");
+    ARC_CHECK_TRUE(
+        fixture->find("board:root title~flaky depth>=3") ==
+        fixture->expect(fixture->flaky_2, fixture->flaky_deep)
+    );
+    ARC_CHECK_TRUE(
+        fixture->find("title~flaky depth:1") ==
+        fixture->expect(fixture->flaky_outside)
+    );
+
+    ARC_TEST_MESSAGE("Checking under an id");
+    arc::str::UTF8String by_id("title~flaky under:");
+    by_id << fixture->flaky_2->get_id();
+    std::vector<sigma::core::tasks::Task*> found;
+    sigma::core::tasks::domain::find_tasks(
+            sigma::core::tasks::TaskQuery(by_id), found);
+    ARC_CHECK_TRUE(found == fixture->expect(fixture->flaky_deep));
+
+    ARC_TEST_MESSAGE("Checking queries that match nothing");
+    ARC_CHECK_TRUE(fixture->find("under:missing").empty());
+    ARC_CHECK_TRUE(fixture->find("priority<none").empty());
+    ARC_CHECK_TRUE(fixture->find("depth<1").empty());
+
+    ARC_TEST_MESSAGE("Checking matches agrees with execution");
+    sigma::core::tasks::TaskQuery query(
+            "under:\"Release 3\" title~flaky priority:high");
+    ARC_CHECK_TRUE(query.matches(fixture->flaky_1));
+    ARC_CHECK_FALSE(query.matches(fixture->flaky_2));
+    ARC_CHECK_FALSE(query.matches(fixture->flaky_outside));
+    ARC_CHECK_FALSE(query.matches(fixture->board));
+}
+
+//------------------------------------------------------------------------------
+//                                   STREAMING
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(streaming, TaskQueryFixture)
+{
+    sigma::core::tasks::TaskQuery query("title~flaky");
+
+    ARC_TEST_MESSAGE("Checking the result limit");
+    std::vector<sigma::core::tasks::Task*> found;
+    ARC_CHECK_EQUAL(sigma::core::tasks::domain::find_tasks(query, found, 2), 2);
+    ARC_CHECK_EQUAL(found.size(), 2);
+    found.clear();
+    ARC_CHECK_EQUAL(sigma::core::tasks::domain::find_tasks(query, found), 5);
+    found.clear();
+    ARC_CHECK_EQUAL(sigma::core::tasks::domain::find_tasks(query, found, 0), 0);
+
+    ARC_TEST_MESSAGE("Checking tree scans stream in pre-order");
+    found.clear();
+    ARC_CHECK_EQUAL(query.find(fixture->board, found), 4);
+    ARC_CHECK_EQUAL(found[0], fixture->flaky_1);
+    ARC_CHECK_EQUAL(found[1], fixture->flaky_2);
+    ARC_CHECK_EQUAL(found[2], fixture->flaky_deep);
+    ARC_CHECK_EQUAL(found[3], fixture->flaky_outside);
+
+    ARC_TEST_MESSAGE("Checking the visitor can stop the query");
+    std::size_t visited = 0;
+    bool completed = sigma::core::tasks::domain::stream_tasks(
+            query,
+            [&](sigma::core::tasks::Task*)
+            {
+                return ++visited < 3;
+            }
+    );
+    ARC_CHECK_FALSE(completed);
+    ARC_CHECK_EQUAL(visited, 3);
+}
+
+} // namespace anonymous
@@ -0,0 +1,184 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(core.tasks.TaskSnapshot)
+
+#include <thread>
+
+#include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TasksDomain.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                  BASE FIXTURE
+//------------------------------------------------------------------------------
+
+class TaskSnapshotFixture : public arc::test::Fixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::RootTask* board;
+
+    sigma::core::tasks::Task* task_1;
+    sigma::core::tasks::Task* task_2;
+    sigma::core::tasks::Task* task_3;
+    sigma::core::tasks::Task* task_4;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    void setup()
+    {
+        sigma::core::tasks::domain::init();
+
+        board = sigma::core::tasks::domain::new_board("root");
+        task_1 = new sigma::core::tasks::Task(board, "task_1");
+        task_2 = new sigma::core::tasks::Task(board, "task_2");
+        task_3 = new sigma::core::tasks::Task(task_1, "task_3");
+        task_4 = new sigma::core::tasks::Task(task_2, "task_4");
+    }
+
+    virtual void teardown()
+    {
+        sigma::core::tasks::domain::clean_up();
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                    CONTENTS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(contents, TaskSnapshotFixture)
+{
+    sigma::core::tasks::TaskSnapshot::Ptr snapshot(fixture->board->snapshot());
+
+    ARC_TEST_MESSAGE("Checking root");
+    ARC_CHECK_EQUAL(snapshot->get_id(), fixture->board->get_id());
+    ARC_CHECK_EQUAL(snapshot->get_title(), "root");
+    ARC_CHECK_EQUAL(snapshot->get_children_count(), 2);
+
+    ARC_TEST_MESSAGE("Checking hierarchy");
+    const sigma::core::tasks::TaskSnapshot::Ptr& s_1 =
+        snapshot->get_children()[0];
+    const sigma::core::tasks::TaskSnapshot::Ptr& s_2 =
+        snapshot->get_children()[1];
+    ARC_CHECK_EQUAL(s_1->get_id(), fixture->task_1->get_id());
+    ARC_CHECK_EQUAL(s_1->get_title(), "task_1");
+    ARC_CHECK_EQUAL(s_1->get_children_count(), 1);
+    ARC_CHECK_EQUAL(s_1->get_children()[0]->get_title(), "task_3");
+    ARC_CHECK_EQUAL(s_2->get_id(), fixture->task_2->get_id());
+    ARC_CHECK_EQUAL(s_2->get_children_count(), 1);
+    ARC_CHECK_EQUAL(s_2->get_children()[0]->get_title(), "task_4");
+
+    ARC_TEST_MESSAGE("Checking unchanged board returns the same snapshot");
+    ARC_CHECK_EQUAL(fixture->board->snapshot().get(), snapshot.get());
+}
+
+//------------------------------------------------------------------------------
+//                                  PERSISTENCE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(persistence, TaskSnapshotFixture)
+{
+    sigma::core::tasks::TaskSnapshot::Ptr before(fixture->board->snapshot());
+
+    fixture->task_3->set_title("renamed");
+    fixture->task_4->set_parent(fixture->task_1);
+    new sigma::core::tasks::Task(fixture->board, "task_5");
+
+    sigma::core::tasks::TaskSnapshot::Ptr after(fixture->board->snapshot());
+
+    ARC_TEST_MESSAGE("Checking old snapshot is unchanged");
+    ARC_CHECK_EQUAL(before->get_children_count(), 2);
+    ARC_CHECK_EQUAL(
+        before->get_children()[0]->get_children()[0]->get_title(),
+        "task_3"
+    );
+    ARC_CHECK_EQUAL(before->get_children()[1]->get_children_count(), 1);
+
+    ARC_TEST_MESSAGE("Checking new snapshot has the changes");
+    ARC_CHECK_EQUAL(after->get_children_count(), 3);
+    ARC_CHECK_EQUAL(after->get_children()[0]->get_children_count(), 2);
+    ARC_CHECK_EQUAL(
+        after->get_children()[0]->get_children()[0]->get_title(),
+        "renamed"
+    );
+    ARC_CHECK_EQUAL(after->get_children()[1]->get_children_count(), 0);
+    ARC_CHECK_EQUAL(after->get_children()[2]->get_title(), "task_5");
+
+    ARC_TEST_MESSAGE("Checking unmodified subtrees are shared");
+    ARC_CHECK_EQUAL(
+        before->get_children()[1]->get_children()[0].get(),
+        after->get_children()[0]->get_children()[1].get()
+    );
+}
+
+//------------------------------------------------------------------------------
+//                               CONCURRENT READERS
+//------------------------------------------------------------------------------
+
+class ConcurrentReadersFixture : public TaskSnapshotFixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    bool consistent;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    virtual void setup()
+    {
+        // super call
+        TaskSnapshotFixture::setup();
+
+        consistent = true;
+    }
+
+    void read()
+    {
+        for(std::size_t i = 0; i < 500; ++i)
+        {
+            sigma::core::tasks::TaskSnapshot::Ptr s(board->snapshot());
+            // task_1 and its child are always added and removed together
+            ARC_FOR_EACH(it, s->get_children())
+            {
+                if((*it)->get_title() == "pair" &&
+                   (*it)->get_children_count() != 1)
+                {
+                    consistent = false;
+                }
+            }
+        }
+    }
+
+    void write()
+    {
+        for(std::size_t i = 0; i < 500; ++i)
+        {
+            sigma::core::util::ScopedWriteLock lock(board->get_lock());
+            sigma::core::tasks::Task* pair =
+                new sigma::core::tasks::Task(board, "pair");
+            new sigma::core::tasks::Task(pair, "child");
+            if(i % 2 == 1)
+            {
+                board->remove_child(pair);
+            }
+        }
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(concurrent_readers, ConcurrentReadersFixture)
+{
+    std::thread writer(&ConcurrentReadersFixture::write, fixture);
+    std::thread reader(&ConcurrentReadersFixture::read, fixture);
+    writer.join();
+    reader.join();
+
+    ARC_TEST_MESSAGE("Checking snapshots were always consistent");
+    ARC_CHECK_TRUE(fixture->consistent);
+}
+
+} // namespace anonymous
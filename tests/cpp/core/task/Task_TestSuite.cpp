@@ -2,7 +2,14 @@
 
 ARC_TEST_MODULE(core.tasks.Task)
 
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#include <thread>
+
 #include "sigma/core/tasks/RootTask.hpp"
+#include "sigma/core/tasks/TaskQuery.hpp"
+#include "sigma/core/tasks/TaskSerialiser.hpp"
 #include "sigma/core/tasks/TasksDomain.hpp"
 
 namespace
@@ -59,7 +66,7 @@ public:
         callback_task = nullptr;
 
         // connect callback
-        task_created_cb_id = sigma::core::tasks::Task::on_created()->
+        task_created_cb_id = sigma::core::tasks::domain::on_task_created()->
                 register_member_function<
                         ConstructorFixture,
                         &ConstructorFixture::on_task_created
@@ -251,7 +258,7 @@ public:
                         &SetParentFixture::on_parent_changed
                 >(this);
 
-        sigma::core::tasks::Task::on_destroyed()->
+        sigma::core::tasks::domain::on_task_destroyed()->
                 register_member_function<
                         SetParentFixture,
                         &SetParentFixture::on_task_destroyed
@@ -511,7 +518,7 @@ public:
         task_5 = new sigma::core::tasks::Task(task_3, "task_5");
 
         // connect callbacks
-        sigma::core::tasks::Task::on_destroyed()->
+        sigma::core::tasks::domain::on_task_destroyed()->
                 register_member_function<
                         RemoveChildFixture,
                         &RemoveChildFixture::on_task_destroyed
@@ -623,7 +630,7 @@ public:
         task_5 = new sigma::core::tasks::Task(task_3, "task_5");
 
         // connect callbacks
-        sigma::core::tasks::Task::on_destroyed()->
+        sigma::core::tasks::domain::on_task_destroyed()->
                 register_member_function<
                         ClearChildrenFixture,
                         &ClearChildrenFixture::on_task_destroyed
@@ -681,4 +688,1160 @@ ARC_TEST_UNIT_FIXTURE(clear_children, ClearChildrenFixture)
     ARC_CHECK_FALSE(fixture->board->has_child(fixture->task_2));
 }
 
+//------------------------------------------------------------------------------
+//                                     ORDER
+//------------------------------------------------------------------------------
+
+class OrderFixture : public TaskBaseFixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::Task* task_1;
+    sigma::core::tasks::Task* task_2;
+    sigma::core::tasks::Task* task_3;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    virtual void setup()
+    {
+        // super call
+        TaskBaseFixture::setup();
+
+        task_1 = new sigma::core::tasks::Task(board, "task_1");
+        task_2 = new sigma::core::tasks::Task(board, "task_2");
+        task_3 = new sigma::core::tasks::Task(board, "task_3");
+    }
+
+    bool keys_ascending(sigma::core::tasks::Task* parent)
+    {
+        const std::vector<sigma::core::tasks::Task*>& children =
+            parent->get_chidren();
+        for(std::size_t i = 1; i < children.size(); ++i)
+        {
+            if(children[i - 1]->get_order_key() >=
+               children[i]->get_order_key())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(order, OrderFixture)
+{
+    ARC_TEST_MESSAGE("Checking appended keys are ascending");
+    ARC_CHECK_TRUE(fixture->keys_ascending(fixture->board));
+
+    ARC_TEST_MESSAGE("Checking moving before a sibling");
+    arc::uint64 key_1 = fixture->task_1->get_order_key();
+    arc::uint64 key_2 = fixture->task_2->get_order_key();
+    fixture->task_3->move_before(fixture->task_2);
+    ARC_CHECK_EQUAL(fixture->board->get_chidren()[0], fixture->task_1);
+    ARC_CHECK_EQUAL(fixture->board->get_chidren()[1], fixture->task_3);
+    ARC_CHECK_EQUAL(fixture->board->get_chidren()[2], fixture->task_2);
+    ARC_CHECK_EQUAL(fixture->task_1->get_order_key(), key_1);
+    ARC_CHECK_EQUAL(fixture->task_2->get_order_key(), key_2);
+    ARC_CHECK_TRUE(fixture->keys_ascending(fixture->board));
+
+    ARC_TEST_MESSAGE("Checking moving after a sibling");
+    fixture->task_1->move_after(fixture->task_2);
+    ARC_CHECK_EQUAL(fixture->board->get_chidren()[0], fixture->task_3);
+    ARC_CHECK_EQUAL(fixture->board->get_chidren()[2], fixture->task_1);
+
+    ARC_TEST_MESSAGE("Checking undoing a reorder");
+    ARC_CHECK_TRUE(fixture->board->get_history().undo());
+    ARC_CHECK_EQUAL(fixture->board->get_chidren()[0], fixture->task_1);
+    ARC_CHECK_EQUAL(fixture->board->get_chidren()[1], fixture->task_3);
+    ARC_CHECK_TRUE(fixture->keys_ascending(fixture->board));
+
+    ARC_TEST_MESSAGE("Checking moving next to a sibling of another parent");
+    sigma::core::tasks::Task* child =
+        new sigma::core::tasks::Task(fixture->task_1, "child");
+    fixture->task_2->move_before(child);
+    ARC_CHECK_EQUAL(fixture->task_2->get_parent(), fixture->task_1);
+    ARC_CHECK_EQUAL(fixture->task_1->get_chidren()[0], fixture->task_2);
+    ARC_CHECK_THROW(
+        fixture->task_1->move_before(child),
+        arc::ex::IllegalActionError
+    );
+    ARC_CHECK_THROW(
+        fixture->task_1->move_before(fixture->board),
+        arc::ex::IllegalActionError
+    );
+    ARC_CHECK_THROW(
+        fixture->task_1->move_before(nullptr),
+        arc::ex::ValueError
+    );
+
+    ARC_TEST_MESSAGE("Checking repeated inserts at one position rebalance");
+    sigma::core::tasks::Task* first = fixture->board->get_chidren()[0];
+    for(std::size_t i = 0; i < 200; ++i)
+    {
+        sigma::core::tasks::Task* task =
+            new sigma::core::tasks::Task(fixture->board, "task");
+        task->move_after(first);
+    }
+    ARC_CHECK_EQUAL(fixture->board->get_children_count(), 202);
+    ARC_CHECK_EQUAL(fixture->board->get_chidren()[0], first);
+    ARC_CHECK_EQUAL(
+        fixture->board->get_chidren()[201],
+        fixture->task_3
+    );
+    ARC_CHECK_TRUE(fixture->keys_ascending(fixture->board));
+}
+
+//------------------------------------------------------------------------------
+//                                    SORTING
+//------------------------------------------------------------------------------
+
+class SortingFixture : public OrderFixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::Task* list;
+    std::size_t reorders;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    virtual void setup()
+    {
+        // super call
+        OrderFixture::setup();
+
+        list = new sigma::core::tasks::Task(board, "list");
+        reorders = 0;
+    }
+
+    void on_reordered(sigma::core::tasks::Task*)
+    {
+        ++reorders;
+    }
+
+    // returns the titles of the children of the given Task joined by spaces
+    arc::str::UTF8String titles(sigma::core::tasks::Task* parent)
+    {
+        arc::str::UTF8String joined;
+        ARC_CONST_FOR_EACH(it, parent->get_chidren())
+        {
+            if(!joined.is_empty())
+            {
+                joined += " ";
+            }
+            joined += (*it)->get_title();
+        }
+        return joined;
+    }
+
+    static bool by_estimate(
+            const sigma::core::tasks::Task* a,
+            const sigma::core::tasks::Task* b)
+    {
+        return a->get_estimate() < b->get_estimate();
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(sorting, SortingFixture)
+{
+    sigma::core::tasks::Task* list = fixture->list;
+    // accented titles are split so the escapes don't continue into the text
+    const char* titles[] = {"delta", "Bravo", "\xC3\x89" "cho", "alpha",
+                            "charlie", "\xC3\xA9" "cho", "Alpha"};
+    std::vector<sigma::core::tasks::Task*> tasks;
+    for(std::size_t i = 0; i < 7; ++i)
+    {
+        tasks.push_back(new sigma::core::tasks::Task(list, titles[i]));
+    }
+    sigma::core::ScopedCallback callback =
+        list->on_children_reordered()->register_member_function<
+            SortingFixture,
+            &SortingFixture::on_reordered>(fixture);
+
+    ARC_TEST_MESSAGE("Checking sorting by title ignores case");
+    list->sort_children(sigma::core::tasks::ORDER_BY_TITLE);
+    ARC_CHECK_EQUAL(
+        fixture->titles(list),
+        "alpha Alpha Bravo charlie delta \xC3\x89" "cho \xC3\xA9" "cho"
+    );
+    ARC_CHECK_EQUAL(fixture->reorders, 1);
+    ARC_CHECK_TRUE(fixture->keys_ascending(list));
+
+    ARC_TEST_MESSAGE("Checking retitling updates the sort key");
+    tasks[0]->set_title("Aardvark");
+    list->sort_children(sigma::core::tasks::ORDER_BY_TITLE);
+    ARC_CHECK_EQUAL(list->get_chidren()[0], tasks[0]);
+    ARC_CHECK_EQUAL(fixture->reorders, 2);
+
+    ARC_TEST_MESSAGE("Checking sorting an already sorted Task does nothing");
+    std::size_t undo_count = fixture->board->get_history().get_undo_count();
+    list->sort_children(sigma::core::tasks::ORDER_BY_TITLE);
+    ARC_CHECK_EQUAL(fixture->reorders, 2);
+    ARC_CHECK_EQUAL(fixture->board->get_history().get_undo_count(), undo_count);
+
+    ARC_TEST_MESSAGE("Checking sorting by priority");
+    tasks[4]->set_priority(sigma::core::tasks::PRIORITY_HIGH);
+    tasks[1]->set_priority(sigma::core::tasks::PRIORITY_LOW);
+    tasks[6]->set_priority(sigma::core::tasks::PRIORITY_HIGH);
+    list->sort_children(sigma::core::tasks::ORDER_BY_PRIORITY);
+    ARC_CHECK_EQUAL(list->get_chidren()[0], tasks[6]);
+    ARC_CHECK_EQUAL(list->get_chidren()[1], tasks[4]);
+    ARC_CHECK_EQUAL(list->get_chidren()[2], tasks[1]);
+    ARC_CHECK_EQUAL(list->get_chidren()[3], tasks[0]);
+
+    ARC_TEST_MESSAGE("Checking sorting by due date");
+    tasks[5]->set_due_date(-100);
+    tasks[3]->set_due_date(2000);
+    tasks[2]->set_due_date(50);
+    list->sort_children(sigma::core::tasks::ORDER_BY_DUE_DATE);
+    ARC_CHECK_EQUAL(list->get_chidren()[0], tasks[5]);
+    ARC_CHECK_EQUAL(list->get_chidren()[1], tasks[2]);
+    ARC_CHECK_EQUAL(list->get_chidren()[2], tasks[3]);
+    ARC_CHECK_EQUAL(list->get_chidren()[3], tasks[6]);
+
+    ARC_TEST_MESSAGE("Checking undoing and redoing a sort");
+    std::vector<sigma::core::tasks::Task*> sorted(list->get_chidren());
+    ARC_CHECK_TRUE(fixture->board->get_history().undo());
+    ARC_CHECK_EQUAL(list->get_chidren()[0], tasks[6]);
+    ARC_CHECK_EQUAL(list->get_chidren()[3], tasks[0]);
+    ARC_CHECK_TRUE(fixture->keys_ascending(list));
+    ARC_CHECK_TRUE(fixture->board->get_history().redo());
+    ARC_CHECK_TRUE(list->get_chidren() == sorted);
+
+    ARC_TEST_MESSAGE("Checking sorting with a custom comparator");
+    ARC_CHECK_THROW(
+        list->sort_children(sigma::core::tasks::TaskComparator()),
+        arc::ex::ValueError
+    );
+    for(std::size_t i = 0; i < tasks.size(); ++i)
+    {
+        tasks[i]->set_estimate(static_cast<arc::uint32>(100 - i * 10));
+    }
+    list->sort_children(&SortingFixture::by_estimate);
+    ARC_CHECK_EQUAL(list->get_chidren()[0], tasks[6]);
+    ARC_CHECK_EQUAL(list->get_chidren()[6], tasks[0]);
+
+    ARC_TEST_MESSAGE("Checking sorting many children in parallel");
+    std::srand(11);
+    sigma::core::tasks::Task* parent =
+        new sigma::core::tasks::Task(list, "parent");
+    for(std::size_t i = 0; i < 20000; ++i)
+    {
+        sigma::core::tasks::Task* child =
+            new sigma::core::tasks::Task(parent, "task");
+        child->set_estimate(static_cast<arc::uint32>(std::rand() % 500));
+    }
+    std::vector<sigma::core::tasks::Task*> expected(parent->get_chidren());
+    std::stable_sort(
+        expected.begin(),
+        expected.end(),
+        &SortingFixture::by_estimate
+    );
+    sigma::core::ScopedCallback parent_callback =
+        parent->on_children_reordered()->register_member_function<
+            SortingFixture,
+            &SortingFixture::on_reordered>(fixture);
+    std::size_t reorders = fixture->reorders;
+    parent->sort_children(&SortingFixture::by_estimate);
+    ARC_CHECK_TRUE(parent->get_chidren() == expected);
+    ARC_CHECK_TRUE(fixture->keys_ascending(parent));
+    ARC_CHECK_EQUAL(fixture->reorders, reorders + 1);
+}
+
+//------------------------------------------------------------------------------
+//                                    ANCESTRY
+//------------------------------------------------------------------------------
+
+class AncestryFixture : public TaskBaseFixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    std::vector<sigma::core::tasks::Task*> tasks;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    virtual void setup()
+    {
+        TaskBaseFixture::setup();
+
+        // a deep random tree
+        std::srand(3);
+        tasks.push_back(board);
+        for(std::size_t i = 0; i < 500; ++i)
+        {
+            // favour recent tasks as parents so the tree is deep
+            std::size_t range = std::min<std::size_t>(tasks.size(), 10);
+            sigma::core::tasks::Task* parent =
+                tasks[tasks.size() - 1 - (std::rand() % range)];
+            tasks.push_back(new sigma::core::tasks::Task(parent, "task"));
+        }
+    }
+
+    static std::size_t walk_depth(sigma::core::tasks::Task* task)
+    {
+        std::size_t depth = 0;
+        for(; task->get_parent() != nullptr; task = task->get_parent())
+        {
+            ++depth;
+        }
+        return depth;
+    }
+
+    static sigma::core::tasks::Task* walk_common_ancestor(
+            sigma::core::tasks::Task* a,
+            sigma::core::tasks::Task* b)
+    {
+        std::set<sigma::core::tasks::Task*> ancestors;
+        for(; a != nullptr; a = a->get_parent())
+        {
+            ancestors.insert(a);
+        }
+        for(; ancestors.find(b) == ancestors.end(); b = b->get_parent());
+        return b;
+    }
+
+    // checks the indexed queries against walking the parents
+    bool matches_walk()
+    {
+        bool matches = true;
+        for(std::size_t i = 0; i < 300; ++i)
+        {
+            sigma::core::tasks::Task* a = tasks[std::rand() % tasks.size()];
+            sigma::core::tasks::Task* b = tasks[std::rand() % tasks.size()];
+            std::size_t depth = walk_depth(a);
+            matches &= a->get_depth() == depth;
+            std::size_t level = std::rand() % (depth + 1);
+            sigma::core::tasks::Task* expected = a;
+            for(std::size_t j = depth; j > level; --j)
+            {
+                expected = expected->get_parent();
+            }
+            matches &= a->get_ancestor_at_depth(level) == expected;
+            matches &= a->find_common_ancestor(b) ==
+                       walk_common_ancestor(a, b);
+        }
+        return matches;
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(ancestry, AncestryFixture)
+{
+    std::vector<sigma::core::tasks::Task*>& tasks = fixture->tasks;
+
+    ARC_TEST_MESSAGE("Checking depths");
+    ARC_CHECK_EQUAL(fixture->board->get_depth(), 0);
+    ARC_CHECK_EQUAL(tasks[1]->get_depth(), 1);
+    ARC_CHECK_THROW(
+        tasks[1]->get_ancestor_at_depth(2),
+        arc::ex::ValueError
+    );
+
+    ARC_TEST_MESSAGE("Checking queries against walking parents");
+    ARC_CHECK_TRUE(fixture->matches_walk());
+
+    ARC_TEST_MESSAGE("Checking queries after moving subtrees");
+    for(std::size_t i = 0; i < 20; ++i)
+    {
+        sigma::core::tasks::Task* task = tasks[1 + std::rand() % 500];
+        sigma::core::tasks::Task* parent = tasks[std::rand() % tasks.size()];
+        try
+        {
+            task->set_parent(parent);
+        }
+        catch(const arc::ex::IllegalActionError&)
+        {
+        }
+    }
+    ARC_CHECK_TRUE(fixture->matches_walk());
+
+    ARC_TEST_MESSAGE("Checking finding common ancestors in bulk");
+    std::vector<std::pair<
+        const sigma::core::tasks::Task*,
+        const sigma::core::tasks::Task*
+    >> pairs;
+    for(std::size_t i = 0; i < 2000; ++i)
+    {
+        pairs.push_back(std::make_pair(
+                tasks[std::rand() % tasks.size()],
+                tasks[std::rand() % tasks.size()]
+        ));
+    }
+    std::vector<sigma::core::tasks::Task*> ancestors;
+    fixture->board->find_common_ancestors(pairs, ancestors);
+    ARC_CHECK_EQUAL(ancestors.size(), pairs.size());
+    bool bulk_matches = true;
+    for(std::size_t i = 0; i < pairs.size(); ++i)
+    {
+        bulk_matches &= ancestors[i] == fixture->walk_common_ancestor(
+                const_cast<sigma::core::tasks::Task*>(pairs[i].first),
+                const_cast<sigma::core::tasks::Task*>(pairs[i].second)
+        );
+    }
+    ARC_CHECK_TRUE(bulk_matches);
+
+    ARC_TEST_MESSAGE("Checking Tasks on different boards");
+    sigma::core::tasks::RootTask* board_2 =
+        sigma::core::tasks::domain::new_board("board_2");
+    sigma::core::tasks::Task* other =
+        new sigma::core::tasks::Task(board_2, "other");
+    ARC_CHECK_EQUAL(tasks[5]->find_common_ancestor(other), nullptr);
+    pairs.push_back(std::make_pair(tasks[5], other));
+    ARC_CHECK_THROW(
+        fixture->board->find_common_ancestors(pairs, ancestors),
+        arc::ex::ValueError
+    );
+    tasks[5]->set_parent(other);
+    ARC_CHECK_EQUAL(tasks[5]->get_depth(), 2);
+    ARC_CHECK_EQUAL(tasks[5]->find_common_ancestor(other), other);
+}
+
+//------------------------------------------------------------------------------
+//                                   COMPLETION
+//------------------------------------------------------------------------------
+
+class CompletionFixture : public TaskBaseFixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::Task* release;
+    sigma::core::tasks::Task* docs;
+    sigma::core::tasks::Task* build;
+    sigma::core::tasks::Task* test;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    virtual void setup()
+    {
+        TaskBaseFixture::setup();
+
+        release = new sigma::core::tasks::Task(board, "release");
+        docs = new sigma::core::tasks::Task(release, "docs");
+        build = new sigma::core::tasks::Task(release, "build");
+        test = new sigma::core::tasks::Task(build, "test");
+    }
+
+    // returns the board for an id of 0, otherwise the Task with the id
+    sigma::core::tasks::Task* find(arc::uint32 id)
+    {
+        if(id == 0)
+        {
+            return board;
+        }
+        return board->find_task(id);
+    }
+
+    // checks the stored counts of the given Task and its descendants against
+    // counting the descendants
+    static bool counts_match(
+            sigma::core::tasks::Task* task,
+            std::size_t& count,
+            std::size_t& done)
+    {
+        bool matches = true;
+        count = 0;
+        done = 0;
+        ARC_CONST_FOR_EACH(it, task->get_chidren())
+        {
+            std::size_t child_count = 0;
+            std::size_t child_done = 0;
+            matches &= counts_match(*it, child_count, child_done);
+            count += child_count + 1;
+            done += child_done;
+            if((*it)->get_status() == sigma::core::tasks::STATUS_DONE)
+            {
+                ++done;
+            }
+        }
+        return matches &&
+               task->get_descendant_count() == count &&
+               task->get_done_descendant_count() == done;
+    }
+
+    static bool counts_match(sigma::core::tasks::Task* task)
+    {
+        std::size_t count = 0;
+        std::size_t done = 0;
+        return counts_match(task, count, done);
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(completion, CompletionFixture)
+{
+    ARC_TEST_MESSAGE("Checking new Tasks");
+    ARC_CHECK_EQUAL(fixture->board->get_descendant_count(), 4);
+    ARC_CHECK_EQUAL(fixture->release->get_descendant_count(), 3);
+    ARC_CHECK_EQUAL(fixture->release->get_completion(), 0.0F);
+    ARC_CHECK_EQUAL(fixture->test->get_completion(), 0.0F);
+
+    ARC_TEST_MESSAGE("Checking status changes");
+    fixture->test->set_status(sigma::core::tasks::STATUS_DONE);
+    ARC_CHECK_EQUAL(fixture->test->get_completion(), 1.0F);
+    ARC_CHECK_EQUAL(fixture->build->get_completion(), 1.0F);
+    ARC_CHECK_EQUAL(fixture->board->get_done_descendant_count(), 1);
+    fixture->docs->set_status(sigma::core::tasks::STATUS_DONE);
+    fixture->docs->set_status(sigma::core::tasks::STATUS_BLOCKED);
+    fixture->build->set_status(sigma::core::tasks::STATUS_DONE);
+    ARC_CHECK_EQUAL(fixture->release->get_done_descendant_count(), 2);
+    ARC_CHECK_EQUAL(fixture->release->get_completion(), 2.0F / 3.0F);
+    ARC_CHECK_TRUE(fixture->board->get_history().undo());
+    ARC_CHECK_EQUAL(fixture->release->get_done_descendant_count(), 1);
+
+    ARC_TEST_MESSAGE("Checking moves");
+    fixture->build->set_parent(fixture->board);
+    ARC_CHECK_EQUAL(fixture->release->get_descendant_count(), 1);
+    ARC_CHECK_EQUAL(fixture->release->get_done_descendant_count(), 0);
+    ARC_CHECK_EQUAL(fixture->board->get_descendant_count(), 4);
+    ARC_CHECK_EQUAL(fixture->board->get_done_descendant_count(), 1);
+    fixture->build->set_status(sigma::core::tasks::STATUS_DONE);
+    fixture->build->move_before(fixture->docs);
+    ARC_CHECK_EQUAL(fixture->release->get_completion(), 2.0F / 3.0F);
+    sigma::core::tasks::RootTask* board_2 =
+        sigma::core::tasks::domain::new_board("board_2");
+    fixture->build->set_parent(board_2);
+    ARC_CHECK_EQUAL(fixture->board->get_descendant_count(), 2);
+    ARC_CHECK_EQUAL(board_2->get_done_descendant_count(), 2);
+
+    ARC_TEST_MESSAGE("Checking deletion");
+    fixture->docs->set_parent(fixture->build);
+    board_2->remove_child(fixture->build);
+    ARC_CHECK_EQUAL(board_2->get_descendant_count(), 0);
+    ARC_CHECK_EQUAL(board_2->get_done_descendant_count(), 0);
+    ARC_CHECK_EQUAL(fixture->release->get_completion(), 0.0F);
+    ARC_CHECK_TRUE(board_2->get_history().undo());
+    ARC_CHECK_EQUAL(board_2->get_descendant_count(), 3);
+    ARC_CHECK_EQUAL(board_2->get_done_descendant_count(), 2);
+
+    ARC_TEST_MESSAGE("Checking random changes");
+    // undoing may destroy and restore Tasks, so they are found by id
+    std::srand(5);
+    std::vector<arc::uint32> ids;
+    ids.push_back(0);
+    for(std::size_t i = 0; i < 300; ++i)
+    {
+        sigma::core::tasks::Task* task =
+            fixture->find(ids[std::rand() % ids.size()]);
+        if(task == nullptr)
+        {
+            continue;
+        }
+        switch(std::rand() % 4)
+        {
+            case 0:
+                ids.push_back(
+                    (new sigma::core::tasks::Task(task, "task"))->get_id());
+                break;
+            case 1:
+                if(!task->is_root())
+                {
+                    task->set_status(
+                        static_cast<sigma::core::tasks::TaskStatus>(
+                            std::rand() % 4)
+                    );
+                }
+                break;
+            case 2:
+            {
+                sigma::core::tasks::Task* parent =
+                    fixture->find(ids[std::rand() % ids.size()]);
+                if(!task->is_root() && parent != nullptr)
+                {
+                    try
+                    {
+                        task->set_parent(parent);
+                    }
+                    catch(const arc::ex::IllegalActionError&)
+                    {
+                    }
+                }
+                break;
+            }
+            default:
+                fixture->board->get_history().undo();
+                break;
+        }
+    }
+    ARC_CHECK_TRUE(fixture->counts_match(fixture->board));
+}
+
+//------------------------------------------------------------------------------
+//                                    ARCHIVE
+//------------------------------------------------------------------------------
+
+class ArchiveFixture : public TaskBaseFixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    sigma::core::tasks::Task* release;
+    arc::uint32 docs_id;
+    arc::uint32 build_id;
+    arc::uint32 test_id;
+    std::size_t destroyed;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    virtual void setup()
+    {
+        TaskBaseFixture::setup();
+
+        // release
+        //   docs                               done
+        //   build
+        //     test                             done, assigned
+        release = new sigma::core::tasks::Task(board, "release");
+        sigma::core::tasks::Task* docs =
+            new sigma::core::tasks::Task(release, "docs");
+        docs->set_status(sigma::core::tasks::STATUS_DONE);
+        sigma::core::tasks::Task* build =
+            new sigma::core::tasks::Task(release, "build");
+        sigma::core::tasks::Task* test =
+            new sigma::core::tasks::Task(build, "test");
+        test->set_status(sigma::core::tasks::STATUS_DONE);
+        test->set_assignee("sam");
+
+        docs_id = docs->get_id();
+        build_id = build->get_id();
+        test_id = test->get_id();
+        destroyed = 0;
+    }
+
+    void on_destroyed(sigma::core::tasks::Task*)
+    {
+        ++destroyed;
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(archive, ArchiveFixture)
+{
+    sigma::core::tasks::Task* release = fixture->release;
+    arc::uint64 hash = release->get_hash();
+    arc::uint64 board_hash = fixture->board->get_hash();
+
+    ARC_TEST_MESSAGE("Checking archiving");
+    ARC_CHECK_TRUE(release->archive());
+    ARC_CHECK_TRUE(release->is_archived());
+    ARC_CHECK_FALSE(release->archive());
+    ARC_CHECK_EQUAL(fixture->board->get_archived_count(), 3);
+    ARC_CHECK_EQUAL(release->get_children_count(), 2);
+    ARC_CHECK_EQUAL(release->get_descendant_count(), 3);
+    ARC_CHECK_EQUAL(release->get_completion(), 2.0F / 3.0F);
+    ARC_CHECK_EQUAL(fixture->board->get_hash(), board_hash);
+    release->set_title("renamed");
+    release->set_title("release");
+    ARC_CHECK_EQUAL(release->get_hash(), hash);
+
+    ARC_TEST_MESSAGE("Checking rehydrating through the children");
+    ARC_CHECK_EQUAL(release->get_chidren().size(), 2);
+    ARC_CHECK_FALSE(release->is_archived());
+    // the children of build stay archived until they're accessed
+    ARC_CHECK_EQUAL(fixture->board->get_archived_count(), 1);
+    ARC_CHECK_TRUE(release->get_chidren()[1]->is_archived());
+    ARC_CHECK_EQUAL(release->get_chidren()[0]->get_id(), fixture->docs_id);
+    ARC_CHECK_EQUAL(release->get_chidren()[1]->get_title(), "build");
+    ARC_CHECK_EQUAL(release->get_completion(), 2.0F / 3.0F);
+    ARC_CHECK_EQUAL(release->get_hash(), hash);
+
+    ARC_TEST_MESSAGE("Checking rehydrating through lookups");
+    fixture->board->find_task(fixture->build_id)->archive();
+    release->archive();
+    ARC_CHECK_EQUAL(fixture->board->get_archived_count(), 3);
+    sigma::core::tasks::Task* test =
+        fixture->board->find_task(fixture->test_id);
+    ARC_CHECK_TRUE(test != nullptr);
+    ARC_CHECK_EQUAL(test->get_assignee(), "sam");
+    ARC_CHECK_EQUAL(test->get_parent()->get_id(), fixture->build_id);
+    ARC_CHECK_EQUAL(fixture->board->get_archived_count(), 0);
+    ARC_CHECK_EQUAL(fixture->board->find_task(12345), nullptr);
+
+    ARC_TEST_MESSAGE("Checking rehydrating through searches");
+    release->archive();
+    std::vector<sigma::core::tasks::Task*> found;
+    fixture->board->find_tasks(
+        sigma::core::tasks::TaskFilter().with_status(
+            sigma::core::tasks::STATUS_DONE),
+        found
+    );
+    ARC_CHECK_EQUAL(found.size(), 2);
+    release->archive();
+    ARC_CHECK_EQUAL(
+        sigma::core::tasks::TaskQuery("title:test").find(
+            fixture->board,
+            found
+        ),
+        1
+    );
+
+    ARC_TEST_MESSAGE("Checking searches only rehydrate matching Tasks");
+    release->archive();
+    ARC_CHECK_EQUAL(
+        fixture->board->count_tasks(
+            sigma::core::tasks::TaskFilter().with_status(
+                sigma::core::tasks::STATUS_DONE)
+        ),
+        2
+    );
+    ARC_CHECK_EQUAL(
+        fixture->board->count_tasks(
+            sigma::core::tasks::TaskFilter().under(release)),
+        3
+    );
+    ARC_CHECK_TRUE(release->is_archived());
+    found.clear();
+    fixture->board->find_tasks(
+        sigma::core::tasks::TaskFilter().with_status(
+            sigma::core::tasks::STATUS_BLOCKED),
+        found
+    );
+    ARC_CHECK_TRUE(found.empty());
+    ARC_CHECK_TRUE(release->is_archived());
+    fixture->board->find_tasks(
+        sigma::core::tasks::TaskFilter().with_assignee("sam"),
+        found
+    );
+    ARC_CHECK_EQUAL(found.size(), 1);
+    ARC_CHECK_EQUAL(found[0]->get_id(), fixture->test_id);
+
+    ARC_TEST_MESSAGE("Checking rehydrating by adding a child");
+    release->archive();
+    sigma::core::tasks::Task* added =
+        new sigma::core::tasks::Task(release, "added");
+    ARC_CHECK_EQUAL(release->get_chidren().size(), 3);
+    ARC_CHECK_EQUAL(release->get_chidren()[2], added);
+
+    ARC_TEST_MESSAGE("Checking undoing changes to archived Tasks");
+    fixture->board->find_task(fixture->test_id)->set_status(
+            sigma::core::tasks::STATUS_OPEN);
+    release->archive();
+    ARC_CHECK_TRUE(fixture->board->get_history().undo());
+    ARC_CHECK_EQUAL(
+        fixture->board->find_task(fixture->test_id)->get_status(),
+        sigma::core::tasks::STATUS_DONE
+    );
+
+    ARC_TEST_MESSAGE("Checking deleting and moving archived Tasks");
+    release->archive();
+    fixture->board->remove_child(release);
+    ARC_CHECK_EQUAL(fixture->board->get_archived_count(), 0);
+    ARC_CHECK_EQUAL(fixture->board->find_task(fixture->test_id), nullptr);
+    ARC_CHECK_TRUE(fixture->board->get_history().undo());
+    release = fixture->board->get_chidren()[0];
+    ARC_CHECK_EQUAL(release->get_descendant_count(), 4);
+    release->archive();
+    sigma::core::tasks::RootTask* board_2 =
+        sigma::core::tasks::domain::new_board("board_2");
+    release->set_parent(board_2);
+    ARC_CHECK_EQUAL(fixture->board->get_archived_count(), 0);
+    ARC_CHECK_EQUAL(board_2->get_archived_count(), 4);
+    ARC_CHECK_EQUAL(board_2->get_done_descendant_count(), 2);
+    ARC_CHECK_EQUAL(
+        board_2->find_task(fixture->test_id)->get_parent()->get_id(),
+        fixture->build_id
+    );
+}
+
+ARC_TEST_UNIT_FIXTURE(archive_relations, ArchiveFixture)
+{
+    sigma::core::tasks::TasksDomain& domain =
+        sigma::core::tasks::domain::get_default();
+    sigma::core::tasks::DependencyGraph& graph = domain.get_dependencies();
+    sigma::core::tasks::TagIndex& tags = domain.get_tags();
+    sigma::core::tasks::Task* release = fixture->release;
+    sigma::core::tasks::Task* deploy =
+        new sigma::core::tasks::Task(fixture->board, "deploy");
+
+    // docs blocks test, test blocks deploy
+    sigma::core::tasks::Task* test =
+        fixture->board->find_task(fixture->test_id);
+    test->set_estimate(10);
+    deploy->set_estimate(5);
+    graph.add_dependency(
+            fixture->board->find_task(fixture->docs_id),
+            test
+    );
+    graph.add_dependency(test, deploy);
+    tags.add_tag(test, "backend");
+    tags.add_tag(fixture->board->find_task(fixture->build_id), "p1");
+
+    ARC_TEST_MESSAGE("Checking archiving keeps dependencies and tags");
+    sigma::core::ScopedCallback destroyed_callback =
+        sigma::core::tasks::domain::on_task_destroyed()->
+            register_member_function<
+                ArchiveFixture,
+                &ArchiveFixture::on_destroyed>(fixture);
+    release->archive();
+    ARC_CHECK_EQUAL(fixture->destroyed, 0);
+    ARC_CHECK_EQUAL(graph.get_task_count(), 3);
+    ARC_CHECK_EQUAL(graph.get_finish_time(deploy), 15);
+    ARC_CHECK_EQUAL(tags.get_tagged_count("backend"), 1);
+    ARC_CHECK_EQUAL(tags.get_tagged_count("p1"), 1);
+    std::vector<sigma::core::tasks::Task*> tagged;
+    tags.get_tasks(tags.get_tagged("backend"), tagged);
+    ARC_CHECK_TRUE(tagged.empty());
+
+    ARC_TEST_MESSAGE("Checking rehydrating restores dependencies and tags");
+    test = fixture->board->find_task(fixture->test_id);
+    ARC_CHECK_EQUAL(fixture->destroyed, 0);
+    ARC_CHECK_TRUE(tags.has_tag(test, "backend"));
+    ARC_CHECK_TRUE(tags.has_tag(test->get_parent(), "p1"));
+    tags.get_tasks(tags.get_tagged("backend"), tagged);
+    ARC_CHECK_EQUAL(tagged.size(), 1);
+    ARC_CHECK_EQUAL(tagged[0], test);
+    ARC_CHECK_TRUE(graph.has_dependency(test, deploy));
+    ARC_CHECK_TRUE(graph.has_dependency(
+            fixture->board->find_task(fixture->docs_id),
+            test
+    ));
+    // estimates still propagate from the rehydrated Task
+    test->set_estimate(20);
+    ARC_CHECK_EQUAL(graph.get_finish_time(deploy), 25);
+
+    ARC_TEST_MESSAGE("Checking deleting archived Tasks removes them");
+    release->archive();
+    fixture->board->remove_child(release);
+    ARC_CHECK_EQUAL(fixture->destroyed, 1);
+    ARC_CHECK_EQUAL(graph.get_task_count(), 0);
+    ARC_CHECK_EQUAL(tags.get_tagged_count("backend"), 0);
+    ARC_CHECK_EQUAL(tags.get_tagged_count("p1"), 0);
+}
+
+//------------------------------------------------------------------------------
+//                                  LAZY LOADING
+//------------------------------------------------------------------------------
+
+class LazyLoadingFixture : public TaskBaseFixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    std::vector<arc::uint8> data;
+    arc::uint32 deep_id;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    virtual void setup()
+    {
+        TaskBaseFixture::setup();
+
+        // 20 Tasks, each with 10 children, each with 5 children that are done
+        for(std::size_t i = 0; i < 20; ++i)
+        {
+            sigma::core::tasks::Task* top =
+                new sigma::core::tasks::Task(board, "top");
+            for(std::size_t j = 0; j < 10; ++j)
+            {
+                sigma::core::tasks::Task* middle =
+                    new sigma::core::tasks::Task(top, "middle");
+                for(std::size_t k = 0; k < 5; ++k)
+                {
+                    sigma::core::tasks::Task* leaf =
+                        new sigma::core::tasks::Task(middle, "leaf");
+                    leaf->set_status(sigma::core::tasks::STATUS_DONE);
+                    deep_id = leaf->get_id();
+                }
+            }
+        }
+
+        // the board is stored and the Tasks are deleted so that their ids
+        // can be loaded
+        sigma::core::tasks::TaskSerialiser::serialise_children(board, data);
+        sigma::core::tasks::domain::delete_board(board);
+        board = sigma::core::tasks::domain::new_board("loaded");
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(lazy_loading, LazyLoadingFixture)
+{
+    sigma::core::tasks::RootTask* board = fixture->board;
+    std::vector<arc::uint8>& data = fixture->data;
+
+    ARC_TEST_MESSAGE("Checking invalid data");
+    ARC_CHECK_THROW(
+        sigma::core::tasks::TaskSerialiser::load_children(
+                board,
+                &data[0],
+                data.size() - 1
+        ),
+        arc::ex::ParseError
+    );
+    ARC_CHECK_EQUAL(board->get_descendant_count(), 0);
+
+    ARC_TEST_MESSAGE("Checking loading doesn't create Tasks");
+    sigma::core::tasks::TaskSerialiser::load_children(
+            board,
+            &data[0],
+            data.size()
+    );
+    ARC_CHECK_EQUAL(board->get_resident_count(), 1);
+    ARC_CHECK_EQUAL(board->get_children_count(), 20);
+    ARC_CHECK_EQUAL(board->get_descendant_count(), 1220);
+    ARC_CHECK_EQUAL(board->get_done_descendant_count(), 1000);
+    ARC_CHECK_THROW(
+        sigma::core::tasks::TaskSerialiser::load_children(
+                board,
+                &data[0],
+                data.size()
+        ),
+        arc::ex::IllegalActionError
+    );
+
+    ARC_TEST_MESSAGE("Checking one level is created at a time");
+    std::vector<sigma::core::tasks::Task*> tops(board->get_chidren());
+    ARC_CHECK_EQUAL(tops.size(), 20);
+    ARC_CHECK_EQUAL(board->get_resident_count(), 21);
+    ARC_CHECK_EQUAL(tops[0]->get_children_count(), 10);
+    ARC_CHECK_EQUAL(tops[0]->get_descendant_count(), 60);
+    ARC_CHECK_EQUAL(tops[0]->get_completion(), 50.0F / 60.0F);
+    ARC_CHECK_EQUAL(board->get_resident_count(), 21);
+    ARC_CHECK_EQUAL(tops[0]->get_chidren().size(), 10);
+    ARC_CHECK_EQUAL(board->get_resident_count(), 31);
+    ARC_CHECK_EQUAL(board->get_done_descendant_count(), 1000);
+
+    ARC_TEST_MESSAGE("Checking the resident budget");
+    board->set_resident_budget(60);
+    for(std::size_t i = 1; i < 5; ++i)
+    {
+        tops[i]->get_chidren();
+    }
+    // tops[0] is the least recently used
+    ARC_CHECK_TRUE(tops[0]->is_archived());
+    ARC_CHECK_FALSE(tops[4]->is_archived());
+    ARC_CHECK_TRUE(board->get_resident_count() <= 60);
+    tops[2]->get_chidren();
+    tops[5]->get_chidren();
+    tops[6]->get_chidren();
+    ARC_CHECK_FALSE(tops[2]->is_archived());
+    ARC_CHECK_TRUE(tops[3]->is_archived());
+    ARC_CHECK_TRUE(board->get_resident_count() <= 60);
+    ARC_CHECK_EQUAL(board->get_descendant_count(), 1220);
+    ARC_CHECK_EQUAL(board->get_done_descendant_count(), 1000);
+
+    ARC_TEST_MESSAGE("Checking rehydrating under a read lock is reported");
+    {
+        sigma::core::util::ScopedReadLock lock(board->get_lock());
+        ARC_CHECK_EQUAL(board->find_task(tops[4]->get_id()), tops[4]);
+        ARC_CHECK_THROW(tops[3]->get_chidren(), arc::ex::StateError);
+        ARC_CHECK_THROW(
+            board->find_task(fixture->deep_id),
+            arc::ex::StateError
+        );
+        ARC_CHECK_TRUE(tops[3]->is_archived());
+    }
+
+    ARC_TEST_MESSAGE("Checking looking up a deep Task");
+    sigma::core::tasks::Task* deep = board->find_task(fixture->deep_id);
+    ARC_CHECK_TRUE(deep != nullptr);
+    ARC_CHECK_EQUAL(deep->get_title(), "leaf");
+    ARC_CHECK_EQUAL(deep->get_depth(), 3);
+    ARC_CHECK_EQUAL(deep->get_ancestor_at_depth(1), tops[19]);
+
+    ARC_TEST_MESSAGE("Checking searches only create matching Tasks");
+    board->set_resident_budget(0);
+    std::size_t resident = board->get_resident_count();
+    ARC_CHECK_EQUAL(
+        board->count_tasks(
+            sigma::core::tasks::TaskFilter().with_status(
+                sigma::core::tasks::STATUS_DONE)
+        ),
+        1000
+    );
+    ARC_CHECK_EQUAL(board->get_resident_count(), resident);
+    std::vector<sigma::core::tasks::Task*> found;
+    board->find_tasks(
+        sigma::core::tasks::TaskFilter().with_status(
+            sigma::core::tasks::STATUS_DONE),
+        found
+    );
+    ARC_CHECK_EQUAL(found.size(), 1000);
+    ARC_CHECK_EQUAL(board->get_done_descendant_count(), 1000);
+
+    ARC_TEST_MESSAGE("Checking searches keep within the resident budget");
+    board->set_resident_budget(60);
+    ARC_CHECK_TRUE(board->get_resident_count() <= 60);
+    found.clear();
+    ARC_CHECK_EQUAL(
+        sigma::core::tasks::TaskQuery("status:done").find(board, found, 5),
+        5
+    );
+    ARC_CHECK_TRUE(board->get_resident_count() <= 60);
+    ARC_CHECK_EQUAL(found[4]->get_title(), "leaf");
+    ARC_CHECK_EQUAL(board->get_descendant_count(), 1220);
+    ARC_CHECK_EQUAL(board->get_done_descendant_count(), 1000);
+}
+
+//------------------------------------------------------------------------------
+//                                   COMPACTION
+//------------------------------------------------------------------------------
+
+class CompactionFixture : public TaskBaseFixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    std::vector<sigma::core::tasks::Task*> tops;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    virtual void setup()
+    {
+        TaskBaseFixture::setup();
+
+        // 50 Tasks which each had 200 children, of which 10 remain
+        for(std::size_t i = 0; i < 50; ++i)
+        {
+            tops.push_back(new sigma::core::tasks::Task(board, "top"));
+            std::vector<sigma::core::tasks::Task*> children;
+            for(std::size_t j = 0; j < 200; ++j)
+            {
+                children.push_back(
+                        new sigma::core::tasks::Task(tops.back(), "child"));
+                children.back()->set_estimate(
+                        static_cast<arc::uint32>(i * 1000 + j));
+            }
+            for(std::size_t j = 10; j < 200; ++j)
+            {
+                tops.back()->remove_child(children[j]);
+            }
+        }
+    }
+
+    // appends the descendants of the Task in depth-first order
+    void depth_first(
+            const sigma::core::tasks::Task* task,
+            std::vector<sigma::core::tasks::Task*>& out)
+    {
+        ARC_CONST_FOR_EACH(it, task->get_chidren())
+        {
+            out.push_back(*it);
+            depth_first(*it, out);
+        }
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(compaction, CompactionFixture)
+{
+    sigma::core::tasks::RootTask* board = fixture->board;
+    std::vector<sigma::core::tasks::Task*>& tops = fixture->tops;
+    tops[3]->archive();
+
+    ARC_TEST_MESSAGE("Checking spare capacity is reclaimed");
+    std::size_t usage = board->get_memory_usage();
+    std::size_t reclaimed = board->compact();
+    ARC_CHECK_TRUE(reclaimed > 0);
+    ARC_CHECK_EQUAL(board->get_memory_usage(), usage - reclaimed);
+    ARC_CHECK_EQUAL(tops[0]->get_chidren().capacity(), 10);
+    ARC_CHECK_EQUAL(board->compact(), 0);
+
+    ARC_TEST_MESSAGE("Checking the board is unchanged");
+    ARC_CHECK_EQUAL(board->get_descendant_count(), 550);
+    ARC_CHECK_TRUE(tops[3]->is_archived());
+    ARC_CHECK_EQUAL(tops[7]->get_chidren()[4]->get_estimate(), 7004);
+    ARC_CHECK_EQUAL(tops[3]->get_chidren()[9]->get_estimate(), 3009);
+    ARC_CHECK_EQUAL(
+        board->count_tasks(
+            sigma::core::tasks::TaskFilter().with_estimate_between(1000, 1999)),
+        10
+    );
+
+    ARC_TEST_MESSAGE("Checking attributes are stored in depth-first order");
+    board->compact();
+    std::vector<sigma::core::tasks::Task*> expected;
+    fixture->depth_first(board, expected);
+    std::vector<sigma::core::tasks::Task*> found;
+    board->find_tasks(sigma::core::tasks::TaskFilter(), found);
+    ARC_CHECK_TRUE(found == expected);
+}
+
+//------------------------------------------------------------------------------
+//                               CONCURRENT BOARDS
+//------------------------------------------------------------------------------
+
+class ConcurrentBoardsFixture : public TaskBaseFixture
+{
+public:
+
+    //--------------------------------ATTRIBUTES--------------------------------
+
+    static const std::size_t thread_count = 4;
+    static const std::size_t tasks_per_thread = 2000;
+
+    std::vector<sigma::core::tasks::RootTask*> boards;
+    std::vector<std::vector<sigma::core::tasks::Task*>> created;
+
+    //--------------------------------FUNCTIONS---------------------------------
+
+    virtual void setup()
+    {
+        // super call
+        TaskBaseFixture::setup();
+
+        for(std::size_t i = 0; i < thread_count; ++i)
+        {
+            boards.push_back(sigma::core::tasks::domain::new_board("board"));
+        }
+        created.resize(thread_count);
+    }
+
+    void populate(std::size_t index)
+    {
+        sigma::core::tasks::Task* parent = boards[index];
+        for(std::size_t i = 0; i < tasks_per_thread; ++i)
+        {
+            sigma::core::tasks::Task* task =
+                new sigma::core::tasks::Task(parent, "task");
+            created[index].push_back(task);
+            // build a shallow tree by restarting at the root every so often
+            parent = (i % 8 == 7) ? boards[index] : task;
+        }
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(concurrent_boards, ConcurrentBoardsFixture)
+{
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < fixture->thread_count; ++i)
+    {
+        threads.push_back(std::thread(
+                &ConcurrentBoardsFixture::populate, fixture, i));
+    }
+    ARC_FOR_EACH(it, threads)
+    {
+        it->join();
+    }
+
+    ARC_TEST_MESSAGE("Checking ids are unique");
+    std::set<arc::uint32> ids;
+    bool boards_match = true;
+    for(std::size_t i = 0; i < fixture->thread_count; ++i)
+    {
+        ARC_FOR_EACH(task_it, fixture->created[i])
+        {
+            ids.insert((*task_it)->get_id());
+            boards_match &= (*task_it)->get_board() == fixture->boards[i];
+        }
+    }
+    ARC_CHECK_EQUAL(
+        ids.size(),
+        fixture->thread_count * fixture->tasks_per_thread
+    );
+
+    ARC_TEST_MESSAGE("Checking tasks belong to their boards");
+    ARC_CHECK_TRUE(boards_match);
+
+    ARC_TEST_MESSAGE("Checking moving a task between boards");
+    sigma::core::tasks::Task* moved = fixture->created[0][0];
+    moved->set_parent(fixture->boards[1]);
+    ARC_CHECK_EQUAL(moved->get_board(), fixture->boards[1]);
+    ARC_CHECK_EQUAL(moved->get_chidren()[0]->get_board(), fixture->boards[1]);
+}
+
 } // namespace anonymous